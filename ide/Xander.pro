@@ -21,14 +21,49 @@ SOURCES += \
     ../src/Controller/controller.cpp \
     ../src/Model/AudioCore/audiocore.cpp \
     ../src/Model/AudioEngine/SAudioEngine/saudioengine.cpp \
+    ../src/Model/AudioEngine/SEffectProcessor/seffectprocessor.cpp \
+    ../src/Model/AudioEngine/SEffectXAPO/seffectxapo.cpp \
+    ../src/Model/AudioEngine/SBiquadEQ/sbiquadeq.cpp \
+    ../src/Model/AudioEngine/SReverb/sreverb.cpp \
+    ../src/Model/AudioEngine/SEcho/secho.cpp \
+    ../src/Model/AudioEngine/SOfflineRenderer/sofflinerenderer.cpp \
+    ../src/Model/AudioEngine/SResampler/sresampler.cpp \
+    ../src/Model/AudioEngine/SFFT/sfft.cpp \
+    ../src/Model/AudioEngine/STimeStretcher/stimestretcher.cpp \
+    ../src/Model/AudioEngine/SSpectrumAnalyzer/sspectrumanalyzer.cpp \
+    ../src/Model/AudioEngine/SPositionClock/spositionclock.cpp \
+    ../src/Model/AudioEngine/SDecoder/sdecoder.cpp \
+    ../src/Model/AudioEngine/SMFDecoder/smfdecoder.cpp \
+    ../src/Model/AudioEngine/SWaveDecoder/swavedecoder.cpp \
+    ../src/Model/AudioEngine/SNullSink/snullsink.cpp \
+    ../src/Model/AudioEngine/SAsyncSink/sasyncsink.cpp \
+    ../src/Model/AudioEngine/SSinkTap/ssinktap.cpp \
+    ../src/Model/AudioEngine/SWaveFileSink/swavefilesink.cpp \
+    ../src/Model/AudioEngine/SCrossfader/scrossfader.cpp \
     ../src/Model/AudioEngine/SSound/ssound.cpp \
+    ../src/Model/AudioEngine/SSampleConverter/ssampleconverter.cpp \
+    ../src/Model/AudioEngine/SSeekIndex/sseekindex.cpp \
     ../src/Model/AudioEngine/SSoundMix/ssoundmix.cpp \
+    ../src/Model/AudioEngine/SWaveDecimator/swavedecimator.cpp \
+    ../src/Model/AudioEngine/SWaveFile/swavefile.cpp \
+    ../src/Model/AudioEngine/SMappedFile/smappedfile.cpp \
+    ../src/Model/AudioEngine/SFileHandleCache/sfilehandlecache.cpp \
+    ../src/Model/PeakCache/peakcache.cpp \
+    ../src/Model/TrackImporter/trackimporter.cpp \
+    ../src/Model/IndexedTracklist/indexedtracklist.cpp \
+    ../src/Model/TracklistFile/tracklistfile.cpp \
+    ../src/Model/MediaLibrary/medialibrary.cpp \
+    ../src/Model/StoppableTask/stoppabletask.cpp \
+    ../src/Model/NextTrackPredictor/nexttrackpredictor.cpp \
+    ../src/Model/Utf8/utf8.cpp \
     ../src/View/AboutQtWindow/aboutqtwindow.cpp \
     ../src/View/AboutWindow/aboutwindow.cpp \
     ../src/View/FXWindow/fxwindow.cpp \
+    ../src/View/SpectrumWindow/spectrumwindow.cpp \
     ../src/View/SearchWindow/searchwindow.cpp \
     ../src/View/TrackList/tracklist.cpp \
-    ../src/View/TrackWidget/trackwidget.cpp \
+    ../src/View/TrackListModel/tracklistmodel.cpp \
+    ../src/View/TrackDelegate/trackdelegate.cpp \
     ../src/main.cpp \
     ../src/View/MainWindow/mainwindow.cpp
 
@@ -37,25 +72,62 @@ HEADERS += \
     ../src/Controller/controller.h \
     ../src/Model/AudioCore/audiocore.h \
     ../src/Model/AudioEngine/SAudioEngine/saudioengine.h \
+    ../src/Model/AudioEngine/SEffectProcessor/seffectprocessor.h \
+    ../src/Model/AudioEngine/SEffectXAPO/seffectxapo.h \
+    ../src/Model/AudioEngine/SBiquadEQ/sbiquadeq.h \
+    ../src/Model/AudioEngine/SReverb/sreverb.h \
+    ../src/Model/AudioEngine/SEcho/secho.h \
+    ../src/Model/AudioEngine/SOfflineRenderer/sofflinerenderer.h \
+    ../src/Model/AudioEngine/SResampler/sresampler.h \
+    ../src/Model/AudioEngine/SFFT/sfft.h \
+    ../src/Model/AudioEngine/STimeStretcher/stimestretcher.h \
+    ../src/Model/AudioEngine/SSpectrumAnalyzer/sspectrumanalyzer.h \
+    ../src/Model/AudioEngine/SPositionClock/spositionclock.h \
+    ../src/Model/AudioEngine/SDecoder/sdecoder.h \
+    ../src/Model/AudioEngine/SMFDecoder/smfdecoder.h \
+    ../src/Model/AudioEngine/SWaveDecoder/swavedecoder.h \
+    ../src/Model/AudioEngine/SAudioSink/saudiosink.h \
+    ../src/Model/AudioEngine/SNullSink/snullsink.h \
+    ../src/Model/AudioEngine/SAsyncSink/sasyncsink.h \
+    ../src/Model/AudioEngine/SSinkTap/ssinktap.h \
+    ../src/Model/AudioEngine/SWaveFileSink/swavefilesink.h \
+    ../src/Model/AudioEngine/SCrossfader/scrossfader.h \
+    ../src/Model/AudioEngine/SRingBuffer/sringbuffer.h \
     ../src/Model/AudioEngine/SSound/ssound.h \
+    ../src/Model/AudioEngine/SSampleConverter/ssampleconverter.h \
+    ../src/Model/AudioEngine/SSeekIndex/sseekindex.h \
     ../src/Model/AudioEngine/SSoundMix/ssoundmix.h \
+    ../src/Model/AudioEngine/SWaveDecimator/swavedecimator.h \
+    ../src/Model/AudioEngine/SWaveFile/swavefile.h \
+    ../src/Model/AudioEngine/SMappedFile/smappedfile.h \
+    ../src/Model/AudioEngine/SFileHandleCache/sfilehandlecache.h \
+    ../src/Model/PeakCache/peakcache.h \
+    ../src/Model/TrackImporter/trackimporter.h \
+    ../src/Model/IndexedTracklist/indexedtracklist.h \
+    ../src/Model/TracklistFile/tracklistfile.h \
+    ../src/Model/MediaLibrary/medialibrary.h \
+    ../src/Model/StoppableTask/stoppabletask.h \
+    ../src/Model/NextTrackPredictor/nexttrackpredictor.h \
+    ../src/Model/Utf8/utf8.h \
     ../src/Model/globals.h \
     ../src/View/AboutQtWindow/aboutqtwindow.h \
     ../src/View/AboutWindow/aboutwindow.h \
     ../src/View/FXWindow/fxwindow.h \
+    ../src/View/SpectrumWindow/spectrumwindow.h \
     ../src/View/MainWindow/mainwindow.h \
     ../src/View/SearchWindow/searchwindow.h \
     ../src/View/TrackList/tracklist.h \
-    ../src/View/TrackWidget/trackwidget.h
+    ../src/View/TrackListModel/tracklistmodel.h \
+    ../src/View/TrackDelegate/trackdelegate.h
 
 FORMS += \
     ../src/View/AboutQtWindow/aboutqtwindow.ui \
     ../src/View/AboutWindow/aboutwindow.ui \
     ../src/View/FXWindow/fxwindow.ui \
+    ../src/View/SpectrumWindow/spectrumwindow.ui \
     ../src/View/MainWindow/mainwindow.ui \
     ../src/View/SearchWindow/searchwindow.ui \
-    ../src/View/TrackList/tracklist.ui \
-    ../src/View/TrackWidget/trackwidget.ui
+    ../src/View/TrackList/tracklist.ui
 
 INCLUDEPATH += "../src"
 INCLUDEPATH += "../src/Model"
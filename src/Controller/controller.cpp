@@ -25,9 +25,9 @@ void Controller::addTracks(const std::wstring &sFolderPath)
     pAudioCore->addTracks(sFolderPath);
 }
 
-void Controller::removeTrack(const std::wstring &sAudioTitle)
+void Controller::removeTrack(unsigned long long iTrackID)
 {
-    pAudioCore->removeTrack(sAudioTitle);
+    pAudioCore->removeTrack(iTrackID);
 }
 
 void Controller::setTrackPos(double x)
@@ -35,19 +35,19 @@ void Controller::setTrackPos(double x)
     pAudioCore->setTrackPos(x);
 }
 
-void Controller::moveUp(const std::wstring &sAudioTitle)
+void Controller::moveUp(unsigned long long iTrackID)
 {
-    pAudioCore->moveUp(sAudioTitle);
+    pAudioCore->moveUp(iTrackID);
 }
 
-void Controller::moveDown(const std::wstring &sAudioTitle)
+void Controller::moveDown(unsigned long long iTrackID)
 {
-    pAudioCore->moveDown(sAudioTitle);
+    pAudioCore->moveDown(iTrackID);
 }
 
-void Controller::playTrack(const std::wstring &sTrackTitle)
+void Controller::playTrack(unsigned long long iTrackID)
 {
-    pAudioCore->playTrack(sTrackTitle, false);
+    pAudioCore->playTrack(iTrackID, false);
 }
 
 void Controller::playTrack()
@@ -85,6 +85,21 @@ void Controller::setRepeatTrack()
     pAudioCore->setRepeatTrack();
 }
 
+void Controller::setCrossfade(double dCrossfadeInSec, bool bEqualPowerCurve)
+{
+    pAudioCore->setCrossfade(dCrossfadeInSec, bEqualPowerCurve ? CC_EQUAL_POWER : CC_LINEAR);
+}
+
+void Controller::exportTrack(unsigned long long iTrackID, const std::wstring &sOutputPath)
+{
+    pAudioCore->exportTrack(iTrackID, sOutputPath);
+}
+
+void Controller::exportTracklist(const std::wstring &sOutputFolder)
+{
+    pAudioCore->exportTracklist(sOutputFolder);
+}
+
 void Controller::clearTracklist()
 {
     pAudioCore->clearTracklist();
@@ -95,6 +110,11 @@ void Controller::setVolume(int iVolume)
     pAudioCore->setVolume(iVolume);
 }
 
+const SPositionClock *Controller::getPositionClock() const
+{
+    return pAudioCore->getPositionClock();
+}
+
 CurrentEffects *Controller::getCurrentEffects()
 {
     return pAudioCore->getCurrentEffects();
@@ -105,11 +125,26 @@ void Controller::setPitch(float fPitch)
     pAudioCore->setPitch(fPitch);
 }
 
+void Controller::setTempo(float fTempo)
+{
+    pAudioCore->setTempo(fTempo);
+}
+
 void Controller::setReverbVolume(float fVolume)
 {
     pAudioCore->setReverbVolume(fVolume);
 }
 
+void Controller::setSpectrumEnabled(bool bEnable)
+{
+    pAudioCore->setSpectrumEnabled(bEnable);
+}
+
+void Controller::getSpectrum(std::vector<float> &vBands)
+{
+    pAudioCore->getSpectrum(vBands);
+}
+
 void Controller::saveTracklist(const std::wstring &sPathToFile)
 {
     pAudioCore->saveTracklist(sPathToFile);
@@ -13,6 +13,7 @@
 
 class MainWindow;
 class AudioCore;
+class SPositionClock;
 
 class Controller
 {
@@ -23,15 +24,15 @@ public:
 
     void addTracks  (const std::vector<std::wstring>& vFiles);
     void addTracks  (const std::wstring& sFolderPath);
-    void removeTrack(const std::wstring& sAudioTitle);
+    void removeTrack(unsigned long long iTrackID);
     void setTrackPos(double x);
 
 
-    void moveUp     (const std::wstring& sAudioTitle);
-    void moveDown   (const std::wstring& sAudioTitle);
+    void moveUp     (unsigned long long iTrackID);
+    void moveDown   (unsigned long long iTrackID);
 
 
-    void playTrack  (const std::wstring& sTrackTitle);
+    void playTrack  (unsigned long long iTrackID);
     void playTrack  ();
     void pauseTrack ();
     void stopTrack  ();
@@ -41,6 +42,12 @@ public:
 
     void setRandomTrack();
     void setRepeatTrack();
+    // 'dCrossfadeInSec' == 0 - no crossfade, otherwise a linear or an equal-power curve.
+    void setCrossfade  (double dCrossfadeInSec, bool bEqualPowerCurve);
+
+
+    void exportTrack    (unsigned long long iTrackID, const std::wstring& sOutputPath);
+    void exportTracklist(const std::wstring& sOutputFolder);
 
 
     void clearTracklist();
@@ -49,11 +56,20 @@ public:
     void setVolume   (int iVolume);
 
 
+    // Can be read without locking (see SPositionClock).
+    const SPositionClock* getPositionClock() const;
+
+
     class CurrentEffects* getCurrentEffects();
     void setPitch       (float fPitch);
+    void setTempo       (float fTempo);
     void setReverbVolume(float fVolume);
 
 
+    void setSpectrumEnabled(bool bEnable);
+    void getSpectrum       (std::vector<float>& vBands);
+
+
     void saveTracklist  (const std::wstring& sPathToFile);
     void openTracklist  (const std::wstring& sPathToFile, bool bClearCurrentTracklist);
 
@@ -10,12 +10,20 @@
 // STL
 #include <filesystem>
 #include <functional>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
 
 // Custom
 #include "View/MainWindow/mainwindow.h"
 #include "Model/AudioEngine/SAudioEngine/saudioengine.h"
 #include "Model/AudioEngine/SSound/ssound.h"
 #include "Model/AudioEngine/SSoundMix/ssoundmix.h"
+#include "Model/AudioEngine/SOfflineRenderer/sofflinerenderer.h"
+#include "Model/AudioEngine/SWaveDecimator/swavedecimator.h"
+#include "Model/TrackImporter/trackimporter.h"
+#include "Model/TracklistFile/tracklistfile.h"
 
 namespace fs = std::filesystem;
 
@@ -29,6 +37,11 @@ AudioCore::AudioCore(MainWindow* pMainWindow)
     pAudioEngine = new SAudioEngine(pMainWindow);
     pAudioEngine->init(false);
     pAudioEngine->setMasterVolume(DEFAULT_VOLUME / 100.0f);
+    pAudioEngine->setMaxCachedFiles(MAX_CACHED_AUDIO_FILES);
+
+    // If the library file can't be written the library is only kept in memory.
+    std::error_code ec;
+    library.open((fs::temp_directory_path(ec) / L"Xander" / LIBRARY_FILE_NAME).wstring());
 
     pAudioEngine->createSoundMix(pMix);
 
@@ -70,6 +83,9 @@ AudioCore::AudioCore(MainWindow* pMainWindow)
     pMix->setAudioEffects(&vEffects);
 
 
+    spectrumAnalyzer.setup(SPECTRUM_FFT_SIZE, SPECTRUM_BAND_COUNT, SPECTRUM_MIN_FREQUENCY, SPECTRUM_MAX_FREQUENCY);
+    bSpectrumEnabled = false;
+
 
 
     pCurrentTrack = new SSound(pAudioEngine);
@@ -77,142 +93,243 @@ AudioCore::AudioCore(MainWindow* pMainWindow)
     std::function<void(SSound*)> f = std::bind(&AudioCore::onCurrentTrackEnded, this, std::placeholders::_1);
     pCurrentTrack->setOnPlayEndCallback(f);
 
+    pNextTrack = new SSound(pAudioEngine);
+    pNextTrack->setOnPlayEndCallback(f);
+
+    pNextTrackFile = nullptr;
+    bCrossfadeSet = false;
+    iNextTrackGeneration = 0;
+
+    dCrossfadeInSec = DEFAULT_CROSSFADE_IN_SEC;
+    crossfadeCurve = CC_EQUAL_POWER;
+
 
     bLoadedTrackAtLeastOneTime = false;
     bRandomTrack = false;
     bRepeatTrack = false;
-    bDrawingGraph = false;
     bDestroyCalled = false;
     bMonitorRunning = false;
+    bExportRunning = false;
+    bCancelExport = false;
+    bImportRunning = false;
+    bCancelImport = false;
+    iImportGeneration = 0;
+    iNextTrackID = 1;
 
     currentTrackState = CTS_DELETED;
+
+
+    pTracklist = std::make_shared<IndexedTracklist>();
+
+    iCurrentPosInSearchVec = 0;
+    bFirstSearchAfterKeyChange = false;
 }
 
 void AudioCore::addTracks(const std::vector<std::wstring> &vFiles)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    ImportJob job;
+    job.vFiles = vFiles;
+
+    startImport(job);
+}
+
+void AudioCore::addTracks(const std::wstring &sFolderPath)
+{
+    ImportJob job;
+    job.sFolderPath = sFolderPath;
+
+    startImport(job);
+}
+
+void AudioCore::addImportedTracks(const XTracklist &vTracks, unsigned int iImportGeneration)
+{
+    mtxTracklist.lock();
 
-    for (size_t i = 0; i < vFiles.size(); i++)
+    if (iImportGeneration != this->iImportGeneration)
     {
-        vAudioTracks.push_back(new XAudioFile());
+        // The tracklist was cleared after these tracks were found (their files are closed when they are deleted).
 
-        vAudioTracks.back()->pOpenedStream = new std::ifstream();
-        vAudioTracks.back()->pOpenedStream->open(vFiles[i], std::ios::binary);
+        mtxTracklist.unlock();
 
-        if (vAudioTracks.back()->pOpenedStream->is_open())
-        {
-            vAudioTracks.back()->sPathToAudioFile = vFiles[i];
-            vAudioTracks.back()->sAudioTitle = getTrackTitle(vFiles[i]);
-            vAudioTracks.back()->sTrackExtension = getTrackExtension(vFiles[i]);
+        return;
+    }
 
 
+    for (size_t i = 0; i < vTracks.size(); i++)
+    {
+        vTracks[i]->iTrackID = iNextTrackID;
+        iNextTrackID++;
+    }
 
-            // Tell MainWindow to create widget.
+    std::shared_ptr<IndexedTracklist> pNewTracklist = std::make_shared<IndexedTracklist>(*getTracklist());
+    pNewTracklist->append(vTracks);
 
-            std::promise<class TrackWidget*> promiseCreateWidget;
-            std::future<class TrackWidget*> future = promiseCreateWidget.get_future();
+    publishTracklist(pNewTracklist);
 
-            pMainWindow->addTrackWidget(vAudioTracks.back()->sAudioTitle, &promiseCreateWidget);
+    // Not under 'mtxTracklist': the transport may wait for the UI thread that may wait for 'mtxTracklist'.
+    mtxTracklist.unlock();
 
-            vAudioTracks.back()->pTrackWidget = future.get();
-        }
-        else
-        {
-            delete vAudioTracks.back()->pOpenedStream;
-            delete vAudioTracks[i];
-            vAudioTracks.pop_back();
 
-            pMainWindow->showMessageBox(L"Error", L"An error occurred at AudioCore::addTracks(): could not open the file \""
-                                        + vFiles[i] + L"\", skipping this file.", true, false);
-        }
+    // The next track may be different now (if the current track was the last one).
+    std::lock_guard<std::mutex> transportLock(mtxTransport);
+
+    cancelNextTrackIfChanged();
+}
+
+void AudioCore::applyFolderChanges(const MediaLibraryChanges &changes, unsigned int iImportGeneration)
+{
+    if (changes.vRemovedPaths.size() == 0 && changes.vMovedPaths.size() == 0)
+    {
+        return;
+    }
+
+
+    mtxTracklist.lock();
+
+    if (iImportGeneration != this->iImportGeneration)
+    {
+        // The tracklist was cleared during the scan.
+
+        mtxTracklist.unlock();
+
+        return;
+    }
+
+
+    std::shared_ptr<IndexedTracklist> pNewTracklist = std::make_shared<IndexedTracklist>(*getTracklist());
+
+    XTracklist vRemovedTracks;
+
+    TrackImporter::applyFolderChanges(*pNewTracklist, changes, vRemovedTracks);
+
+    if (vRemovedTracks.size() == 0 && changes.vMovedPaths.size() == 0)
+    {
+        mtxTracklist.unlock();
+
+        return;
     }
+
+
+    removeTracks(pNewTracklist, vRemovedTracks);
 }
 
-void AudioCore::addTracks(const std::wstring &sFolderPath)
+void AudioCore::removeTrack(unsigned long long iTrackID)
 {
-    mtxProcess.lock();
+    mtxTracklist.lock();
+
+    std::shared_ptr<const IndexedTracklist> pOldTracklist = getTracklist();
 
-    std::vector<std::wstring> vFilePaths;
+    size_t iIndex = 0;
 
-    for (const auto& entry : fs::directory_iterator(sFolderPath))
+    if (pOldTracklist->findTrack(iTrackID, iIndex) == false)
     {
-        if (entry.is_directory() == false &&
-                (entry.path().extension() == EXTENSION_MP3 || entry.path().extension() == EXTENSION_WAV || entry.path().extension() == EXTENSION_OGG))
-        {
-            vFilePaths.push_back(entry.path().wstring());
-        }
+        mtxTracklist.unlock();
+
+        return;
     }
 
-    mtxProcess.unlock();
 
-    addTracks(vFilePaths);
+    std::shared_ptr<XAudioFile> pAudio = (*pOldTracklist)[iIndex];
+
+    std::shared_ptr<IndexedTracklist> pNewTracklist = std::make_shared<IndexedTracklist>(*pOldTracklist);
+    pNewTracklist->remove(iIndex);
+
+    removeTracks(pNewTracklist, {pAudio});
 }
 
-void AudioCore::removeTrack(const std::wstring &sAudioTitle)
+void AudioCore::removeTracks(std::shared_ptr<const IndexedTracklist> pNewTracklist, const XTracklist& vRemovedTracks)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    publishTracklist(pNewTracklist);
+
+
+
+    mtxTransport.lock();
+
+    std::shared_future<bool> futureGraphStopped;
 
-    for (size_t i = 0; i < vAudioTracks.size(); i++)
+    for (size_t i = 0; i < vRemovedTracks.size(); i++)
     {
-        if (vAudioTracks[i]->sAudioTitle == sAudioTitle)
+        const std::shared_ptr<XAudioFile>& pAudio = vRemovedTracks[i];
+
+        if (pAudio == pNextTrackFile || (vPlayedHistory.size() > 0 && vPlayedHistory.back() == pAudio))
         {
-            if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED && vPlayedHistory.back()->sAudioTitle == sAudioTitle)
-            {
-                // Playing right now.
-                pCurrentTrack->stopSound();
+            // Even if the crossfade started.
+            cancelNextTrack(true);
+        }
 
-                waitForGraphToStop();
-                pMainWindow->clearGraph();
+        if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED && vPlayedHistory.size() > 0 && vPlayedHistory.back() == pAudio)
+        {
+            // Playing right now.
+            pCurrentTrack->stopSound();
 
-                currentTrackState = CTS_DELETED;
+            // Wait for the graph after the mutexes are unlocked (see below).
+            futureGraphStopped = graphTask.stop();
 
-                pMainWindow->changePlayButtonStyle(false, false);
+            currentTrackState = CTS_DELETED;
 
-                pMainWindow->setMainWindowTitle(L"Xander");
-            }
+            positionClock.clear();
 
+            pMainWindow->changePlayButtonStyle(false, false);
 
-            for (size_t j = 0; j < vPlayedHistory.size();)
-            {
-                // Remove from history.
+            pMainWindow->setMainWindowTitle(L"Xander");
+        }
 
-                if (vPlayedHistory[j] == vAudioTracks[i])
-                {
-                    vPlayedHistory.erase(vPlayedHistory.begin() + j);
-                }
-                else
-                {
-                    j++;
-                }
-            }
 
+        for (size_t j = 0; j < vPlayedHistory.size();)
+        {
+            // Remove from history.
+
+            if (vPlayedHistory[j] == pAudio)
+            {
+                vPlayedHistory.erase(vPlayedHistory.begin() + j);
+            }
+            else
+            {
+                j++;
+            }
+        }
+    }
 
-            vAudioTracks[i]->pOpenedStream->close();
-            delete vAudioTracks[i]->pOpenedStream;
+    // Keeps the crossfade (if started).
+    cancelNextTrackIfChanged();
 
-            std::promise<bool> promiseRemoveWidget;
-            std::future<bool> future = promiseRemoveWidget.get_future();
+    mtxTransport.unlock();
 
-            pMainWindow->removeTrackWidget(vAudioTracks[i]->pTrackWidget, &promiseRemoveWidget);
+    mtxTracklist.unlock();
 
-            future.get();
 
-            delete vAudioTracks[i];
 
+    if (futureGraphStopped.valid())
+    {
+        // The draw thread may take a while to notice the stop,
+        // other threads (import, search, next track) are not blocked meanwhile.
+        futureGraphStopped.get();
 
-            vAudioTracks.erase(vAudioTracks.begin() + i);
+        std::lock_guard<std::mutex> transportLock(mtxTransport);
 
-            break;
+        if (currentTrackState == CTS_DELETED)
+        {
+            // Not if another track was started while waiting (it has a new graph).
+            pMainWindow->clearGraph();
         }
     }
+
+
+    for (size_t i = 0; i < vRemovedTracks.size(); i++)
+    {
+        removeTrack(vRemovedTracks[i].get());
+    }
 }
 
 void AudioCore::setTrackPos(double x)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTransport);
 
     if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
+        // The fade out is set by frame so it stays valid, the next track will be prefetched again.
+        cancelNextTrack(true);
+
         SSoundInfo info;
         pCurrentTrack->getSoundInfo(info);
 
@@ -221,74 +338,79 @@ void AudioCore::setTrackPos(double x)
 
         pCurrentTrack->setPositionInSec(dResultPosInSec);
 
+        updatePositionClock();
+    }
+}
 
-        if (currentTrackState == CTS_PAUSED)
-        {
-            SSoundInfo info;
-            pCurrentTrack->getSoundInfo(info);
-
+void AudioCore::moveUp(unsigned long long iTrackID)
+{
+    std::lock_guard<std::mutex> lock(mtxTracklist);
 
-            std::string sTime = getTimeString(dResultPosInSec);
+    std::shared_ptr<const IndexedTracklist> pOldTracklist = getTracklist();
 
+    size_t iIndex = 0;
 
-            pMainWindow->setCurrentPos(dResultPosInSec / info.dSoundLengthInSec, sTime);
-        }
+    if (pOldTracklist->findTrack(iTrackID, iIndex) == false)
+    {
+        return;
     }
-}
 
-void AudioCore::moveUp(const std::wstring &sAudioTitle)
-{
-    std::lock_guard<std::mutex> lock(mtxProcess);
 
-    for (size_t i = 0; i < vAudioTracks.size(); i++)
+    std::shared_ptr<IndexedTracklist> pNewTracklist = std::make_shared<IndexedTracklist>(*pOldTracklist);
+
+    if (iIndex == 0)
     {
-        if (vAudioTracks[i]->sAudioTitle == sAudioTitle)
-        {
-            XAudioFile* pAudio = vAudioTracks[i];
-            vAudioTracks.erase(vAudioTracks.begin() + i);
+        pNewTracklist->move(iIndex, pNewTracklist->size() - 1);
+    }
+    else
+    {
+        pNewTracklist->move(iIndex, iIndex - 1);
+    }
 
-            if (i == 0)
-            {
-                vAudioTracks.push_back(pAudio);
-            }
-            else
-            {
-                vAudioTracks.insert(vAudioTracks.begin() + i - 1, pAudio);
-            }
+    publishTracklist(pNewTracklist);
 
-            break;
-        }
-    }
+
+    std::lock_guard<std::mutex> transportLock(mtxTransport);
+
+    cancelNextTrackIfChanged();
 }
 
-void AudioCore::moveDown(const std::wstring &sAudioTitle)
+void AudioCore::moveDown(unsigned long long iTrackID)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTracklist);
+
+    std::shared_ptr<const IndexedTracklist> pOldTracklist = getTracklist();
+
+    size_t iIndex = 0;
 
-    for (size_t i = 0; i < vAudioTracks.size(); i++)
+    if (pOldTracklist->findTrack(iTrackID, iIndex) == false)
     {
-        if (vAudioTracks[i]->sAudioTitle == sAudioTitle)
-        {
-            XAudioFile* pAudio = vAudioTracks[i];
-            vAudioTracks.erase(vAudioTracks.begin() + i);
+        return;
+    }
 
-            if (i == vAudioTracks.size())
-            {
-                vAudioTracks.insert(vAudioTracks.begin(), pAudio);
-            }
-            else
-            {
-                vAudioTracks.insert(vAudioTracks.begin() + i + 1, pAudio);
-            }
 
-            break;
-        }
+    std::shared_ptr<IndexedTracklist> pNewTracklist = std::make_shared<IndexedTracklist>(*pOldTracklist);
+
+    if (iIndex == pNewTracklist->size() - 1)
+    {
+        pNewTracklist->move(iIndex, 0);
     }
+    else
+    {
+        pNewTracklist->move(iIndex, iIndex + 1);
+    }
+
+    publishTracklist(pNewTracklist);
+
+
+    std::lock_guard<std::mutex> transportLock(mtxTransport);
+
+    cancelNextTrackIfChanged();
 }
 
-void AudioCore::playTrack(const std::wstring &sTrackTitle, bool bCalledFromOtherThread)
+void AudioCore::playTrack(unsigned long long iTrackID, bool bCalledFromOtherThread)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::unique_lock<std::mutex> lock(mtxTransport);
 
 
     if (bMonitorRunning == false)
@@ -298,89 +420,126 @@ void AudioCore::playTrack(const std::wstring &sTrackTitle, bool bCalledFromOther
     }
 
 
-    if (vPlayedHistory.size() == 0 || vPlayedHistory.back()->sAudioTitle != sTrackTitle)
+    if (vPlayedHistory.size() == 0 || vPlayedHistory.back()->iTrackID != iTrackID)
     {
-        waitForGraphToStop();
+        // The draw thread may take a while to notice the stop, the transport is not blocked meanwhile
+        // (the graphs are only started here, under 'mtxTransport').
+        graphTask.stopAndWaitUnlocked(lock);
     }
 
 
-    for (size_t i = 0; i < vAudioTracks.size(); i++)
+    std::shared_ptr<XAudioFile> pAudio = getTracklist()->getTrack(iTrackID);
+
+    if (pAudio == nullptr)
     {
-        if (vAudioTracks[i]->sAudioTitle == sTrackTitle)
-        {
-            if (pCurrentTrack->loadAudioFile(vAudioTracks[i]->sPathToAudioFile, true, pMix))
-            {
-                return;
-            }
+        return;
+    }
 
-            applyAudioEffects();
 
+    bool bAlreadyPlaying = false;
 
-            if (pCurrentTrack->playSound())
-            {
-                return;
-            }
+    if (pNextTrackFile == pAudio)
+    {
+        // Already loaded and decoding, switch the sounds.
 
-            bLoadedTrackAtLeastOneTime = true;
-            currentTrackState = CTS_PLAYING;
+        pCurrentTrack->stopSound();
 
-            pMainWindow->changePlayButtonStyle(true, bCalledFromOtherThread);
+        std::swap(pCurrentTrack, pNextTrack);
 
+        pNextTrackFile = nullptr;
+        bCrossfadeSet = false;
 
 
-            // Add to history.
+        // Started by the crossfade.
+        SSoundState state;
+        pCurrentTrack->getSoundState(state);
 
-            bool bNewTrack = false;
+        bAlreadyPlaying = (state == SS_PLAYING);
+    }
+    else
+    {
+        cancelNextTrack(true);
 
-            if (vPlayedHistory.size() > 0)
-            {
-                if (vPlayedHistory.back() != vAudioTracks[i])
-                {
-                    if (vPlayedHistory.size() == MAX_HISTORY_SIZE)
-                    {
-                        vPlayedHistory.erase(vPlayedHistory.begin());
-                    }
+        if (pCurrentTrack->loadAudioFile(pAudio->sPathToAudioFile, true, pMix))
+        {
+            return;
+        }
+    }
 
-                    vPlayedHistory.push_back(vAudioTracks[i]);
+    applyAudioEffects();
 
-                    bNewTrack = true;
-                }
-            }
-            else
-            {
-                vPlayedHistory.push_back(vAudioTracks[i]);
 
-                bNewTrack = true;
-            }
+    if (bAlreadyPlaying == false && pCurrentTrack->playSound())
+    {
+        return;
+    }
 
+    bLoadedTrackAtLeastOneTime = true;
+    currentTrackState = CTS_PLAYING;
 
-            // Show track on screen.
+    updatePositionClock();
 
-            pMainWindow->setTrackInfo(vAudioTracks[i]->sAudioTitle, getTrackInfo(vAudioTracks[i]));
+    pMainWindow->changePlayButtonStyle(true, bCalledFromOtherThread);
 
 
 
-            if (bNewTrack)
-            {
-                // New track: start drawing graph.
+    // Add to history.
 
-                promiseFinishDrawGraph = std::promise<bool>();
+    bool bNewTrack = false;
 
-                std::thread t (&AudioCore::drawGraph, this);
-                t.detach();
+    if (vPlayedHistory.size() > 0)
+    {
+        if (vPlayedHistory.back() != pAudio)
+        {
+            if (vPlayedHistory.size() == MAX_HISTORY_SIZE)
+            {
+                vPlayedHistory.erase(vPlayedHistory.begin());
             }
 
+            vPlayedHistory.push_back(pAudio);
 
-            pMainWindow->setMainWindowTitle(vAudioTracks[i]->sAudioTitle);
-
-            break;
+            bNewTrack = true;
         }
     }
+    else
+    {
+        vPlayedHistory.push_back(pAudio);
+
+        bNewTrack = true;
+    }
+
+
+    updateTrackMetadata(pAudio.get());
+
+
+    // Show track on screen.
+
+    pMainWindow->setTrackInfo(pAudio->sAudioTitle, getTrackInfo(pAudio.get()));
+
+
+
+    if (bNewTrack)
+    {
+        // New track: start drawing graph.
+
+        // Started here and not in the thread so that a stop requested before the thread starts is not lost.
+        unsigned long long iGraphTaskID = 0;
+        std::promise<bool> promiseFinish = graphTask.start(iGraphTaskID);
+
+        std::thread t (&AudioCore::drawGraph, this, pAudio->sPathToAudioFile, std::move(promiseFinish), iGraphTaskID);
+        t.detach();
+    }
+
+
+    pMainWindow->setMainWindowTitle(pAudio->sAudioTitle);
 }
 
 void AudioCore::playTrack(bool bCalledFromOtherThread)
 {
-    mtxProcess.lock();
+    std::shared_ptr<const IndexedTracklist> pTracklist = getTracklist();
+    const IndexedTracklist& vTracks = *pTracklist;
+
+    mtxTransport.lock();
 
     if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
@@ -401,37 +560,44 @@ void AudioCore::playTrack(bool bCalledFromOtherThread)
             currentTrackState = CTS_PLAYING;
         }
 
+        updatePositionClock();
+
         pMainWindow->setMainWindowTitle(vPlayedHistory.back()->sAudioTitle);
 
-        mtxProcess.unlock();
+        mtxTransport.unlock();
     }
-    else if (vAudioTracks.size() > 0)
+    else if (vTracks.size() > 0)
     {
-        mtxProcess.unlock();
+        mtxTransport.unlock();
 
-        playTrack(vAudioTracks[0]->sAudioTitle, bCalledFromOtherThread);
+        playTrack(vTracks[0]->iTrackID, bCalledFromOtherThread);
 
-        pMainWindow->setNewPlayingTrack(vAudioTracks[0]->pTrackWidget, bCalledFromOtherThread);
+        pMainWindow->setNewPlayingTrack(vTracks[0]->iTrackID, bCalledFromOtherThread);
         pMainWindow->changePlayButtonStyle(true, bCalledFromOtherThread);
     }
     else
     {
-        mtxProcess.unlock();
+        mtxTransport.unlock();
     }
 }
 
 void AudioCore::pauseTrack()
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTransport);
 
     if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
         if (currentTrackState == CTS_PLAYING)
         {
+            // The current track will fade out (if the crossfade started) and the next track will be loaded as usual.
+            cancelNextTrack(true);
+
             pCurrentTrack->pauseSound();
 
             currentTrackState = CTS_PAUSED;
 
+            updatePositionClock();
+
             pMainWindow->changePlayButtonStyle(false, false);
 
             pMainWindow->setMainWindowTitle(L"Xander");
@@ -442,6 +608,8 @@ void AudioCore::pauseTrack()
 
             currentTrackState = CTS_PLAYING;
 
+            updatePositionClock();
+
             pMainWindow->changePlayButtonStyle(true, false);
 
             pMainWindow->setMainWindowTitle(vPlayedHistory.back()->sAudioTitle);
@@ -451,17 +619,20 @@ void AudioCore::pauseTrack()
 
 void AudioCore::stopTrack(bool bCalledFromOtherThread)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTransport);
 
     if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
+        cancelNextTrack(true);
+
         pCurrentTrack->stopSound();
+        pCurrentTrack->clearFade();
 
         currentTrackState = CTS_STOPPED;
 
         pMainWindow->changePlayButtonStyle(false, bCalledFromOtherThread);
 
-        pMainWindow->setCurrentPos(0.0, "");
+        positionClock.clear();
 
         pMainWindow->setMainWindowTitle(L"Xander");
     }
@@ -469,11 +640,14 @@ void AudioCore::stopTrack(bool bCalledFromOtherThread)
 
 void AudioCore::prevTrack()
 {
-    mtxProcess.lock();
+    std::shared_ptr<const IndexedTracklist> pTracklist = getTracklist();
+    const IndexedTracklist& vTracks = *pTracklist;
+
+    mtxTransport.lock();
 
-    if (vAudioTracks.size() == 0)
+    if (vTracks.size() == 0)
     {
-        mtxProcess.unlock();
+        mtxTransport.unlock();
         return;
     }
 
@@ -481,33 +655,24 @@ void AudioCore::prevTrack()
     {
         if (vPlayedHistory.size() > 1)
         {
-            XAudioFile* pFind = vPlayedHistory[vPlayedHistory.size() - 2];
-
-            bool bFound = false;
+            std::shared_ptr<XAudioFile> pFind = vPlayedHistory[vPlayedHistory.size() - 2];
 
             // Should 100% find.
-            for (size_t i = 0; i < vAudioTracks.size(); i++)
-            {
-                if (vAudioTracks[i] == pFind)
-                {
-                    bFound = true;
-                    break;
-                }
-            }
+            size_t iFoundIndex = 0;
 
-            if (bFound)
+            if (vTracks.findTrack(pFind->iTrackID, iFoundIndex))
             {
                 vPlayedHistory.pop_back(); // pop current
                 vPlayedHistory.pop_back();
 
-                mtxProcess.unlock();
-                playTrack(pFind->sAudioTitle, false);
+                mtxTransport.unlock();
+                playTrack(pFind->iTrackID, false);
 
-                pMainWindow->setNewPlayingTrack(pFind->pTrackWidget, false);
+                pMainWindow->setNewPlayingTrack(pFind->iTrackID, false);
             }
             else
             {
-                mtxProcess.unlock();
+                mtxTransport.unlock();
 
                 pMainWindow->showMessageBox(L"Error", L"An error occurred at AudioCore::prevTrack(): "
                                                       "could not find XAudioFile.", true, false);
@@ -515,30 +680,48 @@ void AudioCore::prevTrack()
         }
         else
         {
-            mtxProcess.unlock();
+            mtxTransport.unlock();
         }
     }
     else
     {
-        mtxProcess.unlock();
+        mtxTransport.unlock();
     }
 }
 
 void AudioCore::nextTrack(bool bCalledFromOtherThread)
 {
-    mtxProcess.lock();
+    std::shared_ptr<const IndexedTracklist> pTracklist = getTracklist();
+    const IndexedTracklist& vTracks = *pTracklist;
 
-    if (vAudioTracks.size() == 0)
+    mtxTransport.lock();
+
+    if (vTracks.size() == 0)
     {
-        mtxProcess.unlock();
+        mtxTransport.unlock();
         return;
     }
 
     if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
-        if (vAudioTracks.size() == 1)
+        if (pNextTrackFile)
+        {
+            // Use the track that was picked (and prefetched, maybe already crossfading) earlier.
+
+            std::shared_ptr<XAudioFile> pNextFile = pNextTrackFile;
+
+            mtxTransport.unlock();
+
+            playTrack(pNextFile->iTrackID, bCalledFromOtherThread);
+
+            pMainWindow->setNewPlayingTrack(pNextFile->iTrackID, bCalledFromOtherThread);
+
+            return;
+        }
+
+        if (vTracks.size() == 1)
         {
-            mtxProcess.unlock();
+            mtxTransport.unlock();
 
             stopTrack(bCalledFromOtherThread);
             playTrack(bCalledFromOtherThread);
@@ -552,20 +735,12 @@ void AudioCore::nextTrack(bool bCalledFromOtherThread)
 
             size_t iCurrentIndex = 0;
 
-            for (size_t i = 0; i < vAudioTracks.size(); i++)
-            {
-                if (vAudioTracks[i] == vPlayedHistory.back())
-                {
-                    iCurrentIndex = i;
-
-                    break;
-                }
-            }
+            vTracks.findTrack(vPlayedHistory.back()->iTrackID, iCurrentIndex);
 
 
-            if (vAudioTracks.size() > 1)
+            if (vTracks.size() > 1)
             {
-                std::uniform_int_distribution<> uid(0, static_cast<int>(vAudioTracks.size()) - 1);
+                std::uniform_int_distribution<> uid(0, static_cast<int>(vTracks.size()) - 1);
 
                 do
                 {
@@ -573,15 +748,15 @@ void AudioCore::nextTrack(bool bCalledFromOtherThread)
 
                 }while (iNextTrackIndex == iCurrentIndex);
 
-                mtxProcess.unlock();
+                mtxTransport.unlock();
 
-                playTrack(vAudioTracks[iNextTrackIndex]->sAudioTitle, bCalledFromOtherThread);
+                playTrack(vTracks[iNextTrackIndex]->iTrackID, bCalledFromOtherThread);
 
-                pMainWindow->setNewPlayingTrack(vAudioTracks[iNextTrackIndex]->pTrackWidget, bCalledFromOtherThread);
+                pMainWindow->setNewPlayingTrack(vTracks[iNextTrackIndex]->iTrackID, bCalledFromOtherThread);
             }
             else
             {
-                mtxProcess.unlock();
+                mtxTransport.unlock();
 
                 stopTrack(bCalledFromOtherThread);
                 playTrack(bCalledFromOtherThread);
@@ -589,7 +764,7 @@ void AudioCore::nextTrack(bool bCalledFromOtherThread)
         }
         else if (bRepeatTrack)
         {
-            mtxProcess.unlock();
+            mtxTransport.unlock();
 
             stopTrack(bCalledFromOtherThread);
             playTrack(bCalledFromOtherThread);
@@ -598,58 +773,52 @@ void AudioCore::nextTrack(bool bCalledFromOtherThread)
         {
             size_t iCurrentIndex = 0;
 
-            for (size_t i = 0; i < vAudioTracks.size(); i++)
-            {
-                if (vAudioTracks[i] == vPlayedHistory.back())
-                {
-                    iCurrentIndex = i;
-
-                    break;
-                }
-            }
+            vTracks.findTrack(vPlayedHistory.back()->iTrackID, iCurrentIndex);
 
             size_t iNextTrackIndex = iCurrentIndex + 1;
 
-            if (iCurrentIndex == vAudioTracks.size() - 1)
+            if (iCurrentIndex == vTracks.size() - 1)
             {
                 iNextTrackIndex = 0;
             }
 
-            mtxProcess.unlock();
+            mtxTransport.unlock();
 
-            playTrack(vAudioTracks[iNextTrackIndex]->sAudioTitle, bCalledFromOtherThread);
+            playTrack(vTracks[iNextTrackIndex]->iTrackID, bCalledFromOtherThread);
 
-            pMainWindow->setNewPlayingTrack(vAudioTracks[iNextTrackIndex]->pTrackWidget, bCalledFromOtherThread);
+            pMainWindow->setNewPlayingTrack(vTracks[iNextTrackIndex]->iTrackID, bCalledFromOtherThread);
         }
     }
-    else if (vAudioTracks.size() > 0)
+    else if (vTracks.size() > 0)
     {
-        mtxProcess.unlock();
+        mtxTransport.unlock();
 
-        size_t iTrackIDToPlay = 0;
+        size_t iTrackIndexToPlay = 0;
 
         if (bRandomTrack)
         {
-            std::uniform_int_distribution<> uid(0, static_cast<int>(vAudioTracks.size()) - 1);
+            std::uniform_int_distribution<> uid(0, static_cast<int>(vTracks.size()) - 1);
 
-            iTrackIDToPlay = static_cast<size_t>(uid(*pRndGen));
+            iTrackIndexToPlay = static_cast<size_t>(uid(*pRndGen));
         }
 
 
-        playTrack(vAudioTracks[iTrackIDToPlay]->sAudioTitle, bCalledFromOtherThread);
+        playTrack(vTracks[iTrackIndexToPlay]->iTrackID, bCalledFromOtherThread);
 
-        pMainWindow->setNewPlayingTrack(vAudioTracks[iTrackIDToPlay]->pTrackWidget, bCalledFromOtherThread);
+        pMainWindow->setNewPlayingTrack(vTracks[iTrackIndexToPlay]->iTrackID, bCalledFromOtherThread);
         pMainWindow->changePlayButtonStyle(true, bCalledFromOtherThread);
     }
     else
     {
-        mtxProcess.unlock();
+        mtxTransport.unlock();
     }
 }
 
 void AudioCore::setRandomTrack()
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTransport);
+
+    cancelNextTrack(false);
 
     bRandomTrack = !bRandomTrack;
 
@@ -664,7 +833,9 @@ void AudioCore::setRandomTrack()
 
 void AudioCore::setRepeatTrack()
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTransport);
+
+    cancelNextTrack(false);
 
     bRepeatTrack = !bRepeatTrack;
 
@@ -677,151 +848,295 @@ void AudioCore::setRepeatTrack()
     }
 }
 
-void AudioCore::clearTracklist()
+void AudioCore::setCrossfade(double dCrossfadeInSec, S_CROSSFADE_CURVE curve)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTransport);
 
-    if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
+    cancelNextTrack(false);
+
+    if (dCrossfadeInSec < 0.0)
     {
-        pCurrentTrack->stopSound();
+        dCrossfadeInSec = 0.0;
     }
-
-    for(size_t i = 0; i < vAudioTracks.size(); i++)
+    else if (dCrossfadeInSec > MAX_CROSSFADE_IN_SEC)
     {
-        removeTrack(vAudioTracks[i]);
+        dCrossfadeInSec = MAX_CROSSFADE_IN_SEC;
     }
 
-    vAudioTracks.clear();
+    this->dCrossfadeInSec = dCrossfadeInSec;
+    this->crossfadeCurve = curve;
+}
 
-    vPlayedHistory.clear();
+void AudioCore::clearTracklist()
+{
+    mtxTracklist.lock();
 
-    currentTrackState = CTS_DELETED;
+    std::shared_ptr<const IndexedTracklist> pOldTracklist = getTracklist();
 
-    pMainWindow->changePlayButtonStyle(false, false);
+    publishTracklist(std::make_shared<IndexedTracklist>());
 
 
+    // The tracks that are being imported will not be added.
+    mtxImport.lock();
 
-    waitForGraphToStop();
-    pMainWindow->clearGraph();
+    qImportJobs.clear();
+    iImportGeneration++;
+    bCancelImport = true;
 
+    mtxImport.unlock();
 
-    pMainWindow->setMainWindowTitle(L"Xander");
-}
 
-void AudioCore::setVolume(int iVolume)
-{
-    pAudioEngine->setMasterVolume(iVolume / 100.0f);
-}
 
-CurrentEffects *AudioCore::getCurrentEffects()
-{
-    return &effects;
-}
+    mtxTransport.lock();
+
+    cancelNextTrack(true);
+
+    if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
+    {
+        pCurrentTrack->stopSound();
+    }
+
+    vPlayedHistory.clear();
+
+    currentTrackState = CTS_DELETED;
+
+    positionClock.clear();
+
+    pMainWindow->changePlayButtonStyle(false, false);
+
+    // Wait for the graph after the mutexes are unlocked (see removeTrack()).
+    std::shared_future<bool> futureGraphStopped = graphTask.stop();
+
+
+    pMainWindow->setMainWindowTitle(L"Xander");
+
+    mtxTransport.unlock();
+
+    mtxTracklist.unlock();
+
+
+
+    if (futureGraphStopped.valid())
+    {
+        futureGraphStopped.get();
+    }
+
+    mtxTransport.lock();
+
+    if (currentTrackState == CTS_DELETED)
+    {
+        pMainWindow->clearGraph();
+    }
+
+    mtxTransport.unlock();
+
+
+
+    for (size_t i = 0; i < pOldTracklist->size(); i++)
+    {
+        removeTrack((*pOldTracklist)[i].get());
+    }
+}
+
+void AudioCore::setVolume(int iVolume)
+{
+    pAudioEngine->setMasterVolume(iVolume / 100.0f);
+}
+
+const SPositionClock *AudioCore::getPositionClock() const
+{
+    return &positionClock;
+}
+
+CurrentEffects *AudioCore::getCurrentEffects()
+{
+    return &effects;
+}
 
 void AudioCore::setPitch(float fPitch)
 {
+    std::lock_guard<std::mutex> lock(mtxTransport);
+
     effects.fPitchInSemitones = fPitch;
 
     if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
-        std::lock_guard<std::mutex> lock(mtxProcess);
+        // The prefetched track was decoded with the old pitch.
+        cancelNextTrack(false);
+
         applyAudioEffects();
     }
 }
 
-void AudioCore::setReverbVolume(float fVolume)
+void AudioCore::setTempo(float fTempo)
 {
-    effects.fReverbVolume = fVolume;
+    std::lock_guard<std::mutex> lock(mtxTransport);
+
+    effects.fTempo = fTempo;
 
     if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
-        std::lock_guard<std::mutex> lock(mtxProcess);
+        // The prefetched track was decoded with the old tempo (and the crossfade frames are different now).
+        cancelNextTrack(false);
+
         applyAudioEffects();
+
+        // The speed of the clock.
+        updatePositionClock();
     }
 }
 
-void AudioCore::saveTracklist(const std::wstring &sPathToFile)
+void AudioCore::setReverbVolume(float fVolume)
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxTransport);
 
-    if (vAudioTracks.size() == 0)
+    effects.fReverbVolume = fVolume;
+
+    if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
     {
-        pMainWindow->showMessageBox(L"Information", L"The tracklist is empty, there is nothing to save.", false, false);
+        applyAudioEffects();
+    }
+}
 
+void AudioCore::setSpectrumEnabled(bool bEnable)
+{
+    if (bSpectrumEnabled == bEnable)
+    {
         return;
     }
 
-    std::ofstream file(sPathToFile, std::ios::binary);
-
+    // The analyzer is opened with the format of the final mix.
+    if (pAudioEngine->setAnalyzerSink(bEnable ? &spectrumAnalyzer : nullptr) == false)
+    {
+        bSpectrumEnabled = bEnable;
+    }
+}
 
-    unsigned int iTrackCount = static_cast<unsigned int>(vAudioTracks.size());
-    file.write(reinterpret_cast<char*>(&iTrackCount), sizeof(iTrackCount));
+void AudioCore::getSpectrum(std::vector<float> &vBands)
+{
+    if (vBands.size() != SPECTRUM_BAND_COUNT)
+    {
+        vBands.resize(SPECTRUM_BAND_COUNT);
+    }
 
-    for (unsigned int i = 0; i < iTrackCount; i++)
+    if (bSpectrumEnabled == false || spectrumAnalyzer.getSpectrum(vBands.data()))
     {
-        unsigned short iPathSize = static_cast<unsigned short>(vAudioTracks[i]->sPathToAudioFile.size());
-        file.write(reinterpret_cast<char*>(&iPathSize), sizeof(iPathSize));
+        std::fill(vBands.begin(), vBands.end(), 0.0f);
+    }
+}
+
+void AudioCore::exportTrack(unsigned long long iTrackID, const std::wstring &sOutputPath)
+{
+    std::shared_ptr<XAudioFile> pAudio = getTracklist()->getTrack(iTrackID);
 
-        file.write(reinterpret_cast<char*>(const_cast<wchar_t*>(vAudioTracks[i]->sPathToAudioFile.c_str())), iPathSize * sizeof(wchar_t));
+    if (pAudio == nullptr)
+    {
+        return;
     }
 
 
-    file.close();
+    SRenderJob job;
+    job.sInputPath = pAudio->sPathToAudioFile;
+    job.sOutputPath = sOutputPath;
+
+    startExport({job});
 }
 
-void AudioCore::openTracklist(const std::wstring &sPathToFile, bool bClearCurrentTracklist)
+void AudioCore::exportTracklist(const std::wstring &sOutputFolder)
 {
-    if (bClearCurrentTracklist)
+    std::shared_ptr<const IndexedTracklist> pTracklist = getTracklist();
+    const IndexedTracklist& vTracks = *pTracklist;
+
+    if (vTracks.size() == 0)
     {
-        clearTracklist();
+        pMainWindow->showMessageBox(L"Information", L"The tracklist is empty, there is nothing to export.", false, false);
+
+        return;
     }
 
+    std::vector<SRenderJob> vJobs;
 
-    mtxProcess.lock();
+    // Titles are not unique (same file name in different folders or the same file added twice)
+    // so every file is prefixed with the track number (zero-padded so that the files are sorted like the tracklist).
+    const size_t iNumberWidth = std::to_wstring(vTracks.size()).size();
 
+    for (size_t i = 0; i < vTracks.size(); i++)
+    {
+        std::wstring sNumber = std::to_wstring(i + 1);
+        sNumber.insert(0, iNumberWidth - sNumber.size(), L'0');
 
-    std::ifstream file(sPathToFile, std::ios::binary);
+        SRenderJob job;
+        job.sInputPath = vTracks[i]->sPathToAudioFile;
+        job.sOutputPath = (fs::path(sOutputFolder) / (sNumber + L" - " + vTracks[i]->sAudioTitle + L".wav")).wstring();
 
-    if (file.is_open() == false)
+        vJobs.push_back(job);
+    }
+
+    startExport(vJobs);
+}
+
+void AudioCore::saveTracklist(const std::wstring &sPathToFile)
+{
+    // The file is written from a snapshot, the tracklist can be changed meanwhile.
+    std::shared_ptr<const IndexedTracklist> pTracklist = getTracklist();
+    const IndexedTracklist& vTracks = *pTracklist;
+
+    if (vTracks.size() == 0)
     {
-        pMainWindow->showMessageBox(L"Error", L"Could not open the tracklist file.", true, false);
+        pMainWindow->showMessageBox(L"Information", L"The tracklist is empty, there is nothing to save.", false, false);
 
-        mtxProcess.unlock();
         return;
     }
 
+    if (TracklistFile::save(sPathToFile, vTracks))
+    {
+        pMainWindow->showMessageBox(L"Error", L"Could not save the tracklist file.", true, false);
+
+        return;
+    }
 
-    unsigned int iTrackCount = 0;
-    file.read(reinterpret_cast<char*>(&iTrackCount), sizeof(iTrackCount));
 
-    std::vector<std::wstring> vFilePaths;
+    setPeakCacheDirectory(sPathToFile);
+}
 
-    for (unsigned int i = 0; i < iTrackCount; i++)
+void AudioCore::openTracklist(const std::wstring &sPathToFile, bool bClearCurrentTracklist)
+{
+    if (bClearCurrentTracklist)
     {
-        unsigned short iPathSize = 0;
-        file.read(reinterpret_cast<char*>(&iPathSize), sizeof(iPathSize));
+        clearTracklist();
+    }
+
 
-        wchar_t* pPathString = new wchar_t[iPathSize + 1];
-        memset(pPathString, 0, (iPathSize + 1) * sizeof(wchar_t));
+    // The files are checked (and the metadata is matched with them) by the import.
 
-        file.read(reinterpret_cast<char*>(pPathString), iPathSize * sizeof(wchar_t));
+    ImportJob job;
 
-        vFilePaths.push_back(pPathString);
+    if (TracklistFile::open(sPathToFile, job.vFiles, job.vMetadata))
+    {
+        pMainWindow->showMessageBox(L"Error", L"Could not open the tracklist file.", true, false);
 
-        delete[] pPathString;
+        return;
     }
 
 
-    file.close();
+    setPeakCacheDirectory(sPathToFile);
 
 
-    mtxProcess.unlock();
-    addTracks(vFilePaths);
+    startImport(job);
 }
 
 void AudioCore::searchFindPrev()
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxSearch);
+
+    std::shared_ptr<const IndexedTracklist> pTracklist = getTracklist();
+
+    if (updateSearchResult(pTracklist))
+    {
+        // The tracklist was changed since the last search.
+        pMainWindow->setSearchMatchCount(vSearchResult.size());
+    }
+
 
     if (vSearchResult.size() > 0)
     {
@@ -840,7 +1155,7 @@ void AudioCore::searchFindPrev()
 
         if ( !(bFirstSearchAfterKeyChange == false && vSearchResult.size() == 1) ) // do not select again if matches == 1 && already selected
         {
-            pMainWindow->searchSetSelected ( vAudioTracks[vSearchResult[iCurrentPosInSearchVec]]->pTrackWidget );
+            pMainWindow->searchSetSelected ( (*pTracklist)[vSearchResult[iCurrentPosInSearchVec]]->iTrackID );
         }
 
 
@@ -850,7 +1165,16 @@ void AudioCore::searchFindPrev()
 
 void AudioCore::searchFindNext()
 {
-    std::lock_guard<std::mutex> lock(mtxProcess);
+    std::lock_guard<std::mutex> lock(mtxSearch);
+
+    std::shared_ptr<const IndexedTracklist> pTracklist = getTracklist();
+
+    if (updateSearchResult(pTracklist))
+    {
+        // The tracklist was changed since the last search.
+        pMainWindow->setSearchMatchCount(vSearchResult.size());
+    }
+
 
     if (vSearchResult.size() > 0)
     {
@@ -869,7 +1193,7 @@ void AudioCore::searchFindNext()
 
         if ( !(bFirstSearchAfterKeyChange == false && vSearchResult.size() == 1) ) // do not select again if matches == 1 && already selected
         {
-            pMainWindow->searchSetSelected ( vAudioTracks[vSearchResult[iCurrentPosInSearchVec]]->pTrackWidget );
+            pMainWindow->searchSetSelected ( (*pTracklist)[vSearchResult[iCurrentPosInSearchVec]]->iTrackID );
         }
 
 
@@ -879,73 +1203,67 @@ void AudioCore::searchFindNext()
 
 void AudioCore::searchTextSet(const std::wstring &sKeyword)
 {
-    mtxProcess.lock();
+    mtxSearch.lock();
 
 
-    vSearchResult.clear();
-    iCurrentPosInSearchVec = 0;
+    sSearchKeyword = sKeyword;
 
-    if (sKeyword != L"")
-    {
-        for (size_t i = 0; i < vAudioTracks.size(); i++)
-        {
-            if ( findCaseInsensitive( vAudioTracks[i]->sAudioTitle, const_cast<std::wstring&>(sKeyword)) != std::string::npos )
-            {
-                vSearchResult.push_back(i);
-            }
-        }
-    }
+    pSearchTracklist = nullptr;
+    updateSearchResult(getTracklist());
 
-    bFirstSearchAfterKeyChange = true;
+    size_t iMatchCount = vSearchResult.size();
 
 
-    mtxProcess.unlock();
+    mtxSearch.unlock();
 
 
-    pMainWindow->setSearchMatchCount (vSearchResult.size());
+    pMainWindow->setSearchMatchCount (iMatchCount);
 }
 
-std::wstring AudioCore::getTrackTitle(const std::wstring &sAudioPath)
+std::shared_ptr<const IndexedTracklist> AudioCore::getTracklist() const
 {
-    size_t iTitleStartIndex = 0;
-    size_t iLastDotPos = 0;
+    return std::atomic_load(&pTracklist);
+}
 
-    for (size_t i = sAudioPath.size() - 1; i >= 1; i--)
-    {
-        if (sAudioPath[i] == L'.' && iLastDotPos == 0)
-        {
-            iLastDotPos = i;
-        }
+void AudioCore::publishTracklist(std::shared_ptr<const IndexedTracklist> pNewTracklist)
+{
+    // The old snapshot (and the removed tracks) will be deleted when the last reader releases it.
+    std::atomic_store(&pTracklist, pNewTracklist);
 
-        if (sAudioPath[i] == L'/' || sAudioPath[i] == L'\\')
-        {
-            iTitleStartIndex = i + 1;
-            break;
-        }
+    if (bDestroyCalled == false)
+    {
+        pMainWindow->setTracklist(pNewTracklist);
     }
-
-    std::wstring sTrackTitle = sAudioPath.substr(iTitleStartIndex, iLastDotPos - iTitleStartIndex);
-
-    return sTrackTitle;
 }
 
-std::wstring AudioCore::getTrackExtension(const std::wstring &sTrackPath)
+bool AudioCore::updateSearchResult(const std::shared_ptr<const IndexedTracklist>& pCurrentTracklist)
 {
-    size_t iLastDotPos = 0;
+    if (pSearchTracklist == pCurrentTracklist)
+    {
+        return false;
+    }
+
 
-    for (size_t i = sTrackPath.size() - 1; i >= 1; i--)
+    vSearchResult.clear();
+    iCurrentPosInSearchVec = 0;
+
+    if (sSearchKeyword != L"")
     {
-        if (sTrackPath[i] == L'.')
+        for (size_t i = 0; i < pCurrentTracklist->size(); i++)
         {
-            iLastDotPos = i;
-
-            break;
+            if ( findCaseInsensitive( (*pCurrentTracklist)[i]->sAudioTitle, sSearchKeyword) != std::string::npos )
+            {
+                vSearchResult.push_back(i);
+            }
         }
     }
 
-    std::wstring sTrackExtension = sTrackPath.substr(iLastDotPos + 1, sTrackPath.size() - (iLastDotPos + 1));
+    bFirstSearchAfterKeyChange = true;
+
+    pSearchTracklist = pCurrentTracklist;
+
 
-    return sTrackExtension;
+    return true;
 }
 
 std::wstring AudioCore::getTrackInfo(XAudioFile *pTrack)
@@ -1002,19 +1320,44 @@ std::wstring AudioCore::getTrackInfo(XAudioFile *pTrack)
     return sTrackInfo;
 }
 
-void AudioCore::removeTrack(XAudioFile *pAudio)
+void AudioCore::updateTrackMetadata(XAudioFile *pTrack)
 {
-    pAudio->pOpenedStream->close();
-    delete pAudio->pOpenedStream;
+    std::shared_ptr<XTrackMetadata> pMetadata = std::make_shared<XTrackMetadata>();
+
+    if (TracklistFile::getFileKey(pTrack->sPathToAudioFile, pMetadata->iFileSizeInBytes, pMetadata->iLastWriteTime))
+    {
+        return;
+    }
+
+    SSoundInfo info;
+    pCurrentTrack->getSoundInfo(info);
+
+    pMetadata->dLengthInSec   = info.dSoundLengthInSec;
+    pMetadata->iSampleRate    = static_cast<unsigned int>(info.iSampleRate);
+    pMetadata->iBitrate       = info.iBitrate;
+    pMetadata->iChannels      = info.iChannels;
+    pMetadata->iBitsPerSample = info.iBitsPerSample;
+
+    // Can be read by saveTracklist() at the same time.
+    std::atomic_store(&pTrack->pMetadata, std::shared_ptr<const XTrackMetadata>(pMetadata));
 
-    std::promise<bool> promiseRemoveWidget;
-    std::future<bool> future = promiseRemoveWidget.get_future();
+    // So that the next scan of the folder does not lose it.
+    library.setMetadata(pTrack->sPathToAudioFile, pMetadata);
+}
 
-    pMainWindow->removeTrackWidget(pAudio->pTrackWidget, &promiseRemoveWidget);
+void AudioCore::removeTrack(XAudioFile *pAudio)
+{
+    // The file is released now (unless it's still played), the XAudioFile itself is deleted with the last tracklist snapshot that has it.
+    pAudioEngine->closeCachedFile(pAudio->sPathToAudioFile);
+}
 
-    future.get();
+void AudioCore::setPeakCacheDirectory(const std::wstring &sPathToTracklist)
+{
+    // Keep the peaks next to the tracklist.
+
+    fs::path tracklistPath(sPathToTracklist);
 
-    delete pAudio;
+    peakCache.setCacheDirectory( (tracklistPath.parent_path() / (tracklistPath.stem().wstring() + L"_" + PEAK_CACHE_FOLDER_NAME)).wstring() );
 }
 
 void AudioCore::onCurrentTrackEnded(SSound* pTrack)
@@ -1033,6 +1376,140 @@ void AudioCore::onCurrentTrackEnded(SSound* pTrack)
     }
 }
 
+void AudioCore::prefetchNextTrack(std::shared_ptr<XAudioFile> pFile)
+{
+    pNextTrack->setPitchInSemitones(effects.fPitchInSemitones);
+    pNextTrack->setTempo(effects.fTempo);
+
+
+    // Crossfade (each track counts the frames in its own sample rate).
+
+    bool bCrossfade = false;
+    unsigned long long iFadeOutStartFrame = 0;
+    unsigned long long iFadeOutFrameCount = 0;
+    unsigned long long iFadeInFrameCount  = 0;
+
+    if (dCrossfadeInSec > 0.0)
+    {
+        SSoundInfo currentInfo;
+        pCurrentTrack->getSoundInfo(currentInfo);
+
+        SSoundInfo nextInfo;
+        pNextTrack->getSoundInfo(nextInfo);
+
+        double dPos = 0.0;
+        pCurrentTrack->getPositionInSec(dPos);
+
+        size_t iBufferCount = 0;
+        double dReadAheadInSec = 0.0;
+        pCurrentTrack->getStreamingBuffering(iBufferCount, dReadAheadInSec);
+
+
+        // Not longer than half of each track (the tracks are played 'tempo' times faster).
+
+        double dCrossfade = dCrossfadeInSec * effects.fTempo;
+
+        if (dCrossfade > currentInfo.dSoundLengthInSec / 2)
+        {
+            dCrossfade = currentInfo.dSoundLengthInSec / 2;
+        }
+
+        if (dCrossfade > nextInfo.dSoundLengthInSec / 2)
+        {
+            dCrossfade = nextInfo.dSoundLengthInSec / 2;
+        }
+
+        const double dFadeOutStartInSec = currentInfo.dSoundLengthInSec - dCrossfade;
+
+
+        // The fade out frames should not be decoded yet.
+        if (dPos + dReadAheadInSec * effects.fTempo < dFadeOutStartInSec)
+        {
+            bCrossfade = true;
+
+            iFadeOutStartFrame = static_cast<unsigned long long>(std::llround(dFadeOutStartInSec * currentInfo.iSampleRate));
+            iFadeOutFrameCount = static_cast<unsigned long long>(std::llround(dCrossfade * currentInfo.iSampleRate));
+            iFadeInFrameCount  = static_cast<unsigned long long>(std::llround(dCrossfade * nextInfo.iSampleRate));
+        }
+    }
+
+
+    if (bCrossfade)
+    {
+        // Before the decoding starts.
+        pNextTrack->setFade(crossfadeCurve, true, 0, iFadeInFrameCount);
+    }
+
+    if (pNextTrack->preloadSound())
+    {
+        return;
+    }
+
+    pNextTrackFile = pFile;
+
+
+    if (bCrossfade)
+    {
+        pCurrentTrack->setFade(crossfadeCurve, false, iFadeOutStartFrame, iFadeOutFrameCount);
+        pCurrentTrack->setCrossfadeTo(pNextTrack, iFadeOutStartFrame);
+
+        bCrossfadeSet = true;
+    }
+}
+
+void AudioCore::cancelNextTrackIfChanged()
+{
+    if (pNextTrackFile == nullptr)
+    {
+        // The track that is being loaded (if any) is checked before it's used (see monitorTrackPosition()).
+        return;
+    }
+
+    if (NextTrackPredictor::isStillNext(*getTracklist(), vPlayedHistory, pNextTrackFile, bRandomTrack, bRepeatTrack))
+    {
+        return;
+    }
+
+    cancelNextTrack(false);
+}
+
+void AudioCore::cancelNextTrack(bool bEvenIfStarted)
+{
+    // The next track that is being loaded (if any) is not the next one anymore.
+    iNextTrackGeneration++;
+
+    if (pNextTrackFile == nullptr)
+    {
+        return;
+    }
+
+
+    SSoundState state;
+    pNextTrack->getSoundState(state);
+
+    const bool bStarted = (state == SS_PLAYING);
+
+    if (bStarted && bEvenIfStarted == false)
+    {
+        // The crossfade already started, the next track is decided.
+        return;
+    }
+
+
+    if (bCrossfadeSet && bStarted == false)
+    {
+        // Also stops the crossfade from starting.
+        pCurrentTrack->clearFade();
+    }
+
+    bCrossfadeSet = false;
+
+
+    pNextTrack->stopSound();
+
+    pNextTrackFile = nullptr;
+}
+
 size_t AudioCore::findCaseInsensitive(std::wstring sText, std::wstring sKeyword)
 {
     // All to lower case
@@ -1044,38 +1521,78 @@ size_t AudioCore::findCaseInsensitive(std::wstring sText, std::wstring sKeyword)
     return sText.find(sKeyword);
 }
 
-void AudioCore::drawGraph()
+void AudioCore::drawGraph(std::wstring sPathToAudioFile, std::promise<bool> promiseFinish, unsigned long long iGraphTaskID)
 {
     SSoundInfo info;
     pCurrentTrack->getSoundInfo(info);
 
-    if (info.iBitsPerSample != 16 && info.iBitsPerSample != 24 && info.iBitsPerSample != 32)
+    S_SAMPLE_FORMAT sampleFormat;
+
+    if (SSampleConverter::getSampleFormat(info.iBitsPerSample, info.bFloatingPointSamples, sampleFormat))
     {
         pMainWindow->showMessageBox(L"Error", L"An error occurred at AudioCore::drawGraph(): unsupported sample format, "
                                               "the sample size is " + std::to_wstring(info.iBitsPerSample) + L" bits.", true, true);
+
+        promiseFinish.set_value(false);
+
         return;
     }
 
 
-    mtxDrawGraph.lock();
+    pMainWindow->clearGraph();
+
+
+    if (drawGraphFromCache(sPathToAudioFile))
+    {
+        // No peaks in the cache, decode the file.
+        drawGraphFromFile(sPathToAudioFile, info, sampleFormat, iGraphTaskID);
+    }
+
+
+    graphTask.markFinished(iGraphTaskID);
 
-    bDrawingGraph = true;
 
-    mtxDrawGraph.unlock();
+    promiseFinish.set_value(false);
+}
 
+bool AudioCore::drawGraphFromCache(const std::wstring &sPathToAudioFile)
+{
+    std::vector<PeakLevel> vPeakLevels;
 
-    pMainWindow->clearGraph();
+    if (peakCache.loadPeaks(sPathToAudioFile, vPeakLevels))
+    {
+        return true;
+    }
+
+
+    // No need to send more peaks than there are pixels on the graph.
 
+    const PeakLevel& level = vPeakLevels[PeakCache::pickLevel(vPeakLevels, pMainWindow->getGraphWidthInPixels())];
 
+    std::vector<float> vSamplesForGraph;
+
+    peaksToGraph(level.vPeaks, 0, level.vPeaks.size() / 2, vSamplesForGraph);
 
 
+    pMainWindow->setMaxXToGraph(static_cast<unsigned int>(level.vPeaks.size() / 2));
+    pMainWindow->addWaveDataToGraph(vSamplesForGraph);
+
+    return false;
+}
 
+void AudioCore::drawGraphFromFile(const std::wstring &sPathToAudioFile, const SSoundInfo &info, S_SAMPLE_FORMAT sampleFormat, unsigned long long iGraphTaskID)
+{
     unsigned int iDivideSampleCount = 100;
     // so we calculate 'iSamplesInOne' like this:
     // 3000 (samples in 1 graph sample) - 6000 (sec.)
     // x    (samples in 1 graph sample) - track length (in sec.)
     iDivideSampleCount = static_cast<unsigned int>(3000 * info.dSoundLengthInSec / 6000);
 
+    if (iDivideSampleCount == 0)
+    {
+        iDivideSampleCount = 1;
+    }
+
 
     unsigned int iSampleCount = static_cast<unsigned int>(info.dSoundLengthInSec * info.iSampleRate);
     iSampleCount /= iDivideSampleCount; // approximate amount (will be corrected later)
@@ -1084,32 +1601,49 @@ void AudioCore::drawGraph()
 
 
 
+    // The most detailed level of the peak cache, every peak is 'iDivideSampleCount' frames.
+    SWaveDecimator decimator;
+    if (decimator.setup(info.iChannels, iDivideSampleCount, static_cast<unsigned long long>(info.dSoundLengthInSec * info.iSampleRate)))
+    {
+        return;
+    }
+
+    size_t iSentPeakCount = 0;
+
+
     bool bReachedEOF = true;
     bool bEOF = false;
-    bool bClearVector = true;
 
-    std::vector<unsigned char> vWaveData;
+    std::vector<float> vFloatSamples;
     std::vector<float> vSamplesForGraph;
-    unsigned int iActualSampleCount = 0;
     unsigned int iSampleReadCountInOneRead = 30;
     unsigned int iCurrentSampleReadCount = 0;
 
-    do
+    const size_t iFrameSize = (info.iBitsPerSample / 8) * info.iChannels;
+
+
+    // Converts the decoded buffer (while it's still locked) and feeds it to the decimator.
+    auto onWaveData = [&](const unsigned char* pData, size_t iSizeInBytes)
     {
-        if (bClearVector)
-        {
-            vWaveData.clear();
-        }
-        else
+        const size_t iFrameCount = iSizeInBytes / iFrameSize;
+
+        if (vFloatSamples.size() < iFrameCount * info.iChannels)
         {
-            bClearVector = true;
+            vFloatSamples.resize(iFrameCount * info.iChannels);
         }
 
+        SSampleConverter::convertToFloat(pData, iFrameCount * info.iChannels, sampleFormat, vFloatSamples.data());
+
+        decimator.process(vFloatSamples.data(), iFrameCount);
+    };
+
+    do
+    {
         bool bExit = false;
         iCurrentSampleReadCount = 0;
         do
         {
-            if (pCurrentTrack->readWaveData(&vWaveData, bEOF))
+            if (pCurrentTrack->readWaveData(onWaveData, bEOF))
             {
                 bReachedEOF = false;
                 bExit = true;
@@ -1130,174 +1664,261 @@ void AudioCore::drawGraph()
         if (bExit) break;
 
 
-        if ((vWaveData.size() < (info.iChannels * iDivideSampleCount)) && (bEOF == false))
+        if (bEOF)
         {
-            bClearVector = false;
+            decimator.flush();
         }
 
-        if (bEOF && vWaveData.size() == 0)
+
+
+        peaksToGraph(decimator.getPeaks(), iSentPeakCount, decimator.getBucketCount(), vSamplesForGraph);
+        iSentPeakCount = decimator.getBucketCount();
+
+        if (vSamplesForGraph.size() > 0)
         {
-            break;
+            pMainWindow->addWaveDataToGraph(vSamplesForGraph);
+            vSamplesForGraph.clear();
         }
 
 
-        if (bClearVector)
+
+        if (bEOF)
         {
-            std::vector<float> vSampleData;
+            break;
+        }
 
-            for (size_t i = 0; i < vWaveData.size(); i += (info.iBitsPerSample / 8) * info.iChannels)
-            {
-                std::vector<float> vSamplesChannels;
+        if (graphTask.isStopRequested(iGraphTaskID))
+        {
+            bReachedEOF = false;
 
-                for (unsigned short j = 0; j < info.iChannels; j++)
-                {
-                    float fSample = 0.0f;
-
-                    if (info.iBitsPerSample == 16)
-                    {
-                        fSample = read16bitSample(vWaveData[i + (info.iBitsPerSample / 8) * j], vWaveData[i + 1 + (info.iBitsPerSample / 8) * j]);
-                    }
-                    else if (info.iBitsPerSample == 24)
-                    {
-                        fSample = read24bitSample(vWaveData[i +     (info.iBitsPerSample / 8) * j],
-                                                  vWaveData[i + 1 + (info.iBitsPerSample / 8) * j],
-                                                  vWaveData[i + 2 + (info.iBitsPerSample / 8) * j]);
-                    }
-                    else // 32 bit
-                    {
-                        fSample = read32bitSample(vWaveData[i +     (info.iBitsPerSample / 8) * j],
-                                                  vWaveData[i + 1 + (info.iBitsPerSample / 8) * j],
-                                                  vWaveData[i + 2 + (info.iBitsPerSample / 8) * j],
-                                                  vWaveData[i + 3 + (info.iBitsPerSample / 8) * j]);
-                    }
-
-                    vSamplesChannels.push_back(fSample);
-                }
+            break;
+        }
+    }while(true);
 
-                // sample is normalized in [-1.0f, 1.0f]
-                // combine all channels into 1 sample
 
-                vSampleData.push_back(vSamplesChannels[0]);
+    if (bReachedEOF)
+    {
+        pMainWindow->setMaxXToGraph(static_cast<unsigned int>(iSentPeakCount));
 
-                for (size_t k = 1; k < vSamplesChannels.size(); k++)
-                {
-                    if (abs(vSamplesChannels[k]) > abs(vSampleData.back()))
-                    {
-                        vSampleData.back() = vSamplesChannels[k];
-                    }
-                }
-            }
 
+        // Save peaks so that the next time we don't need to decode this file.
 
+        std::vector<PeakLevel> vPeakLevels(1);
+        vPeakLevels[0].iFramesPerPeak = iDivideSampleCount;
+        vPeakLevels[0].vPeaks = decimator.takePeaks();
 
+        PeakCache::buildLevels(vPeakLevels, PEAK_CACHE_MIN_PEAK_COUNT);
+        peakCache.savePeaks(sPathToAudioFile, vPeakLevels);
+    }
+}
 
-            bool bPlusOnly = vSampleData[0] > 0.0f ? true : false;
+void AudioCore::peaksToGraph(const std::vector<float> &vPeaks, size_t iFirstPeak, size_t iPeakCount, std::vector<float> &vSamplesForGraph)
+{
+    // (min, max) pairs, the graph draws the envelope between them.
 
-            for (size_t i = 0; i < vSampleData.size();)
-            {
-                float fResultSample = vSampleData[i];
-                i++;
+    vSamplesForGraph.reserve(vSamplesForGraph.size() + (iPeakCount - iFirstPeak) * 2);
 
-                for (size_t j = 1; (j < iDivideSampleCount) && (i < vSampleData.size()); j++, i++)
-                {
-                    if (bPlusOnly)
-                    {
-                        if (vSampleData[i] > fResultSample)
-                        {
-                            fResultSample = vSampleData[i];
-                        }
-                    }
-                    else
-                    {
-                        if (vSampleData[i] < fResultSample)
-                        {
-                            fResultSample = vSampleData[i];
-                        }
-                    }
-                }
+    for (size_t i = iFirstPeak * 2; i < iPeakCount * 2; i++)
+    {
+        vSamplesForGraph.push_back((vPeaks[i] / 2) + 0.5f); // convert to [0.0f; 1.0f]
+    }
+}
 
-                bPlusOnly = !bPlusOnly;
+void AudioCore::applyAudioEffects()
+{
+    pCurrentTrack->setPitchInSemitones(effects.fPitchInSemitones);
+    pCurrentTrack->setTempo(effects.fTempo);
+    pMix->setFXVolume(effects.fReverbVolume);
+}
 
-                vSamplesForGraph.push_back((fResultSample / 2) + 0.5f); // convert to [0.0f; 1.0f]
-            }
+void AudioCore::startImport(ImportJob job)
+{
+    std::lock_guard<std::mutex> lock(mtxImport);
 
+    job.iGeneration = iImportGeneration;
 
+    qImportJobs.push_back(job);
 
-            iActualSampleCount += vSamplesForGraph.size();
+    if (bImportRunning == false)
+    {
+        bImportRunning = true;
 
+        promiseFinishImport = std::promise<bool>();
+        futureFinishImport = promiseFinishImport.get_future();
 
-            pMainWindow->addWaveDataToGraph(vSamplesForGraph);
-            vSamplesForGraph.clear();
+        std::thread t (&AudioCore::importTracks, this);
+        t.detach();
+    }
+}
+
+void AudioCore::importTracks()
+{
+    while (true)
+    {
+        mtxImport.lock();
+
+        if (qImportJobs.size() == 0 || bDestroyCalled)
+        {
+            bImportRunning = false;
+
+            // Under the lock so that the next startImport() does not replace the promise before.
+            promiseFinishImport.set_value(false);
+
+            mtxImport.unlock();
+
+            return;
+        }
+
+        ImportJob job = qImportJobs.front();
+        qImportJobs.pop_front();
+
+        bCancelImport = (job.iGeneration != iImportGeneration);
 
+        mtxImport.unlock();
 
 
-            if (bEOF)
+
+        size_t iFailedCount = 0;
+        std::wstring sFirstFailedPath;
+
+        TrackImporter importer(IMPORT_BATCH_SIZE, IMPORT_THREAD_COUNT);
+
+        importer.setOnBatch([&](XTracklist& vBatch, size_t iProcessedCount, size_t iFoundCount)
+        {
+            addImportedTracks(vBatch, job.iGeneration);
+            pMainWindow->setImportProgress(iProcessedCount, iFoundCount, false);
+        });
+
+        importer.setOnError([&](const std::wstring& sPath)
+        {
+            if (iFailedCount == 0)
             {
-                break;
+                sFirstFailedPath = sPath;
             }
-        }
 
-        mtxDrawGraph.lock();
-        if (bDrawingGraph == false)
+            iFailedCount++;
+        });
+
+
+        if (job.sFolderPath != L"")
         {
-            mtxDrawGraph.unlock();
+            // The folder may be added again (rescan): the files that are in the tracklist are not added twice
+            // and the tracks of the removed/moved files are updated when the folder is walked to the end.
 
-            bReachedEOF = false;
+            std::unordered_set<std::wstring> trackPaths;
 
-            break;
+            std::shared_ptr<const IndexedTracklist> pCurrentTracklist = getTracklist();
+
+            for (const std::shared_ptr<XAudioFile>& pTrack : *pCurrentTracklist)
+            {
+                trackPaths.insert(pTrack->sPathToAudioFile);
+            }
+
+            pCurrentTracklist = nullptr;
+
+            importer.setSkipPath([&trackPaths](const std::wstring& sPath)
+            {
+                return trackPaths.count(sPath) > 0;
+            });
+
+
+            MediaLibraryChanges changes;
+
+            importer.importFolder(job.sFolderPath, &bCancelImport, &library, &changes);
+
+            if (bCancelImport == false)
+            {
+                applyFolderChanges(changes, job.iGeneration);
+            }
         }
         else
         {
-            mtxDrawGraph.unlock();
+            importer.importFiles(job.vFiles, &bCancelImport, &job.vMetadata);
         }
-    }while(true);
 
 
-    if (bReachedEOF)
-    {
-        if (vSamplesForGraph.size() > 0)
+        pMainWindow->setImportProgress(0, 0, true);
+
+        if (iFailedCount > 0 && bCancelImport == false)
         {
-            pMainWindow->addWaveDataToGraph(vSamplesForGraph);
+            pMainWindow->showMessageBox(L"Error", L"An error occurred at AudioCore::importTracks(): could not open "
+                                        + std::to_wstring(iFailedCount) + L" file(s) (for example, ""
+                                        + sFirstFailedPath + L""), skipping these files.", true, true);
         }
+    }
+}
 
-        pMainWindow->setMaxXToGraph(iActualSampleCount);
+void AudioCore::startExport(const std::vector<SRenderJob> &vJobs)
+{
+    if (bExportRunning.exchange(true))
+    {
+        pMainWindow->showMessageBox(L"Information", L"Wait for the current export to finish.", false, false);
+
+        return;
     }
 
+    promiseFinishExport = std::promise<bool>();
+    futureFinishExport = promiseFinishExport.get_future();
 
-    mtxDrawGraph.lock();
+    std::thread t (&AudioCore::exportTracks, this, vJobs);
+    t.detach();
+}
 
-    bDrawingGraph = false;
+void AudioCore::exportTracks(std::vector<SRenderJob> vJobs)
+{
+    // Same chain as the playback.
 
-    mtxDrawGraph.unlock();
+    mtxTransport.lock();
 
+    SRenderSettings settings;
+    pMix->getRenderSettings(settings);
+    settings.fPitchInSemitones = effects.fPitchInSemitones;
+    settings.fTempo = effects.fTempo;
+    settings.pFileCache = pAudioEngine->getFileHandleCache();
 
-    promiseFinishDrawGraph.set_value(false);
-}
+    mtxTransport.unlock();
 
-void AudioCore::waitForGraphToStop()
-{
-    // Wait for the draw thread to finish.
-    mtxDrawGraph.lock();
 
-    if (bDrawingGraph)
+    SOfflineRenderer renderer(settings);
+
+    std::mutex mtxResult;
+    size_t iFailedCount = 0;
+    std::wstring sFirstError;
+
+    renderer.renderBatch(vJobs, 0, [&](size_t iJobIndex, bool bError, const std::wstring& sErrorText)
     {
-        std::future<bool> f = promiseFinishDrawGraph.get_future();
+        if (bError)
+        {
+            std::lock_guard<std::mutex> lock(mtxResult);
 
-        bDrawingGraph = false;
-        mtxDrawGraph.unlock();
+            if (iFailedCount == 0)
+            {
+                sFirstError = vJobs[iJobIndex].sInputPath + L": " + sErrorText;
+            }
 
-        f.get();
-    }
-    else
+            iFailedCount++;
+        }
+    }, &bCancelExport);
+
+
+    if (bCancelExport == false)
     {
-        mtxDrawGraph.unlock();
+        if (iFailedCount == 0)
+        {
+            pMainWindow->showMessageBox(L"Information", L"Exported " + std::to_wstring(vJobs.size()) + L" track(s).", false, true);
+        }
+        else
+        {
+            pMainWindow->showMessageBox(L"Error", L"An error occurred at AudioCore::exportTracks(): could not export "
+                                        + std::to_wstring(iFailedCount) + L" of " + std::to_wstring(vJobs.size())
+                                        + L" track(s), " + sFirstError, true, true);
+        }
     }
-}
 
-void AudioCore::applyAudioEffects()
-{
-    pCurrentTrack->setPitchInSemitones(effects.fPitchInSemitones);
-    pMix->setFXVolume(effects.fReverbVolume);
+
+    bExportRunning = false;
+
+    promiseFinishExport.set_value(false);
 }
 
 void AudioCore::monitorTrackPosition()
@@ -1306,31 +1927,72 @@ void AudioCore::monitorTrackPosition()
 
     bMonitorRunning = true;
 
+    // The UI reads the position from the clock (without locking) and extrapolates it,
+    // here the clock is only corrected (the played samples don't go exactly with the system time) and the next track is prefetched.
+
     while (bDestroyCalled == false)
     {
-        mtxProcess.lock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(UPDATE_TRACK_POS_IN_MS));
+
+        double dPos = 0.0;
+        double dLength = 0.0;
 
-        if (bLoadedTrackAtLeastOneTime && currentTrackState != CTS_DELETED)
+        if (positionClock.get(dPos, dLength))
         {
-            if (currentTrackState == CTS_PLAYING)
-            {
-                double dPos;
-                pCurrentTrack->getPositionInSec(dPos);
+            // Nothing is playing.
+            continue;
+        }
 
-                SSoundInfo info;
-                pCurrentTrack->getSoundInfo(info);
 
+        if (mtxTransport.try_lock() == false)
+        {
+            // Busy with a playback command, try next time.
+            continue;
+        }
 
-                std::string sTime = getTimeString(dPos);
+        std::shared_ptr<XAudioFile> pPrefetchFile;
+        unsigned long long iGeneration = iNextTrackGeneration;
 
+        if (bLoadedTrackAtLeastOneTime && currentTrackState == CTS_PLAYING)
+        {
+            updatePositionClock();
+
+            positionClock.get(dPos, dLength);
 
-                pMainWindow->setCurrentPos(dPos / info.dSoundLengthInSec, sTime);
+            // The time left is shorter if the tempo is faster.
+            if (pNextTrackFile == nullptr && (dLength - dPos) / effects.fTempo <= PREFETCH_NEXT_TRACK_BEFORE_END_IN_SEC + dCrossfadeInSec)
+            {
+                pPrefetchFile = NextTrackPredictor::predict(*getTracklist(), vPlayedHistory, bRandomTrack, bRepeatTrack, *pRndGen);
             }
         }
 
-        mtxProcess.unlock();
+        mtxTransport.unlock();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(UPDATE_TRACK_POS_IN_MS));
+
+        if (pPrefetchFile == nullptr)
+        {
+            continue;
+        }
+
+        // Opening the file can take a while (disk), the playback commands are not blocked meanwhile.
+        // Only this thread uses 'pNextTrack' while 'pNextTrackFile' is 'nullptr'.
+        if (pNextTrack->loadAudioFile(pPrefetchFile->sPathToAudioFile, true, pMix))
+        {
+            continue;
+        }
+
+        mtxTransport.lock();
+
+        // Not if the track was stopped, the mode was changed (see cancelNextTrack()) or the tracklist was changed
+        // so that it's not the next track anymore, it's predicted again next time.
+        if (iGeneration == iNextTrackGeneration && pNextTrackFile == nullptr
+                && bLoadedTrackAtLeastOneTime && currentTrackState == CTS_PLAYING
+                && NextTrackPredictor::isStillNext(*getTracklist(), vPlayedHistory, pPrefetchFile, bRandomTrack, bRepeatTrack))
+        {
+            prefetchNextTrack(pPrefetchFile);
+        }
+
+        mtxTransport.unlock();
     }
 
     bMonitorRunning = false;
@@ -1338,71 +2000,44 @@ void AudioCore::monitorTrackPosition()
     promiseFinishMonitorTrackPos.set_value(false);
 }
 
-std::string AudioCore::getTimeString(double dTimeInSec)
+void AudioCore::updatePositionClock()
 {
-    unsigned int iSeconds = static_cast<unsigned int>(std::round(dTimeInSec));
-    unsigned int iMinutes = iSeconds / 60;
-    iSeconds -= (iMinutes * 60);
-
-    std::string sTime = "";
-    sTime += std::to_string(iMinutes);
-    sTime += ":";
-    if (iSeconds < 10) sTime += "0";
-    sTime += std::to_string(iSeconds);
-
-    return sTime;
-}
+    if (bLoadedTrackAtLeastOneTime == false || currentTrackState == CTS_DELETED || currentTrackState == CTS_STOPPED)
+    {
+        positionClock.clear();
 
-float AudioCore::read16bitSample(unsigned char iByte1, unsigned char iByte2)
-{
-    float fSample = 0.0f;
+        return;
+    }
 
-    short int iSample = 0;
 
-    std::memcpy(reinterpret_cast<char*>(&iSample),     &iByte1, 1);
-    std::memcpy(reinterpret_cast<char*>(&iSample) + 1, &iByte2, 1);
+    double dPos = 0.0;
+    pCurrentTrack->getPositionInSec(dPos);
 
-    // normalize to [-1.0f, 1.0f]
-    fSample = static_cast<float>(iSample) / SHRT_MAX;
+    SSoundInfo info;
+    pCurrentTrack->getSoundInfo(info);
 
-    return fSample;
+    positionClock.set(dPos, info.dSoundLengthInSec, effects.fTempo, currentTrackState == CTS_PLAYING);
 }
 
-float AudioCore::read24bitSample(unsigned char iByte1, unsigned char iByte2, unsigned char iByte3)
+AudioCore::~AudioCore()
 {
-    float fSample = 0.0f;
-
-    // interpret 24 bit as int 32
-    int iSample = ( (iByte3 << 24) | (iByte2 << 16) | (iByte1 << 8) ) >> 8;
-
-    // normalize to [-1.0f, 1.0f]
-    fSample = static_cast<float>(iSample) / 16777216; // 2^24
-
-    return fSample;
-}
+    std::future<bool> f = promiseFinishMonitorTrackPos.get_future();
 
-float AudioCore::read32bitSample(unsigned char iByte1, unsigned char iByte2, unsigned char iByte3, unsigned char iByte4)
-{
-    float fSample = 0.0f;
+    bDestroyCalled = true;
 
-    int iSample = 0;
 
-    std::memcpy(reinterpret_cast<char*>(&iSample),     &iByte1, 1);
-    std::memcpy(reinterpret_cast<char*>(&iSample) + 1, &iByte2, 1);
-    std::memcpy(reinterpret_cast<char*>(&iSample) + 2, &iByte3, 1);
-    std::memcpy(reinterpret_cast<char*>(&iSample) + 3, &iByte4, 1);
+    mtxImport.lock();
 
-    // normalize to [-1.0f, 1.0f]
-    fSample = static_cast<float>(iSample) / INT_MAX;
+    qImportJobs.clear();
+    bCancelImport = true;
 
-    return fSample;
-}
+    mtxImport.unlock();
 
-AudioCore::~AudioCore()
-{
-    std::future<bool> f = promiseFinishMonitorTrackPos.get_future();
+    if (futureFinishImport.valid())
+    {
+        futureFinishImport.get(); // wait for importTracks() thread to finish.
+    }
 
-    bDestroyCalled = true;
 
     if (currentTrackState != CTS_DELETED)
     {
@@ -1414,14 +2049,26 @@ AudioCore::~AudioCore()
         f.get(); // wait for monitorTrackPosition() thread to finish.
     }
 
+    if (futureFinishExport.valid())
+    {
+        bCancelExport = true;
+        futureFinishExport.get(); // wait for exportTracks() thread to finish.
+    }
+
+    cancelNextTrack(true);
+
     delete pCurrentTrack;
+    delete pNextTrack;
+
+    std::shared_ptr<const IndexedTracklist> pOldTracklist = getTracklist();
 
-    for (size_t i = 0; i < vAudioTracks.size(); i++)
+    for (size_t i = 0; i < pOldTracklist->size(); i++)
     {
-        removeTrack(vAudioTracks[i]);
+        removeTrack((*pOldTracklist)[i].get());
     }
 
-    vAudioTracks.clear();
+    publishTracklist(std::make_shared<IndexedTracklist>());
+    vPlayedHistory.clear();
 
     delete pRndGen;
 
@@ -14,15 +14,37 @@
 #include <mutex>
 #include <random>
 #include <future>
+#include <atomic>
+#include <memory>
+#include <deque>
 
 // Custom
 #include "Model/globals.h"
+#include "Model/PeakCache/peakcache.h"
+#include "Model/MediaLibrary/medialibrary.h"
+#include "Model/IndexedTracklist/indexedtracklist.h"
+#include "Model/StoppableTask/stoppabletask.h"
+#include "Model/NextTrackPredictor/nexttrackpredictor.h"
+#include "Model/AudioEngine/SSampleConverter/ssampleconverter.h"
+#include "Model/AudioEngine/SCrossfader/scrossfader.h"
+#include "Model/AudioEngine/SSpectrumAnalyzer/sspectrumanalyzer.h"
+#include "Model/AudioEngine/SPositionClock/spositionclock.h"
 
 
 class MainWindow;
 class SAudioEngine;
 class SSound;
 class SSoundMix;
+struct SSoundInfo;
+struct SRenderJob;
+
+struct ImportJob
+{
+    std::vector<std::wstring> vFiles;
+    std::vector<std::shared_ptr<const XTrackMetadata>> vMetadata; // for 'vFiles' (if opened from the tracklist file)
+    std::wstring sFolderPath; // if not empty, the files of this folder are imported instead of 'vFiles'
+    unsigned int iGeneration = 0;
+};
 
 enum CURRENT_TRACK_STATE
 {
@@ -46,17 +68,18 @@ public:
     ~AudioCore();
 
 
+    // The tracks are imported in another thread (see TrackImporter) and added in batches.
     void addTracks   (const std::vector<std::wstring>& vFiles);
     void addTracks   (const std::wstring& sFolderPath);
-    void removeTrack (const std::wstring& sAudioTitle);
+    void removeTrack (unsigned long long iTrackID);
     void setTrackPos (double x);
 
 
-    void moveUp     (const std::wstring& sAudioTitle);
-    void moveDown   (const std::wstring& sAudioTitle);
+    void moveUp     (unsigned long long iTrackID);
+    void moveDown   (unsigned long long iTrackID);
 
 
-    void playTrack   (const std::wstring& sTrackTitle, bool bCalledFromOtherThread);
+    void playTrack   (unsigned long long iTrackID, bool bCalledFromOtherThread);
     void playTrack   (bool bCalledFromOtherThread);
     void pauseTrack  ();
     void stopTrack   (bool bCalledFromOtherThread);
@@ -66,6 +89,8 @@ public:
 
     void setRandomTrack();
     void setRepeatTrack();
+    // 'dCrossfadeInSec' is in [0, MAX_CROSSFADE_IN_SEC], 0 - no crossfade.
+    void setCrossfade   (double dCrossfadeInSec, S_CROSSFADE_CURVE curve);
 
 
     void clearTracklist();
@@ -74,79 +99,168 @@ public:
     void setVolume   (int iVolume);
 
 
+    // Position of the current track, can be read from any thread without locking.
+    const SPositionClock* getPositionClock() const;
+
+
     CurrentEffects* getCurrentEffects();
     void setPitch        (float fPitch);
+    void setTempo        (float fTempo);
     void setReverbVolume (float fVolume);
 
 
+    // The final mix is analyzed only while enabled.
+    void setSpectrumEnabled (bool bEnable);
+    // 'vBands' will have SPECTRUM_BAND_COUNT levels in [0, 1] (all zeros if disabled).
+    void getSpectrum        (std::vector<float>& vBands);
+
+
     void saveTracklist   (const std::wstring& sPathToFile);
     void openTracklist   (const std::wstring& sPathToFile, bool bClearCurrentTracklist);
 
 
+    // Renders the tracks with the current effects (pitch, reverb, eq) to .wav files faster than realtime
+    // (in another thread, the tracks are rendered in parallel).
+    void exportTrack     (unsigned long long iTrackID, const std::wstring& sOutputPath);
+    void exportTracklist (const std::wstring& sOutputFolder);
+
+
     void searchFindPrev  ();
     void searchFindNext  ();
     void searchTextSet   (const std::wstring& sKeyword);
 
 private:
 
-    std::wstring getTrackTitle (const std::wstring& sAudioPath);
-    std::wstring getTrackExtension(const std::wstring& sTrackPath);
     std::wstring  getTrackInfo (XAudioFile* pTrack);
+    // Should be called under 'mtxTransport' when the track is loaded in 'pCurrentTrack'.
+    void updateTrackMetadata   (XAudioFile* pTrack);
 
+    // Releases the file of the track (the track should not be in the tracklist).
     void removeTrack           (XAudioFile* pAudio);
+    // Should be called under 'mtxTracklist' (it's unlocked here): publishes 'pNewTracklist' (without 'vRemovedTracks'),
+    // stops the removed track if it's playing and removes them from the history.
+    void removeTracks          (std::shared_ptr<const IndexedTracklist> pNewTracklist, const XTracklist& vRemovedTracks);
+    void setPeakCacheDirectory (const std::wstring& sPathToTracklist);
     void onCurrentTrackEnded   (SSound* pTrack);
 
+    // Snapshot of the tracklist, can be used without locking.
+    std::shared_ptr<const IndexedTracklist> getTracklist() const;
+    // Should be called under 'mtxTracklist', the UI is updated asynchronously.
+    void publishTracklist      (std::shared_ptr<const IndexedTracklist> pNewTracklist);
+    // Should be called under 'mtxSearch', returns 'true' if the search was done again (the tracklist was changed).
+    bool updateSearchResult    (const std::shared_ptr<const IndexedTracklist>& pCurrentTracklist);
+
+    // Should be called under 'mtxTransport' when 'pFile' is loaded in 'pNextTrack' (see monitorTrackPosition()):
+    // starts decoding the next track (without playing) so that switching to it is almost instant.
+    void prefetchNextTrack     (std::shared_ptr<XAudioFile> pFile);
+    // Keeps the next track if it's already playing (crossfade started) and 'bEvenIfStarted' is 'false'.
+    void cancelNextTrack       (bool bEvenIfStarted);
+    // Should be called under 'mtxTransport' after the tracklist was changed: keeps the next track if it's still the next one.
+    void cancelNextTrackIfChanged();
+
     size_t findCaseInsensitive (std::wstring sText, std::wstring sKeyword);
 
-    void drawGraph             ();
-    void waitForGraphToStop    ();
+    void drawGraph             (std::wstring sPathToAudioFile, std::promise<bool> promiseFinish, unsigned long long iGraphTaskID);
+    bool drawGraphFromCache    (const std::wstring& sPathToAudioFile);
+    void drawGraphFromFile     (const std::wstring& sPathToAudioFile, const SSoundInfo& info, S_SAMPLE_FORMAT sampleFormat, unsigned long long iGraphTaskID);
+    void peaksToGraph          (const std::vector<float>& vPeaks, size_t iFirstPeak, size_t iPeakCount, std::vector<float>& vSamplesForGraph);
     void applyAudioEffects     ();
+    void startImport           (ImportJob job);
+    void importTracks          ();
+    // Called on the import thread for each batch.
+    void addImportedTracks     (const XTracklist& vTracks, unsigned int iImportGeneration);
+    // Called on the import thread after a folder is scanned: the tracks of the removed files are removed,
+    // the tracks of the moved files are replaced with the tracks of their new paths.
+    void applyFolderChanges    (const MediaLibraryChanges& changes, unsigned int iImportGeneration);
+    void startExport           (const std::vector<SRenderJob>& vJobs);
+    void exportTracks          (std::vector<SRenderJob> vJobs);
 
     void monitorTrackPosition  ();
-    std::string getTimeString  (double dTimeInSec);
-
-    float read16bitSample      (unsigned char iByte1, unsigned char iByte2);
-    float read24bitSample      (unsigned char iByte1, unsigned char iByte2, unsigned char iByte3);
-    float read32bitSample      (unsigned char iByte1, unsigned char iByte2, unsigned char iByte3, unsigned char iByte4);
+    // Should be called under 'mtxTransport' when the position, the state or the tempo of the current track changes.
+    void updatePositionClock   ();
 
 
     MainWindow*   pMainWindow;
     SAudioEngine* pAudioEngine;
     SSound*       pCurrentTrack;
+    SSound*       pNextTrack;
+    std::shared_ptr<XAudioFile> pNextTrackFile; // file loaded in 'pNextTrack' (if not 'nullptr')
+    bool          bCrossfadeSet; // 'pCurrentTrack' will fade out into 'pNextTrack'
+    unsigned long long iNextTrackGeneration; // under 'mtxTransport', changed in cancelNextTrack()
     SSoundMix*    pMix;
 
     std::mt19937_64*  pRndGen;
 
 
-    std::vector<XAudioFile*> vAudioTracks;
-    std::vector<XAudioFile*> vPlayedHistory;
+    // Copy-on-write: the readers take a snapshot (see getTracklist()) without locking,
+    // the writers copy it, change the copy and publish it (see publishTracklist()).
+    std::shared_ptr<const IndexedTracklist> pTracklist;
+    unsigned long long  iNextTrackID; // under 'mtxTracklist', see XAudioFile::iTrackID
+    XTracklist          vPlayedHistory; // under 'mtxTransport'
 
 
     CurrentEffects      effects;
 
 
-    std::promise<bool>  promiseFinishDrawGraph;
-    std::mutex          mtxDrawGraph;
-    bool                bDrawingGraph;
+    SPositionClock      positionClock;
+
+
+    SSpectrumAnalyzer   spectrumAnalyzer;
+    bool                bSpectrumEnabled;
+
+
+    // Import (the jobs are done one by one on the import thread).
+    std::deque<ImportJob> qImportJobs;
+    std::mutex          mtxImport;
+    std::promise<bool>  promiseFinishImport;
+    std::future<bool>   futureFinishImport;
+    bool                bImportRunning; // under 'mtxImport'
+    std::atomic<bool>   bCancelImport;
+    std::atomic<unsigned int> iImportGeneration; // changed when the tracklist is cleared
+
+
+    std::promise<bool>  promiseFinishExport;
+    std::future<bool>   futureFinishExport;
+    std::atomic<bool>   bExportRunning;
+    std::atomic<bool>   bCancelExport;
+
+
+    // The draw thread is started under 'mtxTransport' (in playTrack()),
+    // waited for only after 'mtxTracklist' and 'mtxTransport' are unlocked.
+    StoppableTask       graphTask;
+
+
+    PeakCache           peakCache;
+    MediaLibrary        library;
 
 
     std::promise<bool>  promiseFinishMonitorTrackPos;
     bool                bMonitorRunning;
 
 
-    // Search
+    // Search (under 'mtxSearch'), the results are the indexes in 'pSearchTracklist'.
+    std::shared_ptr<const IndexedTracklist> pSearchTracklist;
+    std::wstring        sSearchKeyword;
     std::vector<size_t> vSearchResult;
     size_t              iCurrentPosInSearchVec;
     bool                bFirstSearchAfterKeyChange;
 
 
-    std::mutex    mtxProcess;
+    // The writers of the tracklist (the file and the UI work is done under this one).
+    std::mutex    mtxTracklist;
+    // The playback: the current and the next sound, the state, the history and the playback settings.
+    std::mutex    mtxTransport;
+    std::mutex    mtxSearch;
 
 
     bool          bLoadedTrackAtLeastOneTime;
     CURRENT_TRACK_STATE currentTrackState;
 
 
+    double        dCrossfadeInSec;
+    S_CROSSFADE_CURVE crossfadeCurve;
+
+
     bool          bRandomTrack;
     bool          bRepeatTrack;
     bool          bDestroyCalled;
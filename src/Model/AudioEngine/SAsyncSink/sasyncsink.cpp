@@ -0,0 +1,177 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sasyncsink.h"
+
+// STL
+#include <chrono>
+
+
+SAsyncSink::SAsyncSink()
+{
+    pSink = nullptr;
+
+    iFrameSizeInBytes = 0;
+
+    bStopWriter = false;
+
+    iWrittenFrameCount = 0;
+    iDroppedFrameCount = 0;
+    bSinkFailed        = false;
+
+    bOpen = false;
+}
+
+SAsyncSink::~SAsyncSink()
+{
+    close();
+}
+
+void SAsyncSink::setSink(SAudioSink *pSink)
+{
+    this->pSink = pSink;
+}
+
+bool SAsyncSink::open(const SAudioSinkFormat &format)
+{
+    close();
+
+    if (pSink == nullptr || format.iSampleRate == 0 || format.iChannels == 0)
+    {
+        return true;
+    }
+
+    if (pSink->open(format))
+    {
+        return true;
+    }
+
+
+    iFrameSizeInBytes = format.iChannels * sizeof(float);
+
+    const size_t iRingFrameCount = static_cast<size_t>(format.iSampleRate * RING_SIZE_IN_SEC);
+
+    ring.setup(iRingFrameCount * iFrameSizeInBytes);
+    vWriteBuffer.resize(ring.getCapacity());
+
+    iWrittenFrameCount = 0;
+    iDroppedFrameCount = 0;
+    bSinkFailed        = false;
+
+    bStopWriter = false;
+    writerThread = std::thread(&SAsyncSink::writeToSink, this);
+
+    bOpen = true;
+
+    return false;
+}
+
+bool SAsyncSink::write(const float *pSamples, size_t iFrameCount)
+{
+    if (bOpen == false)
+    {
+        return true;
+    }
+
+    // Only whole frames so that the writer never sees a part of one.
+    size_t iFitFrameCount = ring.getFreeSize() / iFrameSizeInBytes;
+    if (iFitFrameCount > iFrameCount)
+    {
+        iFitFrameCount = iFrameCount;
+    }
+
+    ring.write(reinterpret_cast<const unsigned char*>(pSamples), iFitFrameCount * iFrameSizeInBytes);
+
+    iWrittenFrameCount.fetch_add(iFitFrameCount, std::memory_order_relaxed);
+
+    if (iFitFrameCount < iFrameCount)
+    {
+        iDroppedFrameCount.fetch_add(iFrameCount - iFitFrameCount, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool SAsyncSink::close()
+{
+    if (bOpen == false)
+    {
+        return false;
+    }
+
+    bOpen = false;
+
+
+    {
+        std::lock_guard<std::mutex> lock(mtxWriter);
+
+        bStopWriter = true;
+    }
+
+    cvWriter.notify_one();
+
+    writerThread.join();
+
+
+    if (pSink->close())
+    {
+        bSinkFailed = true;
+    }
+
+    return bSinkFailed;
+}
+
+bool SAsyncSink::isOpen() const
+{
+    return bOpen;
+}
+
+unsigned long long SAsyncSink::getWrittenFrameCount() const
+{
+    return iWrittenFrameCount.load(std::memory_order_relaxed);
+}
+
+unsigned long long SAsyncSink::getDroppedFrameCount() const
+{
+    return iDroppedFrameCount.load(std::memory_order_relaxed);
+}
+
+void SAsyncSink::writeToSink()
+{
+    bool bStop = false;
+
+    while (true)
+    {
+        // Everything written before close() is in the ring when the stop is seen.
+        size_t iReadSize = ring.read(vWriteBuffer.data(), vWriteBuffer.size());
+
+        while (iReadSize > 0)
+        {
+            if (bSinkFailed == false && pSink->write(reinterpret_cast<const float*>(vWriteBuffer.data()), iReadSize / iFrameSizeInBytes))
+            {
+                bSinkFailed = true;
+            }
+
+            iReadSize = ring.read(vWriteBuffer.data(), vWriteBuffer.size());
+        }
+
+        if (bStop)
+        {
+            break;
+        }
+
+
+        std::unique_lock<std::mutex> lock(mtxWriter);
+
+        cvWriter.wait_for(lock, std::chrono::milliseconds(iWriteIntervalInMs), [this]() { return bStopWriter; });
+
+        // One more pass for the frames written before the stop.
+        bStop = bStopWriter;
+    }
+}
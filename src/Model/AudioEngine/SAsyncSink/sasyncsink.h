@@ -0,0 +1,77 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// Custom
+#include "AudioEngine/SAudioSink/saudiosink.h"
+#include "AudioEngine/SRingBuffer/sringbuffer.h"
+
+
+// Puts a sink that may block (like SWaveFileSink) behind a ring buffer: write() only copies the frames
+// to the ring (it does not lock or allocate, so it can be called on the XAudio2 thread) and a writer thread
+// passes them to the sink. If the writer falls behind by more than the ring the new frames are dropped.
+class SAsyncSink : public SAudioSink
+{
+public:
+
+    SAsyncSink();
+    ~SAsyncSink() override;
+
+
+    // Should be called when the sink is closed, 'pSink' is opened and closed with this sink.
+    void setSink(SAudioSink* pSink);
+
+
+    bool open   (const SAudioSinkFormat& format) override;
+    // Returns 'true' if the frames did not fit in the ring (see getDroppedFrameCount()).
+    bool write  (const float* pSamples, size_t iFrameCount) override;
+    // Waits until everything written is passed to the sink,
+    // returns 'true' if the sink failed to write or close.
+    bool close  () override;
+
+
+    bool isOpen () const override;
+    // The frames that were put in the ring (not dropped).
+    unsigned long long getWrittenFrameCount() const override;
+
+    unsigned long long getDroppedFrameCount() const;
+
+    static constexpr double RING_SIZE_IN_SEC = 2.0;
+
+private:
+
+    void writeToSink();
+
+
+    SAudioSink*        pSink;
+
+    SRingBuffer        ring;
+    size_t             iFrameSizeInBytes;
+
+    std::thread        writerThread;
+    std::mutex         mtxWriter;
+    std::condition_variable cvWriter;
+    bool               bStopWriter;
+
+    std::vector<unsigned char> vWriteBuffer;
+
+    std::atomic<unsigned long long> iWrittenFrameCount;
+    std::atomic<unsigned long long> iDroppedFrameCount;
+    std::atomic<bool>  bSinkFailed;
+
+    std::atomic<bool>  bOpen;
+
+    static const unsigned int iWriteIntervalInMs = 10;
+};
@@ -12,6 +12,8 @@
 
 // Custom
 #include "AudioEngine/SSoundMix/ssoundmix.h"
+#include "AudioEngine/SAudioSink/saudiosink.h"
+#include "AudioEngine/SSinkTap/ssinktap.h"
 #include "View/MainWindow/mainwindow.h"
 
 
@@ -21,6 +23,11 @@ SAudioEngine::SAudioEngine(MainWindow* pMainWindow)
 
     pMasteringVoice = nullptr;
 
+    pOutputSink = nullptr;
+    pSinkTap = nullptr;
+    pAnalyzerSink = nullptr;
+    pAnalyzerTap = nullptr;
+
     bEngineInitialized = false;
 
     bEnableLowLatency = true;
@@ -95,6 +102,149 @@ bool SAudioEngine::getMasterVolume(float &fVolume)
     return false;
 }
 
+bool SAudioEngine::setOutputSink(SAudioSink *pSink)
+{
+    return setSinkTap(pSink, pOutputSink, pSinkTap, &outputSinkWriter, L"AudioEngine::setOutputSink");
+}
+
+bool SAudioEngine::setAnalyzerSink(SAudioSink *pSink)
+{
+    // SSpectrumAnalyzer::write() only copies to its ring.
+    return setSinkTap(pSink, pAnalyzerSink, pAnalyzerTap, nullptr, L"AudioEngine::setAnalyzerSink");
+}
+
+void SAudioEngine::setMaxCachedFiles(size_t iMaxCachedFiles)
+{
+    fileHandleCache.setMaxOpenedFiles(iMaxCachedFiles);
+}
+
+void SAudioEngine::closeCachedFile(const std::wstring &sPathToFile)
+{
+    fileHandleCache.closeFile(sPathToFile);
+}
+
+SFileHandleCache *SAudioEngine::getFileHandleCache()
+{
+    return &fileHandleCache;
+}
+
+bool SAudioEngine::setSinkTap(SAudioSink *pSink, SAudioSink *&pCurrentSink, SSinkTap *&pCurrentTap, SAsyncSink *pWriter, const std::wstring &sPathToFunc)
+{
+    if (bEngineInitialized == false)
+    {
+        showError(sPathToFunc + L"()", L"the audio engine is not initialized.");
+        return true;
+    }
+
+
+    std::lock_guard<std::mutex> lock(mtxOutputSink);
+
+    if (pCurrentTap)
+    {
+        // Remove the old sink (the other tap stays).
+
+        SSinkTap* pOldTap = pCurrentTap;
+        pCurrentTap = nullptr;
+
+        updateMasteringEffectChain();
+
+        pOldTap->detach();
+        pOldTap->Release();
+
+        if (pWriter)
+        {
+            // Writes the rest of the ring and closes the sink.
+            pWriter->close();
+        }
+        else
+        {
+            pCurrentSink->close();
+        }
+
+        pCurrentSink = nullptr;
+    }
+
+    if (pSink == nullptr)
+    {
+        return false;
+    }
+
+
+    XAUDIO2_VOICE_DETAILS details;
+    pMasteringVoice->GetVoiceDetails(&details);
+
+    SAudioSinkFormat format;
+    format.iSampleRate = details.InputSampleRate;
+    format.iChannels   = static_cast<unsigned short>(details.InputChannels);
+
+    SAudioSink* pTapSink = pSink;
+
+    if (pWriter)
+    {
+        pWriter->setSink(pSink);
+
+        pTapSink = pWriter;
+    }
+
+    if (pTapSink->open(format))
+    {
+        showError(sPathToFunc + L"()", L"could not open the sink.");
+        return true;
+    }
+
+
+    pCurrentTap = new SSinkTap(pTapSink);
+
+    HRESULT hr = updateMasteringEffectChain();
+    if (FAILED(hr))
+    {
+        pCurrentTap->Release();
+        pCurrentTap = nullptr;
+
+        pTapSink->close();
+
+        showError(hr, sPathToFunc + L"::SetEffectChain()");
+        return true;
+    }
+
+    pCurrentSink = pSink;
+
+
+    return false;
+}
+
+HRESULT SAudioEngine::updateMasteringEffectChain()
+{
+    XAUDIO2_VOICE_DETAILS details;
+    pMasteringVoice->GetVoiceDetails(&details);
+
+    XAUDIO2_EFFECT_DESCRIPTOR descriptors[2];
+    UINT32 iEffectCount = 0;
+
+    for (SSinkTap* pTap : {pSinkTap, pAnalyzerTap})
+    {
+        if (pTap)
+        {
+            descriptors[iEffectCount].InitialState   = TRUE;
+            descriptors[iEffectCount].OutputChannels = details.InputChannels;
+            descriptors[iEffectCount].pEffect        = static_cast<IXAPO*>(pTap);
+
+            iEffectCount++;
+        }
+    }
+
+    if (iEffectCount == 0)
+    {
+        return pMasteringVoice->SetEffectChain(nullptr);
+    }
+
+    XAUDIO2_EFFECT_CHAIN chain;
+    chain.EffectCount        = iEffectCount;
+    chain.pEffectDescriptors = descriptors;
+
+    return pMasteringVoice->SetEffectChain(&chain);
+}
+
 SAudioEngine::~SAudioEngine()
 {
     mtxSoundMix.lock();
@@ -107,6 +257,12 @@ SAudioEngine::~SAudioEngine()
     mtxSoundMix.unlock();
 
 
+    if (bEngineInitialized)
+    {
+        setOutputSink(nullptr);
+        setAnalyzerSink(nullptr);
+    }
+
 
     pMasteringVoice->DestroyVoice();
 
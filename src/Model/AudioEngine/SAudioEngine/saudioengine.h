@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <functional>
 
 // XAudio2
 #include <xaudio2.h>
@@ -30,6 +31,11 @@
 
 #include <Shlwapi.h>
 
+// Custom
+#include "AudioEngine/SEffectProcessor/seffectprocessor.h"
+#include "AudioEngine/SFileHandleCache/sfilehandlecache.h"
+#include "AudioEngine/SAsyncSink/sasyncsink.h"
+
 #pragma comment(lib, "mfreadwrite.lib")
 #pragma comment(lib, "mfplat.lib")
 #pragma comment(lib, "mfuuid")
@@ -162,6 +168,10 @@ struct VoiceCallback : public IXAudio2VoiceCallback
     HANDLE hStreamEnd;
     HANDLE hBufferEndEvent;
 
+    // Optional, called on the XAudio2 thread (should not block).
+    std::function<void(UINT32)> onProcessingPassStart;
+    std::function<void(void*)>  onBufferEnd;
+
     VoiceCallback()
     {
         hBufferEndEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
@@ -185,11 +195,17 @@ struct VoiceCallback : public IXAudio2VoiceCallback
     void OnVoiceProcessingPassEnd() { }
     void OnVoiceProcessingPassStart(UINT32 SamplesRequired)
     {
-        UNREFERENCED_PARAMETER(SamplesRequired);
+        if (onProcessingPassStart)
+        {
+            onProcessingPassStart(SamplesRequired);
+        }
     }
     void OnBufferEnd(void * pBufferContext)
     {
-        UNREFERENCED_PARAMETER(pBufferContext);
+        if (onBufferEnd)
+        {
+            onBufferEnd(pBufferContext);
+        }
 
         SetEvent(hBufferEndEvent);
     }
@@ -213,6 +229,8 @@ struct VoiceCallback : public IXAudio2VoiceCallback
 class MainWindow;
 class SSoundMix;
 class SSound;
+class SAudioSink;
+class SSinkTap;
 
 
 class SAudioEngine
@@ -234,6 +252,29 @@ public:
 
     bool getMasterVolume(float& fVolume);
 
+
+    // The final mix is also written to 'pSink' (it's opened here with the mastering voice format
+    // and closed when replaced), pass 'nullptr' to remove the sink.
+    // The sink is called on a writer thread (see SAsyncSink) so it may block, frames are dropped
+    // if it falls behind by more than SAsyncSink::RING_SIZE_IN_SEC.
+    bool setOutputSink(SAudioSink* pSink);
+
+    // Same as setOutputSink() but for the analysis of the final mix (see SSpectrumAnalyzer),
+    // both sinks can be set at the same time.
+    // This sink is called on the XAudio2 thread, its write() should not block.
+    bool setAnalyzerSink(SAudioSink* pSink);
+
+
+    // The mapped .wav files of the sounds are kept in the cache (see SFileHandleCache),
+    // at most 'iMaxCachedFiles' files that are not played are kept opened.
+    void setMaxCachedFiles(size_t iMaxCachedFiles);
+
+    // Should be called when the file is not going to be played, it will be opened again if needed.
+    void closeCachedFile(const std::wstring& sPathToFile);
+
+    // For the other readers of the tracks (export, graph) so that a file is mapped only once.
+    SFileHandleCache* getFileHandleCache();
+
     ~SAudioEngine();
 
 private:
@@ -248,6 +289,12 @@ private:
 
     bool initSourceReaderConfig(IMFAttributes*& pSourceReaderConfig);
 
+    // Replaces 'pCurrentSink' with 'pSink' (under 'mtxOutputSink'),
+    // if 'pWriter' is not 'nullptr' the tap writes to it and it writes to 'pSink'.
+    bool    setSinkTap(SAudioSink* pSink, SAudioSink*& pCurrentSink, SSinkTap*& pCurrentTap, SAsyncSink* pWriter, const std::wstring& sPathToFunc);
+    // The sink taps of the mastering voice.
+    HRESULT updateMasteringEffectChain();
+
     void showError(HRESULT hr, const std::wstring& sPathToFunc);
     void showError(const std::wstring& sPathToFunc, const std::wstring& sErrorText);
 
@@ -259,10 +306,21 @@ private:
     IXAudio2MasteringVoice* pMasteringVoice;
 
 
+    std::mutex  mtxOutputSink;
+    SAudioSink* pOutputSink;
+    SSinkTap*   pSinkTap;
+    SAsyncSink  outputSinkWriter;
+    SAudioSink* pAnalyzerSink;
+    SSinkTap*   pAnalyzerTap;
+
+
     std::mutex mtxSoundMix;
     std::vector<SSoundMix*> vCreatedSoundMixes;
 
 
+    SFileHandleCache fileHandleCache;
+
+
     bool bEngineInitialized;
     bool bEnableLowLatency;
 };
@@ -271,18 +329,12 @@ private:
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 
-enum S_EFFECT_TYPE
-{
-    ET_REVERB = 0,
-    ET_EQ = 1,
-    ET_ECHO = 2
-};
-
 class SAudioEffect
 {
 public:
 
-    // see 'https://docs.microsoft.com/en-us/windows/win32/xaudio2/xapofx-overview' for details.
+    // see 'https://docs.microsoft.com/en-us/windows/win32/xaudio2/xapofx-overview' for details,
+    // the effects are processed by the native implementations (see SEffectProcessor) with the same parameters.
     SAudioEffect(SAudioEngine* pAudioEngine, S_EFFECT_TYPE effectType, bool bEnable)
     {
         this->effectType = effectType;
@@ -325,6 +377,7 @@ private:
 
     friend class SSound;
     friend class SSoundMix;
+    friend class SOfflineRenderer;
 
 
     SAudioEngine* pAudioEngine;
@@ -0,0 +1,37 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <cstddef>
+
+
+struct SAudioSinkFormat
+{
+    unsigned long  iSampleRate;
+    unsigned short iChannels;
+};
+
+// Output backend: receives the final mix as interleaved 32-bit float frames.
+// All methods return 'true' on error.
+class SAudioSink
+{
+public:
+
+    virtual ~SAudioSink() {}
+
+
+    virtual bool open   (const SAudioSinkFormat& format) = 0;
+    // 'pSamples' contains 'iFrameCount * format.iChannels' samples.
+    virtual bool write  (const float* pSamples, size_t iFrameCount) = 0;
+    virtual bool close  () = 0;
+
+
+    virtual bool isOpen () const = 0;
+    virtual unsigned long long getWrittenFrameCount() const = 0;
+};
@@ -0,0 +1,214 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sbiquadeq.h"
+
+// STL
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define S_BIQUAD_EQ_SSE
+#endif
+
+
+SBiquadEQ::SBiquadEQ()
+{
+    params.FrequencyCenter0 = FXEQ_DEFAULT_FREQUENCY_CENTER_0;
+    params.Gain0            = FXEQ_DEFAULT_GAIN;
+    params.Bandwidth0       = FXEQ_DEFAULT_BANDWIDTH;
+    params.FrequencyCenter1 = FXEQ_DEFAULT_FREQUENCY_CENTER_1;
+    params.Gain1            = FXEQ_DEFAULT_GAIN;
+    params.Bandwidth1       = FXEQ_DEFAULT_BANDWIDTH;
+    params.FrequencyCenter2 = FXEQ_DEFAULT_FREQUENCY_CENTER_2;
+    params.Gain2            = FXEQ_DEFAULT_GAIN;
+    params.Bandwidth2       = FXEQ_DEFAULT_BANDWIDTH;
+    params.FrequencyCenter3 = FXEQ_DEFAULT_FREQUENCY_CENTER_3;
+    params.Gain3            = FXEQ_DEFAULT_GAIN;
+    params.Bandwidth3       = FXEQ_DEFAULT_BANDWIDTH;
+
+    iSampleRate = 44100;
+    iChannels   = 0;
+
+    updateCoefficients();
+}
+
+void SBiquadEQ::setup(unsigned long iSampleRate, unsigned short iChannels)
+{
+    this->iSampleRate = iSampleRate;
+    this->iChannels   = iChannels;
+
+    vState.clear();
+    vState.resize(((iChannels + 3) / 4) * iBandCount * 2 * 4, 0.0f);
+
+    updateCoefficients();
+}
+
+void SBiquadEQ::setParameters(const void *pParameters)
+{
+    std::memcpy(&params, pParameters, sizeof(params));
+
+    updateCoefficients();
+}
+
+void SBiquadEQ::reset()
+{
+    std::fill(vState.begin(), vState.end(), 0.0f);
+}
+
+void SBiquadEQ::process(float *pSamples, size_t iFrameCount)
+{
+    SDenormalGuard guard;
+
+    for (unsigned short iFirstChannel = 0; iFirstChannel < iChannels; iFirstChannel += 4)
+    {
+        processChannels(pSamples, iFrameCount, iFirstChannel);
+    }
+}
+
+void SBiquadEQ::updateCoefficients()
+{
+    const float bandParams[iBandCount][3] =
+    {
+        {params.FrequencyCenter0, params.Gain0, params.Bandwidth0},
+        {params.FrequencyCenter1, params.Gain1, params.Bandwidth1},
+        {params.FrequencyCenter2, params.Gain2, params.Bandwidth2},
+        {params.FrequencyCenter3, params.Gain3, params.Bandwidth3}
+    };
+
+    const double dPi = 3.14159265358979323846;
+
+    for (size_t i = 0; i < iBandCount; i++)
+    {
+        // Peaking EQ from the "Audio EQ Cookbook" (R. Bristow-Johnson),
+        // the gain is linear (amplitude) as in FXEQ, bandwidth is in octaves.
+
+        double dFrequency = bandParams[i][0];
+        double dGain      = bandParams[i][1];
+        double dBandwidth = bandParams[i][2];
+
+        if (dFrequency < FXEQ_MIN_FREQUENCY_CENTER) dFrequency = FXEQ_MIN_FREQUENCY_CENTER;
+        if (dFrequency > 0.45 * iSampleRate)        dFrequency = 0.45 * iSampleRate;
+        if (dGain < FXEQ_MIN_GAIN)                  dGain = FXEQ_MIN_GAIN;
+        if (dGain > FXEQ_MAX_GAIN)                  dGain = FXEQ_MAX_GAIN;
+        if (dBandwidth < FXEQ_MIN_BANDWIDTH)        dBandwidth = FXEQ_MIN_BANDWIDTH;
+        if (dBandwidth > FXEQ_MAX_BANDWIDTH)        dBandwidth = FXEQ_MAX_BANDWIDTH;
+
+        const double dA     = std::sqrt(dGain);
+        const double dW0    = 2.0 * dPi * dFrequency / iSampleRate;
+        const double dCosW0 = std::cos(dW0);
+        const double dSinW0 = std::sin(dW0);
+        const double dAlpha = dSinW0 * std::sinh(std::log(2.0) / 2.0 * dBandwidth * dW0 / dSinW0);
+
+        const double dA0 = 1.0 + dAlpha / dA;
+
+        coefficients[i][0] = static_cast<float>((1.0 + dAlpha * dA) / dA0);
+        coefficients[i][1] = static_cast<float>((-2.0 * dCosW0) / dA0);
+        coefficients[i][2] = static_cast<float>((1.0 - dAlpha * dA) / dA0);
+        coefficients[i][3] = static_cast<float>((-2.0 * dCosW0) / dA0);
+        coefficients[i][4] = static_cast<float>((1.0 - dAlpha / dA) / dA0);
+    }
+}
+
+void SBiquadEQ::processChannels(float *pSamples, size_t iFrameCount, unsigned short iFirstChannel)
+{
+    unsigned short iLaneCount = iChannels - iFirstChannel;
+    if (iLaneCount > 4)
+    {
+        iLaneCount = 4;
+    }
+
+    float* pState = vState.data() + (iFirstChannel / 4) * iBandCount * 2 * 4;
+
+#if defined(S_BIQUAD_EQ_SSE)
+
+    alignas(16) float frame[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    __m128 b0[iBandCount], b1[iBandCount], b2[iBandCount], a1[iBandCount], a2[iBandCount];
+    __m128 z1[iBandCount], z2[iBandCount];
+
+    for (size_t i = 0; i < iBandCount; i++)
+    {
+        b0[i] = _mm_set1_ps(coefficients[i][0]);
+        b1[i] = _mm_set1_ps(coefficients[i][1]);
+        b2[i] = _mm_set1_ps(coefficients[i][2]);
+        a1[i] = _mm_set1_ps(coefficients[i][3]);
+        a2[i] = _mm_set1_ps(coefficients[i][4]);
+
+        z1[i] = _mm_loadu_ps(pState + (i * 2) * 4);
+        z2[i] = _mm_loadu_ps(pState + (i * 2 + 1) * 4);
+    }
+
+    for (size_t iFrame = 0; iFrame < iFrameCount; iFrame++)
+    {
+        float* pFrame = pSamples + iFrame * iChannels + iFirstChannel;
+
+        for (unsigned short c = 0; c < iLaneCount; c++)
+        {
+            frame[c] = pFrame[c];
+        }
+
+        __m128 x = _mm_load_ps(frame);
+
+        for (size_t i = 0; i < iBandCount; i++)
+        {
+            // y = b0 * x + z1
+            // z1 = b1 * x - a1 * y + z2
+            // z2 = b2 * x - a2 * y
+            __m128 y = _mm_add_ps(_mm_mul_ps(b0[i], x), z1[i]);
+
+            z1[i] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1[i], x), _mm_mul_ps(a1[i], y)), z2[i]);
+            z2[i] = _mm_sub_ps(_mm_mul_ps(b2[i], x), _mm_mul_ps(a2[i], y));
+
+            x = y;
+        }
+
+        _mm_store_ps(frame, x);
+
+        for (unsigned short c = 0; c < iLaneCount; c++)
+        {
+            pFrame[c] = frame[c];
+        }
+    }
+
+    for (size_t i = 0; i < iBandCount; i++)
+    {
+        _mm_storeu_ps(pState + (i * 2) * 4, z1[i]);
+        _mm_storeu_ps(pState + (i * 2 + 1) * 4, z2[i]);
+    }
+
+#else
+
+    for (size_t iFrame = 0; iFrame < iFrameCount; iFrame++)
+    {
+        float* pFrame = pSamples + iFrame * iChannels + iFirstChannel;
+
+        for (unsigned short c = 0; c < iLaneCount; c++)
+        {
+            float x = pFrame[c];
+
+            for (size_t i = 0; i < iBandCount; i++)
+            {
+                float& z1 = pState[(i * 2) * 4 + c];
+                float& z2 = pState[(i * 2 + 1) * 4 + c];
+
+                const float y = coefficients[i][0] * x + z1;
+
+                z1 = coefficients[i][1] * x - coefficients[i][3] * y + z2;
+                z2 = coefficients[i][2] * x - coefficients[i][4] * y;
+
+                x = y;
+            }
+
+            pFrame[c] = x;
+        }
+    }
+
+#endif
+}
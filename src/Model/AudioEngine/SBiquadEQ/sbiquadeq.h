@@ -0,0 +1,53 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Custom
+#include "AudioEngine/SEffectProcessor/seffectprocessor.h"
+
+
+// 4-band parametric EQ (FXEQ_PARAMETERS): a cascade of 4 peaking biquads (transposed direct form II),
+// up to 4 channels are filtered at once with SSE.
+class SBiquadEQ : public SEffectProcessor
+{
+public:
+
+    SBiquadEQ();
+
+
+    void setup         (unsigned long iSampleRate, unsigned short iChannels) override;
+    void setParameters (const void* pParameters) override;
+    void reset         () override;
+
+    void process       (float* pSamples, size_t iFrameCount) override;
+
+private:
+
+    void updateCoefficients();
+    // 'iFirstChannel' - first of the (up to) 4 channels.
+    void processChannels(float* pSamples, size_t iFrameCount, unsigned short iFirstChannel);
+
+
+    static const size_t iBandCount = 4;
+
+
+    FXEQ_PARAMETERS params;
+
+    // b0, b1, b2, a1, a2 (normalized) for each band.
+    float coefficients[iBandCount][5];
+
+    // z1, z2 for each band of each channel ([channel group][band][z1/z2][4 channels]).
+    std::vector<float> vState;
+
+
+    unsigned long  iSampleRate;
+    unsigned short iChannels;
+};
@@ -0,0 +1,229 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "scrossfader.h"
+
+// STL
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+
+SCrossfader::SCrossfader()
+{
+    reset();
+}
+
+void SCrossfader::setup(S_CROSSFADE_CURVE curve, bool bFadeIn, unsigned long long iFadeStartFrame, unsigned long long iFadeFrameCount)
+{
+    this->curve = curve;
+    this->bFadeIn = bFadeIn;
+    this->iFadeStartFrame = iFadeStartFrame;
+    this->iFadeFrameCount = iFadeFrameCount;
+}
+
+void SCrossfader::reset()
+{
+    curve = CC_EQUAL_POWER;
+    bFadeIn = false;
+    iFadeStartFrame = 0;
+    iFadeFrameCount = 0;
+}
+
+bool SCrossfader::isEnabled() const
+{
+    return iFadeFrameCount > 0;
+}
+
+float SCrossfader::getGain(unsigned long long iFrame) const
+{
+    if (iFadeFrameCount == 0)
+    {
+        return 1.0f;
+    }
+
+    if (iFrame < iFadeStartFrame)
+    {
+        return bFadeIn ? 0.0f : 1.0f;
+    }
+
+    if (iFrame - iFadeStartFrame >= iFadeFrameCount)
+    {
+        return bFadeIn ? 1.0f : 0.0f;
+    }
+
+
+    const double dProgress = static_cast<double>(iFrame - iFadeStartFrame) / iFadeFrameCount;
+
+    return getCurveGain(curve, bFadeIn ? dProgress : 1.0 - dProgress);
+}
+
+void SCrossfader::apply(float *pSamples, size_t iFrameCount, unsigned short iChannels, unsigned long long iFirstFrame) const
+{
+    if (iFadeFrameCount == 0)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < iFrameCount; i++)
+    {
+        const float fGain = getGain(iFirstFrame + i);
+
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            pSamples[i * iChannels + c] *= fGain;
+        }
+    }
+}
+
+void SCrossfader::apply(unsigned char *pData, size_t iFrameCount, unsigned short iChannels, S_SAMPLE_FORMAT format, unsigned long long iFirstFrame) const
+{
+    if (iFadeFrameCount == 0)
+    {
+        return;
+    }
+
+    if (format == SF_FLOAT32)
+    {
+        // Decoded buffers are not always aligned for float.
+        for (size_t i = 0; i < iFrameCount; i++)
+        {
+            const float fGain = getGain(iFirstFrame + i);
+
+            if (fGain == 1.0f)
+            {
+                continue;
+            }
+
+            for (unsigned short c = 0; c < iChannels; c++)
+            {
+                unsigned char* pSample = pData + (i * iChannels + c) * sizeof(float);
+
+                float fSample = 0.0f;
+                std::memcpy(&fSample, pSample, sizeof(fSample));
+
+                fSample *= fGain;
+                std::memcpy(pSample, &fSample, sizeof(fSample));
+            }
+        }
+
+        return;
+    }
+
+
+    for (size_t i = 0; i < iFrameCount; i++)
+    {
+        const float fGain = getGain(iFirstFrame + i);
+
+        if (fGain == 1.0f)
+        {
+            continue;
+        }
+
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            const size_t iSampleIndex = i * iChannels + c;
+
+            switch (format)
+            {
+            case(SF_UINT8):
+            {
+                const int iSample = static_cast<int>(pData[iSampleIndex]) - 128;
+
+                pData[iSampleIndex] = static_cast<unsigned char>(std::lround(iSample * fGain) + 128);
+
+                break;
+            }
+            case(SF_INT16):
+            {
+                int16_t iSample = 0;
+                std::memcpy(&iSample, pData + iSampleIndex * 2, sizeof(iSample));
+
+                iSample = static_cast<int16_t>(std::lround(iSample * fGain));
+                std::memcpy(pData + iSampleIndex * 2, &iSample, sizeof(iSample));
+
+                break;
+            }
+            case(SF_INT24):
+            {
+                unsigned char* pSample = pData + iSampleIndex * 3;
+
+                int32_t iSample = static_cast<int32_t>( (static_cast<uint32_t>(pSample[2]) << 24) |
+                                                        (static_cast<uint32_t>(pSample[1]) << 16) |
+                                                        (static_cast<uint32_t>(pSample[0]) << 8) ) >> 8;
+
+                iSample = static_cast<int32_t>(std::lround(iSample * static_cast<double>(fGain)));
+
+                pSample[0] = static_cast<unsigned char>(iSample & 0xFF);
+                pSample[1] = static_cast<unsigned char>((iSample >> 8) & 0xFF);
+                pSample[2] = static_cast<unsigned char>((iSample >> 16) & 0xFF);
+
+                break;
+            }
+            case(SF_INT32):
+            {
+                int32_t iSample = 0;
+                std::memcpy(&iSample, pData + iSampleIndex * 4, sizeof(iSample));
+
+                iSample = static_cast<int32_t>(std::llround(iSample * static_cast<double>(fGain)));
+                std::memcpy(pData + iSampleIndex * 4, &iSample, sizeof(iSample));
+
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+}
+
+void SCrossfader::mix(const float *pOutgoing, const float *pIncoming, float *pOutSamples, size_t iFrameCount, unsigned short iChannels,
+                      S_CROSSFADE_CURVE curve, unsigned long long iFirstFrame, unsigned long long iFadeFrameCount)
+{
+    for (size_t i = 0; i < iFrameCount; i++)
+    {
+        float fOutGain = 0.0f;
+        float fInGain  = 1.0f;
+
+        if (iFirstFrame + i < iFadeFrameCount)
+        {
+            const double dProgress = static_cast<double>(iFirstFrame + i) / iFadeFrameCount;
+
+            fOutGain = getCurveGain(curve, 1.0 - dProgress);
+            fInGain  = getCurveGain(curve, dProgress);
+        }
+
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            const size_t iSampleIndex = i * iChannels + c;
+
+            pOutSamples[iSampleIndex] = pOutgoing[iSampleIndex] * fOutGain + pIncoming[iSampleIndex] * fInGain;
+        }
+    }
+}
+
+float SCrossfader::getCurveGain(S_CROSSFADE_CURVE curve, double dProgress)
+{
+    if (dProgress <= 0.0)
+    {
+        return 0.0f;
+    }
+
+    if (dProgress >= 1.0)
+    {
+        return 1.0f;
+    }
+
+
+    if (curve == CC_EQUAL_POWER)
+    {
+        // sin^2 + cos^2 = 1 so the summed power stays the same for uncorrelated tracks.
+        return static_cast<float>(std::sin(dProgress * 1.57079632679489661923));
+    }
+
+    return static_cast<float>(dProgress);
+}
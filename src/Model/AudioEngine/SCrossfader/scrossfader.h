@@ -0,0 +1,65 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <cstddef>
+
+// Custom
+#include "AudioEngine/SSampleConverter/ssampleconverter.h"
+
+
+enum S_CROSSFADE_CURVE
+{
+    CC_LINEAR      = 0,
+    CC_EQUAL_POWER = 1
+};
+
+// Gain ramp of one track in a crossfade (fade in from silence or fade out to silence).
+// The gain is computed from the frame index (not from the buffer position)
+// so the ramp is the same no matter how the track is split into buffers.
+class SCrossfader
+{
+public:
+
+    SCrossfader();
+
+
+    // 'iFadeFrameCount' == 0 disables the fade.
+    void setup                  (S_CROSSFADE_CURVE curve, bool bFadeIn, unsigned long long iFadeStartFrame, unsigned long long iFadeFrameCount);
+    void reset                  ();
+
+    bool isEnabled              () const;
+
+
+    // Gain of the frame 'iFrame' (frame index in the track).
+    float getGain               (unsigned long long iFrame) const;
+
+    // 'iFirstFrame' is the frame index (in the track) of the first frame in the buffer.
+    void apply                  (float* pSamples, size_t iFrameCount, unsigned short iChannels, unsigned long long iFirstFrame) const;
+    void apply                  (unsigned char* pData, size_t iFrameCount, unsigned short iChannels, S_SAMPLE_FORMAT format, unsigned long long iFirstFrame) const;
+
+
+    // Mixes two tracks, 'iFirstFrame' is the frame index (in the crossfade) of the first frame in the buffers,
+    // frames after the crossfade have only the incoming track.
+    static void mix             (const float* pOutgoing, const float* pIncoming, float* pOutSamples, size_t iFrameCount, unsigned short iChannels,
+                                 S_CROSSFADE_CURVE curve, unsigned long long iFirstFrame, unsigned long long iFadeFrameCount);
+
+    // Gain of the incoming track, 'dProgress' is in [0, 1].
+    // The outgoing track uses 'getCurveGain(curve, 1.0 - dProgress)'.
+    static float getCurveGain   (S_CROSSFADE_CURVE curve, double dProgress);
+
+private:
+
+    unsigned long long  iFadeStartFrame;
+    unsigned long long  iFadeFrameCount;
+
+    S_CROSSFADE_CURVE   curve;
+
+    bool                bFadeIn;
+};
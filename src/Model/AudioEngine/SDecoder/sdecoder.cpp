@@ -0,0 +1,65 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sdecoder.h"
+
+// STL
+#include <filesystem>
+#include <algorithm>
+#include <cwctype>
+
+// Custom
+#include "AudioEngine/SWaveDecoder/swavedecoder.h"
+#if defined(_WIN32)
+#include "AudioEngine/SMFDecoder/smfdecoder.h"
+#endif
+
+
+SDecoder *SDecoder::openFile(const std::wstring &sPathToFile, S_SAMPLE_FORMAT outputFormat, SFileHandleCache* pFileCache)
+{
+    std::wstring sExtension = std::filesystem::path(sPathToFile).extension().wstring();
+    std::transform(sExtension.begin(), sExtension.end(), sExtension.begin(), ::towlower);
+
+
+    if (sExtension == L".wav")
+    {
+        // Uncompressed .wav files are read right from the mapped file.
+
+        SWaveDecoder* pWaveDecoder = new SWaveDecoder(pFileCache);
+
+        if (pWaveDecoder->open(sPathToFile, outputFormat) == false)
+        {
+            return pWaveDecoder;
+        }
+
+        delete pWaveDecoder;
+    }
+
+
+#if defined(_WIN32)
+    // .mp3, .ogg and compressed .wav files.
+
+    SMFDecoder* pMFDecoder = new SMFDecoder();
+
+    if (pMFDecoder->open(sPathToFile, outputFormat) == false)
+    {
+        return pMFDecoder;
+    }
+
+    delete pMFDecoder;
+#endif
+
+
+    return nullptr;
+}
+
+size_t SDecoder::getOutputBlockAlign() const
+{
+    const size_t iSampleSize = (getOutputFormat() == SF_FLOAT32) ? sizeof(float) : 2;
+
+    return iSampleSize * getInfo().iChannels;
+}
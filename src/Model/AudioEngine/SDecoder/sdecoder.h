@@ -0,0 +1,62 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <cstddef>
+
+// Custom
+#include "AudioEngine/SSampleConverter/ssampleconverter.h"
+
+
+class SFileHandleCache;
+
+
+struct SDecoderInfo
+{
+    unsigned long long iFrameCount; // exact if 'bExactFrameCount', otherwise estimated from the duration
+    double         dLengthInSec;
+    unsigned int   iBitrate;        // of the encoded stream, 0 if unknown
+    unsigned long  iSampleRate;
+    unsigned short iChannels;
+    bool           bExactFrameCount;
+    bool           bUsesVariableBitRate;
+};
+
+// Decodes an audio file to interleaved PCM (16 bit int or 32 bit float) in caller-provided buffers.
+// All methods return 'true' on error.
+class SDecoder
+{
+public:
+
+    virtual ~SDecoder() {}
+
+
+    // Picks a decoder that supports the file (by the extension and the contents) on this platform,
+    // returns 'nullptr' if there is none. 'outputFormat' is SF_INT16 or SF_FLOAT32.
+    // The .wav files are mapped through 'pFileCache' (if not 'nullptr') so the file that is played is not opened again.
+    static SDecoder* openFile   (const std::wstring& sPathToFile, S_SAMPLE_FORMAT outputFormat, SFileHandleCache* pFileCache = nullptr);
+
+
+    virtual bool open           (const std::wstring& sPathToFile, S_SAMPLE_FORMAT outputFormat) = 0;
+    virtual void close          () = 0;
+
+
+    virtual const SDecoderInfo& getInfo() const = 0;
+    virtual S_SAMPLE_FORMAT getOutputFormat() const = 0;
+    size_t getOutputBlockAlign  () const;
+
+
+    // 'pOutData' should have space for 'iFrameCount' frames (see getOutputBlockAlign()),
+    // 'iReadFrameCount' is less than 'iFrameCount' only at the end of the stream.
+    virtual bool read           (unsigned char* pOutData, size_t iFrameCount, size_t& iReadFrameCount) = 0;
+
+    // The next read() starts at 'iFrameIndex'.
+    virtual bool seek           (unsigned long long iFrameIndex) = 0;
+};
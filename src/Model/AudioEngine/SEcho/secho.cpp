@@ -0,0 +1,131 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "secho.h"
+
+// STL
+#include <cstring>
+#include <algorithm>
+
+
+SEcho::SEcho()
+{
+    params.WetDryMix = FXECHO_DEFAULT_WETDRYMIX;
+    params.Feedback  = FXECHO_DEFAULT_FEEDBACK;
+    params.Delay     = FXECHO_DEFAULT_DELAY;
+
+    iDelayInFrames = 1;
+    iWritePos      = 0;
+
+    fWet      = 0.0f;
+    fDry      = 1.0f;
+    fFeedback = 0.0f;
+
+    iSampleRate = 44100;
+    iChannels   = 0;
+}
+
+void SEcho::setup(unsigned long iSampleRate, unsigned short iChannels)
+{
+    this->iSampleRate = iSampleRate;
+    this->iChannels   = iChannels;
+
+    const size_t iMaxDelayInFrames = static_cast<size_t>(FXECHO_MAX_DELAY / 1000.0 * iSampleRate) + 1;
+
+    vDelayLine.assign(iMaxDelayInFrames * iChannels, 0.0f);
+
+    reset();
+
+    updateParameters();
+}
+
+void SEcho::setParameters(const void *pParameters)
+{
+    std::memcpy(&params, pParameters, sizeof(params));
+
+    updateParameters();
+}
+
+void SEcho::reset()
+{
+    std::fill(vDelayLine.begin(), vDelayLine.end(), 0.0f);
+
+    iWritePos = 0;
+}
+
+void SEcho::process(float *pSamples, size_t iFrameCount)
+{
+    if (vDelayLine.empty())
+    {
+        return;
+    }
+
+    SDenormalGuard guard;
+
+    const size_t iLineFrameCount = vDelayLine.size() / iChannels;
+
+    size_t iReadPos = (iWritePos + iLineFrameCount - iDelayInFrames) % iLineFrameCount;
+
+    for (size_t iFrame = 0; iFrame < iFrameCount; iFrame++)
+    {
+        float* pFrame   = pSamples + iFrame * iChannels;
+        float* pDelayed = vDelayLine.data() + iReadPos * iChannels;
+        float* pWrite   = vDelayLine.data() + iWritePos * iChannels;
+
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            const float fInput   = pFrame[c];
+            const float fDelayed = pDelayed[c];
+
+            pWrite[c] = fInput + fFeedback * fDelayed;
+            pFrame[c] = fDry * fInput + fWet * fDelayed;
+        }
+
+        iWritePos++;
+        if (iWritePos == iLineFrameCount)
+        {
+            iWritePos = 0;
+        }
+
+        iReadPos++;
+        if (iReadPos == iLineFrameCount)
+        {
+            iReadPos = 0;
+        }
+    }
+}
+
+void SEcho::updateParameters()
+{
+    float fMix      = params.WetDryMix;
+    float fFeedback = params.Feedback;
+    float fDelay    = params.Delay;
+
+    if (fMix < FXECHO_MIN_WETDRYMIX)      fMix = FXECHO_MIN_WETDRYMIX;
+    if (fMix > FXECHO_MAX_WETDRYMIX)      fMix = FXECHO_MAX_WETDRYMIX;
+    if (fFeedback < FXECHO_MIN_FEEDBACK)  fFeedback = FXECHO_MIN_FEEDBACK;
+    if (fFeedback > FXECHO_MAX_FEEDBACK)  fFeedback = FXECHO_MAX_FEEDBACK;
+    if (fDelay < FXECHO_MIN_DELAY)        fDelay = FXECHO_MIN_DELAY;
+    if (fDelay > FXECHO_MAX_DELAY)        fDelay = FXECHO_MAX_DELAY;
+
+    fWet = fMix;
+    fDry = 1.0f - fMix;
+
+    // Keep the feedback loop stable.
+    this->fFeedback = fFeedback < 0.99f ? fFeedback : 0.99f;
+
+    iDelayInFrames = static_cast<size_t>(fDelay / 1000.0 * iSampleRate);
+    if (iDelayInFrames < 1)
+    {
+        iDelayInFrames = 1;
+    }
+
+    if (iChannels > 0 && iDelayInFrames >= vDelayLine.size() / iChannels)
+    {
+        iDelayInFrames = vDelayLine.size() / iChannels - 1;
+    }
+}
@@ -0,0 +1,51 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Custom
+#include "AudioEngine/SEffectProcessor/seffectprocessor.h"
+
+
+// Feedback echo (FXECHO_PARAMETERS), each channel has its own delay line.
+class SEcho : public SEffectProcessor
+{
+public:
+
+    SEcho();
+
+
+    void setup         (unsigned long iSampleRate, unsigned short iChannels) override;
+    void setParameters (const void* pParameters) override;
+    void reset         () override;
+
+    void process       (float* pSamples, size_t iFrameCount) override;
+
+private:
+
+    void updateParameters();
+
+
+    FXECHO_PARAMETERS params;
+
+
+    // Interleaved delay line (allocated for FXECHO_MAX_DELAY).
+    std::vector<float> vDelayLine;
+    size_t             iDelayInFrames;
+    size_t             iWritePos;
+
+    float              fWet;
+    float              fDry;
+    float              fFeedback;
+
+
+    unsigned long  iSampleRate;
+    unsigned short iChannels;
+};
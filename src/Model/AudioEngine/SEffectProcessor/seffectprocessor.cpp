@@ -0,0 +1,80 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "seffectprocessor.h"
+
+// Custom
+#include "AudioEngine/SBiquadEQ/sbiquadeq.h"
+#include "AudioEngine/SReverb/sreverb.h"
+#include "AudioEngine/SEcho/secho.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define S_DENORMAL_GUARD_SSE
+#endif
+
+
+SEffectProcessor* SEffectProcessor::create(S_EFFECT_TYPE effectType)
+{
+    switch (effectType)
+    {
+    case(ET_REVERB):
+    {
+        return new SReverb();
+    }
+    case(ET_EQ):
+    {
+        return new SBiquadEQ();
+    }
+    case(ET_ECHO):
+    {
+        return new SEcho();
+    }
+    }
+
+    return nullptr;
+}
+
+size_t SEffectProcessor::getParametersSize(S_EFFECT_TYPE effectType)
+{
+    switch (effectType)
+    {
+    case(ET_REVERB):
+    {
+        return sizeof(FXREVERB_PARAMETERS);
+    }
+    case(ET_EQ):
+    {
+        return sizeof(FXEQ_PARAMETERS);
+    }
+    case(ET_ECHO):
+    {
+        return sizeof(FXECHO_PARAMETERS);
+    }
+    }
+
+    return 0;
+}
+
+SDenormalGuard::SDenormalGuard()
+{
+#if defined(S_DENORMAL_GUARD_SSE)
+    iOldState = _mm_getcsr();
+
+    // Flush to zero (0x8000) and denormals are zero (0x0040).
+    _mm_setcsr(iOldState | 0x8040);
+#else
+    iOldState = 0;
+#endif
+}
+
+SDenormalGuard::~SDenormalGuard()
+{
+#if defined(S_DENORMAL_GUARD_SSE)
+    _mm_setcsr(iOldState);
+#endif
+}
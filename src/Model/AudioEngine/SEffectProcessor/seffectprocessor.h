@@ -0,0 +1,137 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <cstddef>
+
+#if defined(_WIN32)
+
+// XAudio2
+#include <xaudio2.h>
+#include <xapofx.h>
+
+#else
+
+// Same as in xapofx.h (the native effects use the XAPOFX parameters).
+
+struct FXEQ_PARAMETERS
+{
+    float FrequencyCenter0;
+    float Gain0;
+    float Bandwidth0;
+    float FrequencyCenter1;
+    float Gain1;
+    float Bandwidth1;
+    float FrequencyCenter2;
+    float Gain2;
+    float Bandwidth2;
+    float FrequencyCenter3;
+    float Gain3;
+    float Bandwidth3;
+};
+
+struct FXREVERB_PARAMETERS
+{
+    float Diffusion;
+    float RoomSize;
+};
+
+struct FXECHO_PARAMETERS
+{
+    float WetDryMix;
+    float Feedback;
+    float Delay;
+};
+
+#define FXEQ_MIN_FRAMERATE 22000
+#define FXEQ_MAX_FRAMERATE 48000
+
+#define FXEQ_MIN_FREQUENCY_CENTER       20.0f
+#define FXEQ_MAX_FREQUENCY_CENTER       20000.0f
+#define FXEQ_DEFAULT_FREQUENCY_CENTER_0 100.0f
+#define FXEQ_DEFAULT_FREQUENCY_CENTER_1 800.0f
+#define FXEQ_DEFAULT_FREQUENCY_CENTER_2 2000.0f
+#define FXEQ_DEFAULT_FREQUENCY_CENTER_3 10000.0f
+
+#define FXEQ_MIN_GAIN     0.126f
+#define FXEQ_MAX_GAIN     7.94f
+#define FXEQ_DEFAULT_GAIN 1.0f
+
+#define FXEQ_MIN_BANDWIDTH     0.1f
+#define FXEQ_MAX_BANDWIDTH     2.0f
+#define FXEQ_DEFAULT_BANDWIDTH 1.0f
+
+#define FXREVERB_MIN_DIFFUSION     0.0f
+#define FXREVERB_MAX_DIFFUSION     1.0f
+#define FXREVERB_DEFAULT_DIFFUSION 0.9f
+
+#define FXREVERB_MIN_ROOMSIZE     0.0001f
+#define FXREVERB_MAX_ROOMSIZE     1.0f
+#define FXREVERB_DEFAULT_ROOMSIZE 0.6f
+
+#define FXECHO_MIN_WETDRYMIX     0.0f
+#define FXECHO_MAX_WETDRYMIX     1.0f
+#define FXECHO_DEFAULT_WETDRYMIX 0.5f
+
+#define FXECHO_MIN_FEEDBACK     0.0f
+#define FXECHO_MAX_FEEDBACK     1.0f
+#define FXECHO_DEFAULT_FEEDBACK 0.5f
+
+#define FXECHO_MIN_DELAY     1.0f
+#define FXECHO_MAX_DELAY     2000.0f
+#define FXECHO_DEFAULT_DELAY 500.0f
+
+#endif
+
+
+enum S_EFFECT_TYPE
+{
+    ET_REVERB = 0,
+    ET_EQ = 1,
+    ET_ECHO = 2
+};
+
+
+// Native (portable) implementation of an effect, processes interleaved 32 bit float frames in place.
+class SEffectProcessor
+{
+public:
+
+    // Returns 'nullptr' if the type is unknown.
+    static SEffectProcessor* create(S_EFFECT_TYPE effectType);
+    // Size of the parameters struct (FXEQ_PARAMETERS, FXREVERB_PARAMETERS, FXECHO_PARAMETERS).
+    static size_t getParametersSize(S_EFFECT_TYPE effectType);
+
+
+    virtual ~SEffectProcessor() = default;
+
+
+    // Should be called before process(), resets the state.
+    virtual void setup         (unsigned long iSampleRate, unsigned short iChannels) = 0;
+    // 'pParameters' points to the parameters struct of this effect type (see getParametersSize()).
+    virtual void setParameters (const void* pParameters) = 0;
+    // Clears the history (delay lines, filter state).
+    virtual void reset         () = 0;
+
+    virtual void process       (float* pSamples, size_t iFrameCount) = 0;
+};
+
+
+// Flushes denormals to zero while alive (the recursive filters decay into denormals on silence).
+class SDenormalGuard
+{
+public:
+
+    SDenormalGuard();
+    ~SDenormalGuard();
+
+private:
+
+    unsigned int iOldState;
+};
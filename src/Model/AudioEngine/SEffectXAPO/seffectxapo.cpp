@@ -0,0 +1,91 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "seffectxapo.h"
+
+// STL
+#include <cstring>
+
+
+XAPO_REGISTRATION_PROPERTIES SEffectXAPO::registrationProperties =
+{
+    __uuidof(SEffectXAPO),
+    L"SEffectXAPO",
+    L"Copyright Aleksandr \"Flone\" Tretyakov",
+    1,
+    0,
+    XAPO_FLAG_CHANNELS_MUST_MATCH | XAPO_FLAG_FRAMERATE_MUST_MATCH | XAPO_FLAG_BITSPERSAMPLE_MUST_MATCH
+    | XAPO_FLAG_BUFFERCOUNT_MUST_MATCH | XAPO_FLAG_INPLACE_SUPPORTED | XAPO_FLAG_INPLACE_REQUIRED,
+    1,
+    1,
+    1,
+    1
+};
+
+
+SEffectXAPO::SEffectXAPO(S_EFFECT_TYPE effectType)
+    : CXAPOParametersBase(&registrationProperties, parameterBlocks, static_cast<UINT32>(SEffectProcessor::getParametersSize(effectType)), FALSE)
+{
+    std::memset(parameterBlocks, 0, sizeof(parameterBlocks));
+
+    pProcessor.reset(SEffectProcessor::create(effectType));
+
+    iChannels = 0;
+}
+
+HRESULT SEffectXAPO::LockForProcess(UINT32 iInputLockedParameterCount, const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS *pInputLockedParameters,
+                                    UINT32 iOutputLockedParameterCount, const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS *pOutputLockedParameters)
+{
+    HRESULT hr = CXAPOParametersBase::LockForProcess(iInputLockedParameterCount, pInputLockedParameters, iOutputLockedParameterCount, pOutputLockedParameters);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    // The submix voice format is always 32 bit float.
+    iChannels = pInputLockedParameters[0].pFormat->nChannels;
+
+    pProcessor->setup(pInputLockedParameters[0].pFormat->nSamplesPerSec, static_cast<unsigned short>(iChannels));
+
+    return S_OK;
+}
+
+void SEffectXAPO::Process(UINT32 iInputProcessParameterCount, const XAPO_PROCESS_BUFFER_PARAMETERS *pInputProcessParameters,
+                          UINT32 iOutputProcessParameterCount, XAPO_PROCESS_BUFFER_PARAMETERS *pOutputProcessParameters, BOOL bIsEnabled)
+{
+    UNREFERENCED_PARAMETER(iInputProcessParameterCount);
+    UNREFERENCED_PARAMETER(iOutputProcessParameterCount);
+
+    // Parameters set by SetEffectParameters() since the last pass.
+    const BYTE* pParameters = BeginProcess();
+
+    if (ParametersChanged())
+    {
+        pProcessor->setParameters(pParameters);
+    }
+
+    pOutputProcessParameters[0].ValidFrameCount = pInputProcessParameters[0].ValidFrameCount;
+    pOutputProcessParameters[0].BufferFlags     = pInputProcessParameters[0].BufferFlags;
+
+    if (bIsEnabled)
+    {
+        // In-place. Silent input is processed too (reverb/echo tail).
+
+        float* pSamples = static_cast<float*>(pInputProcessParameters[0].pBuffer);
+
+        if (pInputProcessParameters[0].BufferFlags == XAPO_BUFFER_SILENT)
+        {
+            std::memset(pSamples, 0, static_cast<size_t>(pInputProcessParameters[0].ValidFrameCount) * iChannels * sizeof(float));
+        }
+
+        pProcessor->process(pSamples, pInputProcessParameters[0].ValidFrameCount);
+
+        pOutputProcessParameters[0].BufferFlags = XAPO_BUFFER_VALID;
+    }
+
+    EndProcess();
+}
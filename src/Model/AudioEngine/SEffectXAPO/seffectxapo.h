@@ -0,0 +1,53 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <memory>
+
+// XAudio2
+#include <xapobase.h>
+
+// Custom
+#include "AudioEngine/SEffectProcessor/seffectprocessor.h"
+
+#pragma comment(lib, "xapobase.lib")
+
+
+// XAPO that runs a native effect (see SEffectProcessor) in an XAudio2 effect chain,
+// takes the same parameters as the XAPOFX effect of this type (SetEffectParameters()).
+class __declspec(uuid("{0C5A6E2B-7F3D-4B19-A8E4-6D21C9F0B357}")) SEffectXAPO : public CXAPOParametersBase
+{
+public:
+
+    SEffectXAPO(S_EFFECT_TYPE effectType);
+
+
+    STDMETHOD(LockForProcess) (UINT32 iInputLockedParameterCount,
+                               const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS* pInputLockedParameters,
+                               UINT32 iOutputLockedParameterCount,
+                               const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS* pOutputLockedParameters) override;
+
+    STDMETHOD_(void, Process) (UINT32 iInputProcessParameterCount,
+                               const XAPO_PROCESS_BUFFER_PARAMETERS* pInputProcessParameters,
+                               UINT32 iOutputProcessParameterCount,
+                               XAPO_PROCESS_BUFFER_PARAMETERS* pOutputProcessParameters,
+                               BOOL bIsEnabled) override;
+
+private:
+
+    static XAPO_REGISTRATION_PROPERTIES registrationProperties;
+
+    // CXAPOParametersBase needs 3 blocks (the largest parameters struct is FXEQ_PARAMETERS).
+    BYTE parameterBlocks[3 * sizeof(FXEQ_PARAMETERS)];
+
+
+    std::unique_ptr<SEffectProcessor> pProcessor;
+
+    UINT32 iChannels;
+};
@@ -0,0 +1,163 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sfft.h"
+
+// STL
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define S_FFT_SSE
+#endif
+
+
+SFFT::SFFT()
+{
+    iSize = 0;
+}
+
+bool SFFT::setup(size_t iSize)
+{
+    if (iSize < 4 || (iSize & (iSize - 1)) != 0)
+    {
+        return true;
+    }
+
+    this->iSize = iSize;
+
+
+    // Bit reversal.
+
+    vSwapPairs.clear();
+
+    size_t iBitCount = 0;
+    while ((static_cast<size_t>(1) << iBitCount) < iSize)
+    {
+        iBitCount++;
+    }
+
+    for (size_t i = 0; i < iSize; i++)
+    {
+        size_t iReversed = 0;
+        for (size_t iBit = 0; iBit < iBitCount; iBit++)
+        {
+            if (i & (static_cast<size_t>(1) << iBit))
+            {
+                iReversed |= static_cast<size_t>(1) << (iBitCount - 1 - iBit);
+            }
+        }
+
+        if (i < iReversed)
+        {
+            vSwapPairs.push_back(i);
+            vSwapPairs.push_back(iReversed);
+        }
+    }
+
+
+    // Twiddles.
+
+    vTwiddleReal.resize(iSize - 1);
+    vTwiddleImag.resize(iSize - 1);
+
+    const double dPi = 3.14159265358979323846;
+
+    for (size_t iHalf = 1; iHalf < iSize; iHalf *= 2)
+    {
+        for (size_t j = 0; j < iHalf; j++)
+        {
+            const double dAngle = -dPi * static_cast<double>(j) / static_cast<double>(iHalf);
+
+            vTwiddleReal[iHalf - 1 + j] = static_cast<float>(std::cos(dAngle));
+            vTwiddleImag[iHalf - 1 + j] = static_cast<float>(std::sin(dAngle));
+        }
+    }
+
+
+    return false;
+}
+
+size_t SFFT::getSize() const
+{
+    return iSize;
+}
+
+void SFFT::forward(float *pReal, float *pImag) const
+{
+    transform(pReal, pImag);
+}
+
+void SFFT::inverse(float *pReal, float *pImag) const
+{
+    // Swapping the real and imaginary parts before and after the forward transform gives the inverse one.
+    transform(pImag, pReal);
+}
+
+void SFFT::transform(float *pReal, float *pImag) const
+{
+    for (size_t i = 0; i < vSwapPairs.size(); i += 2)
+    {
+        std::swap(pReal[vSwapPairs[i]], pReal[vSwapPairs[i + 1]]);
+        std::swap(pImag[vSwapPairs[i]], pImag[vSwapPairs[i + 1]]);
+    }
+
+
+    for (size_t iHalf = 1; iHalf < iSize; iHalf *= 2)
+    {
+        const float* pTwiddleReal = vTwiddleReal.data() + iHalf - 1;
+        const float* pTwiddleImag = vTwiddleImag.data() + iHalf - 1;
+
+        for (size_t iGroup = 0; iGroup < iSize; iGroup += iHalf * 2)
+        {
+            float* pTopReal    = pReal + iGroup;
+            float* pTopImag    = pImag + iGroup;
+            float* pBottomReal = pTopReal + iHalf;
+            float* pBottomImag = pTopImag + iHalf;
+
+            size_t j = 0;
+
+#if defined(S_FFT_SSE)
+            for (; j + 4 <= iHalf; j += 4)
+            {
+                const __m128 wr = _mm_loadu_ps(pTwiddleReal + j);
+                const __m128 wi = _mm_loadu_ps(pTwiddleImag + j);
+
+                const __m128 br = _mm_loadu_ps(pBottomReal + j);
+                const __m128 bi = _mm_loadu_ps(pBottomImag + j);
+
+                // t = w * bottom
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(wr, br), _mm_mul_ps(wi, bi));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(wr, bi), _mm_mul_ps(wi, br));
+
+                const __m128 ar = _mm_loadu_ps(pTopReal + j);
+                const __m128 ai = _mm_loadu_ps(pTopImag + j);
+
+                _mm_storeu_ps(pTopReal + j,    _mm_add_ps(ar, tr));
+                _mm_storeu_ps(pTopImag + j,    _mm_add_ps(ai, ti));
+                _mm_storeu_ps(pBottomReal + j, _mm_sub_ps(ar, tr));
+                _mm_storeu_ps(pBottomImag + j, _mm_sub_ps(ai, ti));
+            }
+#endif
+
+            for (; j < iHalf; j++)
+            {
+                const float tr = pTwiddleReal[j] * pBottomReal[j] - pTwiddleImag[j] * pBottomImag[j];
+                const float ti = pTwiddleReal[j] * pBottomImag[j] + pTwiddleImag[j] * pBottomReal[j];
+
+                const float ar = pTopReal[j];
+                const float ai = pTopImag[j];
+
+                pTopReal[j]    = ar + tr;
+                pTopImag[j]    = ai + ti;
+                pBottomReal[j] = ar - tr;
+                pBottomImag[j] = ai - ti;
+            }
+        }
+    }
+}
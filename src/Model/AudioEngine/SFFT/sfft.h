@@ -0,0 +1,47 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstddef>
+
+
+// Radix-2 complex FFT on split (real, imaginary) arrays, in place.
+// The butterflies of the bigger stages are done 4 at a time with SSE.
+class SFFT
+{
+public:
+
+    SFFT();
+
+
+    // 'iSize' should be a power of two (>= 4). Returns 'true' if it's not.
+    bool   setup   (size_t iSize);
+    size_t getSize () const;
+
+
+    // X[k] = sum x[n] * e^(-2 pi i k n / N)
+    void forward   (float* pReal, float* pImag) const;
+    // Not scaled (the result is N times bigger than the input of forward()).
+    void inverse   (float* pReal, float* pImag) const;
+
+private:
+
+    void transform (float* pReal, float* pImag) const;
+
+
+    // Index pairs to swap for the bit-reversed order.
+    std::vector<size_t> vSwapPairs;
+
+    // Twiddles of each stage one after another (stage with 'h' butterflies per group starts at 'h - 1').
+    std::vector<float>  vTwiddleReal;
+    std::vector<float>  vTwiddleImag;
+
+    size_t iSize;
+};
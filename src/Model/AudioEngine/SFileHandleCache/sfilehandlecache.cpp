@@ -0,0 +1,144 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sfilehandlecache.h"
+
+// STL
+#include <filesystem>
+
+
+SFileHandleCache::SFileHandleCache()
+{
+    iMaxOpenedFiles = 4;
+
+    iHitCount = 0;
+    iMissCount = 0;
+}
+
+void SFileHandleCache::setMaxOpenedFiles(size_t iMaxOpenedFiles)
+{
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    this->iMaxOpenedFiles = iMaxOpenedFiles;
+
+    closeUnusedFiles();
+}
+
+std::shared_ptr<const SMappedFile> SFileHandleCache::openFile(const std::wstring &sPathToFile)
+{
+    long long iLastWriteTime = 0;
+
+    if (getLastWriteTime(sPathToFile, iLastWriteTime))
+    {
+        return nullptr;
+    }
+
+
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    auto it = fileIndex.find(sPathToFile);
+
+    if (it != fileIndex.end())
+    {
+        if (it->second->iLastWriteTime == iLastWriteTime)
+        {
+            // Most recently used now.
+            lFiles.splice(lFiles.begin(), lFiles, it->second);
+
+            iHitCount++;
+
+            return lFiles.front().pFile;
+        }
+
+        // Changed on the disk.
+        lFiles.erase(it->second);
+        fileIndex.erase(it);
+    }
+
+
+    std::shared_ptr<SMappedFile> pFile = std::make_shared<SMappedFile>();
+
+    if (pFile->open(sPathToFile))
+    {
+        return nullptr;
+    }
+
+    iMissCount++;
+
+    if (iMaxOpenedFiles > 0)
+    {
+        lFiles.push_front({sPathToFile, iLastWriteTime, pFile});
+        fileIndex[sPathToFile] = lFiles.begin();
+
+        closeUnusedFiles();
+    }
+
+    return pFile;
+}
+
+void SFileHandleCache::closeFile(const std::wstring &sPathToFile)
+{
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    auto it = fileIndex.find(sPathToFile);
+
+    if (it != fileIndex.end())
+    {
+        lFiles.erase(it->second);
+        fileIndex.erase(it);
+    }
+}
+
+void SFileHandleCache::closeAll()
+{
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    lFiles.clear();
+    fileIndex.clear();
+}
+
+SFileHandleCacheStats SFileHandleCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    SFileHandleCacheStats stats;
+    stats.iCachedFileCount = lFiles.size();
+    stats.iCachedSizeInBytes = 0;
+    stats.iHitCount = iHitCount;
+    stats.iMissCount = iMissCount;
+
+    for (const SCachedFile& file : lFiles)
+    {
+        stats.iCachedSizeInBytes += file.pFile->getSizeInBytes();
+    }
+
+    return stats;
+}
+
+void SFileHandleCache::closeUnusedFiles()
+{
+    while (lFiles.size() > iMaxOpenedFiles)
+    {
+        fileIndex.erase(lFiles.back().sPathToFile);
+        lFiles.pop_back();
+    }
+}
+
+bool SFileHandleCache::getLastWriteTime(const std::wstring &sPathToFile, long long &iLastWriteTime)
+{
+    std::error_code ec;
+
+    std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(std::filesystem::path(sPathToFile), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+    iLastWriteTime = static_cast<long long>(lastWriteTime.time_since_epoch().count());
+
+    return false;
+}
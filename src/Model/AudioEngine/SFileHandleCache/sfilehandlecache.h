@@ -0,0 +1,82 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+// Custom
+#include "AudioEngine/SMappedFile/smappedfile.h"
+
+
+struct SFileHandleCacheStats
+{
+    size_t             iCachedFileCount;   // including the ones that are used right now
+    unsigned long long iCachedSizeInBytes; // mapped size of the cached files
+    unsigned long long iHitCount;
+    unsigned long long iMissCount;         // the file was opened (not cached or changed)
+};
+
+// Keeps the last used files mapped (least recently used files are closed first),
+// so the files are opened only when they are played and not for every track in the tracklist.
+// The cache keeps at most 'iMaxOpenedFiles' files opened, a file that is still used
+// (see openFile()) stays opened until the last user releases it.
+class SFileHandleCache
+{
+public:
+
+    SFileHandleCache();
+
+    SFileHandleCache(const SFileHandleCache&) = delete;
+    SFileHandleCache& operator=(const SFileHandleCache&) = delete;
+
+
+    // 0 - the files are not cached.
+    void setMaxOpenedFiles     (size_t iMaxOpenedFiles);
+
+
+    // Returns 'nullptr' if the file can't be opened or mapped,
+    // the file is opened again if it was changed since it was cached.
+    std::shared_ptr<const SMappedFile> openFile (const std::wstring& sPathToFile);
+
+    void closeFile             (const std::wstring& sPathToFile);
+    void closeAll              ();
+
+
+    SFileHandleCacheStats getStats ();
+
+private:
+
+    struct SCachedFile
+    {
+        std::wstring sPathToFile;
+        long long    iLastWriteTime;
+        std::shared_ptr<const SMappedFile> pFile;
+    };
+
+
+    // Under 'mtxCache'.
+    void closeUnusedFiles      ();
+
+    static bool getLastWriteTime (const std::wstring& sPathToFile, long long& iLastWriteTime);
+
+
+    std::list<SCachedFile> lFiles; // most recently used first
+    std::unordered_map<std::wstring, std::list<SCachedFile>::iterator> fileIndex;
+
+    std::mutex   mtxCache;
+
+    size_t       iMaxOpenedFiles;
+
+    unsigned long long iHitCount;
+    unsigned long long iMissCount;
+};
@@ -0,0 +1,369 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "smfdecoder.h"
+
+// STL
+#include <cstring>
+#include <cmath>
+
+// Windows Media Foundation (WMF)
+#include <propvarutil.h>
+
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mfuuid")
+#pragma comment(lib, "Propsys.lib")
+
+
+SMFDecoder::SMFDecoder()
+{
+    std::memset(&info, 0, sizeof(info));
+
+    iPendingOffsetInBytes = 0;
+    iSeekTargetFrame = 0;
+
+    outputFormat = SF_INT16;
+
+    bSeekPending = false;
+    bEndOfStream = false;
+}
+
+SMFDecoder::~SMFDecoder()
+{
+    close();
+}
+
+bool SMFDecoder::open(const std::wstring &sPathToFile, S_SAMPLE_FORMAT outputFormat)
+{
+    close();
+
+    if (outputFormat != SF_INT16 && outputFormat != SF_FLOAT32)
+    {
+        return true;
+    }
+
+    this->outputFormat = outputFormat;
+
+
+    HRESULT hr = MFCreateSourceReaderFromURL(sPathToFile.c_str(), nullptr, pSourceReader.GetAddressOf());
+    if (FAILED(hr))
+    {
+        return true;
+    }
+
+
+    // Only the first audio stream.
+
+    pSourceReader->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_ALL_STREAMS), FALSE);
+
+    hr = pSourceReader->SetStreamSelection(static_cast<DWORD>(MF_SOURCE_READER_FIRST_AUDIO_STREAM), TRUE);
+    if (FAILED(hr))
+    {
+        close();
+        return true;
+    }
+
+
+    // Ask for the output format.
+
+    Microsoft::WRL::ComPtr<IMFMediaType> pPartialType;
+    hr = MFCreateMediaType(pPartialType.GetAddressOf());
+    if (FAILED(hr))
+    {
+        close();
+        return true;
+    }
+
+    pPartialType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+
+    if (outputFormat == SF_FLOAT32)
+    {
+        pPartialType->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_Float);
+        pPartialType->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 32);
+    }
+    else
+    {
+        pPartialType->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM);
+        pPartialType->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16);
+    }
+
+    hr = pSourceReader->SetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_AUDIO_STREAM), nullptr, pPartialType.Get());
+    if (FAILED(hr))
+    {
+        close();
+        return true;
+    }
+
+
+    Microsoft::WRL::ComPtr<IMFMediaType> pOutputType;
+    hr = pSourceReader->GetCurrentMediaType(static_cast<DWORD>(MF_SOURCE_READER_FIRST_AUDIO_STREAM), pOutputType.GetAddressOf());
+    if (FAILED(hr))
+    {
+        close();
+        return true;
+    }
+
+    UINT32 iChannels = 0;
+    UINT32 iSampleRate = 0;
+    pOutputType->GetUINT32(MF_MT_AUDIO_NUM_CHANNELS, &iChannels);
+    pOutputType->GetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, &iSampleRate);
+
+    if (iChannels == 0 || iSampleRate == 0)
+    {
+        close();
+        return true;
+    }
+
+    info.iChannels = static_cast<unsigned short>(iChannels);
+    info.iSampleRate = iSampleRate;
+
+
+    readInfo();
+
+
+    return false;
+}
+
+void SMFDecoder::close()
+{
+    pSourceReader.Reset();
+
+    std::memset(&info, 0, sizeof(info));
+
+    vPendingData.clear();
+    iPendingOffsetInBytes = 0;
+
+    bSeekPending = false;
+    bEndOfStream = false;
+}
+
+const SDecoderInfo &SMFDecoder::getInfo() const
+{
+    return info;
+}
+
+S_SAMPLE_FORMAT SMFDecoder::getOutputFormat() const
+{
+    return outputFormat;
+}
+
+bool SMFDecoder::read(unsigned char *pOutData, size_t iFrameCount, size_t &iReadFrameCount)
+{
+    iReadFrameCount = 0;
+
+    if (pSourceReader == nullptr)
+    {
+        return true;
+    }
+
+
+    const size_t iBlockAlign = getOutputBlockAlign();
+
+    size_t iSizeLeftInBytes = iFrameCount * iBlockAlign;
+
+    while (iSizeLeftInBytes > 0)
+    {
+        if (iPendingOffsetInBytes == vPendingData.size())
+        {
+            if (bEndOfStream)
+            {
+                break;
+            }
+
+            if (readSample())
+            {
+                if (bEndOfStream)
+                {
+                    break;
+                }
+
+                return true;
+            }
+
+            continue;
+        }
+
+
+        size_t iCopySize = vPendingData.size() - iPendingOffsetInBytes;
+        if (iCopySize > iSizeLeftInBytes)
+        {
+            iCopySize = iSizeLeftInBytes;
+        }
+
+        std::memcpy(pOutData, vPendingData.data() + iPendingOffsetInBytes, iCopySize);
+
+        pOutData              += iCopySize;
+        iPendingOffsetInBytes += iCopySize;
+        iSizeLeftInBytes      -= iCopySize;
+    }
+
+    iReadFrameCount = iFrameCount - iSizeLeftInBytes / iBlockAlign;
+
+    return false;
+}
+
+bool SMFDecoder::seek(unsigned long long iFrameIndex)
+{
+    if (pSourceReader == nullptr)
+    {
+        return true;
+    }
+
+
+    PROPVARIANT var = { 0 };
+    var.vt = VT_I8;
+    var.hVal.QuadPart = static_cast<LONGLONG>(iFrameIndex * 10000000.0 / info.iSampleRate);
+
+    HRESULT hr = pSourceReader->SetCurrentPosition(GUID_NULL, var);
+    if (FAILED(hr))
+    {
+        return true;
+    }
+
+
+    // The position is not exact, the frames before the target are skipped in readSample().
+    vPendingData.clear();
+    iPendingOffsetInBytes = 0;
+
+    iSeekTargetFrame = iFrameIndex;
+    bSeekPending = true;
+    bEndOfStream = false;
+
+
+    return false;
+}
+
+bool SMFDecoder::readSample()
+{
+    vPendingData.clear();
+    iPendingOffsetInBytes = 0;
+
+
+    DWORD iFlags = 0;
+    LONGLONG iTimestamp = 0;
+    Microsoft::WRL::ComPtr<IMFSample> pSample;
+
+    HRESULT hr = pSourceReader->ReadSample(static_cast<DWORD>(MF_SOURCE_READER_FIRST_AUDIO_STREAM), 0, nullptr, &iFlags, &iTimestamp, pSample.GetAddressOf());
+    if (FAILED(hr))
+    {
+        return true;
+    }
+
+    if ((iFlags & MF_SOURCE_READERF_ENDOFSTREAM) || (iFlags & MF_SOURCE_READERF_CURRENTMEDIATYPECHANGED))
+    {
+        bEndOfStream = true;
+        return true;
+    }
+
+    if (pSample == nullptr)
+    {
+        // Gap in the stream.
+        return false;
+    }
+
+
+    Microsoft::WRL::ComPtr<IMFMediaBuffer> pBuffer;
+    hr = pSample->ConvertToContiguousBuffer(pBuffer.GetAddressOf());
+    if (FAILED(hr))
+    {
+        return true;
+    }
+
+    unsigned char* pData = nullptr;
+    DWORD iSizeInBytes = 0;
+
+    hr = pBuffer->Lock(&pData, nullptr, &iSizeInBytes);
+    if (FAILED(hr))
+    {
+        return true;
+    }
+
+    vPendingData.assign(pData, pData + iSizeInBytes);
+
+    pBuffer->Unlock();
+
+
+    if (bSeekPending)
+    {
+        // First sample after the seek.
+
+        bSeekPending = false;
+
+        const unsigned long long iSampleFrame = static_cast<unsigned long long>(std::llround(iTimestamp / 10000000.0 * info.iSampleRate));
+
+        if (iSeekTargetFrame > iSampleFrame)
+        {
+            size_t iSkipSize = static_cast<size_t>(iSeekTargetFrame - iSampleFrame) * getOutputBlockAlign();
+            if (iSkipSize > vPendingData.size())
+            {
+                // The rest is skipped in the next samples.
+                iSkipSize = vPendingData.size();
+
+                bSeekPending = true;
+            }
+
+            iPendingOffsetInBytes = iSkipSize;
+        }
+    }
+
+
+    return false;
+}
+
+void SMFDecoder::readInfo()
+{
+    PROPVARIANT var;
+
+
+    // Duration (in 100-nanosecond units).
+
+    info.dLengthInSec = 0.0;
+
+    HRESULT hr = pSourceReader->GetPresentationAttribute(static_cast<DWORD>(MF_SOURCE_READER_MEDIASOURCE), MF_PD_DURATION, &var);
+    if (SUCCEEDED(hr))
+    {
+        LONGLONG iDuration = 0;
+        PropVariantToInt64(var, &iDuration);
+        PropVariantClear(&var);
+
+        info.dLengthInSec = iDuration / 10000000.0;
+    }
+
+    info.iFrameCount = static_cast<unsigned long long>(std::llround(info.dLengthInSec * info.iSampleRate));
+    info.bExactFrameCount = false;
+
+
+    // Bitrate (may fail on .ogg).
+
+    info.iBitrate = 0;
+
+    hr = pSourceReader->GetPresentationAttribute(static_cast<DWORD>(MF_SOURCE_READER_MEDIASOURCE), MF_PD_AUDIO_ENCODING_BITRATE, &var);
+    if (SUCCEEDED(hr))
+    {
+        LONG iBitrate = 0;
+        PropVariantToInt32(var, &iBitrate);
+        PropVariantClear(&var);
+
+        info.iBitrate = static_cast<unsigned int>(iBitrate);
+    }
+
+
+    // VBR.
+
+    info.bUsesVariableBitRate = false;
+
+    hr = pSourceReader->GetPresentationAttribute(static_cast<DWORD>(MF_SOURCE_READER_MEDIASOURCE), MF_PD_AUDIO_ISVARIABLEBITRATE, &var);
+    if (SUCCEEDED(hr))
+    {
+        LONG iVBR = 0;
+        PropVariantToInt32(var, &iVBR);
+        PropVariantClear(&var);
+
+        info.bUsesVariableBitRate = (iVBR != 0);
+    }
+}
@@ -0,0 +1,64 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Windows Media Foundation (WMF)
+#include <wrl.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+
+// Custom
+#include "AudioEngine/SDecoder/sdecoder.h"
+
+
+// Any format supported by Windows Media Foundation (.mp3, .ogg, compressed .wav, ...).
+// MFStartup() should be called before (SAudioEngine::init() does that).
+class SMFDecoder : public SDecoder
+{
+public:
+
+    SMFDecoder();
+    ~SMFDecoder() override;
+
+
+    bool open           (const std::wstring& sPathToFile, S_SAMPLE_FORMAT outputFormat) override;
+    void close          () override;
+
+
+    const SDecoderInfo& getInfo() const override;
+    S_SAMPLE_FORMAT getOutputFormat() const override;
+
+
+    bool read           (unsigned char* pOutData, size_t iFrameCount, size_t& iReadFrameCount) override;
+    bool seek           (unsigned long long iFrameIndex) override;
+
+private:
+
+    // Reads the next sample to 'vPendingData', returns 'true' on error or at the end of the stream.
+    bool readSample     ();
+    void readInfo       ();
+
+
+    Microsoft::WRL::ComPtr<IMFSourceReader> pSourceReader;
+
+    SDecoderInfo               info;
+
+    std::vector<unsigned char> vPendingData;
+    size_t                     iPendingOffsetInBytes;
+
+    unsigned long long         iSeekTargetFrame;
+
+    S_SAMPLE_FORMAT            outputFormat;
+
+    bool                       bSeekPending;
+    bool                       bEndOfStream;
+};
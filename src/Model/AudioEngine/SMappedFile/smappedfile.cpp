@@ -0,0 +1,159 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "smappedfile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <filesystem>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+SMappedFile::SMappedFile()
+{
+    pData        = nullptr;
+    iSizeInBytes = 0;
+
+#if defined(_WIN32)
+    hFile    = INVALID_HANDLE_VALUE;
+    hMapping = nullptr;
+#else
+    iFileDescriptor = -1;
+#endif
+}
+
+SMappedFile::~SMappedFile()
+{
+    close();
+}
+
+bool SMappedFile::open(const std::wstring &sPathToFile)
+{
+    close();
+
+#if defined(_WIN32)
+
+    hFile = CreateFileW(sPathToFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return true;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(hFile, &fileSize) == FALSE || fileSize.QuadPart == 0)
+    {
+        close();
+        return true;
+    }
+
+    hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (hMapping == nullptr)
+    {
+        close();
+        return true;
+    }
+
+    pData = static_cast<const unsigned char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (pData == nullptr)
+    {
+        close();
+        return true;
+    }
+
+    iSizeInBytes = static_cast<size_t>(fileSize.QuadPart);
+
+#else
+
+    iFileDescriptor = ::open(std::filesystem::path(sPathToFile).c_str(), O_RDONLY);
+    if (iFileDescriptor == -1)
+    {
+        return true;
+    }
+
+    struct stat fileStat;
+    if (fstat(iFileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close();
+        return true;
+    }
+
+    void* pMapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, iFileDescriptor, 0);
+    if (pMapped == MAP_FAILED)
+    {
+        close();
+        return true;
+    }
+
+    madvise(pMapped, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+    pData        = static_cast<const unsigned char*>(pMapped);
+    iSizeInBytes = static_cast<size_t>(fileStat.st_size);
+
+#endif
+
+    return false;
+}
+
+void SMappedFile::close()
+{
+#if defined(_WIN32)
+
+    if (pData)
+    {
+        UnmapViewOfFile(pData);
+    }
+
+    if (hMapping)
+    {
+        CloseHandle(hMapping);
+        hMapping = nullptr;
+    }
+
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(hFile);
+        hFile = INVALID_HANDLE_VALUE;
+    }
+
+#else
+
+    if (pData)
+    {
+        munmap(const_cast<unsigned char*>(pData), iSizeInBytes);
+    }
+
+    if (iFileDescriptor != -1)
+    {
+        ::close(iFileDescriptor);
+        iFileDescriptor = -1;
+    }
+
+#endif
+
+    pData        = nullptr;
+    iSizeInBytes = 0;
+}
+
+bool SMappedFile::isOpen() const
+{
+    return pData != nullptr;
+}
+
+const unsigned char *SMappedFile::getData() const
+{
+    return pData;
+}
+
+size_t SMappedFile::getSizeInBytes() const
+{
+    return iSizeInBytes;
+}
@@ -0,0 +1,48 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <cstddef>
+
+
+// Read-only memory mapping of a whole file (Windows and POSIX).
+class SMappedFile
+{
+public:
+
+    SMappedFile();
+    ~SMappedFile();
+
+    SMappedFile(const SMappedFile&) = delete;
+    SMappedFile& operator=(const SMappedFile&) = delete;
+
+
+    // Returns 'true' if the file can't be opened or mapped (empty files can't be mapped).
+    bool open                  (const std::wstring& sPathToFile);
+    void close                 ();
+
+
+    bool isOpen                () const;
+
+    const unsigned char* getData() const;
+    size_t getSizeInBytes      () const;
+
+private:
+
+    const unsigned char* pData;
+    size_t               iSizeInBytes;
+
+#if defined(_WIN32)
+    void*                hFile;
+    void*                hMapping;
+#else
+    int                  iFileDescriptor;
+#endif
+};
@@ -0,0 +1,91 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "snullsink.h"
+
+// STL
+#include <cmath>
+
+
+SNullSink::SNullSink()
+{
+    format.iSampleRate = 0;
+    format.iChannels = 0;
+
+    iWrittenFrameCount = 0;
+    fPeakLevel = 0.0f;
+
+    bOpen = false;
+}
+
+bool SNullSink::open(const SAudioSinkFormat &format)
+{
+    if (format.iSampleRate == 0 || format.iChannels == 0)
+    {
+        return true;
+    }
+
+    this->format = format;
+
+    iWrittenFrameCount = 0;
+    fPeakLevel = 0.0f;
+
+    bOpen = true;
+
+    return false;
+}
+
+bool SNullSink::write(const float *pSamples, size_t iFrameCount)
+{
+    if (bOpen == false)
+    {
+        return true;
+    }
+
+
+    float fPeak = fPeakLevel.load();
+
+    const size_t iSampleCount = iFrameCount * format.iChannels;
+
+    for (size_t i = 0; i < iSampleCount; i++)
+    {
+        const float fLevel = std::fabs(pSamples[i]);
+
+        if (fLevel > fPeak)
+        {
+            fPeak = fLevel;
+        }
+    }
+
+    fPeakLevel = fPeak;
+
+    iWrittenFrameCount += iFrameCount;
+
+    return false;
+}
+
+bool SNullSink::close()
+{
+    bOpen = false;
+
+    return false;
+}
+
+bool SNullSink::isOpen() const
+{
+    return bOpen;
+}
+
+unsigned long long SNullSink::getWrittenFrameCount() const
+{
+    return iWrittenFrameCount;
+}
+
+float SNullSink::getPeakLevel() const
+{
+    return fPeakLevel;
+}
@@ -0,0 +1,44 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <atomic>
+
+// Custom
+#include "AudioEngine/SAudioSink/saudiosink.h"
+
+
+// Discards the audio (as fast as it's written), only counts the frames and the peak level.
+class SNullSink : public SAudioSink
+{
+public:
+
+    SNullSink();
+
+
+    bool open   (const SAudioSinkFormat& format) override;
+    bool write  (const float* pSamples, size_t iFrameCount) override;
+    bool close  () override;
+
+
+    bool isOpen () const override;
+    unsigned long long getWrittenFrameCount() const override;
+
+    // Max absolute sample value since open().
+    float getPeakLevel() const;
+
+private:
+
+    SAudioSinkFormat format;
+
+    std::atomic<unsigned long long> iWrittenFrameCount;
+    std::atomic<float> fPeakLevel;
+
+    bool bOpen;
+};
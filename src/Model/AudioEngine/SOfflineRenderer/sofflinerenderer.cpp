@@ -0,0 +1,400 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sofflinerenderer.h"
+
+// STL
+#include <thread>
+#include <memory>
+#include <cmath>
+#include <cstring>
+
+// Custom
+#include "AudioEngine/SAudioSink/saudiosink.h"
+#include "AudioEngine/SWaveFileSink/swavefilesink.h"
+#include "AudioEngine/SDecoder/sdecoder.h"
+#include "AudioEngine/SResampler/sresampler.h"
+#include "AudioEngine/STimeStretcher/stimestretcher.h"
+
+
+SOfflineRenderer::SOfflineRenderer(const SRenderSettings &settings)
+{
+    this->settings = settings;
+
+    iRenderedFrameCount = 0;
+}
+
+bool SOfflineRenderer::render(const std::wstring &sInputPath, SAudioSink *pSink, std::wstring &sErrorText, const std::atomic<bool>* pCancel)
+{
+    std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(sInputPath, SF_FLOAT32, settings.pFileCache));
+    if (pDecoder == nullptr)
+    {
+        sErrorText = L"could not open the file \"" + sInputPath + L"\".";
+        return true;
+    }
+
+    const SDecoderInfo& info = pDecoder->getInfo();
+
+
+    // Tempo and pitch (as in SSound), then the conversion to the mix sample rate.
+
+    STimeStretcher timeStretcher;
+    timeStretcher.setTempo(settings.fTempo);
+    timeStretcher.setPitchInSemitones(settings.fPitchInSemitones);
+    timeStretcher.setup(settings.iOutputChannels);
+
+    SResampler resampler;
+    if (resampler.setup(settings.iOutputChannels, static_cast<double>(info.iSampleRate) / settings.iOutputSampleRate))
+    {
+        sErrorText = L"invalid sample rate.";
+        return true;
+    }
+
+
+    // Each render() has its own effect instances (they keep the state).
+
+    std::vector<SEffectInstance> vInstances;
+    createEffects(vInstances);
+
+
+    SAudioSinkFormat format;
+    format.iSampleRate = settings.iOutputSampleRate;
+    format.iChannels = settings.iOutputChannels;
+
+    if (pSink->open(format))
+    {
+        sErrorText = L"could not open the output.";
+        return true;
+    }
+
+
+    std::vector<float> vDecoded(iBlockFrameCount * info.iChannels);
+    std::vector<float> vMapped;
+    std::vector<float> vStretched;
+    std::vector<float> vResampled;
+    std::vector<float> vFXBuffer;
+
+    const size_t iOutputChannels = settings.iOutputChannels;
+
+    // Silence after the end (effect tails).
+    size_t iTailFrameCount = 0;
+    if (settings.fFXVolume > 0.0f && vInstances.size() > 0)
+    {
+        iTailFrameCount = static_cast<size_t>(info.iSampleRate) * iEffectTailInMs / 1000;
+    }
+
+    bool bEndOfInput = false;
+    bool bError = false;
+
+    while (bEndOfInput == false)
+    {
+        if (pCancel && pCancel->load())
+        {
+            sErrorText = L"cancelled.";
+            bError = true;
+            break;
+        }
+
+
+        // Decode.
+
+        size_t iReadFrameCount = 0;
+        if (pDecoder->read(reinterpret_cast<unsigned char*>(vDecoded.data()), iBlockFrameCount, iReadFrameCount))
+        {
+            sErrorText = L"could not decode the file \"" + sInputPath + L"\".";
+            bError = true;
+            break;
+        }
+
+        if (iReadFrameCount < iBlockFrameCount && iTailFrameCount > 0)
+        {
+            size_t iSilentFrameCount = iBlockFrameCount - iReadFrameCount;
+            if (iSilentFrameCount > iTailFrameCount)
+            {
+                iSilentFrameCount = iTailFrameCount;
+            }
+
+            std::memset(vDecoded.data() + iReadFrameCount * info.iChannels, 0, iSilentFrameCount * info.iChannels * sizeof(float));
+
+            iReadFrameCount += iSilentFrameCount;
+            iTailFrameCount -= iSilentFrameCount;
+        }
+
+        bEndOfInput = (iReadFrameCount < iBlockFrameCount);
+
+
+        // Convert.
+
+        mapChannels(vDecoded.data(), iReadFrameCount, info.iChannels, vMapped);
+
+        const float* pConverted = vMapped.data();
+        size_t iConvertedFrameCount = iReadFrameCount;
+
+        if (timeStretcher.isBypassed() == false)
+        {
+            vStretched.clear();
+            timeStretcher.process(vMapped.data(), iReadFrameCount, vStretched);
+
+            if (bEndOfInput)
+            {
+                timeStretcher.flush(vStretched);
+            }
+
+            pConverted = vStretched.data();
+            iConvertedFrameCount = vStretched.size() / iOutputChannels;
+        }
+
+        vResampled.clear();
+        resampler.process(pConverted, iConvertedFrameCount, vResampled);
+
+        if (bEndOfInput)
+        {
+            resampler.flush(vResampled);
+        }
+
+
+        // Mix.
+
+        size_t iResampledFrameCount = vResampled.size() / iOutputChannels;
+
+        for (size_t iOffset = 0; iOffset < iResampledFrameCount; iOffset += iBlockFrameCount)
+        {
+            size_t iFrameCount = iResampledFrameCount - iOffset;
+            if (iFrameCount > iBlockFrameCount)
+            {
+                iFrameCount = iBlockFrameCount;
+            }
+
+            std::vector<float> vBlock(vResampled.begin() + iOffset * iOutputChannels, vResampled.begin() + (iOffset + iFrameCount) * iOutputChannels);
+
+            processBlock(vInstances, vBlock, iFrameCount, vFXBuffer);
+
+            if (pSink->write(vBlock.data(), iFrameCount))
+            {
+                sErrorText = L"could not write the output.";
+                bError = true;
+                break;
+            }
+
+            iRenderedFrameCount += iFrameCount;
+        }
+
+        if (bError)
+        {
+            break;
+        }
+    }
+
+
+    if (pSink->close() && bError == false)
+    {
+        sErrorText = L"could not finish the output.";
+        bError = true;
+    }
+
+
+    return bError;
+}
+
+void SOfflineRenderer::renderBatch(const std::vector<SRenderJob> &vJobs, size_t iThreadCount,
+                                   const std::function<void(size_t, bool, const std::wstring&)> &onJobDone, const std::atomic<bool>* pCancel)
+{
+    if (iThreadCount == 0)
+    {
+        iThreadCount = std::thread::hardware_concurrency();
+        if (iThreadCount == 0)
+        {
+            iThreadCount = 1;
+        }
+    }
+
+    if (iThreadCount > vJobs.size())
+    {
+        iThreadCount = vJobs.size();
+    }
+
+
+    // Each thread takes the next job until there are none left.
+
+    std::atomic<size_t> iNextJob(0);
+
+    auto worker = [&]()
+    {
+        while (true)
+        {
+            const size_t iJobIndex = iNextJob++;
+            if (iJobIndex >= vJobs.size())
+            {
+                break;
+            }
+
+            std::wstring sErrorText;
+            bool bError = true;
+
+            if (pCancel && pCancel->load())
+            {
+                sErrorText = L"cancelled.";
+            }
+            else
+            {
+                SWaveFileSink sink(vJobs[iJobIndex].sOutputPath);
+                bError = render(vJobs[iJobIndex].sInputPath, &sink, sErrorText, pCancel);
+            }
+
+            if (onJobDone)
+            {
+                onJobDone(iJobIndex, bError, sErrorText);
+            }
+        }
+    };
+
+
+    std::vector<std::thread> vThreads;
+
+    for (size_t i = 0; i < iThreadCount; i++)
+    {
+        vThreads.push_back(std::thread(worker));
+    }
+
+    for (size_t i = 0; i < vThreads.size(); i++)
+    {
+        vThreads[i].join();
+    }
+}
+
+unsigned long long SOfflineRenderer::getRenderedFrameCount() const
+{
+    return iRenderedFrameCount;
+}
+
+void SOfflineRenderer::createEffects(std::vector<SEffectInstance> &vInstances)
+{
+    for (size_t i = 0; i < settings.vEffects.size(); i++)
+    {
+        const SAudioEffect& effect = settings.vEffects[i];
+
+        SEffectInstance instance;
+        instance.bEnabled = effect.isEnabled();
+        instance.pProcessor.reset(SEffectProcessor::create(effect.effectType));
+
+        instance.pProcessor->setup(settings.iOutputSampleRate, settings.iOutputChannels);
+
+        switch (effect.effectType)
+        {
+        case(ET_REVERB):
+        {
+            instance.pProcessor->setParameters(&effect.reverbParams);
+            break;
+        }
+        case(ET_EQ):
+        {
+            instance.pProcessor->setParameters(&effect.eqParams);
+            break;
+        }
+        case(ET_ECHO):
+        {
+            instance.pProcessor->setParameters(&effect.echoParams);
+            break;
+        }
+        }
+
+        vInstances.push_back(std::move(instance));
+    }
+}
+
+void SOfflineRenderer::processBlock(std::vector<SEffectInstance> &vInstances, std::vector<float> &vSamples, size_t iFrameCount, std::vector<float> &vFXBuffer)
+{
+    const size_t iSampleCount = iFrameCount * settings.iOutputChannels;
+
+    bool bAnyEffectEnabled = false;
+    for (size_t i = 0; i < vInstances.size(); i++)
+    {
+        if (vInstances[i].bEnabled)
+        {
+            bAnyEffectEnabled = true;
+            break;
+        }
+    }
+
+
+    if (bAnyEffectEnabled && settings.fFXVolume > 0.0f)
+    {
+        // FX send: the same input through the effect chain (in place).
+
+        vFXBuffer.assign(vSamples.begin(), vSamples.begin() + iSampleCount);
+
+        for (size_t i = 0; i < vInstances.size(); i++)
+        {
+            // Disabled effects pass the audio through.
+            if (vInstances[i].bEnabled)
+            {
+                vInstances[i].pProcessor->process(vFXBuffer.data(), iFrameCount);
+            }
+        }
+
+
+        for (size_t i = 0; i < iSampleCount; i++)
+        {
+            vSamples[i] = (vSamples[i] + vFXBuffer[i] * settings.fFXVolume) * settings.fVolume;
+        }
+    }
+    else if (settings.fVolume != 1.0f)
+    {
+        for (size_t i = 0; i < iSampleCount; i++)
+        {
+            vSamples[i] *= settings.fVolume;
+        }
+    }
+}
+
+void SOfflineRenderer::mapChannels(const float *pSamples, size_t iFrameCount, unsigned short iInputChannels, std::vector<float> &vOutSamples)
+{
+    const unsigned short iOutputChannels = settings.iOutputChannels;
+
+    vOutSamples.resize(iFrameCount * iOutputChannels);
+
+    if (iInputChannels == iOutputChannels)
+    {
+        std::memcpy(vOutSamples.data(), pSamples, iFrameCount * iOutputChannels * sizeof(float));
+        return;
+    }
+
+
+    for (size_t i = 0; i < iFrameCount; i++)
+    {
+        const float* pFrame = pSamples + i * iInputChannels;
+        float* pOutFrame = vOutSamples.data() + i * iOutputChannels;
+
+        if (iInputChannels == 1)
+        {
+            // Mono to all channels.
+            for (unsigned short c = 0; c < iOutputChannels; c++)
+            {
+                pOutFrame[c] = pFrame[0];
+            }
+        }
+        else if (iOutputChannels == 1)
+        {
+            // Average of all channels.
+            float fSum = 0.0f;
+            for (unsigned short c = 0; c < iInputChannels; c++)
+            {
+                fSum += pFrame[c];
+            }
+
+            pOutFrame[0] = fSum / iInputChannels;
+        }
+        else
+        {
+            // Keep the first channels (front left/right), drop or silence the rest.
+            for (unsigned short c = 0; c < iOutputChannels; c++)
+            {
+                pOutFrame[c] = (c < iInputChannels) ? pFrame[c] : 0.0f;
+            }
+        }
+    }
+}
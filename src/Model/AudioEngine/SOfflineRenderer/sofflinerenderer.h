@@ -0,0 +1,92 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+// Custom
+#include "AudioEngine/SAudioEngine/saudioengine.h"
+
+
+class SAudioSink;
+
+struct SRenderSettings
+{
+    // Same as the SSoundMix effect chain (applied on the FX send).
+    std::vector<SAudioEffect> vEffects;
+    float fFXVolume         = 0.0f;
+
+    float fPitchInSemitones = 0.0f; // keeps the tempo (see STimeStretcher)
+    float fTempo            = 1.0f;
+    float fVolume           = 1.0f;
+
+    // Same as SSoundMix.
+    unsigned long  iOutputSampleRate = 44100;
+    unsigned short iOutputChannels   = 2;
+
+    // The .wav files are mapped through it if not 'nullptr' (see SAudioEngine::getFileHandleCache()).
+    SFileHandleCache* pFileCache = nullptr;
+};
+
+struct SRenderJob
+{
+    std::wstring sInputPath;
+    std::wstring sOutputPath; // .wav
+};
+
+// Renders files through the same chain as the playback (tempo and pitch -> dry + FX send with the effects)
+// as fast as the CPU allows, no audio device is used.
+class SOfflineRenderer
+{
+public:
+
+    SOfflineRenderer(const SRenderSettings& settings);
+
+
+    // Returns 'true' on error, 'sErrorText' has the reason.
+    bool render     (const std::wstring& sInputPath, SAudioSink* pSink, std::wstring& sErrorText, const std::atomic<bool>* pCancel = nullptr);
+
+    // Renders each job to its .wav file using 'iThreadCount' threads (0 - one per core),
+    // 'onJobDone' is called from the worker threads.
+    void renderBatch(const std::vector<SRenderJob>& vJobs, size_t iThreadCount,
+                     const std::function<void(size_t iJobIndex, bool bError, const std::wstring& sErrorText)>& onJobDone,
+                     const std::atomic<bool>* pCancel = nullptr);
+
+
+    // Frames rendered by all render() calls so far (for benchmarks).
+    unsigned long long getRenderedFrameCount() const;
+
+private:
+
+    struct SEffectInstance
+    {
+        std::unique_ptr<SEffectProcessor> pProcessor;
+        bool bEnabled;
+    };
+
+    void createEffects  (std::vector<SEffectInstance>& vInstances);
+
+    // 'vSamples' is in the output format, 'iFrameCount' <= 'iBlockFrameCount'.
+    void processBlock   (std::vector<SEffectInstance>& vInstances, std::vector<float>& vSamples, size_t iFrameCount, std::vector<float>& vFXBuffer);
+
+    // Converts the decoded frames to the output channel count.
+    void mapChannels    (const float* pSamples, size_t iFrameCount, unsigned short iInputChannels, std::vector<float>& vOutSamples);
+
+
+    SRenderSettings   settings;
+
+    std::atomic<unsigned long long> iRenderedFrameCount;
+
+    static const size_t iBlockFrameCount = 1024;
+    static const unsigned int iEffectTailInMs = 3000; // silence rendered after the end for reverb/echo tails
+};
@@ -0,0 +1,103 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "spositionclock.h"
+
+// STL
+#include <chrono>
+
+
+SPositionClock::SPositionClock()
+{
+    iSequence = 0;
+
+    dPositionInSec = 0.0;
+    dLengthInSec = 0.0;
+    dSpeed = 1.0;
+    iTimeInNs = 0;
+    bRunning = false;
+}
+
+void SPositionClock::set(double dPositionInSec, double dLengthInSec, double dSpeed, bool bRunning)
+{
+    const unsigned int iOldSequence = iSequence.load(std::memory_order_relaxed);
+
+    iSequence.store(iOldSequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    this->dPositionInSec.store(dPositionInSec, std::memory_order_relaxed);
+    this->dLengthInSec.store(dLengthInSec, std::memory_order_relaxed);
+    this->dSpeed.store(dSpeed, std::memory_order_relaxed);
+    this->iTimeInNs.store(getTimeInNs(), std::memory_order_relaxed);
+    this->bRunning.store(bRunning, std::memory_order_relaxed);
+
+    iSequence.store(iOldSequence + 2, std::memory_order_release);
+}
+
+void SPositionClock::clear()
+{
+    set(0.0, 0.0, 1.0, false);
+}
+
+bool SPositionClock::get(double &dPositionInSec, double &dLengthInSec) const
+{
+    double dSpeed;
+    long long iTimeInNs;
+    bool bRunning;
+
+    while (true)
+    {
+        const unsigned int iStartSequence = iSequence.load(std::memory_order_acquire);
+
+        if (iStartSequence % 2 == 1)
+        {
+            // The writer is changing the values.
+            continue;
+        }
+
+        dPositionInSec = this->dPositionInSec.load(std::memory_order_relaxed);
+        dLengthInSec   = this->dLengthInSec.load(std::memory_order_relaxed);
+        dSpeed         = this->dSpeed.load(std::memory_order_relaxed);
+        iTimeInNs      = this->iTimeInNs.load(std::memory_order_relaxed);
+        bRunning       = this->bRunning.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (iSequence.load(std::memory_order_relaxed) == iStartSequence)
+        {
+            break;
+        }
+    }
+
+    if (dLengthInSec <= 0.0)
+    {
+        dPositionInSec = 0.0;
+        return true;
+    }
+
+
+    if (bRunning)
+    {
+        dPositionInSec += (getTimeInNs() - iTimeInNs) / 1000000000.0 * dSpeed;
+    }
+
+    if (dPositionInSec > dLengthInSec)
+    {
+        dPositionInSec = dLengthInSec;
+    }
+    else if (dPositionInSec < 0.0)
+    {
+        dPositionInSec = 0.0;
+    }
+
+    return false;
+}
+
+long long SPositionClock::getTimeInNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,47 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <atomic>
+
+
+// Playback position that can be read from any thread without locking.
+// The writer stores the position (taken from the played samples) together with the time it was taken,
+// the readers extrapolate it with the playback speed (so they can read it at any rate between the updates).
+class SPositionClock
+{
+public:
+
+    SPositionClock();
+
+
+    // Writer (the calls should be serialized).
+    // 'dSpeed' - seconds of the track per second (the tempo), 'bRunning' - 'false' if paused.
+    void set   (double dPositionInSec, double dLengthInSec, double dSpeed, bool bRunning);
+    // Nothing is playing.
+    void clear ();
+
+
+    // Returns 'true' if nothing is playing. The position is in [0, 'dLengthInSec'].
+    bool get   (double& dPositionInSec, double& dLengthInSec) const;
+
+private:
+
+    static long long getTimeInNs();
+
+
+    // Odd while the writer is changing the values (seqlock).
+    std::atomic<unsigned int> iSequence;
+
+    std::atomic<double>    dPositionInSec;
+    std::atomic<double>    dLengthInSec;
+    std::atomic<double>    dSpeed;
+    std::atomic<long long> iTimeInNs;
+    std::atomic<bool>      bRunning;
+};
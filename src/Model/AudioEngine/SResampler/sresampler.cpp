@@ -0,0 +1,117 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sresampler.h"
+
+
+SResampler::SResampler()
+{
+    dRatio = 1.0;
+    dPosition = 1.0;
+
+    iChannels = 1;
+}
+
+bool SResampler::setup(unsigned short iChannels, double dRatio)
+{
+    if (iChannels == 0 || dRatio <= 0.0)
+    {
+        return true;
+    }
+
+    this->iChannels = iChannels;
+    this->dRatio = dRatio;
+
+
+    // One silent frame before the first frame.
+    vInput.clear();
+    vInput.resize(iChannels, 0.0f);
+
+    dPosition = 1.0;
+
+    return false;
+}
+
+void SResampler::process(const float *pSamples, size_t iFrameCount, std::vector<float> &vOutSamples)
+{
+    vInput.insert(vInput.end(), pSamples, pSamples + iFrameCount * iChannels);
+
+    produce(vOutSamples);
+}
+
+void SResampler::flush(std::vector<float> &vOutSamples)
+{
+    // Frames after the last one are silent.
+    vInput.resize(vInput.size() + 2 * iChannels, 0.0f);
+
+    produce(vOutSamples);
+
+    vInput.clear();
+    vInput.resize(iChannels, 0.0f);
+
+    dPosition = 1.0;
+}
+
+void SResampler::produce(std::vector<float> &vOutSamples)
+{
+    const size_t iInputFrameCount = vInput.size() / iChannels;
+
+    if (dRatio == 1.0)
+    {
+        // Same rate, no interpolation.
+
+        size_t iFrame = static_cast<size_t>(dPosition);
+
+        if (iInputFrameCount >= 2)
+        {
+            vOutSamples.insert(vOutSamples.end(), vInput.begin() + iFrame * iChannels, vInput.end() - 2 * iChannels);
+            iFrame = iInputFrameCount - 2;
+        }
+
+        dPosition = static_cast<double>(iFrame);
+    }
+    else
+    {
+        // Needs frames [i - 1, i + 2] for the position between i and i + 1.
+
+        while (static_cast<size_t>(dPosition) + 2 < iInputFrameCount)
+        {
+            const size_t i = static_cast<size_t>(dPosition);
+            const float t = static_cast<float>(dPosition - i);
+
+            const float* p0 = &vInput[(i - 1) * iChannels];
+            const float* p1 = p0 + iChannels;
+            const float* p2 = p1 + iChannels;
+            const float* p3 = p2 + iChannels;
+
+            for (unsigned short c = 0; c < iChannels; c++)
+            {
+                const float a = -0.5f * p0[c] + 1.5f * p1[c] - 1.5f * p2[c] + 0.5f * p3[c];
+                const float b = p0[c] - 2.5f * p1[c] + 2.0f * p2[c] - 0.5f * p3[c];
+                const float d = -0.5f * p0[c] + 0.5f * p2[c];
+
+                vOutSamples.push_back(((a * t + b) * t + d) * t + p1[c]);
+            }
+
+            dPosition += dRatio;
+        }
+    }
+
+
+    // Keep the history frame and everything after it.
+
+    const size_t iFirstNeededFrame = static_cast<size_t>(dPosition) - 1;
+
+    if (iFirstNeededFrame > 0)
+    {
+        const size_t iEraseFrameCount = (iFirstNeededFrame < iInputFrameCount) ? iFirstNeededFrame : iInputFrameCount;
+
+        vInput.erase(vInput.begin(), vInput.begin() + iEraseFrameCount * iChannels);
+
+        dPosition -= static_cast<double>(iEraseFrameCount);
+    }
+}
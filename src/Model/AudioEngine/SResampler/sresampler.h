@@ -0,0 +1,46 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstddef>
+
+
+// Streaming sample rate converter (4-point cubic Hermite interpolation) for interleaved float samples.
+// Also used to change the pitch the way XAudio2 does it (by changing the playback rate).
+class SResampler
+{
+public:
+
+    SResampler();
+
+
+    // 'dRatio' is the number of input frames per output frame
+    // (input rate / output rate * frequency ratio). Returns 'true' if the parameters are invalid.
+    bool setup      (unsigned short iChannels, double dRatio);
+
+
+    // Appends the output frames to 'vOutSamples'.
+    void process    (const float* pSamples, size_t iFrameCount, std::vector<float>& vOutSamples);
+
+    // Outputs what's left (call once at the end of the stream).
+    void flush      (std::vector<float>& vOutSamples);
+
+private:
+
+    void produce    (std::vector<float>& vOutSamples);
+
+
+    std::vector<float> vInput; // unused input frames (starting with one history frame)
+
+    double             dRatio;
+    double             dPosition; // in 'vInput' frames
+
+    unsigned short     iChannels;
+};
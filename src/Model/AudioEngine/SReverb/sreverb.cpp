@@ -0,0 +1,232 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sreverb.h"
+
+// STL
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+
+namespace
+{
+    // In frames at 44100 Hz (mutually prime).
+    const size_t iBaseLineLength[]     = {1557, 1617, 1491, 1422};
+    const size_t iBaseDiffuserLength[] = {225, 556};
+
+    const double dMinReverbTimeInSec = 0.25;
+    const double dMaxReverbTimeInSec = 4.0;
+}
+
+
+SReverb::SReverb()
+{
+    params.Diffusion = FXREVERB_DEFAULT_DIFFUSION;
+    params.RoomSize  = FXREVERB_DEFAULT_ROOMSIZE;
+
+    for (size_t i = 0; i < iLineCount; i++)
+    {
+        iLineLength[i] = 1;
+        iLinePos[i]    = 0;
+        fLineGain[i]   = 0.0f;
+        fDamping[i]    = 0.0f;
+        fLowpass[i]    = 0.0f;
+    }
+
+    for (size_t i = 0; i < iDiffuserCount; i++)
+    {
+        iDiffuserPos[i] = 0;
+    }
+
+    fDiffuserGain = 0.0f;
+
+    iSampleRate = 44100;
+    iChannels   = 0;
+}
+
+void SReverb::setup(unsigned long iSampleRate, unsigned short iChannels)
+{
+    this->iSampleRate = iSampleRate;
+    this->iChannels   = iChannels;
+
+    const double dRateScale = iSampleRate / 44100.0;
+
+    for (size_t i = 0; i < iLineCount; i++)
+    {
+        vLines[i].assign(static_cast<size_t>(iBaseLineLength[i] * dRateScale) + 1, 0.0f);
+    }
+
+    for (size_t i = 0; i < iDiffuserCount; i++)
+    {
+        vDiffusers[i].assign(static_cast<size_t>(iBaseDiffuserLength[i] * dRateScale) + 1, 0.0f);
+    }
+
+    reset();
+
+    updateParameters();
+}
+
+void SReverb::setParameters(const void *pParameters)
+{
+    std::memcpy(&params, pParameters, sizeof(params));
+
+    updateParameters();
+}
+
+void SReverb::reset()
+{
+    for (size_t i = 0; i < iLineCount; i++)
+    {
+        std::fill(vLines[i].begin(), vLines[i].end(), 0.0f);
+        iLinePos[i] = 0;
+        fLowpass[i] = 0.0f;
+    }
+
+    for (size_t i = 0; i < iDiffuserCount; i++)
+    {
+        std::fill(vDiffusers[i].begin(), vDiffusers[i].end(), 0.0f);
+        iDiffuserPos[i] = 0;
+    }
+}
+
+void SReverb::process(float *pSamples, size_t iFrameCount)
+{
+    if (iChannels == 0 || vLines[0].empty())
+    {
+        return;
+    }
+
+    SDenormalGuard guard;
+
+    const float fInputScale = 1.0f / iChannels;
+
+    for (size_t iFrame = 0; iFrame < iFrameCount; iFrame++)
+    {
+        float* pFrame = pSamples + iFrame * iChannels;
+
+
+        // Mono input.
+
+        float fInput = 0.0f;
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            fInput += pFrame[c];
+        }
+        fInput *= fInputScale;
+
+
+        // Diffusion (Schroeder allpasses).
+
+        for (size_t i = 0; i < iDiffuserCount; i++)
+        {
+            float& fDelayed = vDiffusers[i][iDiffuserPos[i]];
+
+            const float fOutput = fDelayed - fDiffuserGain * fInput;
+            fDelayed = fInput + fDiffuserGain * fOutput;
+
+            fInput = fOutput;
+
+            iDiffuserPos[i]++;
+            if (iDiffuserPos[i] == vDiffusers[i].size())
+            {
+                iDiffuserPos[i] = 0;
+            }
+        }
+
+
+        // Delay network.
+
+        float fLineOutput[iLineCount];
+        float fSum = 0.0f;
+
+        for (size_t i = 0; i < iLineCount; i++)
+        {
+            fLineOutput[i] = vLines[i][iLinePos[i]];
+
+            // One pole lowpass (high frequencies decay faster).
+            fLowpass[i] = fLineOutput[i] + fDamping[i] * (fLowpass[i] - fLineOutput[i]);
+
+            fSum += fLowpass[i];
+        }
+
+        // Householder matrix: x - 2/N * sum(x).
+        const float fReflection = fSum * (2.0f / iLineCount);
+
+        for (size_t i = 0; i < iLineCount; i++)
+        {
+            vLines[i][iLinePos[i]] = fInput + fLineGain[i] * (fLowpass[i] - fReflection);
+
+            iLinePos[i]++;
+            if (iLinePos[i] >= iLineLength[i])
+            {
+                iLinePos[i] = 0;
+            }
+        }
+
+
+        // Lines 0, 2 -> left, 1, 3 -> right.
+
+        const float fLeft  = (fLineOutput[0] + fLineOutput[2]) * 0.5f;
+        const float fRight = (fLineOutput[1] + fLineOutput[3]) * 0.5f;
+
+        if (iChannels == 1)
+        {
+            pFrame[0] = (fLeft + fRight) * 0.5f;
+        }
+        else
+        {
+            for (unsigned short c = 0; c < iChannels; c++)
+            {
+                pFrame[c] = (c % 2 == 0) ? fLeft : fRight;
+            }
+        }
+    }
+}
+
+void SReverb::updateParameters()
+{
+    float fRoomSize  = params.RoomSize;
+    float fDiffusion = params.Diffusion;
+
+    if (fRoomSize < FXREVERB_MIN_ROOMSIZE)   fRoomSize = FXREVERB_MIN_ROOMSIZE;
+    if (fRoomSize > FXREVERB_MAX_ROOMSIZE)   fRoomSize = FXREVERB_MAX_ROOMSIZE;
+    if (fDiffusion < FXREVERB_MIN_DIFFUSION) fDiffusion = FXREVERB_MIN_DIFFUSION;
+    if (fDiffusion > FXREVERB_MAX_DIFFUSION) fDiffusion = FXREVERB_MAX_DIFFUSION;
+
+
+    // Bigger room - longer lines and a longer decay.
+
+    const double dReverbTimeInSec = dMinReverbTimeInSec + (dMaxReverbTimeInSec - dMinReverbTimeInSec) * fRoomSize;
+
+    for (size_t i = 0; i < iLineCount; i++)
+    {
+        if (vLines[i].empty())
+        {
+            continue;
+        }
+
+        size_t iLength = static_cast<size_t>(vLines[i].size() * (0.3 + 0.7 * fRoomSize));
+        if (iLength < 1)
+        {
+            iLength = 1;
+        }
+
+        iLineLength[i] = iLength;
+        if (iLinePos[i] >= iLength)
+        {
+            iLinePos[i] = 0;
+        }
+
+        // -60 dB after 'dReverbTimeInSec'.
+        fLineGain[i] = static_cast<float>(std::pow(10.0, -3.0 * iLength / (dReverbTimeInSec * iSampleRate)));
+
+        fDamping[i] = 0.2f;
+    }
+
+    fDiffuserGain = 0.7f * fDiffusion;
+}
@@ -0,0 +1,60 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Custom
+#include "AudioEngine/SEffectProcessor/seffectprocessor.h"
+
+
+// Reverb (FXREVERB_PARAMETERS): the input (mixed to mono) goes through 2 allpass diffusers
+// into a 4 line feedback delay network (Householder feedback matrix, damped),
+// the output is 100% wet (as FXReverb on the FX send).
+class SReverb : public SEffectProcessor
+{
+public:
+
+    SReverb();
+
+
+    void setup         (unsigned long iSampleRate, unsigned short iChannels) override;
+    void setParameters (const void* pParameters) override;
+    void reset         () override;
+
+    void process       (float* pSamples, size_t iFrameCount) override;
+
+private:
+
+    void updateParameters();
+
+
+    static const size_t iLineCount     = 4;
+    static const size_t iDiffuserCount = 2;
+
+
+    FXREVERB_PARAMETERS params;
+
+
+    // Delay lines (allocated for the largest room).
+    std::vector<float> vLines[iLineCount];
+    size_t             iLineLength[iLineCount];
+    size_t             iLinePos[iLineCount];
+    float              fLineGain[iLineCount];
+    float              fDamping[iLineCount];
+    float              fLowpass[iLineCount];
+
+    std::vector<float> vDiffusers[iDiffuserCount];
+    size_t             iDiffuserPos[iDiffuserCount];
+    float              fDiffuserGain;
+
+
+    unsigned long  iSampleRate;
+    unsigned short iChannels;
+};
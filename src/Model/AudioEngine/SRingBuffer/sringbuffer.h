@@ -0,0 +1,173 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <cstddef>
+
+
+// Lock-free single-producer/single-consumer byte ring with a fixed capacity.
+// One thread may only call the "producer" functions and one other thread may only call the "consumer" functions,
+// nothing is allocated after setup().
+class SRingBuffer
+{
+public:
+
+    SRingBuffer()
+    {
+        iCapacity = 0;
+
+        iWriteCount = 0;
+        iReadCount  = 0;
+    }
+
+    SRingBuffer(const SRingBuffer&) = delete;
+    SRingBuffer& operator=(const SRingBuffer&) = delete;
+
+
+    // Not thread safe, should be called when neither the producer nor the consumer is running.
+    void setup(size_t iCapacityInBytes)
+    {
+        pData.reset(new unsigned char[iCapacityInBytes]);
+        iCapacity = iCapacityInBytes;
+
+        iWriteCount.store(0, std::memory_order_relaxed);
+        iReadCount.store(0, std::memory_order_relaxed);
+    }
+
+    size_t getCapacity() const
+    {
+        return iCapacity;
+    }
+
+
+    // ---------------------------------------------------------------------
+    // Producer.
+    // ---------------------------------------------------------------------
+
+    // Returns the number of written bytes (less than 'iSizeInBytes' if the ring is full).
+    size_t write(const unsigned char* pInData, size_t iSizeInBytes)
+    {
+        const unsigned long long iWrite = iWriteCount.load(std::memory_order_relaxed);
+        const unsigned long long iRead  = iReadCount.load(std::memory_order_acquire);
+
+        size_t iFreeSize = iCapacity - static_cast<size_t>(iWrite - iRead);
+        if (iSizeInBytes > iFreeSize)
+        {
+            iSizeInBytes = iFreeSize;
+        }
+
+        const size_t iPos = static_cast<size_t>(iWrite % iCapacity);
+
+        size_t iFirstPart = iCapacity - iPos;
+        if (iFirstPart > iSizeInBytes)
+        {
+            iFirstPart = iSizeInBytes;
+        }
+
+        std::memcpy(pData.get() + iPos, pInData, iFirstPart);
+        std::memcpy(pData.get(), pInData + iFirstPart, iSizeInBytes - iFirstPart);
+
+        iWriteCount.store(iWrite + iSizeInBytes, std::memory_order_release);
+
+        return iSizeInBytes;
+    }
+
+    size_t getFreeSize() const
+    {
+        return iCapacity - static_cast<size_t>(iWriteCount.load(std::memory_order_relaxed) - iReadCount.load(std::memory_order_acquire));
+    }
+
+    // Total number of bytes ever written.
+    unsigned long long getWriteCount() const
+    {
+        return iWriteCount.load(std::memory_order_acquire);
+    }
+
+
+    // ---------------------------------------------------------------------
+    // Consumer.
+    // ---------------------------------------------------------------------
+
+    size_t getReadableSize() const
+    {
+        return static_cast<size_t>(iWriteCount.load(std::memory_order_acquire) - iReadCount.load(std::memory_order_relaxed));
+    }
+
+    // Returns the contiguous readable region that starts 'iOffset' bytes after the read position
+    // (the data is not consumed), nullptr if there is nothing to read there.
+    const unsigned char* peek(size_t iOffset, size_t& iContiguousSize) const
+    {
+        const size_t iReadable = getReadableSize();
+        if (iOffset >= iReadable)
+        {
+            iContiguousSize = 0;
+            return nullptr;
+        }
+
+        const size_t iPos = static_cast<size_t>((iReadCount.load(std::memory_order_relaxed) + iOffset) % iCapacity);
+
+        iContiguousSize = iCapacity - iPos;
+        if (iContiguousSize > iReadable - iOffset)
+        {
+            iContiguousSize = iReadable - iOffset;
+        }
+
+        return pData.get() + iPos;
+    }
+
+    // Returns the number of read bytes.
+    size_t read(unsigned char* pOutData, size_t iSizeInBytes)
+    {
+        const size_t iReadable = getReadableSize();
+        if (iSizeInBytes > iReadable)
+        {
+            iSizeInBytes = iReadable;
+        }
+
+        const unsigned long long iRead = iReadCount.load(std::memory_order_relaxed);
+        const size_t iPos = static_cast<size_t>(iRead % iCapacity);
+
+        size_t iFirstPart = iCapacity - iPos;
+        if (iFirstPart > iSizeInBytes)
+        {
+            iFirstPart = iSizeInBytes;
+        }
+
+        std::memcpy(pOutData, pData.get() + iPos, iFirstPart);
+        std::memcpy(pOutData + iFirstPart, pData.get(), iSizeInBytes - iFirstPart);
+
+        iReadCount.store(iRead + iSizeInBytes, std::memory_order_release);
+
+        return iSizeInBytes;
+    }
+
+    // Frees 'iSizeInBytes' (should not be bigger than getReadableSize()) for the producer.
+    void consume(size_t iSizeInBytes)
+    {
+        iReadCount.store(iReadCount.load(std::memory_order_relaxed) + iSizeInBytes, std::memory_order_release);
+    }
+
+    // Total number of bytes ever consumed.
+    unsigned long long getReadCount() const
+    {
+        return iReadCount.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    std::unique_ptr<unsigned char[]> pData;
+    size_t iCapacity;
+
+    // On different cache lines so that the producer and the consumer don't slow each other down.
+    alignas(64) std::atomic<unsigned long long> iWriteCount;
+    alignas(64) std::atomic<unsigned long long> iReadCount;
+};
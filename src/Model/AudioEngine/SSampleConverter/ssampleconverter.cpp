@@ -0,0 +1,493 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "ssampleconverter.h"
+
+// STL
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SSAMPLECONVERTER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC allows intrinsics of any instruction set in any function,
+// GCC and Clang need the target to be specified per function.
+#if defined(_MSC_VER) || !defined(SSAMPLECONVERTER_X86)
+#define S_TARGET_SSE2
+#define S_TARGET_AVX2
+#else
+#define S_TARGET_SSE2 __attribute__((target("sse2")))
+#define S_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+
+// Same scale as the old per-sample readers (24 bit is now scaled by 2^23 so that it fills [-1.0f, 1.0f]).
+static const float fScale8  = 1.0f / 128.0f; // 8 bit samples are unsigned (128 is silence)
+static const float fScale16 = 1.0f / SHRT_MAX;
+static const float fScale24 = 1.0f / 8388608.0f; // 2^23
+static const float fScale32 = 1.0f / INT_MAX;
+
+
+S_CONVERTER_PATH SSampleConverter::supportedPath = SSampleConverter::detectPath();
+S_CONVERTER_PATH SSampleConverter::currentPath   = SSampleConverter::supportedPath;
+
+
+bool SSampleConverter::getSampleFormat(unsigned short iBitsPerSample, bool bFloatingPoint, S_SAMPLE_FORMAT &format)
+{
+    if (bFloatingPoint)
+    {
+        if (iBitsPerSample != 32)
+        {
+            return true;
+        }
+
+        format = SF_FLOAT32;
+
+        return false;
+    }
+
+    switch (iBitsPerSample)
+    {
+    case(8):
+    {
+        format = SF_UINT8;
+        break;
+    }
+    case(16):
+    {
+        format = SF_INT16;
+        break;
+    }
+    case(24):
+    {
+        format = SF_INT24;
+        break;
+    }
+    case(32):
+    {
+        format = SF_INT32;
+        break;
+    }
+    default:
+    {
+        return true;
+    }
+    }
+
+    return false;
+}
+
+void SSampleConverter::convertToFloat(const unsigned char *pData, size_t iSampleCount, S_SAMPLE_FORMAT format, float *pOutSamples)
+{
+    if (format == SF_FLOAT32)
+    {
+        std::memcpy(pOutSamples, pData, iSampleCount * sizeof(float));
+
+        return;
+    }
+
+    switch (currentPath)
+    {
+    case(CP_AVX2):
+    {
+        if      (format == SF_UINT8) convert8AVX2(pData, iSampleCount, pOutSamples);
+        else if (format == SF_INT16) convert16AVX2(pData, iSampleCount, pOutSamples);
+        else if (format == SF_INT24) convert24AVX2(pData, iSampleCount, pOutSamples);
+        else                         convert32AVX2(pData, iSampleCount, pOutSamples);
+
+        break;
+    }
+    case(CP_SSE2):
+    {
+        if      (format == SF_UINT8) convert8SSE2(pData, iSampleCount, pOutSamples);
+        else if (format == SF_INT16) convert16SSE2(pData, iSampleCount, pOutSamples);
+        else if (format == SF_INT24) convert24SSE2(pData, iSampleCount, pOutSamples);
+        else                         convert32SSE2(pData, iSampleCount, pOutSamples);
+
+        break;
+    }
+    default:
+    {
+        if      (format == SF_UINT8) convert8Scalar(pData, iSampleCount, pOutSamples);
+        else if (format == SF_INT16) convert16Scalar(pData, iSampleCount, pOutSamples);
+        else if (format == SF_INT24) convert24Scalar(pData, iSampleCount, pOutSamples);
+        else                         convert32Scalar(pData, iSampleCount, pOutSamples);
+
+        break;
+    }
+    }
+}
+
+void SSampleConverter::convertFromFloat(const float *pSamples, size_t iSampleCount, S_SAMPLE_FORMAT format, unsigned char *pOutData)
+{
+    if (format == SF_FLOAT32)
+    {
+        std::memcpy(pOutData, pSamples, iSampleCount * sizeof(float));
+
+        return;
+    }
+
+    for (size_t i = 0; i < iSampleCount; i++)
+    {
+        float fSample = pSamples[i];
+
+        if (fSample > 1.0f)
+        {
+            fSample = 1.0f;
+        }
+        else if (fSample < -1.0f)
+        {
+            fSample = -1.0f;
+        }
+
+        switch (format)
+        {
+        case(SF_UINT8):
+        {
+            pOutData[i] = static_cast<unsigned char>(std::lrint(fSample * 127.0f) + 128);
+
+            break;
+        }
+        case(SF_INT16):
+        {
+            const int16_t iSample = static_cast<int16_t>(std::lrint(fSample * SHRT_MAX));
+            std::memcpy(pOutData + i * 2, &iSample, sizeof(iSample));
+
+            break;
+        }
+        case(SF_INT24):
+        {
+            int32_t iSample = static_cast<int32_t>(std::lrint(fSample * 8388607.0f));
+
+            pOutData[i * 3]     = static_cast<unsigned char>(iSample & 0xFF);
+            pOutData[i * 3 + 1] = static_cast<unsigned char>((iSample >> 8) & 0xFF);
+            pOutData[i * 3 + 2] = static_cast<unsigned char>((iSample >> 16) & 0xFF);
+
+            break;
+        }
+        default:
+        {
+            const int32_t iSample = static_cast<int32_t>(std::llrint(static_cast<double>(fSample) * INT_MAX));
+            std::memcpy(pOutData + i * 4, &iSample, sizeof(iSample));
+
+            break;
+        }
+        }
+    }
+}
+
+void SSampleConverter::setPath(S_CONVERTER_PATH path)
+{
+    if (path > supportedPath)
+    {
+        path = supportedPath;
+    }
+
+    currentPath = path;
+}
+
+S_CONVERTER_PATH SSampleConverter::getPath()
+{
+    return currentPath;
+}
+
+S_CONVERTER_PATH SSampleConverter::detectPath()
+{
+#if defined(SSAMPLECONVERTER_X86)
+#if defined(_MSC_VER)
+    int vInfo[4] = {0};
+
+    __cpuid(vInfo, 0);
+    const int iMaxFunctionId = vInfo[0];
+
+    __cpuid(vInfo, 1);
+    const bool bSSE2    = (vInfo[3] & (1 << 26)) != 0;
+    const bool bOSXSAVE = (vInfo[2] & (1 << 27)) != 0;
+    const bool bAVX     = (vInfo[2] & (1 << 28)) != 0;
+
+    bool bAVX2 = false;
+
+    if (iMaxFunctionId >= 7 && bOSXSAVE && bAVX)
+    {
+        // Make sure that the OS saves YMM registers.
+        if ((_xgetbv(0) & 0x6) == 0x6)
+        {
+            __cpuidex(vInfo, 7, 0);
+            bAVX2 = (vInfo[1] & (1 << 5)) != 0;
+        }
+    }
+#else
+    __builtin_cpu_init();
+
+    const bool bSSE2 = __builtin_cpu_supports("sse2");
+    const bool bAVX2 = __builtin_cpu_supports("avx2");
+#endif
+
+    if (bAVX2)
+    {
+        return CP_AVX2;
+    }
+    else if (bSSE2)
+    {
+        return CP_SSE2;
+    }
+#endif
+
+    return CP_SCALAR;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Scalar.
+// ------------------------------------------------------------------------------------------------
+
+void SSampleConverter::convert8Scalar(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    for (size_t i = 0; i < iSampleCount; i++)
+    {
+        pOutSamples[i] = static_cast<float>(static_cast<int>(pData[i]) - 128) * fScale8;
+    }
+}
+
+void SSampleConverter::convert16Scalar(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    for (size_t i = 0; i < iSampleCount; i++)
+    {
+        int16_t iSample = 0;
+        std::memcpy(&iSample, pData + i * 2, sizeof(iSample));
+
+        pOutSamples[i] = static_cast<float>(iSample) * fScale16;
+    }
+}
+
+void SSampleConverter::convert24Scalar(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    for (size_t i = 0; i < iSampleCount; i++)
+    {
+        const unsigned char* pSample = pData + i * 3;
+
+        // interpret 24 bit as int 32
+        int32_t iSample = static_cast<int32_t>( (static_cast<uint32_t>(pSample[2]) << 24) |
+                                                (static_cast<uint32_t>(pSample[1]) << 16) |
+                                                (static_cast<uint32_t>(pSample[0]) << 8) ) >> 8;
+
+        pOutSamples[i] = static_cast<float>(iSample) * fScale24;
+    }
+}
+
+void SSampleConverter::convert32Scalar(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    for (size_t i = 0; i < iSampleCount; i++)
+    {
+        int32_t iSample = 0;
+        std::memcpy(&iSample, pData + i * 4, sizeof(iSample));
+
+        pOutSamples[i] = static_cast<float>(iSample) * fScale32;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+// SSE2.
+// ------------------------------------------------------------------------------------------------
+
+S_TARGET_SSE2 void SSampleConverter::convert8SSE2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m128 scale = _mm_set1_ps(fScale8);
+
+    // Flipping the high bit makes unsigned samples signed (128 -> 0).
+    const __m128i signBit = _mm_set1_epi8(static_cast<char>(0x80));
+
+    for (; i + 16 <= iSampleCount; i += 16)
+    {
+        __m128i samples = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i)), signBit);
+
+        // Sign extend int8 to int16 and then to int32 (same trick as with int16).
+        __m128i low  = _mm_srai_epi16(_mm_unpacklo_epi8(samples, samples), 8);
+        __m128i high = _mm_srai_epi16(_mm_unpackhi_epi8(samples, samples), 8);
+
+        _mm_storeu_ps(pOutSamples + i,      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(low, low), 16)), scale));
+        _mm_storeu_ps(pOutSamples + i + 4,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(low, low), 16)), scale));
+        _mm_storeu_ps(pOutSamples + i + 8,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(high, high), 16)), scale));
+        _mm_storeu_ps(pOutSamples + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(high, high), 16)), scale));
+    }
+#endif
+
+    convert8Scalar(pData + i, iSampleCount - i, pOutSamples + i);
+}
+
+S_TARGET_SSE2 void SSampleConverter::convert16SSE2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m128 scale = _mm_set1_ps(fScale16);
+
+    for (; i + 8 <= iSampleCount; i += 8)
+    {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i * 2));
+
+        // Sign extend int16 to int32 (put the sample in the high half and shift it back).
+        __m128i low  = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+
+        _mm_storeu_ps(pOutSamples + i,     _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(pOutSamples + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+#endif
+
+    convert16Scalar(pData + i * 2, iSampleCount - i, pOutSamples + i);
+}
+
+S_TARGET_SSE2 void SSampleConverter::convert24SSE2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m128 scale = _mm_set1_ps(fScale24);
+
+    // SSE2 has no byte shuffle so we assemble 4 samples from 3 unaligned 32 bit loads.
+    for (; i + 4 <= iSampleCount; i += 4)
+    {
+        const unsigned char* pSamples = pData + i * 3;
+
+        uint32_t vWords[3];
+        std::memcpy(vWords, pSamples, sizeof(vWords));
+
+        // Put each sample in the high 24 bits, then shift back with sign.
+        __m128i samples = _mm_set_epi32(static_cast<int>(vWords[2] & 0xFFFFFF00u),
+                                        static_cast<int>((vWords[2] << 24) | ((vWords[1] >> 16) << 8)),
+                                        static_cast<int>((vWords[1] << 16) | ((vWords[0] >> 24) << 8)),
+                                        static_cast<int>(vWords[0] << 8));
+
+        samples = _mm_srai_epi32(samples, 8);
+
+        _mm_storeu_ps(pOutSamples + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+#endif
+
+    convert24Scalar(pData + i * 3, iSampleCount - i, pOutSamples + i);
+}
+
+S_TARGET_SSE2 void SSampleConverter::convert32SSE2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m128 scale = _mm_set1_ps(fScale32);
+
+    for (; i + 4 <= iSampleCount; i += 4)
+    {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i * 4));
+
+        _mm_storeu_ps(pOutSamples + i, _mm_mul_ps(_mm_cvtepi32_ps(samples), scale));
+    }
+#endif
+
+    convert32Scalar(pData + i * 4, iSampleCount - i, pOutSamples + i);
+}
+
+// ------------------------------------------------------------------------------------------------
+// AVX2.
+// ------------------------------------------------------------------------------------------------
+
+S_TARGET_AVX2 void SSampleConverter::convert8AVX2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m256 scale = _mm256_set1_ps(fScale8);
+    const __m256i silence = _mm256_set1_epi32(128);
+
+    for (; i + 16 <= iSampleCount; i += 16)
+    {
+        // Zero extend to int32 and subtract the silence level.
+        __m256i low  = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pData + i))), silence);
+        __m256i high = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pData + i + 8))), silence);
+
+        _mm256_storeu_ps(pOutSamples + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(low), scale));
+        _mm256_storeu_ps(pOutSamples + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(high), scale));
+    }
+#endif
+
+    convert8SSE2(pData + i, iSampleCount - i, pOutSamples + i);
+}
+
+S_TARGET_AVX2 void SSampleConverter::convert16AVX2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m256 scale = _mm256_set1_ps(fScale16);
+
+    for (; i + 16 <= iSampleCount; i += 16)
+    {
+        __m128i low  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i * 2));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i * 2 + 16));
+
+        _mm256_storeu_ps(pOutSamples + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(low)), scale));
+        _mm256_storeu_ps(pOutSamples + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(high)), scale));
+    }
+#endif
+
+    convert16SSE2(pData + i * 2, iSampleCount - i, pOutSamples + i);
+}
+
+S_TARGET_AVX2 void SSampleConverter::convert24AVX2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m256 scale = _mm256_set1_ps(fScale24);
+
+    // Every 128 bit lane gets 4 samples (12 bytes), each sample is moved to the high 24 bits of an int32.
+    const __m256i shuffle = _mm256_setr_epi8(-1, 0, 1, 2,  -1, 3, 4, 5,  -1, 6, 7, 8,  -1, 9, 10, 11,
+                                             -1, 0, 1, 2,  -1, 3, 4, 5,  -1, 6, 7, 8,  -1, 9, 10, 11);
+
+    // Each iteration reads 16 bytes starting from the 12th byte so leave some space at the end.
+    for (; i + 12 <= iSampleCount; i += 8)
+    {
+        const unsigned char* pSamples = pData + i * 3;
+
+        __m256i samples = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSamples))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSamples + 12)), 1);
+
+        samples = _mm256_srai_epi32(_mm256_shuffle_epi8(samples, shuffle), 8);
+
+        _mm256_storeu_ps(pOutSamples + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+#endif
+
+    convert24SSE2(pData + i * 3, iSampleCount - i, pOutSamples + i);
+}
+
+S_TARGET_AVX2 void SSampleConverter::convert32AVX2(const unsigned char *pData, size_t iSampleCount, float *pOutSamples)
+{
+    size_t i = 0;
+
+#if defined(SSAMPLECONVERTER_X86)
+    const __m256 scale = _mm256_set1_ps(fScale32);
+
+    for (; i + 8 <= iSampleCount; i += 8)
+    {
+        __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData + i * 4));
+
+        _mm256_storeu_ps(pOutSamples + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+#endif
+
+    convert32SSE2(pData + i * 4, iSampleCount - i, pOutSamples + i);
+}
@@ -0,0 +1,75 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <cstddef>
+
+
+enum S_SAMPLE_FORMAT
+{
+    SF_INT16   = 0,
+    SF_INT24   = 1,
+    SF_INT32   = 2,
+    SF_FLOAT32 = 3,
+    SF_UINT8   = 4
+};
+
+enum S_CONVERTER_PATH
+{
+    CP_SCALAR = 0,
+    CP_SSE2   = 1,
+    CP_AVX2   = 2
+};
+
+// Converts interleaved PCM samples to float samples normalized in [-1.0f, 1.0f].
+// The fastest available instruction set (AVX2, SSE2 or plain C++) is picked at runtime.
+class SSampleConverter
+{
+public:
+
+    // Returns 'true' if the format is not supported.
+    static bool getSampleFormat      (unsigned short iBitsPerSample, bool bFloatingPoint, S_SAMPLE_FORMAT& format);
+
+
+    // 'iSampleCount' is the number of samples (not frames, so all channels are counted),
+    // 'pOutSamples' should have space for 'iSampleCount' floats.
+    static void convertToFloat       (const unsigned char* pData, size_t iSampleCount, S_SAMPLE_FORMAT format, float* pOutSamples);
+
+    // The opposite of convertToFloat() (values outside of [-1.0f, 1.0f] are clipped),
+    // 'pOutData' should have space for 'iSampleCount' samples of 'format'.
+    static void convertFromFloat     (const float* pSamples, size_t iSampleCount, S_SAMPLE_FORMAT format, unsigned char* pOutData);
+
+
+    // Forces a specific path (if supported by the CPU), mostly useful for comparing paths.
+    static void setPath              (S_CONVERTER_PATH path);
+    static S_CONVERTER_PATH getPath  ();
+
+private:
+
+    static S_CONVERTER_PATH detectPath();
+
+    static void convert8Scalar       (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert16Scalar      (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert24Scalar      (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert32Scalar      (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+
+    static void convert8SSE2         (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert16SSE2        (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert24SSE2        (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert32SSE2        (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+
+    static void convert8AVX2         (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert16AVX2        (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert24AVX2        (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+    static void convert32AVX2        (const unsigned char* pData, size_t iSampleCount, float* pOutSamples);
+
+
+    static S_CONVERTER_PATH currentPath;
+    static S_CONVERTER_PATH supportedPath;
+};
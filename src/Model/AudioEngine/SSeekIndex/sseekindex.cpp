@@ -0,0 +1,262 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sseekindex.h"
+
+// STL
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+
+#define SSEEKINDEX_MAGIC   "XSKI"
+#define SSEEKINDEX_VERSION 1
+
+
+SSeekIndex::SSeekIndex()
+{
+    iTotalFrameCount = 0;
+    bComplete        = false;
+}
+
+void SSeekIndex::clear()
+{
+    vEntries.clear();
+
+    iTotalFrameCount = 0;
+    bComplete        = false;
+}
+
+bool SSeekIndex::addEntry(unsigned long long iFrame, long long iTimestamp)
+{
+    if (vEntries.size() > 0 && (iFrame <= vEntries.back().iFrame || iTimestamp <= vEntries.back().iTimestamp))
+    {
+        return true;
+    }
+
+    vEntries.push_back({iFrame, iTimestamp});
+
+    return false;
+}
+
+void SSeekIndex::setComplete(unsigned long long iTotalFrameCount)
+{
+    this->iTotalFrameCount = iTotalFrameCount;
+
+    bComplete = true;
+}
+
+bool SSeekIndex::findByFrame(unsigned long long iFrame, SSeekIndexEntry &entry) const
+{
+    if (vEntries.size() == 0)
+    {
+        return true;
+    }
+
+    auto it = std::upper_bound(vEntries.begin(), vEntries.end(), iFrame, [](unsigned long long iValue, const SSeekIndexEntry& e)
+    {
+        return iValue < e.iFrame;
+    });
+
+    if (it == vEntries.begin())
+    {
+        return true;
+    }
+
+    entry = *(it - 1);
+
+    return false;
+}
+
+bool SSeekIndex::findByTimestamp(long long iTimestamp, unsigned long long &iFrame) const
+{
+    auto it = std::lower_bound(vEntries.begin(), vEntries.end(), iTimestamp, [](const SSeekIndexEntry& e, long long iValue)
+    {
+        return e.iTimestamp < iValue;
+    });
+
+    if (it == vEntries.end() || it->iTimestamp != iTimestamp)
+    {
+        return true;
+    }
+
+    iFrame = it->iFrame;
+
+    return false;
+}
+
+bool SSeekIndex::isComplete() const
+{
+    return bComplete;
+}
+
+unsigned long long SSeekIndex::getLastFrame() const
+{
+    if (bComplete)
+    {
+        return iTotalFrameCount;
+    }
+
+    if (vEntries.size() == 0)
+    {
+        return 0;
+    }
+
+    return vEntries.back().iFrame;
+}
+
+size_t SSeekIndex::getEntryCount() const
+{
+    return vEntries.size();
+}
+
+bool SSeekIndex::load(const std::wstring &sPathToIndexFile, const std::wstring &sPathToAudioFile)
+{
+    unsigned long long iFileSize = 0;
+    long long iLastWriteTime = 0;
+
+    if (getFileKey(sPathToAudioFile, iFileSize, iLastWriteTime))
+    {
+        return true;
+    }
+
+
+    std::ifstream file(fs::path(sPathToIndexFile), std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+    char vMagic[sizeof(SSEEKINDEX_MAGIC) - 1] = {0};
+    unsigned int iVersion = 0;
+    unsigned long long iCachedFileSize = 0;
+    long long iCachedLastWriteTime = 0;
+    unsigned long long iReadTotalFrameCount = 0;
+    unsigned long long iEntryCount = 0;
+
+    file.read(vMagic, sizeof(vMagic));
+    file.read(reinterpret_cast<char*>(&iVersion), sizeof(iVersion));
+    file.read(reinterpret_cast<char*>(&iCachedFileSize), sizeof(iCachedFileSize));
+    file.read(reinterpret_cast<char*>(&iCachedLastWriteTime), sizeof(iCachedLastWriteTime));
+    file.read(reinterpret_cast<char*>(&iReadTotalFrameCount), sizeof(iReadTotalFrameCount));
+    file.read(reinterpret_cast<char*>(&iEntryCount), sizeof(iEntryCount));
+
+    if (file.fail() || std::string(vMagic, sizeof(vMagic)) != SSEEKINDEX_MAGIC || iVersion != SSEEKINDEX_VERSION
+            || iCachedFileSize != iFileSize || iCachedLastWriteTime != iLastWriteTime || iEntryCount > iReadTotalFrameCount)
+    {
+        return true;
+    }
+
+    std::vector<SSeekIndexEntry> vReadEntries(static_cast<size_t>(iEntryCount));
+
+    for (size_t i = 0; i < vReadEntries.size(); i++)
+    {
+        file.read(reinterpret_cast<char*>(&vReadEntries[i].iFrame), sizeof(vReadEntries[i].iFrame));
+        file.read(reinterpret_cast<char*>(&vReadEntries[i].iTimestamp), sizeof(vReadEntries[i].iTimestamp));
+    }
+
+    if (file.fail())
+    {
+        return true;
+    }
+
+    vEntries = std::move(vReadEntries);
+    iTotalFrameCount = iReadTotalFrameCount;
+    bComplete = true;
+
+    return false;
+}
+
+bool SSeekIndex::save(const std::wstring &sPathToIndexFile, const std::wstring &sPathToAudioFile) const
+{
+    if (bComplete == false)
+    {
+        return true;
+    }
+
+    unsigned long long iFileSize = 0;
+    long long iLastWriteTime = 0;
+
+    if (getFileKey(sPathToAudioFile, iFileSize, iLastWriteTime))
+    {
+        return true;
+    }
+
+
+    std::error_code ec;
+    fs::create_directories(fs::path(sPathToIndexFile).parent_path(), ec);
+
+
+    // Write to a temporary file first so that a half-written index is never read.
+
+    fs::path tempPath = fs::path(sPathToIndexFile);
+    tempPath += L".tmp";
+
+    std::ofstream file(tempPath, std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+    unsigned int iVersion = SSEEKINDEX_VERSION;
+    unsigned long long iEntryCount = vEntries.size();
+
+    file.write(SSEEKINDEX_MAGIC, sizeof(SSEEKINDEX_MAGIC) - 1);
+    file.write(reinterpret_cast<const char*>(&iVersion), sizeof(iVersion));
+    file.write(reinterpret_cast<const char*>(&iFileSize), sizeof(iFileSize));
+    file.write(reinterpret_cast<const char*>(&iLastWriteTime), sizeof(iLastWriteTime));
+    file.write(reinterpret_cast<const char*>(&iTotalFrameCount), sizeof(iTotalFrameCount));
+    file.write(reinterpret_cast<const char*>(&iEntryCount), sizeof(iEntryCount));
+
+    for (size_t i = 0; i < vEntries.size(); i++)
+    {
+        file.write(reinterpret_cast<const char*>(&vEntries[i].iFrame), sizeof(vEntries[i].iFrame));
+        file.write(reinterpret_cast<const char*>(&vEntries[i].iTimestamp), sizeof(vEntries[i].iTimestamp));
+    }
+
+    bool bFailed = file.fail();
+
+    file.close();
+
+    if (bFailed)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+    fs::rename(tempPath, fs::path(sPathToIndexFile), ec);
+    if (ec)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+    return false;
+}
+
+bool SSeekIndex::getFileKey(const std::wstring &sPathToAudioFile, unsigned long long &iFileSize, long long &iLastWriteTime)
+{
+    std::error_code ec;
+
+    iFileSize = fs::file_size(fs::path(sPathToAudioFile), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+    fs::file_time_type lastWriteTime = fs::last_write_time(fs::path(sPathToAudioFile), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+    iLastWriteTime = static_cast<long long>(lastWriteTime.time_since_epoch().count());
+
+    return false;
+}
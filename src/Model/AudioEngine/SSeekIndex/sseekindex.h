@@ -0,0 +1,69 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <string>
+#include <cstddef>
+
+
+struct SSeekIndexEntry
+{
+    // First frame of the decoded sample.
+    unsigned long long iFrame;
+    // Timestamp of the decoded sample (in 100-nanosecond units).
+    long long          iTimestamp;
+};
+
+// Maps decoded frames to decoder timestamps, built while the file is decoded from the start.
+// Used to seek to the exact frame in files where the timestamp can't be calculated from the frame (VBR).
+class SSeekIndex
+{
+public:
+
+    SSeekIndex();
+
+
+    void clear                 ();
+
+
+    // Entries should be added in order (the frame and the timestamp should grow).
+    // Returns 'true' if the entry is out of order (it's not added).
+    bool addEntry              (unsigned long long iFrame, long long iTimestamp);
+    // Should be called when the end of the file was reached.
+    void setComplete           (unsigned long long iTotalFrameCount);
+
+
+    // Returns 'true' if the index is empty.
+    // 'entry' is the last entry with the frame not bigger than 'iFrame'.
+    bool findByFrame           (unsigned long long iFrame, SSeekIndexEntry& entry) const;
+    // Returns 'true' if there is no entry with this timestamp.
+    bool findByTimestamp       (long long iTimestamp, unsigned long long& iFrame) const;
+
+
+    bool isComplete            () const;
+    unsigned long long getLastFrame() const;
+    size_t getEntryCount       () const;
+
+
+    // The index is saved with the size and the modification time of the audio file,
+    // load() returns 'true' if there is no index or it belongs to another version of the file.
+    bool load                  (const std::wstring& sPathToIndexFile, const std::wstring& sPathToAudioFile);
+    bool save                  (const std::wstring& sPathToIndexFile, const std::wstring& sPathToAudioFile) const;
+
+private:
+
+    static bool getFileKey     (const std::wstring& sPathToAudioFile, unsigned long long& iFileSize, long long& iLastWriteTime);
+
+
+    std::vector<SSeekIndexEntry> vEntries;
+
+    unsigned long long iTotalFrameCount;
+    bool               bComplete;
+};
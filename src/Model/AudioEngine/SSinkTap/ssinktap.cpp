@@ -0,0 +1,101 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "ssinktap.h"
+
+// STL
+#include <thread>
+
+// Custom
+#include "AudioEngine/SAudioSink/saudiosink.h"
+
+
+XAPO_REGISTRATION_PROPERTIES SSinkTap::registrationProperties =
+{
+    __uuidof(SSinkTap),
+    L"SSinkTap",
+    L"Copyright Aleksandr \"Flone\" Tretyakov",
+    1,
+    0,
+    XAPO_FLAG_CHANNELS_MUST_MATCH | XAPO_FLAG_FRAMERATE_MUST_MATCH | XAPO_FLAG_BITSPERSAMPLE_MUST_MATCH
+    | XAPO_FLAG_BUFFERCOUNT_MUST_MATCH | XAPO_FLAG_INPLACE_SUPPORTED | XAPO_FLAG_INPLACE_REQUIRED,
+    1,
+    1,
+    1,
+    1
+};
+
+
+SSinkTap::SSinkTap(SAudioSink *pSink) : CXAPOBase(&registrationProperties)
+{
+    this->pSink = pSink;
+
+    iProcessCount = 0;
+
+    iChannels = 0;
+}
+
+HRESULT SSinkTap::LockForProcess(UINT32 iInputLockedParameterCount, const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS *pInputLockedParameters,
+                                 UINT32 iOutputLockedParameterCount, const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS *pOutputLockedParameters)
+{
+    HRESULT hr = CXAPOBase::LockForProcess(iInputLockedParameterCount, pInputLockedParameters, iOutputLockedParameterCount, pOutputLockedParameters);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    // The mastering voice mix is always 32 bit float.
+    iChannels = pInputLockedParameters[0].pFormat->nChannels;
+
+    vSilence.clear();
+    vSilence.resize(static_cast<size_t>(pInputLockedParameters[0].MaxFrameCount) * iChannels, 0.0f);
+
+    return S_OK;
+}
+
+void SSinkTap::Process(UINT32 iInputProcessParameterCount, const XAPO_PROCESS_BUFFER_PARAMETERS *pInputProcessParameters,
+                       UINT32 iOutputProcessParameterCount, XAPO_PROCESS_BUFFER_PARAMETERS *pOutputProcessParameters, BOOL bIsEnabled)
+{
+    UNREFERENCED_PARAMETER(iInputProcessParameterCount);
+    UNREFERENCED_PARAMETER(iOutputProcessParameterCount);
+    UNREFERENCED_PARAMETER(bIsEnabled);
+
+    // In-place, the audio is not changed.
+    pOutputProcessParameters[0].BufferFlags     = pInputProcessParameters[0].BufferFlags;
+    pOutputProcessParameters[0].ValidFrameCount = pInputProcessParameters[0].ValidFrameCount;
+
+
+    // Counted before 'pSink' is read so that detach() sees this call if it uses the sink.
+    iProcessCount++;
+
+    SAudioSink* pCurrentSink = pSink;
+
+    if (pCurrentSink)
+    {
+        if (pInputProcessParameters[0].BufferFlags == XAPO_BUFFER_SILENT)
+        {
+            pCurrentSink->write(vSilence.data(), pInputProcessParameters[0].ValidFrameCount);
+        }
+        else
+        {
+            pCurrentSink->write(static_cast<const float*>(pInputProcessParameters[0].pBuffer), pInputProcessParameters[0].ValidFrameCount);
+        }
+    }
+
+    iProcessCount--;
+}
+
+void SSinkTap::detach()
+{
+    pSink = nullptr;
+
+    // A Process() call that has read the old sink.
+    while (iProcessCount > 0)
+    {
+        std::this_thread::yield();
+    }
+}
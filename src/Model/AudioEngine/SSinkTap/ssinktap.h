@@ -0,0 +1,58 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <atomic>
+#include <vector>
+
+// XAudio2
+#include <xapobase.h>
+
+#pragma comment(lib, "xapobase.lib")
+
+
+class SAudioSink;
+
+// Pass-through XAPO (for the mastering voice) that sends the final mix to a sink.
+// The sink is called on the XAudio2 thread so its write() should not block (see SAsyncSink),
+// the tap itself does not lock.
+class __declspec(uuid("{5B9E3C71-2A4D-4F8E-9C61-0D7A8B3E41F2}")) SSinkTap : public CXAPOBase
+{
+public:
+
+    SSinkTap(SAudioSink* pSink);
+
+
+    STDMETHOD(LockForProcess) (UINT32 iInputLockedParameterCount,
+                               const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS* pInputLockedParameters,
+                               UINT32 iOutputLockedParameterCount,
+                               const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS* pOutputLockedParameters) override;
+
+    STDMETHOD_(void, Process) (UINT32 iInputProcessParameterCount,
+                               const XAPO_PROCESS_BUFFER_PARAMETERS* pInputProcessParameters,
+                               UINT32 iOutputProcessParameterCount,
+                               XAPO_PROCESS_BUFFER_PARAMETERS* pOutputProcessParameters,
+                               BOOL bIsEnabled) override;
+
+
+    // The sink will not be used after this call returns (waits for the Process() call that uses it).
+    void detach();
+
+private:
+
+    static XAPO_REGISTRATION_PROPERTIES registrationProperties;
+
+
+    std::atomic<SAudioSink*> pSink;
+    std::atomic<int>         iProcessCount; // Process() calls that may use 'pSink'
+
+    std::vector<float> vSilence;
+
+    UINT32             iChannels;
+};
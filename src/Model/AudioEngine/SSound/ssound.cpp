@@ -9,9 +9,14 @@
 
 // STL
 #include <fstream>
+#include <cmath>
+#include <sstream>
+#include <filesystem>
+#include <memory>
 
 // Custom
 #include "AudioEngine/SSoundMix/ssoundmix.h"
+#include "AudioEngine/SDecoder/sdecoder.h"
 
 // Other
 #include <Mferror.h>
@@ -28,13 +33,70 @@ SSound::SSound(SAudioEngine* pAudioEngine)
 
     bSoundLoaded = false;
     bUseStreaming = false;
+    bPreloaded = false;
     bSoundStoppedManually = false;
     bCurrentlyStreaming = false;
 
     sAudioFileDiskPath = L"";
 
-    dCurrentStreamingPosInSec = 0.0;
     iSamplesPlayedOnLastSetPos = 0;
+    iMappedReadPosInBytes = 0;
+
+    iStreamingBaseFrame = 0;
+    iDecodedFrame = 0;
+    iSeekTargetFrame = 0;
+    iSkipSizeInBytes = 0;
+    iMappedStreamPosInBytes = 0;
+    bDecodedFrameExact = true;
+    bSeekPending = false;
+
+    std::error_code ec;
+    sSeekIndexDirectory = (std::filesystem::temp_directory_path(ec) / L"Xander" / L"seek").wstring();
+
+    iStreamingBufferCountSetting = iDefaultStreamingBufferCount;
+    iStreamingBufferCount = iDefaultStreamingBufferCount;
+    iStreamingBufferSizeInBytes = 0;
+    dStreamingReadAheadInSec = dDefaultStreamingReadAheadInSec;
+    iStreamingUnderrunCount = 0;
+    iStreamingDiscardUntil = 0;
+    iStreamingGeneration = 0;
+    bStreamingRingActive = false;
+    bStreamingEnded = false;
+    bStreamingPositionChanged = false;
+
+    pCrossfadeTo = nullptr;
+    iCrossfadeStartFrame = 0;
+    iCrossfadeStartResult = S_OK;
+    iLastSampleFirstFrame = 0;
+
+    dStreamingBaseTempo = 1.0;
+    bTimeStretchChanged = false;
+
+    iSubmitGeneration = 0;
+    iSubmittedBufferCount = 0;
+    iSubmittedSizeInBytes = 0;
+    bSubmitStarted = false;
+    bSubmitStarving = false;
+
+    voiceCallback.onProcessingPassStart = [this](UINT32)
+    {
+        if (bStreamingRingActive)
+        {
+            submitFromStreamingRing();
+        }
+
+        if (pCrossfadeTo.load())
+        {
+            checkCrossfadeStart();
+        }
+    };
+    voiceCallback.onBufferEnd = [this](void* pBufferContext)
+    {
+        if (bUseStreaming)
+        {
+            releaseStreamingBuffer(pBufferContext);
+        }
+    };
 
     bCalledOnPlayEnd = false;
     bDestroyCalled = false;
@@ -66,6 +128,14 @@ bool SSound::loadAudioFile(const std::wstring &sAudioFilePath, bool bStreamAudio
     iCurrentEffectIndex = 0;
     bEffectsSet = false;
 
+    clearFade();
+
+    mtxStreamingRead.lock();
+    timeStretcher.setTempo(1.0);
+    timeStretcher.setPitchInSemitones(0.0);
+    mtxStreamingRead.unlock();
+    bTimeStretchChanged = false;
+
 
     this->pSoundMix = pOutputToSoundMix;
 
@@ -81,13 +151,15 @@ bool SSound::loadAudioFile(const std::wstring &sAudioFilePath, bool bStreamAudio
 
     if (bStreamAudio == false)
     {
-        if (loadFileIntoMemory(sAudioFilePath, vAudioData, &waveFormatEx, iWaveFormatSize))
+        if (mapWaveFile(sAudioFilePath))
         {
-            return true;
-        }
+            // Not an uncompressed .wav file, decode it.
 
-        soundFormat = *waveFormatEx;
-        CoTaskMemFree(waveFormatEx);
+            if (loadFileIntoMemory(sAudioFilePath, vAudioData))
+            {
+                return true;
+            }
+        }
 
 
         // Create source voice.
@@ -127,22 +199,38 @@ bool SSound::loadAudioFile(const std::wstring &sAudioFilePath, bool bStreamAudio
         }
 
         ZeroMemory(&audioBuffer, sizeof(XAUDIO2_BUFFER));
-        audioBuffer.AudioBytes = static_cast<UINT32>(vAudioData.size());
-        audioBuffer.pAudioData = &vAudioData[0];
+        if (waveFile.isOpen())
+        {
+            // Play right from the mapped file.
+            audioBuffer.AudioBytes = static_cast<UINT32>(waveFile.getDataSizeInBytes());
+            audioBuffer.pAudioData = waveFile.getData();
+        }
+        else
+        {
+            audioBuffer.AudioBytes = static_cast<UINT32>(vAudioData.size());
+            audioBuffer.pAudioData = &vAudioData[0];
+        }
         audioBuffer.pContext = nullptr;
     }
     else
     {
-        if (createAsyncReader(sAudioFilePath, pAsyncSourceReader, &waveFormatEx, iWaveFormatSize))
+        if (mapWaveFile(sAudioFilePath))
         {
-            return true;
-        }
+            // Not an uncompressed .wav file, decode it.
+
+            if (createAsyncReader(sAudioFilePath, pAsyncSourceReader, &waveFormatEx, iWaveFormatSize))
+            {
+                return true;
+            }
 
-        soundFormat = *waveFormatEx;
-        CoTaskMemFree(waveFormatEx);
+            // Read info from the full format (it may be WAVEFORMATEXTENSIBLE).
+            readSoundInfo(pAsyncSourceReader, waveFormatEx);
 
+            soundFormat = *waveFormatEx;
+            CoTaskMemFree(waveFormatEx);
+        }
 
-        readSoundInfo(pAsyncSourceReader, &soundFormat);
+        allocateStreamingBuffers();
 
 
 
@@ -180,21 +268,37 @@ bool SSound::loadAudioFile(const std::wstring &sAudioFilePath, bool bStreamAudio
     }
 
 
-    // Create source reader for readWaveData().
-    WAVEFORMATEX* pWaveFormat;
-    unsigned int iWaveSize;
-    createSourceReader(sAudioFilePath, nullptr, pOptionalSourceReader, &pWaveFormat, iWaveSize, true);
-    CoTaskMemFree(pWaveFormat);
+    // Create source reader for readWaveData() (not needed if the file is mapped).
+    if (waveFile.isOpen() == false)
+    {
+        WAVEFORMATEX* pWaveFormat;
+        unsigned int iWaveSize;
+        createSourceReader(sAudioFilePath, nullptr, pOptionalSourceReader, &pWaveFormat, iWaveSize, true);
+        CoTaskMemFree(pWaveFormat);
+    }
 
 
     this->sAudioFileDiskPath = sAudioFilePath;
 
+
+    // Seek index from the last time (if the file was played to the end),
+    // the mapped files are always seeked to the exact frame.
+    seekIndex.clear();
+    if (bStreamAudio && waveFile.isOpen() == false)
+    {
+        seekIndex.load(getSeekIndexPath(), sAudioFilePath);
+    }
+
     bSoundLoaded = true;
     bUseStreaming = bStreamAudio;
 
 
+    mtxSoundState.lock();
+
     soundState = SS_NOT_PLAYING;
 
+    mtxSoundState.unlock();
+
     return false;
 }
 
@@ -207,6 +311,20 @@ bool SSound::playSound()
     }
 
 
+    if (bPreloaded)
+    {
+        // The decoder is already running, just start the voice.
+        HRESULT hr = startPreloadedVoice();
+        if (FAILED(hr))
+        {
+            pAudioEngine->showError(hr, L"Sound::playSound::Start() [preloaded]");
+            return true;
+        }
+
+        return false;
+    }
+
+
     if (bCurrentlyStreaming && bUseStreaming)
     {
         bStopStreaming = true;
@@ -222,7 +340,6 @@ bool SSound::playSound()
     bSoundStoppedManually = false;
     bCurrentlyStreaming = false;
 
-    dCurrentStreamingPosInSec = 0.0;
     iSamplesPlayedOnLastSetPos = 0;
 
 
@@ -263,8 +380,110 @@ bool SSound::playSound()
     }
 
 
+    mtxSoundState.lock();
+
     soundState = SS_PLAYING;
 
+    mtxSoundState.unlock();
+
+
+    return false;
+}
+
+bool SSound::preloadSound()
+{
+    if (bSoundLoaded == false)
+    {
+        pAudioEngine->showError(L"Sound::preloadSound()", L"no sound is loaded.");
+        return true;
+    }
+
+    if (bUseStreaming == false || soundState != SS_NOT_PLAYING || bPreloaded)
+    {
+        // Nothing to do.
+        return false;
+    }
+
+
+    bStopStreaming = false;
+    bSoundStoppedManually = false;
+    bCurrentlyStreaming = false;
+
+    iSamplesPlayedOnLastSetPos = 0;
+
+    bPreloaded = true;
+
+
+    if (onPlayEndCallback)
+    {
+        // Start callback wait.
+        std::thread t(&SSound::onPlayEnd, this);
+        t.detach();
+    }
+
+
+    // Decode until the ring is full, the voice is started in playSound().
+    std::thread t(&SSound::streamAudioFile, this, pAsyncSourceReader);
+    t.detach();
+
+
+    return false;
+}
+
+bool SSound::setFade(S_CROSSFADE_CURVE curve, bool bFadeIn, unsigned long long iFadeStartFrame, unsigned long long iFadeFrameCount)
+{
+    if (bSoundLoaded == false)
+    {
+        pAudioEngine->showError(L"Sound::setFade()", L"no sound is loaded.");
+        return true;
+    }
+
+    if (bUseStreaming == false)
+    {
+        pAudioEngine->showError(L"Sound::setFade()", L"the fade is only supported in streaming mode.");
+        return true;
+    }
+
+
+    mtxStreamingRead.lock();
+
+    fade.setup(curve, bFadeIn, iFadeStartFrame, iFadeFrameCount);
+
+    mtxStreamingRead.unlock();
+
+
+    return false;
+}
+
+void SSound::clearFade()
+{
+    pCrossfadeTo = nullptr;
+
+    mtxStreamingRead.lock();
+
+    fade.reset();
+
+    mtxStreamingRead.unlock();
+}
+
+bool SSound::setCrossfadeTo(SSound *pNextSound, unsigned long long iStartFrame)
+{
+    if (bSoundLoaded == false)
+    {
+        pAudioEngine->showError(L"Sound::setCrossfadeTo()", L"no sound is loaded.");
+        return true;
+    }
+
+    if (bUseStreaming == false || pNextSound == this)
+    {
+        pAudioEngine->showError(L"Sound::setCrossfadeTo()", L"the crossfade is only supported in streaming mode between two sounds.");
+        return true;
+    }
+
+
+    iCrossfadeStartFrame = iStartFrame;
+    pCrossfadeTo = pNextSound;
+
 
     return false;
 }
@@ -311,6 +530,24 @@ bool SSound::unpauseSound()
         return false;
     }
 
+    if (bTimeStretchChanged.exchange(false) && bUseStreaming)
+    {
+        // The tempo or the pitch was changed while paused, drop the old data.
+
+        double dPositionInSec = 0.0;
+        getPositionInSec(dPositionInSec);
+
+        if (dPositionInSec > soundInfo.dSoundLengthInSec)
+        {
+            dPositionInSec = soundInfo.dSoundLengthInSec;
+        }
+
+        if (setPositionInSec(dPositionInSec))
+        {
+            return true;
+        }
+    }
+
     HRESULT hr = pSourceVoice->Start();
     if (FAILED(hr))
     {
@@ -338,13 +575,28 @@ bool SSound::stopSound()
         return true;
     }
 
-    if (soundState == SS_NOT_PLAYING)
+    // Before the check: a crossfade may start the preloaded voice right now (see startPreloadedVoice()).
+    bSoundStoppedManually = true;
+
+    if (soundState == SS_NOT_PLAYING && bPreloaded == false)
     {
         return false;
     }
 
 
-    bSoundStoppedManually = true;
+    // Don't start the next sound.
+    pCrossfadeTo = nullptr;
+
+    if (bPreloaded)
+    {
+        // The decoder thread may not have started yet.
+        mtxStreamingSwitch.lock();
+
+        bPreloaded = false;
+        bStopStreaming = true;
+
+        mtxStreamingSwitch.unlock();
+    }
 
     if (onPlayEndCallback && bCalledOnPlayEnd == false)
     {
@@ -384,9 +636,9 @@ bool SSound::stopSound()
     }
 
 
-    if (bUseStreaming)
+    if (bUseStreaming && pAsyncSourceReader)
     {
-        // Restart the stream.
+        // Restart the stream (the mapped file is restarted in streamAudioFile()).
         sourceReaderCallback.restart();
 
         PROPVARIANT var = { 0 };
@@ -400,17 +652,18 @@ bool SSound::stopSound()
         }
     }
 
-    dCurrentStreamingPosInSec = 0.0;
-
-
     pSourceVoice->FlushSourceBuffers();
 
 
     audioBuffer.PlayBegin = 0;
 
 
+    mtxSoundState.lock();
+
     soundState = SS_NOT_PLAYING;
 
+    mtxSoundState.unlock();
+
 
     return false;
 }
@@ -433,54 +686,95 @@ bool SSound::setPositionInSec(double dPositionInSec)
 
     if (bUseStreaming)
     {
-        LONGLONG pos = static_cast<LONGLONG>(dPositionInSec * 10000000);
+        std::lock_guard<std::mutex> lock(mtxStreamingRead);
 
 
+        const unsigned long long iTargetFrame = static_cast<unsigned long long>(std::llround(dPositionInSec * soundInfo.iSampleRate));
 
-        PROPVARIANT var;
-        HRESULT hr = InitPropVariantFromInt64(pos, &var);
-        if (SUCCEEDED(hr))
+        if (waveFile.isOpen())
         {
-            //dCurrentStreamingPosInSec = dPositionInSec;
+            // The mapped file is read from the exact frame.
 
-            std::lock_guard<std::mutex> lock(mtxStreamingReadSampleSubmit);
-
-            hr = pAsyncSourceReader->Flush((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM);
-            if (FAILED(hr))
+            unsigned long long iFrame = iTargetFrame;
+            if (iFrame > waveFile.getFrameCount())
             {
-                pAudioEngine->showError(hr, L"Sound::setPositionInSec::Flush()");
-                return true;
+                iFrame = waveFile.getFrameCount();
             }
 
-            hr = pAsyncSourceReader->SetCurrentPosition(GUID_NULL, var);
-            PropVariantClear(&var);
+            iMappedStreamPosInBytes = static_cast<size_t>(iFrame) * soundFormat.nBlockAlign;
+        }
+        else
+        {
+            // Seek to the closest known decoded sample before the target frame (if the index has it),
+            // the decoder thread will skip the frames before the target frame.
 
-            hr = pSourceVoice->Stop();
-            if (FAILED(hr))
+            LONGLONG pos = static_cast<LONGLONG>(dPositionInSec * 10000000);
+
+            SSeekIndexEntry entry;
+            if (seekIndex.findByFrame(iTargetFrame, entry) == false && iTargetFrame - entry.iFrame <= soundInfo.iSampleRate * iMaxSeekSkipInSec)
             {
-                pAudioEngine->showError(hr, L"Sound::setPositionInSec::Stop()");
-                return true;
+                pos = entry.iTimestamp;
             }
 
-            hr = pSourceVoice->FlushSourceBuffers();
+
+
+            PROPVARIANT var;
+            HRESULT hr = InitPropVariantFromInt64(pos, &var);
             if (FAILED(hr))
             {
-                pAudioEngine->showError(hr, L"Sound::setPositionInSec::FlushSourceBuffers()");
+                pAudioEngine->showError(hr, L"Sound::setPositionInSec::SetCurrentPosition()");
                 return true;
             }
 
-            SetEvent(voiceCallback.hBufferEndEvent);
-
-            hr = pSourceVoice->Start();
+            hr = pAsyncSourceReader->Flush((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM);
             if (FAILED(hr))
             {
-                pAudioEngine->showError(hr, L"Sound::setPositionInSec::Start()");
+                PropVariantClear(&var);
+
+                pAudioEngine->showError(hr, L"Sound::setPositionInSec::Flush()");
                 return true;
             }
+
+            pAsyncSourceReader->SetCurrentPosition(GUID_NULL, var);
+            PropVariantClear(&var);
+
+            iSeekTargetFrame = iTargetFrame;
+            bSeekPending = true;
         }
-        else
+
+
+        // Drop the decoded data from the old position
+        // (the decoder thread will do the same when it will see this).
+        requestStreamingDiscard();
+        bStreamingPositionChanged = true;
+
+        HRESULT hr = pSourceVoice->Stop();
+        if (FAILED(hr))
+        {
+            pAudioEngine->showError(hr, L"Sound::setPositionInSec::Stop()");
+            return true;
+        }
+
+        hr = pSourceVoice->FlushSourceBuffers();
+        if (FAILED(hr))
+        {
+            pAudioEngine->showError(hr, L"Sound::setPositionInSec::FlushSourceBuffers()");
+            return true;
+        }
+
+        XAUDIO2_VOICE_STATE state;
+        pSourceVoice->GetState(&state);
+
+        iSamplesPlayedOnLastSetPos = state.SamplesPlayed;
+        iStreamingBaseFrame = iTargetFrame;
+        dStreamingBaseTempo = timeStretcher.getTempo();
+
+        SetEvent(voiceCallback.hBufferEndEvent);
+
+        hr = pSourceVoice->Start();
+        if (FAILED(hr))
         {
-            pAudioEngine->showError(hr, L"Sound::setPositionInSec::SetCurrentPosition()");
+            pAudioEngine->showError(hr, L"Sound::setPositionInSec::Start()");
             return true;
         }
     }
@@ -530,6 +824,44 @@ bool SSound::setPositionInSec(double dPositionInSec)
     return false;
 }
 
+bool SSound::setStreamingBuffering(size_t iBufferCount, double dReadAheadInSec)
+{
+    if (iBufferCount < 3 || iBufferCount > XAUDIO2_MAX_QUEUED_BUFFERS)
+    {
+        pAudioEngine->showError(L"SSound::setStreamingBuffering()", L"the buffer count should be in [3, XAUDIO2_MAX_QUEUED_BUFFERS].");
+        return true;
+    }
+
+    if (dReadAheadInSec <= 0.0)
+    {
+        pAudioEngine->showError(L"SSound::setStreamingBuffering()", L"the read ahead duration should be positive.");
+        return true;
+    }
+
+    iStreamingBufferCountSetting = iBufferCount;
+    dStreamingReadAheadInSec = dReadAheadInSec;
+
+    return false;
+}
+
+void SSound::getStreamingBuffering(size_t &iBufferCount, double &dReadAheadInSec) const
+{
+    iBufferCount = iStreamingBufferCountSetting;
+    dReadAheadInSec = dStreamingReadAheadInSec;
+}
+
+unsigned long long SSound::getStreamingUnderrunCount() const
+{
+    return iStreamingUnderrunCount;
+}
+
+void SSound::setSeekIndexDirectory(const std::wstring &sSeekIndexDirectory)
+{
+    std::lock_guard<std::mutex> lock(mtxStreamingRead);
+
+    this->sSeekIndexDirectory = sSeekIndexDirectory;
+}
+
 void SSound::setOnPlayEndCallback(std::function<void (SSound *)> f)
 {
     onPlayEndCallback = f;
@@ -590,6 +922,26 @@ bool SSound::setPitchInSemitones(float fSemitones)
         return true;
     }
 
+    if (bUseStreaming)
+    {
+        // Keep the tempo.
+
+        mtxStreamingRead.lock();
+
+        const double dOldPitch = timeStretcher.getPitchInSemitones();
+        timeStretcher.setPitchInSemitones(fSemitones);
+        const bool bChanged = timeStretcher.getPitchInSemitones() != dOldPitch;
+
+        mtxStreamingRead.unlock();
+
+        if (bChanged == false)
+        {
+            return false;
+        }
+
+        return applyTimeStretchChange();
+    }
+
     if (fSemitones > 60.0f)
     {
         fSemitones = 60.0f;
@@ -609,34 +961,66 @@ bool SSound::setPitchInSemitones(float fSemitones)
     return false;
 }
 
-bool SSound::setPan(float fPan)
+bool SSound::setTempo(float fTempo)
 {
-    // Get speaker config.
+    if (bSoundLoaded == false)
+    {
+        pAudioEngine->showError(L"Sound::setTempo()", L"no sound is loaded.");
+        return true;
+    }
 
-    unsigned long iChannelMask;
-    HRESULT hr = pAudioEngine->pMasteringVoice->GetChannelMask( &iChannelMask );
-    if (FAILED(hr))
+    if (bUseStreaming == false)
     {
-        pAudioEngine->showError(hr, L"SSound::setPan::GetChannelMask()");
+        pAudioEngine->showError(L"Sound::setTempo()", L"the tempo is only supported in streaming mode.");
         return true;
     }
 
 
-    // Pan of -1.0 indicates all left speaker,
-    // 1.0 is all right speaker, 0.0 is split between left and right
-    float fLeft = 0.5f - fPan / 2;
-    float fRight = 0.5f + fPan / 2;
+    mtxStreamingRead.lock();
 
+    const double dOldTempo = timeStretcher.getTempo();
+    timeStretcher.setTempo(fTempo);
+    const bool bChanged = timeStretcher.getTempo() != dOldTempo;
 
-    float outputMatrix[8];
+    mtxStreamingRead.unlock();
 
-    for (int i = 0; i < 8; i++)
+    if (bChanged == false)
     {
-        outputMatrix[i] = 0;
+        return false;
     }
 
 
-    switch (iChannelMask)
+    return applyTimeStretchChange();
+}
+
+bool SSound::setPan(float fPan)
+{
+    // Get speaker config.
+
+    unsigned long iChannelMask;
+    HRESULT hr = pAudioEngine->pMasteringVoice->GetChannelMask( &iChannelMask );
+    if (FAILED(hr))
+    {
+        pAudioEngine->showError(hr, L"SSound::setPan::GetChannelMask()");
+        return true;
+    }
+
+
+    // Pan of -1.0 indicates all left speaker,
+    // 1.0 is all right speaker, 0.0 is split between left and right
+    float fLeft = 0.5f - fPan / 2;
+    float fRight = 0.5f + fPan / 2;
+
+
+    float outputMatrix[8];
+
+    for (int i = 0; i < 8; i++)
+    {
+        outputMatrix[i] = 0;
+    }
+
+
+    switch (iChannelMask)
     {
 
     case SPEAKER_MONO:
@@ -737,8 +1121,12 @@ bool SSound::getSoundState(SSoundState &state)
         return true;
     }
 
+    mtxSoundState.lock();
+
     state = soundState;
 
+    mtxSoundState.unlock();
+
     return false;
 }
 
@@ -753,7 +1141,8 @@ bool SSound::getPositionInSec(double &dPositionInSec)
 
     if (bUseStreaming)
     {
-        dPositionInSec = dCurrentStreamingPosInSec;
+        // Frames played since the last seek (sample-accurate).
+        dPositionInSec = getStreamingPlayedFrame() / static_cast<double>(soundInfo.iSampleRate);
     }
     else
     {
@@ -795,7 +1184,7 @@ bool SSound::getLoadedAudioDataSizeInBytes(size_t& iSizeInBytes)
     }
     else
     {
-        iSizeInBytes = vAudioData.size();
+        iSizeInBytes = audioBuffer.AudioBytes;
     }
 
 
@@ -808,9 +1197,48 @@ bool SSound::isSoundStoppedManually() const
 }
 
 bool SSound::readWaveData(std::vector<unsigned char>* pvWaveData, bool& bEndOfStream)
+{
+    return readWaveData([pvWaveData](const unsigned char* pData, size_t iSizeInBytes)
+    {
+        pvWaveData->insert(pvWaveData->end(), pData, pData + iSizeInBytes);
+    }, bEndOfStream);
+}
+
+bool SSound::readWaveData(const std::function<void(const unsigned char*, size_t)>& onWaveData, bool& bEndOfStream)
 {
     std::lock_guard<std::mutex> lock(mtxOptionalSourceReaderRead);
 
+    if (waveFile.isOpen())
+    {
+        // Hand out the mapped data in small parts (like the decoder does).
+
+        if (iMappedReadPosInBytes >= waveFile.getDataSizeInBytes())
+        {
+            iMappedReadPosInBytes = 0;
+
+            bEndOfStream = true;
+
+            return false;
+        }
+
+        size_t iSizeInBytes = (waveFile.getFormat().iAvgBytesPerSec / 10) / waveFile.getFormat().iBlockAlign * waveFile.getFormat().iBlockAlign;
+        if (iSizeInBytes == 0)
+        {
+            iSizeInBytes = waveFile.getFormat().iBlockAlign;
+        }
+
+        if (iSizeInBytes > waveFile.getDataSizeInBytes() - iMappedReadPosInBytes)
+        {
+            iSizeInBytes = waveFile.getDataSizeInBytes() - iMappedReadPosInBytes;
+        }
+
+        onWaveData(waveFile.getData() + iMappedReadPosInBytes, iSizeInBytes);
+
+        iMappedReadPosInBytes += iSizeInBytes;
+
+        return false;
+    }
+
     if (pOptionalSourceReader == nullptr)
     {
         return true;
@@ -865,7 +1293,7 @@ bool SSound::readWaveData(std::vector<unsigned char>* pvWaveData, bool& bEndOfSt
         return true;
     }
 
-    // Lock buffer and copy data to local memory.
+    // Lock buffer and pass the decoded data without copying it.
     hr = pBuffer->Lock(&pLocalAudioData, nullptr, &iLocalAudioDataLength);
     if (FAILED(hr))
     {
@@ -873,10 +1301,7 @@ bool SSound::readWaveData(std::vector<unsigned char>* pvWaveData, bool& bEndOfSt
         return true;
     }
 
-    for (size_t i = 0; i < iLocalAudioDataLength; i++)
-    {
-        pvWaveData->push_back(pLocalAudioData[i]);
-    }
+    onWaveData(pLocalAudioData, iLocalAudioDataLength);
 
     // Unlock the buffer.
     hr = pBuffer->Unlock();
@@ -907,7 +1332,6 @@ void SSound::clearSound()
         }
 
         vAudioData.clear();
-        vSpeedChangedAudioData.clear();
 
         if (pAsyncSourceReader)
         {
@@ -921,6 +1345,10 @@ void SSound::clearSound()
             pOptionalSourceReader->Release();
             pOptionalSourceReader = nullptr;
         }
+
+        // The voice is destroyed so the mapped data is not used anymore.
+        waveFile.close();
+        iMappedReadPosInBytes = 0;
         mtxOptionalSourceReaderRead.unlock();
     }
 }
@@ -952,6 +1380,12 @@ bool SSound::readSoundInfo(IMFSourceReader* pSourceReader, WAVEFORMATEX* pFormat
     soundInfo.iSampleRate    = pFormat->nSamplesPerSec;
     soundInfo.iBitsPerSample = pFormat->wBitsPerSample;
 
+    soundInfo.bFloatingPointSamples = (pFormat->wFormatTag == WAVE_FORMAT_IEEE_FLOAT);
+    if (pFormat->wFormatTag == WAVE_FORMAT_EXTENSIBLE && pFormat->cbSize >= sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX))
+    {
+        soundInfo.bFloatingPointSamples = (reinterpret_cast<WAVEFORMATEXTENSIBLE*>(pFormat)->SubFormat == MFAudioFormat_Float);
+    }
+
 
     // Get audio length.
 
@@ -1044,7 +1478,52 @@ bool SSound::readSoundInfo(IMFSourceReader* pSourceReader, WAVEFORMATEX* pFormat
     return false;
 }
 
-bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::vector<unsigned char> &vAudioData, WAVEFORMATEX **pFormat, unsigned int &iWaveFormatSize)
+bool SSound::mapWaveFile(const std::wstring &sAudioFilePath)
+{
+    if (pAudioEngine->bEngineInitialized == false)
+    {
+        pAudioEngine->showError(L"SSound::mapWaveFile()", L"the audio engine is not initialized.");
+        return true;
+    }
+
+
+    std::lock_guard<std::mutex> lock(mtxOptionalSourceReaderRead);
+
+    if (waveFile.open(sAudioFilePath, &pAudioEngine->fileHandleCache))
+    {
+        return true;
+    }
+
+    iMappedReadPosInBytes = 0;
+
+
+    const SWaveFormat& format = waveFile.getFormat();
+
+    ZeroMemory(&soundFormat, sizeof(WAVEFORMATEX));
+    soundFormat.wFormatTag      = (format.iFormatTag == WFT_IEEE_FLOAT) ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+    soundFormat.nChannels       = format.iChannels;
+    soundFormat.nSamplesPerSec  = format.iSampleRate;
+    soundFormat.nAvgBytesPerSec = format.iAvgBytesPerSec;
+    soundFormat.nBlockAlign     = format.iBlockAlign;
+    soundFormat.wBitsPerSample  = format.iBitsPerSample;
+    soundFormat.cbSize          = 0;
+
+    iWaveFormatSize = sizeof(WAVEFORMATEX);
+
+
+    soundInfo.iChannels             = format.iChannels;
+    soundInfo.iSampleRate           = format.iSampleRate;
+    soundInfo.iBitsPerSample        = format.iBitsPerSample;
+    soundInfo.bFloatingPointSamples = (format.iFormatTag == WFT_IEEE_FLOAT);
+    soundInfo.dSoundLengthInSec     = waveFile.getLengthInSec();
+    soundInfo.iBitrate              = format.iAvgBytesPerSec * 8;
+    soundInfo.bUsesVariableBitRate  = false;
+    soundInfo.iFileSizeInBytes      = waveFile.getFileSizeInBytes();
+
+    return false;
+}
+
+bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::vector<unsigned char> &vAudioData)
 {
     if (pAudioEngine->bEngineInitialized == false)
     {
@@ -1055,99 +1534,100 @@ bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::vector<
 
     // Check if the file exists.
 
-    std::ifstream file(sAudioFilePath, std::ios::binary);
-    if (file.is_open())
+    std::error_code ec;
+    const unsigned long long iFileSizeInBytes = std::filesystem::file_size(sAudioFilePath, ec);
+    if (ec)
     {
-        file.close();
+        pAudioEngine->showError(L"AudioEngine::loadFileIntoMemory()", L"the specified file (" + sAudioFilePath +L") does not exist.");
+        return true;
     }
-    else
+
+
+    std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(sAudioFilePath, SF_INT16, &pAudioEngine->fileHandleCache));
+    if (pDecoder == nullptr)
     {
-        pAudioEngine->showError(L"AudioEngine::loadFileIntoMemory()", L"the specified file (" + sAudioFilePath +L") does not exist.");
+        pAudioEngine->showError(L"AudioEngine::loadFileIntoMemory()", L"the format of the file (" + sAudioFilePath +L") is not supported.");
         return true;
     }
 
+    const SDecoderInfo& info = pDecoder->getInfo();
+    const size_t iBlockAlign = pDecoder->getOutputBlockAlign();
 
-    IMFSourceReader* pSourceReaderOut;
-    createSourceReader(sAudioFilePath, nullptr, pSourceReaderOut, pFormat, iWaveFormatSize);
 
-    readSoundInfo(pSourceReaderOut, *pFormat);
+    ZeroMemory(&soundFormat, sizeof(WAVEFORMATEX));
+    soundFormat.wFormatTag      = WAVE_FORMAT_PCM;
+    soundFormat.nChannels       = info.iChannels;
+    soundFormat.nSamplesPerSec  = info.iSampleRate;
+    soundFormat.nAvgBytesPerSec = static_cast<DWORD>(info.iSampleRate * iBlockAlign);
+    soundFormat.nBlockAlign     = static_cast<WORD>(iBlockAlign);
+    soundFormat.wBitsPerSample  = 16;
+    soundFormat.cbSize          = 0;
 
-    Microsoft::WRL::ComPtr<IMFSourceReader> pSourceReader(pSourceReaderOut);
+    iWaveFormatSize = sizeof(WAVEFORMATEX);
 
 
-    // Copy data into byte vector.
+    soundInfo.iChannels             = info.iChannels;
+    soundInfo.iSampleRate           = info.iSampleRate;
+    soundInfo.iBitsPerSample        = 16;
+    soundInfo.bFloatingPointSamples = false;
+    soundInfo.dSoundLengthInSec     = info.dLengthInSec;
+    soundInfo.iBitrate              = info.iBitrate;
+    soundInfo.bUsesVariableBitRate  = info.bUsesVariableBitRate;
+    soundInfo.iFileSizeInBytes      = iFileSizeInBytes;
 
-    Microsoft::WRL::ComPtr<IMFSample> pSample = nullptr;
-    Microsoft::WRL::ComPtr<IMFMediaBuffer> pBuffer = nullptr;
-    unsigned char* pLocalAudioData = NULL;
-    DWORD iLocalAudioDataLength = 0;
 
+    // Reserve the whole decoded size at once (the duration may be a bit off so add some space)
+    // so that the vector is not reallocated (and copied) while decoding.
 
-    // Audio stream index.
-    DWORD iStreamIndex = (DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM;
-    HRESULT hr = S_OK;
+    size_t iExpectedFrameCount = static_cast<size_t>(info.iFrameCount);
+    if (info.bExactFrameCount == false)
+    {
+        iExpectedFrameCount += soundInfo.iSampleRate * iLoadReserveSlackInMs / 1000;
+    }
+
+    // +1 frame to see the end of the stream without growing the vector.
+    vAudioData.clear();
+    vAudioData.reserve((iExpectedFrameCount + 1) * iBlockAlign);
+
+
+    // Decode right into the vector.
 
     while (true)
     {
-        DWORD flags = 0;
-        hr = pSourceReader->ReadSample(iStreamIndex, 0, nullptr, &flags, nullptr, pSample.GetAddressOf());
-        if (FAILED(hr))
-        {
-            pAudioEngine->showError(hr, L"AudioEngine::loadFileIntoMemory::ReadSample()");
-            return true;
-        }
-
-        // Check whether the data is still valid.
-        if (flags & MF_SOURCE_READERF_CURRENTMEDIATYPECHANGED)
-        {
-            break;
-        }
+        // 100 ms (or what's left of the reserved space).
+        size_t iChunkFrameCount = soundInfo.iSampleRate / 10;
 
-        // Check for eof.
-        if (flags & MF_SOURCE_READERF_ENDOFSTREAM)
+        const size_t iFreeFrameCount = (vAudioData.capacity() - vAudioData.size()) / iBlockAlign;
+        if (iFreeFrameCount > 0 && iFreeFrameCount < iChunkFrameCount)
         {
-            break;
+            iChunkFrameCount = iFreeFrameCount;
         }
 
-        if (pSample == nullptr)
-        {
-            continue;
-        }
+        const size_t iOldSize = vAudioData.size();
+        vAudioData.resize(iOldSize + iChunkFrameCount * iBlockAlign);
 
-        // Convert data to contiguous buffer.
-        hr = pSample->ConvertToContiguousBuffer(pBuffer.GetAddressOf());
-        if (FAILED(hr))
+        size_t iReadFrameCount = 0;
+        if (pDecoder->read(vAudioData.data() + iOldSize, iChunkFrameCount, iReadFrameCount))
         {
-            pAudioEngine->showError(hr, L"AudioEngine::loadFileIntoMemory::ConvertToContiguousBuffer()");
+            pAudioEngine->showError(L"AudioEngine::loadFileIntoMemory()", L"could not decode the file (" + sAudioFilePath +L").");
             return true;
         }
 
-        // Lock buffer and copy data to local memory.
-        hr = pBuffer->Lock(&pLocalAudioData, nullptr, &iLocalAudioDataLength);
-        if (FAILED(hr))
-        {
-            pAudioEngine->showError(hr, L"AudioEngine::loadFileIntoMemory::Lock()");
-            return true;
-        }
+        vAudioData.resize(iOldSize + iReadFrameCount * iBlockAlign);
 
-        for (size_t i = 0; i < iLocalAudioDataLength; i++)
+        if (iReadFrameCount < iChunkFrameCount)
         {
-            vAudioData.push_back(pLocalAudioData[i]);
+            break;
         }
+    }
 
-        // Unlock the buffer.
-        hr = pBuffer->Unlock();
-        pLocalAudioData = nullptr;
 
-        if (FAILED(hr))
-        {
-            pAudioEngine->showError(hr, L"AudioEngine::loadFileIntoMemory::Unlock()");
-            return true;
-        }
+    // Give back the unused space if the duration was too far off.
+    if (vAudioData.capacity() - vAudioData.size() > soundInfo.iSampleRate * iBlockAlign * iLoadReserveSlackInMs / 1000)
+    {
+        vAudioData.shrink_to_fit();
     }
 
-    pSourceReader.Reset();
-
     return false;
 }
 
@@ -1202,11 +1682,46 @@ bool SSound::streamAudioFile(IMFSourceReader *pAsyncReader)
     DWORD iStreamIndex = (DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM;
 
 
-    pSourceVoice->Start();
+    // Drop what's left from the last time.
+    bStreamingEnded = false;
+    requestStreamingDiscard();
+    bStreamingRingActive = true;
+
+
+    // The stream starts from the beginning.
+
+    mtxStreamingRead.lock();
+
+    iDecodedFrame = 0;
+    iSkipSizeInBytes = 0;
+    bDecodedFrameExact = true;
+    bSeekPending = false;
+    iMappedStreamPosInBytes = 0;
+
+    XAUDIO2_VOICE_STATE state;
+    pSourceVoice->GetState(&state);
 
+    iSamplesPlayedOnLastSetPos = state.SamplesPlayed;
+    iStreamingBaseFrame = 0;
 
-    if (loopStream(pAsyncReader, pSourceVoice))
+    timeStretcher.setup(soundInfo.iChannels);
+    dStreamingBaseTempo = timeStretcher.getTempo();
+    bTimeStretchChanged = false;
+
+    mtxStreamingRead.unlock();
+
+    if (bPreloaded == false)
+    {
+        pSourceVoice->Start();
+    }
+
+
+    const bool bError = waveFile.isOpen() ? loopMappedStream(pSourceVoice) : loopStream(pAsyncReader, pSourceVoice);
+
+    if (bError)
     {
+        bStreamingRingActive = false;
+
         mtxStreamingSwitch.lock();
         bCurrentlyStreaming = false;
         mtxStreamingSwitch.unlock();
@@ -1216,7 +1731,12 @@ bool SSound::streamAudioFile(IMFSourceReader *pAsyncReader)
     }
 
 
-    pAsyncReader->Flush(iStreamIndex);
+    bStreamingRingActive = false;
+
+    if (pAsyncReader)
+    {
+        pAsyncReader->Flush(iStreamIndex);
+    }
 
     pSourceVoice->Stop();
 
@@ -1236,8 +1756,6 @@ bool SSound::loopStream(IMFSourceReader *pAsyncReader, IXAudio2SourceVoice *pSou
     DWORD streamIndex = (DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM;
     HRESULT hr = S_OK;
 
-    DWORD iCurrentStreamBufferIndex = 0;
-
     while(true)
     {
         if (bStopStreaming)
@@ -1253,12 +1771,21 @@ bool SSound::loopStream(IMFSourceReader *pAsyncReader, IXAudio2SourceVoice *pSou
         }
 
 
-        mtxStreamingReadSampleSubmit.lock();
+        mtxStreamingRead.lock();
+
+        if (bStreamingPositionChanged)
+        {
+            bStreamingPositionChanged = false;
+
+            requestStreamingDiscard();
+
+            timeStretcher.reset();
+        }
 
         hr = pAsyncReader->ReadSample(streamIndex, 0, nullptr, nullptr, nullptr, nullptr);
         if (FAILED(hr))
         {
-            mtxStreamingReadSampleSubmit.unlock();
+            mtxStreamingRead.unlock();
 
             if (hr == MF_E_NOTACCEPTING)
             {
@@ -1271,28 +1798,17 @@ bool SSound::loopStream(IMFSourceReader *pAsyncReader, IXAudio2SourceVoice *pSou
 
         WaitForSingleObject(sourceReaderCallback.hReadSampleEvent, INFINITE);
 
-        mtxStreamingReadSampleSubmit.unlock();
+        updateSeekIndex();
 
+        const SCrossfader sampleFade = fade;
+        const unsigned long long iSampleFirstFrame = iLastSampleFirstFrame;
+
+        mtxStreamingRead.unlock();
 
-        dCurrentStreamingPosInSec = sourceReaderCallback.llTimestamp / 10000000;
 
         if (sourceReaderCallback.bIsEndOfStream)
         {
-            // Notify about onPlayEnd.
-
-            XAUDIO2_VOICE_STATE state;
-            pSourceVoice->GetState(&state);
-            while(state.BuffersQueued > 0)
-            {
-                WaitForSingleObject(voiceCallback.hBufferEndEvent, INFINITE);
-
-                pSourceVoice->GetState(&state);
-            }
-
-            if (onPlayEndCallback)
-            {
-                SetEvent(voiceCallback.hStreamEnd);
-            }
+            finishStream(pSourceVoice);
 
             break;
         }
@@ -1324,20 +1840,48 @@ bool SSound::loopStream(IMFSourceReader *pAsyncReader, IXAudio2SourceVoice *pSou
         }
 
 
+        S_SAMPLE_FORMAT sampleFormat;
+
+        if (sampleFade.isEnabled() && SSampleConverter::getSampleFormat(soundInfo.iBitsPerSample, soundInfo.bFloatingPointSamples, sampleFormat) == false)
+        {
+            // Fade in/out (the decoded buffer is ours so it's changed in place).
+            sampleFade.apply(pAudioData, iSampleBufferSize / soundFormat.nBlockAlign, soundInfo.iChannels, sampleFormat, iSampleFirstFrame);
+        }
+
+
 
-        // Recreate proper buffer if needed.
+        size_t iSkippedSize = 0;
 
-        if (vSizeOfBuffers[iCurrentStreamBufferIndex] < iSampleBufferSize)
+        if (iSkipSizeInBytes > 0)
         {
-            vBuffers[iCurrentStreamBufferIndex].reset(new uint8_t[iSampleBufferSize]);
-            vSizeOfBuffers[iCurrentStreamBufferIndex] = iSampleBufferSize;
+            // Frames before the seek target.
+            iSkippedSize = (iSkipSizeInBytes < iSampleBufferSize) ? iSkipSizeInBytes : iSampleBufferSize;
+            iSkipSizeInBytes -= iSkippedSize;
         }
 
+        const unsigned char* pWriteData = pAudioData + iSkippedSize;
+        size_t iWriteSize = iSampleBufferSize - iSkippedSize;
 
 
-        // Copy data to our buffer.
+        // Tempo and pitch.
 
-        std::memcpy(vBuffers[iCurrentStreamBufferIndex].get(), pAudioData, iSampleBufferSize);
+        mtxStreamingRead.lock();
+
+        if (timeStretcher.isBypassed() == false)
+        {
+            stretchDecodedData(pWriteData, iWriteSize, false);
+
+            pWriteData = vStretchedData.data();
+            iWriteSize = vStretchedData.size();
+        }
+
+        mtxStreamingRead.unlock();
+
+
+
+        // Copy data to the ring, wait for the voice to free some space if it's full.
+
+        const bool bStop = writeToStreamingRing(pWriteData, iWriteSize);
 
 
         hr = pMediaBuffer->Unlock();
@@ -1347,51 +1891,550 @@ bool SSound::loopStream(IMFSourceReader *pAsyncReader, IXAudio2SourceVoice *pSou
             return true;
         }
 
+        if (bStop)
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool SSound::loopMappedStream(IXAudio2SourceVoice *pSourceVoice)
+{
+    // The same as loopStream() but the data is read right from the mapped file.
+
+    const size_t iBlockAlign = soundFormat.nBlockAlign;
+
+    // 100 ms (whole frames).
+    size_t iChunkSizeInBytes = soundFormat.nSamplesPerSec / 10 * iBlockAlign;
+    if (iChunkSizeInBytes == 0)
+    {
+        iChunkSizeInBytes = iBlockAlign;
+    }
+
+    S_SAMPLE_FORMAT sampleFormat;
+    const bool bFormatSupported = (SSampleConverter::getSampleFormat(soundInfo.iBitsPerSample, soundInfo.bFloatingPointSamples, sampleFormat) == false);
+
+    while(true)
+    {
+        if (bStopStreaming)
+        {
+            // Exit.
+            break;
+        }
+
+
+        if (waitForUnpause())
+        {
+            break;
+        }
 
 
-        // Wait until there is 'iMaxBufferDuringStreaming - 1' buffers in the queue (leave 1 buffer for reader).
+        mtxStreamingRead.lock();
 
-        XAUDIO2_VOICE_STATE state;
-        while(true)
+        if (bStreamingPositionChanged)
         {
-            pSourceVoice->GetState(&state);
+            bStreamingPositionChanged = false;
 
-            if (state.BuffersQueued < iMaxBufferDuringStreaming - 1)
-            {
-                break;
-            }
+            requestStreamingDiscard();
 
-            WaitForSingleObject(voiceCallback.hBufferEndEvent, INFINITE);
+            timeStretcher.reset();
+        }
 
-            if (waitForUnpause())
-            {
-                return false;
-            }
+        const size_t iReadPosInBytes = iMappedStreamPosInBytes;
+
+        size_t iReadSize = waveFile.getDataSizeInBytes() - iReadPosInBytes;
+        if (iReadSize > iChunkSizeInBytes)
+        {
+            iReadSize = iChunkSizeInBytes;
         }
 
+        iMappedStreamPosInBytes += iReadSize;
 
+        const SCrossfader sampleFade = fade;
 
-        // Play audio.
+        mtxStreamingRead.unlock();
+
+
+        if (iReadSize == 0)
+        {
+            finishStream(pSourceVoice);
+
+            break;
+        }
+
+
+        const unsigned char* pWriteData = waveFile.getData() + iReadPosInBytes;
+        size_t iWriteSize = iReadSize;
+
+        if (sampleFade.isEnabled() && bFormatSupported)
+        {
+            // Fade in/out (the mapped data is read-only so change a copy).
+            vMappedFadeData.assign(pWriteData, pWriteData + iWriteSize);
+
+            sampleFade.apply(vMappedFadeData.data(), iWriteSize / iBlockAlign, soundInfo.iChannels, sampleFormat, iReadPosInBytes / iBlockAlign);
+
+            pWriteData = vMappedFadeData.data();
+        }
+
+
+        // Tempo and pitch.
+
+        mtxStreamingRead.lock();
+
+        if (timeStretcher.isBypassed() == false)
+        {
+            stretchDecodedData(pWriteData, iWriteSize, false);
+
+            pWriteData = vStretchedData.data();
+            iWriteSize = vStretchedData.size();
+        }
+
+        mtxStreamingRead.unlock();
+
+
+
+        // Copy data to the ring, wait for the voice to free some space if it's full.
+
+        if (writeToStreamingRing(pWriteData, iWriteSize))
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+void SSound::finishStream(IXAudio2SourceVoice *pSourceVoice)
+{
+    mtxStreamingRead.lock();
+
+    const bool bStretch = timeStretcher.isBypassed() == false;
+    if (bStretch)
+    {
+        // What's left in the time stretcher.
+        stretchDecodedData(nullptr, 0, true);
+    }
+
+    mtxStreamingRead.unlock();
+
+    if (bStretch && writeToStreamingRing(vStretchedData.data(), vStretchedData.size()))
+    {
+        return;
+    }
+
+
+    // Let the voice callback submit what's left.
+    bStreamingEnded = true;
+
+
+    // Notify about onPlayEnd.
+
+    XAUDIO2_VOICE_STATE state;
+    pSourceVoice->GetState(&state);
+    while(state.BuffersQueued > 0 || streamingRing.getReadableSize() > 0)
+    {
+        WaitForSingleObject(voiceCallback.hBufferEndEvent, INFINITE);
+
+        reportCrossfadeStartError();
+
+        if (bStopStreaming)
+        {
+            return;
+        }
+
+        pSourceVoice->GetState(&state);
+    }
+
+    reportCrossfadeStartError();
+
+    if (onPlayEndCallback)
+    {
+        SetEvent(voiceCallback.hStreamEnd);
+    }
+}
+
+void SSound::updateSeekIndex()
+{
+    const long long iTimestamp = sourceReaderCallback.llTimestamp;
+    const size_t iBlockAlign = soundFormat.nBlockAlign;
+
+    if (bSeekPending)
+    {
+        // First sample after the seek, find out where we are.
+
+        bSeekPending = false;
+
+        bDecodedFrameExact = (seekIndex.findByTimestamp(iTimestamp, iDecodedFrame) == false);
+        if (bDecodedFrameExact == false)
+        {
+            iDecodedFrame = static_cast<unsigned long long>(std::llround(iTimestamp / 10000000.0 * soundInfo.iSampleRate));
+        }
+
+        if (iSeekTargetFrame > iDecodedFrame)
+        {
+            iSkipSizeInBytes = static_cast<size_t>(iSeekTargetFrame - iDecodedFrame) * iBlockAlign;
+        }
+        else
+        {
+            iSkipSizeInBytes = 0;
+
+            // Can't go back.
+            iStreamingBaseFrame = iDecodedFrame;
+        }
+    }
+
+
+    if (sourceReaderCallback.bIsEndOfStream)
+    {
+        if (bDecodedFrameExact && seekIndex.isComplete() == false)
+        {
+            seekIndex.setComplete(iDecodedFrame);
+            seekIndex.save(getSeekIndexPath(), sAudioFileDiskPath);
+        }
+
+        return;
+    }
+
+
+    DWORD iSampleSize = 0;
+    sourceReaderCallback.sample->GetTotalLength(&iSampleSize);
+
+    if (bDecodedFrameExact && seekIndex.isComplete() == false)
+    {
+        // Ignored if already added.
+        seekIndex.addEntry(iDecodedFrame, iTimestamp);
+    }
+
+    iLastSampleFirstFrame = iDecodedFrame;
+
+    iDecodedFrame += iSampleSize / iBlockAlign;
+}
+
+std::wstring SSound::getSeekIndexPath()
+{
+    std::wstringstream fileName;
+    fileName << std::hex << std::hash<std::wstring>{}(sAudioFileDiskPath) << L".xsk";
+
+    return (std::filesystem::path(sSeekIndexDirectory) / fileName.str()).wstring();
+}
+
+void SSound::requestStreamingDiscard()
+{
+    iStreamingDiscardUntil.store(streamingRing.getWriteCount());
+
+    // The voice callback will notice the new generation on the next processing pass.
+    iStreamingGeneration++;
+}
+
+void SSound::submitFromStreamingRing()
+{
+    const unsigned int iGeneration = iStreamingGeneration.load();
+
+    if (iGeneration != iSubmitGeneration)
+    {
+        // Submitted buffers of the old generation were flushed.
+
+        iSubmitGeneration = iGeneration;
+
+        iSubmittedBufferCount = 0;
+        iSubmittedSizeInBytes = 0;
+        bSubmitStarted = false;
+        bSubmitStarving = false;
+
+        streamingRing.consume(static_cast<size_t>(iStreamingDiscardUntil.load() - streamingRing.getReadCount()));
+    }
+
+
+    const bool bEnded = bStreamingEnded;
+
+    while (iSubmittedBufferCount < iStreamingBufferCount - 1)
+    {
+        const size_t iAvailableSize = streamingRing.getReadableSize() - iSubmittedSizeInBytes;
+
+        if (iAvailableSize == 0)
+        {
+            break;
+        }
+
+        if (iAvailableSize < iStreamingBufferSizeInBytes && bEnded == false && iSubmittedBufferCount > 0)
+        {
+            // Wait for a full buffer (unless the voice has nothing to play).
+            break;
+        }
+
+        size_t iContiguousSize = 0;
+        const unsigned char* pData = streamingRing.peek(iSubmittedSizeInBytes, iContiguousSize);
+
+        size_t iSize = iContiguousSize;
+        if (iSize > iStreamingBufferSizeInBytes)
+        {
+            iSize = iStreamingBufferSizeInBytes;
+        }
+
+
+        // The context has the size and the generation of the buffer so that it can be freed in releaseStreamingBuffer().
 
         XAUDIO2_BUFFER buf = { 0 };
-        buf.AudioBytes = iSampleBufferSize;
-        buf.pAudioData = vBuffers[iCurrentStreamBufferIndex].get();
+        buf.AudioBytes = static_cast<UINT32>(iSize);
+        buf.pAudioData = pData;
+        buf.pContext   = reinterpret_cast<void*>((static_cast<uintptr_t>(iSize) << 8) | (iGeneration & 0xFF));
+
+        if (FAILED(pSourceVoice->SubmitSourceBuffer(&buf)))
+        {
+            break;
+        }
+
+        iSubmittedBufferCount++;
+        iSubmittedSizeInBytes += iSize;
+
+        bSubmitStarted = true;
+        bSubmitStarving = false;
+    }
+
+
+    if (bSubmitStarted && iSubmittedBufferCount == 0 && bEnded == false && bSubmitStarving == false)
+    {
+        // The decoder was too slow, the voice has nothing to play.
+        bSubmitStarving = true;
+        iStreamingUnderrunCount++;
+    }
+}
+
+void SSound::releaseStreamingBuffer(void *pBufferContext)
+{
+    const uintptr_t iContext = reinterpret_cast<uintptr_t>(pBufferContext);
+
+    if ((iContext & 0xFF) != (iSubmitGeneration & 0xFF) || iSubmittedBufferCount == 0)
+    {
+        // Flushed buffer of the old generation.
+        return;
+    }
+
+    const size_t iSize = static_cast<size_t>(iContext >> 8);
+
+    iSubmittedBufferCount--;
+    iSubmittedSizeInBytes -= iSize;
+
+    streamingRing.consume(iSize);
+}
 
-        mtxStreamingReadSampleSubmit.lock();
-        pSourceVoice->SubmitSourceBuffer(&buf);
-        mtxStreamingReadSampleSubmit.unlock();
+void SSound::checkCrossfadeStart()
+{
+    SSound* pNextSound = pCrossfadeTo.load();
+
+    if (pNextSound == nullptr)
+    {
+        return;
+    }
+
+    const unsigned long long iFrame = getStreamingPlayedFrame();
+
+    // The next sound will start on the next processing pass (XAudio2 passes are 10 ms).
+    const unsigned long long iPassFrames = static_cast<unsigned long long>(soundFormat.nSamplesPerSec / 100 * dStreamingBaseTempo.load());
+
+    if (iFrame + iPassFrames < iCrossfadeStartFrame)
+    {
+        return;
+    }
+
+
+    if (pCrossfadeTo.compare_exchange_strong(pNextSound, nullptr))
+    {
+        HRESULT hr = pNextSound->startPreloadedVoice();
+        if (FAILED(hr))
+        {
+            // Shown by the decoder thread (see reportCrossfadeStartError()).
+            iCrossfadeStartResult = hr;
+        }
+    }
+}
+
+void SSound::reportCrossfadeStartError()
+{
+    HRESULT hr = iCrossfadeStartResult.exchange(S_OK);
+
+    if (FAILED(hr))
+    {
+        pAudioEngine->showError(hr, L"Sound::checkCrossfadeStart::Start()");
+    }
+}
+
+unsigned long long SSound::getStreamingPlayedFrame()
+{
+    // The voice plays 'tempo' source frames per frame.
+
+    XAUDIO2_VOICE_STATE state;
+    pSourceVoice->GetState(&state);
+
+    const double dPlayedFrames = static_cast<double>(state.SamplesPlayed - iSamplesPlayedOnLastSetPos) * dStreamingBaseTempo.load();
+
+    return iStreamingBaseFrame + static_cast<unsigned long long>(std::llround(dPlayedFrames));
+}
+
+void SSound::stretchDecodedData(const unsigned char *pData, size_t iSizeInBytes, bool bEndOfStream)
+{
+    vStretchedData.clear();
+
+    S_SAMPLE_FORMAT sampleFormat;
+    if (SSampleConverter::getSampleFormat(soundInfo.iBitsPerSample, soundInfo.bFloatingPointSamples, sampleFormat))
+    {
+        // Not supported, play as is.
+        if (iSizeInBytes > 0)
+        {
+            vStretchedData.assign(pData, pData + iSizeInBytes);
+        }
+
+        return;
+    }
+
+
+    const size_t iBytesPerSample = soundFormat.nBlockAlign / soundInfo.iChannels;
+
+    vStretchOutput.clear();
+
+    if (bEndOfStream)
+    {
+        timeStretcher.flush(vStretchOutput);
+    }
+    else
+    {
+        const size_t iSampleCount = iSizeInBytes / iBytesPerSample;
+
+        vStretchInput.resize(iSampleCount);
+        SSampleConverter::convertToFloat(pData, iSampleCount, sampleFormat, vStretchInput.data());
+
+        timeStretcher.process(vStretchInput.data(), iSampleCount / soundInfo.iChannels, vStretchOutput);
+    }
+
+    vStretchedData.resize(vStretchOutput.size() * iBytesPerSample);
+    SSampleConverter::convertFromFloat(vStretchOutput.data(), vStretchOutput.size(), sampleFormat, vStretchedData.data());
+}
+
+bool SSound::writeToStreamingRing(const unsigned char *pData, size_t iSizeInBytes)
+{
+    size_t iWrittenSize = 0;
+
+    while (iWrittenSize < iSizeInBytes)
+    {
+        iWrittenSize += streamingRing.write(pData + iWrittenSize, iSizeInBytes - iWrittenSize);
+
+        if (iWrittenSize == iSizeInBytes)
+        {
+            break;
+        }
 
+        WaitForSingleObject(voiceCallback.hBufferEndEvent, INFINITE);
 
+        reportCrossfadeStartError();
 
-        // Next buffer.
+        if (waitForUnpause() || bStopStreaming)
+        {
+            return true;
+        }
 
-        iCurrentStreamBufferIndex++;
-        iCurrentStreamBufferIndex %= iMaxBufferDuringStreaming;
+        if (bStreamingPositionChanged)
+        {
+            // This data is from the old position.
+            break;
+        }
     }
 
     return false;
 }
 
+bool SSound::applyTimeStretchChange()
+{
+    // The buffered audio (up to the read ahead) was stretched with the old parameters
+    // so decode it again from the current position (this also resets the time stretcher).
+
+    if (bCurrentlyStreaming == false || bPreloaded)
+    {
+        // Applied to the next decoded data (already preloaded data keeps the old parameters).
+        return false;
+    }
+
+    if (soundState == SS_PAUSED)
+    {
+        // See unpauseSound().
+        bTimeStretchChanged = true;
+        return false;
+    }
+
+
+    double dPositionInSec = 0.0;
+    if (getPositionInSec(dPositionInSec))
+    {
+        return true;
+    }
+
+    if (dPositionInSec > soundInfo.dSoundLengthInSec)
+    {
+        dPositionInSec = soundInfo.dSoundLengthInSec;
+    }
+
+
+    return setPositionInSec(dPositionInSec);
+}
+
+HRESULT SSound::startPreloadedVoice()
+{
+    // Called on the XAudio2 thread when a crossfade starts (see checkCrossfadeStart()) or by playSound(),
+    // so no locks: the exchange of 'bPreloaded' decides who starts the voice (stopSound() clears it too).
+    if (bPreloaded.exchange(false) == false)
+    {
+        // Stopped or already started.
+        return S_OK;
+    }
+
+    soundState = SS_PLAYING;
+
+    HRESULT hr = pSourceVoice->Start();
+    if (FAILED(hr))
+    {
+        soundState = SS_NOT_PLAYING;
+
+        return hr;
+    }
+
+    if (bSoundStoppedManually)
+    {
+        // stopSound() was called after the exchange and may have stopped the voice before it was started.
+        pSourceVoice->Stop();
+    }
+
+
+    return S_OK;
+}
+
+void SSound::allocateStreamingBuffers()
+{
+    // Each buffer holds 'dStreamingReadAheadInSec / (iStreamingBufferCount - 1)' of audio (whole frames).
+
+    iStreamingBufferCount = iStreamingBufferCountSetting;
+
+    size_t iBlockAlign = soundFormat.nBlockAlign;
+    if (iBlockAlign == 0)
+    {
+        iBlockAlign = 1;
+    }
+
+    size_t iFrameCount = static_cast<size_t>(std::ceil(dStreamingReadAheadInSec * soundFormat.nSamplesPerSec / (iStreamingBufferCount - 1)));
+    if (iFrameCount == 0)
+    {
+        iFrameCount = 1;
+    }
+
+    iStreamingBufferSizeInBytes = iFrameCount * iBlockAlign;
+
+    streamingRing.setup(iStreamingBufferCount * iStreamingBufferSizeInBytes);
+
+    iStreamingUnderrunCount = 0;
+    iStreamingDiscardUntil = 0;
+    bStreamingPositionChanged = false;
+}
+
 bool SSound::createSourceReader(const std::wstring &sAudioFilePath, SourceReaderCallback** pAsyncSourceReaderCallback,
                                 IMFSourceReader *& pOutSourceReader, WAVEFORMATEX **pFormat, unsigned int &iWaveFormatSize, bool bOptional)
 {
@@ -1580,7 +2623,7 @@ void SSound::onPlayEnd()
        {
            break;
        }
-       else if (sourceReaderCallback.bIsEndOfStream)
+       else if (bStreamingEnded)
        {
            break;
        }
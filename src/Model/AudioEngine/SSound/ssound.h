@@ -12,6 +12,7 @@
 #include <string>
 #include <functional>
 #include <future>
+#include <atomic>
 
 // XAudio2
 #include <xaudio2.h>
@@ -19,6 +20,11 @@
 
 // Custom
 #include "AudioEngine/SAudioEngine/saudioengine.h"
+#include "AudioEngine/SWaveFile/swavefile.h"
+#include "AudioEngine/SRingBuffer/sringbuffer.h"
+#include "AudioEngine/SSeekIndex/sseekindex.h"
+#include "AudioEngine/SCrossfader/scrossfader.h"
+#include "AudioEngine/STimeStretcher/stimestretcher.h"
 
 
 class SAudioEngine;
@@ -40,6 +46,7 @@ struct SSoundInfo
     unsigned short iChannels;
     unsigned long  iSampleRate;
     unsigned short iBitsPerSample;
+    bool           bFloatingPointSamples;
     bool           bUsesVariableBitRate;
 };
 
@@ -57,6 +64,8 @@ public:
 
     // will restart the sound if playing, unpause if paused
     bool playSound    ();
+    // Streaming only, starts decoding (without playing) so that playSound() starts instantly.
+    bool preloadSound ();
     bool pauseSound   ();
     bool unpauseSound ();
     bool stopSound    ();
@@ -64,16 +73,40 @@ public:
 
 
     bool setVolume        (float fVolume);
-    // [0.03125, 32] so [-5, 5] octaves
+    // [0.03125, 32] so [-5, 5] octaves, changes the playback rate (so the tempo changes too).
     bool setPitchInFreqRatio(float fRatio);
-    // [-5, 5] octaves so [-60, 60]
+    // Streaming: [-24, 24], the tempo and the duration are kept (see STimeStretcher).
+    // Otherwise: [-5, 5] octaves so [-60, 60], same as setPitchInFreqRatio().
     bool setPitchInSemitones(float fSemitones);
+    // Streaming only, [0.25, 4] (1 - original speed), the pitch is kept.
+    bool setTempo         (float fTempo);
     bool setPan           (float fPan);
 
 
     void setOnPlayEndCallback(std::function<void(SSound*)> f);
 
 
+    // Streaming only, gain ramp applied to the decoded frames (fade in from silence or fade out to silence).
+    // Should be set before the frames are decoded (before preloadSound() for a fade in).
+    bool setFade          (S_CROSSFADE_CURVE curve, bool bFadeIn, unsigned long long iFadeStartFrame, unsigned long long iFadeFrameCount);
+    void clearFade        ();
+    // Streaming only, 'pNextSound' (preloaded) is started when this sound plays the frame 'iStartFrame'.
+    bool setCrossfadeTo   (SSound* pNextSound, unsigned long long iStartFrame);
+
+
+    // Streaming only, applied on the next loadAudioFile().
+    // 'iBufferCount' is in [3, XAUDIO2_MAX_QUEUED_BUFFERS], the decoder keeps
+    // about 'dReadAheadInSec' of audio queued (split between 'iBufferCount - 1' buffers).
+    bool setStreamingBuffering(size_t iBufferCount, double dReadAheadInSec);
+    void getStreamingBuffering(size_t& iBufferCount, double& dReadAheadInSec) const;
+
+    // How many times the queue ran dry while streaming (since the sound was loaded).
+    unsigned long long getStreamingUnderrunCount() const;
+
+    // Streaming only, seek indexes (decoded frame -> timestamp) of the files that were played to the end are stored there.
+    void setSeekIndexDirectory(const std::wstring& sSeekIndexDirectory);
+
+
     bool getVolume        (float& fVolume);
     bool getSoundInfo     (SSoundInfo& soundInfo);
     bool getSoundState    (SSoundState& state);
@@ -82,15 +115,49 @@ public:
     bool getLoadedAudioDataSizeInBytes(size_t& iSizeInBytes);
     bool isSoundStoppedManually() const;
 
+    // Appends the next decoded buffer to 'pvWaveData'.
     bool readWaveData     (std::vector<unsigned char>* pvWaveData, bool& bEndOfStream);
+    // Passes the next decoded buffer to 'onWaveData' without copying it,
+    // the data is only valid until 'onWaveData' returns.
+    bool readWaveData     (const std::function<void(const unsigned char* pData, size_t iSizeInBytes)>& onWaveData, bool& bEndOfStream);
 
 private:
 
-    bool loadFileIntoMemory(const std::wstring& sAudioFilePath, std::vector<unsigned char>& vAudioData, WAVEFORMATEX** pFormat, unsigned int& iWaveFormatSize);
+    // Returns 'true' if the file is not an uncompressed .wav file (then it should be decoded).
+    bool mapWaveFile(const std::wstring& sAudioFilePath);
+    // Decodes the whole file (see SDecoder) to 16 bit PCM.
+    bool loadFileIntoMemory(const std::wstring& sAudioFilePath, std::vector<unsigned char>& vAudioData);
 
     bool createAsyncReader(const std::wstring& sAudioFilePath, IMFSourceReader*& pSourceReader, WAVEFORMATEX** pFormat, unsigned int& iWaveFormatSize);
     bool streamAudioFile(IMFSourceReader* pAsyncReader);
     bool loopStream(IMFSourceReader* pAsyncReader, IXAudio2SourceVoice* pSourceVoice);
+    // Streams the mapped file (see mapWaveFile()) instead of decoding it.
+    bool loopMappedStream(IXAudio2SourceVoice* pSourceVoice);
+    // Called by the decoder thread at the end of the stream, waits for the voice to play what's left.
+    void finishStream(IXAudio2SourceVoice* pSourceVoice);
+    void allocateStreamingBuffers();
+    // Called by the decoder thread (under 'mtxStreamingRead') after each read sample.
+    void updateSeekIndex();
+    std::wstring getSeekIndexPath();
+    // Called by the decoder thread, everything that was written to the ring so far will not be played.
+    void requestStreamingDiscard();
+    // Called on the XAudio2 thread.
+    void submitFromStreamingRing();
+    void releaseStreamingBuffer(void* pBufferContext);
+    // Called on the XAudio2 thread, starts the next sound without locking.
+    void checkCrossfadeStart();
+    // Called by the decoder thread, shows the error of the last crossfade start (if any).
+    void reportCrossfadeStartError();
+    // Source frame that is being played (streaming).
+    unsigned long long getStreamingPlayedFrame();
+    // Called by the decoder thread (under 'mtxStreamingRead'), the result is in 'vStretchedData'.
+    void stretchDecodedData(const unsigned char* pData, size_t iSizeInBytes, bool bEndOfStream);
+    // Called by the decoder thread, returns 'true' if the streaming should stop.
+    bool writeToStreamingRing(const unsigned char* pData, size_t iSizeInBytes);
+    // Decodes the buffered audio again with the new tempo/pitch.
+    bool applyTimeStretchChange();
+    // Lock-free (see checkCrossfadeStart()), returns S_OK if the sound was stopped or already started.
+    HRESULT startPreloadedVoice();
 
     bool createSourceReader(const std::wstring& sAudioFilePath, SourceReaderCallback** pAsyncSourceReaderCallback,
                             IMFSourceReader*& pOutSourceReader, WAVEFORMATEX** pFormat, unsigned int& iWaveFormatSize, bool bOptional = false);
@@ -128,15 +195,60 @@ private:
     SourceReaderCallback   sourceReaderCallback;
     VoiceCallback          voiceCallback;
     bool bStopStreaming = false;
-    static const int iMaxBufferDuringStreaming = 3; // see XAUDIO2_MAX_QUEUED_BUFFERS
+    static const int iDefaultStreamingBufferCount = 8; // see XAUDIO2_MAX_QUEUED_BUFFERS
+    static constexpr double dDefaultStreamingReadAheadInSec = 1.0;
+    static const int iLoadReserveSlackInMs = 500; // extra space reserved in loadFileIntoMemory()
 
 
+    SWaveFile                  waveFile; // uncompressed .wav files are played right from the mapped file (in both modes)
+    size_t                     iMappedReadPosInBytes; // see readWaveData()
     // Used in sync mode.
     std::vector<unsigned char> vAudioData;
-    std::vector<unsigned char> vSpeedChangedAudioData;
     // Used in async mode (streaming).
-    size_t vSizeOfBuffers[iMaxBufferDuringStreaming] = { 0 };
-    std::unique_ptr<uint8_t[]> vBuffers[iMaxBufferDuringStreaming];
+    // The decoder thread writes to the ring, the voice callback submits parts of the ring
+    // (up to 'iStreamingBufferCount - 1' buffers of 'iStreamingBufferSizeInBytes') and frees them on buffer end.
+    SRingBuffer    streamingRing;
+    size_t         iStreamingBufferCountSetting;
+    size_t         iStreamingBufferCount;
+    size_t         iStreamingBufferSizeInBytes;
+    double         dStreamingReadAheadInSec;
+    std::atomic<unsigned long long> iStreamingUnderrunCount;
+    std::atomic<unsigned long long> iStreamingDiscardUntil;
+    std::atomic<unsigned int>       iStreamingGeneration;
+    std::atomic<bool>              bStreamingRingActive;
+    std::atomic<bool>              bStreamingEnded;
+    bool           bStreamingPositionChanged;
+    // Only used on the XAudio2 thread.
+    unsigned int   iSubmitGeneration;
+    size_t         iSubmittedBufferCount;
+    size_t         iSubmittedSizeInBytes;
+    bool           bSubmitStarted;
+    bool           bSubmitStarving;
+    // Seeking (under 'mtxStreamingRead').
+    SSeekIndex     seekIndex;
+    std::wstring   sSeekIndexDirectory;
+    unsigned long long iDecodedFrame;
+    unsigned long long iSeekTargetFrame;
+    std::atomic<unsigned long long> iStreamingBaseFrame;
+    size_t         iSkipSizeInBytes;
+    bool           bDecodedFrameExact;
+    bool           bSeekPending;
+    size_t         iMappedStreamPosInBytes; // next read position in 'waveFile'
+    static const unsigned int iMaxSeekSkipInSec = 10; // decode at most this much to seek to the exact frame
+    // Crossfade.
+    SCrossfader    fade; // under 'mtxStreamingRead'
+    std::vector<unsigned char> vMappedFadeData;
+    unsigned long long iLastSampleFirstFrame;
+    std::atomic<SSound*>            pCrossfadeTo;
+    std::atomic<unsigned long long> iCrossfadeStartFrame;
+    std::atomic<HRESULT>            iCrossfadeStartResult; // set on the XAudio2 thread, see reportCrossfadeStartError()
+    // Tempo and pitch.
+    STimeStretcher timeStretcher; // under 'mtxStreamingRead'
+    std::vector<float>         vStretchInput;
+    std::vector<float>         vStretchOutput;
+    std::vector<unsigned char> vStretchedData;
+    std::atomic<double>        dStreamingBaseTempo; // tempo of the audio played after 'iStreamingBaseFrame'
+    std::atomic<bool>          bTimeStretchChanged; // while paused, applied on unpause
 
 
     std::promise<bool> promiseStreaming;
@@ -148,7 +260,7 @@ private:
     std::mutex     mtxStreamingSwitch;
     std::mutex     mtxSoundState;
     std::mutex     mtxOptionalSourceReaderRead;
-    std::mutex     mtxStreamingReadSampleSubmit;
+    std::mutex     mtxStreamingRead;
 
 
     std::wstring   sAudioFileDiskPath;
@@ -157,20 +269,20 @@ private:
     XAUDIO2_BUFFER audioBuffer;
     WAVEFORMATEX   soundFormat;
     unsigned int   iWaveFormatSize;
-    double         dCurrentStreamingPosInSec;
     unsigned long long iSamplesPlayedOnLastSetPos;
     size_t         iLastReadSampleSize;
 
     SSoundInfo     soundInfo;
 
-    SSoundState    soundState;
+    std::atomic<SSoundState> soundState; // changed under 'mtxSoundState' except by startPreloadedVoice()
 
     size_t         iCurrentEffectIndex;
 
     bool           bUseStreaming;
+    std::atomic<bool> bPreloaded;
     bool           bCurrentlyStreaming;
     bool           bSoundLoaded;
-    bool           bSoundStoppedManually;
+    std::atomic<bool> bSoundStoppedManually;
     bool           bCalledOnPlayEnd;
     bool           bDestroyCalled;
     bool           bEffectsSet;
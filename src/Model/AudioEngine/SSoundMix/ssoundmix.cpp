@@ -9,6 +9,8 @@
 
 // Custom
 #include "AudioEngine/SAudioEngine/saudioengine.h"
+#include "AudioEngine/SOfflineRenderer/sofflinerenderer.h"
+#include "AudioEngine/SEffectXAPO/seffectxapo.h"
 
 SSoundMix::SSoundMix(SAudioEngine* pAudioEngine)
 {
@@ -86,6 +88,7 @@ bool SSoundMix::setAudioEffects(std::vector<SAudioEffect> *pvEffects)
         pSubmixVoiceFX->SetVolume(0.0f);
 
         vEnabledEffects.clear();
+        vEffects.clear();
 
         if (pvEffects->size() == 0)
         {
@@ -102,26 +105,8 @@ bool SSoundMix::setAudioEffects(std::vector<SAudioEffect> *pvEffects)
 
     for (size_t i = 0; i < pvEffects->size(); i++)
     {
-        hr = S_OK;
-
-        switch(pvEffects->operator[](i).effectType)
-        {
-        case(ET_REVERB):
-        {
-            hr = CreateFX(__uuidof(FXReverb), &vXAPO[i]);
-            break;
-        }
-        case(ET_EQ):
-        {
-            hr = CreateFX(__uuidof(FXEQ), &vXAPO[i]);
-            break;
-        }
-        case(ET_ECHO):
-        {
-            hr = CreateFX(__uuidof(FXEcho), &vXAPO[i]);
-            break;
-        }
-        }
+        // Native effects instead of CreateFX() (same parameters).
+        vXAPO[i] = static_cast<IXAPO*>(new SEffectXAPO(pvEffects->operator[](i).effectType));
 
         if (pvEffects->operator[](i).bEnable && bEnableSound == false)
         {
@@ -129,12 +114,6 @@ bool SSoundMix::setAudioEffects(std::vector<SAudioEffect> *pvEffects)
         }
 
         vEnabledEffects.push_back(pvEffects->operator[](i).bEnable);
-
-        if (FAILED(hr))
-        {
-            pAudioEngine->showError(hr, L"SSoundMix::setAudioEffects::CreateFX()");
-            return true;
-        }
     }
 
     if (bEnableSound)
@@ -200,6 +179,8 @@ bool SSoundMix::setAudioEffects(std::vector<SAudioEffect> *pvEffects)
     }
 
 
+    vEffects = *pvEffects;
+
     bEffectsSet = true;
 
     return false;
@@ -233,6 +214,7 @@ bool SSoundMix::setEnableAudioEffect(unsigned int iEffectIndex, bool bEnable)
     }
 
     vEnabledEffects[iEffectIndex] = bEnable;
+    vEffects[iEffectIndex].setEnableEffect(bEnable);
 
     for (size_t i = 0; i < vEnabledEffects.size(); i++)
     {
@@ -282,6 +264,10 @@ bool SSoundMix::setAudioEffectParameters(unsigned int iEffectIndex, SAudioEffect
         return true;
     }
 
+    bool bEnable = vEffects[iEffectIndex].isEnabled();
+    vEffects[iEffectIndex] = *params;
+    vEffects[iEffectIndex].setEnableEffect(bEnable);
+
     return false;
 }
 
@@ -295,6 +281,17 @@ void SSoundMix::getFXVolume(float &fFXVolume)
     fFXVolume = this->fFXVolume;
 }
 
+void SSoundMix::getRenderSettings(SRenderSettings &settings)
+{
+    settings.vEffects = vEffects;
+    settings.fFXVolume = fFXVolume;
+
+    getVolume(settings.fVolume);
+
+    settings.iOutputSampleRate = 44100;
+    settings.iOutputChannels = bMonoOutput ? 1 : 2;
+}
+
 SSoundMix::~SSoundMix()
 {
     if (pSubmixVoice)
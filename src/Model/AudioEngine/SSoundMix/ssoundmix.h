@@ -12,6 +12,7 @@
 
 class SAudioEngine;
 class SAudioEffect;
+struct SRenderSettings;
 
 class SSoundMix
 {
@@ -34,6 +35,10 @@ public:
     void getFXVolume(float& fFXVolume);
 
 
+    // Fills the effect chain, volumes and the format of this mix (for SOfflineRenderer).
+    void getRenderSettings(SRenderSettings& settings);
+
+
 
     ~SSoundMix();
 
@@ -54,6 +59,7 @@ private:
 
 
     std::vector<bool> vEnabledEffects;
+    std::vector<SAudioEffect> vEffects; // copy of the current chain
 
 
     float fFXVolume = 1.0f;
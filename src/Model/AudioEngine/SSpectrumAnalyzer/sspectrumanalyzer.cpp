@@ -0,0 +1,369 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sspectrumanalyzer.h"
+
+// STL
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define S_SPECTRUM_SSE
+#endif
+
+
+SSpectrumAnalyzer::SSpectrumAnalyzer()
+{
+    format.iSampleRate = 0;
+    format.iChannels = 0;
+
+    std::memset(vMonoChunk, 0, sizeof(vMonoChunk));
+
+    fPowerScale = 1.0f;
+
+    dTotalSpectrumTimeInUs = 0.0;
+    iSpectrumCount = 0;
+
+    iFFTSize = 0;
+    iBandCount = 0;
+    fMinFrequency = 0.0f;
+    fMaxFrequency = 0.0f;
+
+    iWrittenFrameCount = 0;
+    bOpen = false;
+}
+
+bool SSpectrumAnalyzer::setup(size_t iFFTSize, size_t iBandCount, float fMinFrequency, float fMaxFrequency)
+{
+    if (bOpen || iBandCount == 0 || fMinFrequency <= 0.0f || fMaxFrequency <= fMinFrequency)
+    {
+        return true;
+    }
+
+    if (fft.setup(iFFTSize))
+    {
+        return true;
+    }
+
+    this->iFFTSize = iFFTSize;
+    this->iBandCount = iBandCount;
+    this->fMinFrequency = fMinFrequency;
+    this->fMaxFrequency = fMaxFrequency;
+
+
+    // Hann window.
+
+    const double dPi = 3.14159265358979323846;
+
+    vWindow.resize(iFFTSize);
+
+    double dWindowSum = 0.0;
+    for (size_t i = 0; i < iFFTSize; i++)
+    {
+        vWindow[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * dPi * i / iFFTSize));
+        dWindowSum += vWindow[i];
+    }
+
+    // The peak of a sine with the amplitude 'A' is 'A * sum(window) / 2'.
+    fPowerScale = static_cast<float>(4.0 / (dWindowSum * dWindowSum));
+
+
+    vHistory.assign(iFFTSize, 0.0f);
+    vReal.resize(iFFTSize);
+    vImag.resize(iFFTSize);
+    vPower.resize(iFFTSize / 2 + 1);
+
+    vBandFirstBin.resize(iBandCount);
+    vBandLastBin.resize(iBandCount);
+    vBandLevels.assign(iBandCount, 0.0f);
+
+    return false;
+}
+
+bool SSpectrumAnalyzer::open(const SAudioSinkFormat &format)
+{
+    if (format.iSampleRate == 0 || format.iChannels == 0 || iFFTSize == 0)
+    {
+        return true;
+    }
+
+    this->format = format;
+
+
+    // Room for a few analysis frames (the consumer only needs the last 'iFFTSize' samples).
+    ring.setup(iFFTSize * 4 * sizeof(float));
+
+    std::fill(vHistory.begin(), vHistory.end(), 0.0f);
+    std::fill(vBandLevels.begin(), vBandLevels.end(), 0.0f);
+
+
+    // Bands (each has at least one bin, the lowest bands may share the same bin).
+
+    const double dBinWidth = static_cast<double>(format.iSampleRate) / iFFTSize;
+    const size_t iLastBin  = iFFTSize / 2;
+
+    for (size_t i = 0; i < iBandCount; i++)
+    {
+        const double dLowFrequency  = fMinFrequency * std::pow(static_cast<double>(fMaxFrequency) / fMinFrequency, static_cast<double>(i) / iBandCount);
+        const double dHighFrequency = fMinFrequency * std::pow(static_cast<double>(fMaxFrequency) / fMinFrequency, static_cast<double>(i + 1) / iBandCount);
+
+        size_t iFirstBin = static_cast<size_t>(std::llround(dLowFrequency / dBinWidth));
+        size_t iBandLastBin = static_cast<size_t>(std::llround(dHighFrequency / dBinWidth));
+
+        if (iBandLastBin > iFirstBin)
+        {
+            iBandLastBin--;
+        }
+
+        if (iFirstBin > iLastBin)
+        {
+            iFirstBin = iLastBin;
+        }
+
+        if (iBandLastBin > iLastBin)
+        {
+            iBandLastBin = iLastBin;
+        }
+
+        vBandFirstBin[i] = iFirstBin;
+        vBandLastBin[i]  = iBandLastBin;
+    }
+
+
+    lastSpectrumTime = std::chrono::steady_clock::now();
+    dTotalSpectrumTimeInUs = 0.0;
+    iSpectrumCount = 0;
+
+    iWrittenFrameCount = 0;
+    bOpen = true;
+
+    return false;
+}
+
+bool SSpectrumAnalyzer::write(const float *pSamples, size_t iFrameCount)
+{
+    if (bOpen == false)
+    {
+        return true;
+    }
+
+
+    const unsigned short iChannels = format.iChannels;
+    const float fChannelScale = 1.0f / iChannels;
+
+    for (size_t iOffset = 0; iOffset < iFrameCount; iOffset += iChunkFrameCount)
+    {
+        size_t iCount = iFrameCount - iOffset;
+        if (iCount > iChunkFrameCount)
+        {
+            iCount = iChunkFrameCount;
+        }
+
+        const float* pFrames = pSamples + iOffset * iChannels;
+
+        if (iChannels == 2)
+        {
+            for (size_t i = 0; i < iCount; i++)
+            {
+                vMonoChunk[i] = (pFrames[i * 2] + pFrames[i * 2 + 1]) * 0.5f;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < iCount; i++)
+            {
+                float fSum = 0.0f;
+
+                for (unsigned short iChannel = 0; iChannel < iChannels; iChannel++)
+                {
+                    fSum += pFrames[i * iChannels + iChannel];
+                }
+
+                vMonoChunk[i] = fSum * fChannelScale;
+            }
+        }
+
+        // If the consumer is slow the new samples are dropped (it will catch up on the next frame).
+        ring.write(reinterpret_cast<const unsigned char*>(vMonoChunk), iCount * sizeof(float));
+    }
+
+
+    iWrittenFrameCount += iFrameCount;
+
+    return false;
+}
+
+bool SSpectrumAnalyzer::close()
+{
+    bOpen = false;
+
+    return false;
+}
+
+bool SSpectrumAnalyzer::isOpen() const
+{
+    return bOpen;
+}
+
+unsigned long long SSpectrumAnalyzer::getWrittenFrameCount() const
+{
+    return iWrittenFrameCount;
+}
+
+bool SSpectrumAnalyzer::getSpectrum(float *pOutBands)
+{
+    if (bOpen == false)
+    {
+        return true;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+
+    // Move the new samples to the end of the history (older samples than 'iFFTSize' are skipped).
+
+    size_t iNewCount = ring.getReadableSize() / sizeof(float);
+
+    if (iNewCount > iFFTSize)
+    {
+        ring.consume((iNewCount - iFFTSize) * sizeof(float));
+        iNewCount = iFFTSize;
+    }
+
+    if (iNewCount > 0)
+    {
+        std::memmove(vHistory.data(), vHistory.data() + iNewCount, (iFFTSize - iNewCount) * sizeof(float));
+        ring.read(reinterpret_cast<unsigned char*>(vHistory.data() + iFFTSize - iNewCount), iNewCount * sizeof(float));
+    }
+
+
+    // The levels fall off with the same speed at any frame rate.
+
+    const float fElapsedInSec = std::chrono::duration<float>(startTime - lastSpectrumTime).count();
+    lastSpectrumTime = startTime;
+
+    const float fFallOff = FALL_OFF_PER_SEC * fElapsedInSec;
+
+    for (size_t i = 0; i < iBandCount; i++)
+    {
+        vBandLevels[i] -= fFallOff;
+    }
+
+    analyze();
+
+    std::memcpy(pOutBands, vBandLevels.data(), iBandCount * sizeof(float));
+
+
+    dTotalSpectrumTimeInUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+    iSpectrumCount++;
+
+    return false;
+}
+
+size_t SSpectrumAnalyzer::getBandCount() const
+{
+    return iBandCount;
+}
+
+double SSpectrumAnalyzer::getAverageSpectrumTimeInUs() const
+{
+    if (iSpectrumCount == 0)
+    {
+        return 0.0;
+    }
+
+    return dTotalSpectrumTimeInUs / iSpectrumCount;
+}
+
+void SSpectrumAnalyzer::analyze()
+{
+    const size_t iBinCount = iFFTSize / 2 + 1;
+
+
+    // Window.
+
+    size_t i = 0;
+
+#if defined(S_SPECTRUM_SSE)
+    for (; i + 4 <= iFFTSize; i += 4)
+    {
+        _mm_storeu_ps(&vReal[i], _mm_mul_ps(_mm_loadu_ps(&vHistory[i]), _mm_loadu_ps(&vWindow[i])));
+    }
+#endif
+
+    for (; i < iFFTSize; i++)
+    {
+        vReal[i] = vHistory[i] * vWindow[i];
+    }
+
+    std::memset(vImag.data(), 0, iFFTSize * sizeof(float));
+
+
+    fft.forward(vReal.data(), vImag.data());
+
+
+    // Power of the bins.
+
+    i = 0;
+
+#if defined(S_SPECTRUM_SSE)
+    const __m128 scale = _mm_set1_ps(fPowerScale);
+
+    for (; i + 4 <= iBinCount; i += 4)
+    {
+        const __m128 re = _mm_loadu_ps(&vReal[i]);
+        const __m128 im = _mm_loadu_ps(&vImag[i]);
+
+        _mm_storeu_ps(&vPower[i], _mm_mul_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)), scale));
+    }
+#endif
+
+    for (; i < iBinCount; i++)
+    {
+        vPower[i] = (vReal[i] * vReal[i] + vImag[i] * vImag[i]) * fPowerScale;
+    }
+
+
+    // Bands (the loudest bin).
+
+    for (size_t iBand = 0; iBand < iBandCount; iBand++)
+    {
+        float fMaxPower = 0.0f;
+
+        for (size_t iBin = vBandFirstBin[iBand]; iBin <= vBandLastBin[iBand]; iBin++)
+        {
+            if (vPower[iBin] > fMaxPower)
+            {
+                fMaxPower = vPower[iBin];
+            }
+        }
+
+        const float fLevelInDB = 10.0f * std::log10(fMaxPower + 1e-20f);
+
+        float fLevel = (fLevelInDB - MIN_LEVEL_IN_DB) / -MIN_LEVEL_IN_DB;
+
+        if (fLevel > 1.0f)
+        {
+            fLevel = 1.0f;
+        }
+
+        // Falling level (see getSpectrum()).
+        if (fLevel < vBandLevels[iBand])
+        {
+            fLevel = vBandLevels[iBand];
+        }
+
+        if (fLevel < 0.0f)
+        {
+            fLevel = 0.0f;
+        }
+
+        vBandLevels[iBand] = fLevel;
+    }
+}
@@ -0,0 +1,95 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+// Custom
+#include "AudioEngine/SAudioSink/saudiosink.h"
+#include "AudioEngine/SRingBuffer/sringbuffer.h"
+#include "AudioEngine/SFFT/sfft.h"
+
+
+// Spectrum of the final mix (set as the analyzer sink of SAudioEngine).
+// write() (XAudio2 thread) only downmixes to mono and puts the samples to a lock-free ring,
+// the FFT is done in getSpectrum() on the consumer thread (UI), nothing is allocated after open().
+class SSpectrumAnalyzer : public SAudioSink
+{
+public:
+
+    SSpectrumAnalyzer();
+
+
+    // Should be called before open(), returns 'true' if the parameters are invalid.
+    // 'iFFTSize' should be a power of two, the bands are spaced logarithmically in ['fMinFrequency', 'fMaxFrequency'].
+    bool setup  (size_t iFFTSize, size_t iBandCount, float fMinFrequency, float fMaxFrequency);
+
+
+    bool open   (const SAudioSinkFormat& format) override;
+    bool write  (const float* pSamples, size_t iFrameCount) override;
+    bool close  () override;
+
+
+    bool isOpen () const override;
+    unsigned long long getWrittenFrameCount() const override;
+
+
+    // Consumer (one thread).
+    // 'pOutBands' should have space for getBandCount() values, each in [0, 1] (MIN_LEVEL_IN_DB to 0 dB),
+    // the levels fall off smoothly. Returns 'true' if not opened.
+    bool   getSpectrum       (float* pOutBands);
+    size_t getBandCount      () const;
+
+    // Average time of one getSpectrum() call (for benchmarks).
+    double getAverageSpectrumTimeInUs() const;
+
+
+    static constexpr float MIN_LEVEL_IN_DB = -80.0f;
+    static constexpr float FALL_OFF_PER_SEC = 1.5f; // in levels per second
+
+private:
+
+    // Windowed FFT of 'vHistory' to the band levels in 'vBandLevels'.
+    void analyze            ();
+
+
+    static const size_t iChunkFrameCount = 256;
+
+
+    SAudioSinkFormat   format;
+
+    SRingBuffer        ring;                   // mono float samples
+    float              vMonoChunk[iChunkFrameCount];
+
+    SFFT               fft;
+    std::vector<float> vWindow;
+    std::vector<float> vHistory;               // last 'iFFTSize' samples
+    std::vector<float> vReal;
+    std::vector<float> vImag;
+    std::vector<float> vPower;
+    float              fPowerScale;            // full scale sine -> 1.0
+
+    std::vector<size_t> vBandFirstBin;
+    std::vector<size_t> vBandLastBin;
+    std::vector<float>  vBandLevels;
+
+    std::chrono::steady_clock::time_point lastSpectrumTime;
+    double             dTotalSpectrumTimeInUs;
+    unsigned long long iSpectrumCount;
+
+    size_t             iFFTSize;
+    size_t             iBandCount;
+    float              fMinFrequency;
+    float              fMaxFrequency;
+
+    std::atomic<unsigned long long> iWrittenFrameCount;
+    std::atomic<bool>  bOpen;
+};
@@ -0,0 +1,495 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "stimestretcher.h"
+
+// STL
+#include <cmath>
+#include <algorithm>
+
+
+namespace
+{
+    const double dPi    = 3.14159265358979323846;
+    const double dTwoPi = 2.0 * dPi;
+
+    // Hann window squared, overlapped every quarter of the frame.
+    const double dOverlapAddGain = 1.5;
+}
+
+
+STimeStretcher::STimeStretcher()
+{
+    dTempo            = 1.0;
+    dPitchInSemitones = 0.0;
+    dPitchRatio       = 1.0;
+
+    dAnalysisPos    = 0.0;
+    dAnalysisHop    = iSynthesisHop;
+    iLastFrameStart = 0;
+    bFirstFrame     = true;
+
+    iDropFrameCount      = 0;
+    iInputFrameCount     = 0;
+    iStretchedFrameCount = 0;
+
+    iChannels = 0;
+
+
+    fft.setup(iFrameSize);
+
+    vWindow.resize(iFrameSize);
+    for (size_t i = 0; i < iFrameSize; i++)
+    {
+        vWindow[i] = static_cast<float>(0.5 - 0.5 * std::cos(dTwoPi * i / iFrameSize));
+    }
+
+    vReal.resize(iFrameSize);
+    vImag.resize(iFrameSize);
+    vMagnitude.resize(iBinCount * 2);
+    vPhase.resize(iBinCount * 2);
+    vSynthesisPhase.resize(iBinCount * 2);
+}
+
+bool STimeStretcher::setup(unsigned short iChannels)
+{
+    if (iChannels == 0)
+    {
+        return true;
+    }
+
+    this->iChannels = iChannels;
+
+    reset();
+
+    return false;
+}
+
+void STimeStretcher::setTempo(double dTempo)
+{
+    if (dTempo < MIN_TEMPO) dTempo = MIN_TEMPO;
+    if (dTempo > MAX_TEMPO) dTempo = MAX_TEMPO;
+
+    this->dTempo = dTempo;
+
+    updateHops();
+}
+
+void STimeStretcher::setPitchInSemitones(double dSemitones)
+{
+    if (dSemitones < -MAX_PITCH_IN_SEMITONES) dSemitones = -MAX_PITCH_IN_SEMITONES;
+    if (dSemitones > MAX_PITCH_IN_SEMITONES)  dSemitones = MAX_PITCH_IN_SEMITONES;
+
+    dPitchInSemitones = dSemitones;
+    dPitchRatio       = std::pow(2.0, dSemitones / 12.0);
+
+    updateHops();
+
+    if (iChannels != 0)
+    {
+        resampler.setup(iChannels, dPitchRatio);
+    }
+}
+
+double STimeStretcher::getTempo() const
+{
+    return dTempo;
+}
+
+double STimeStretcher::getPitchInSemitones() const
+{
+    return dPitchInSemitones;
+}
+
+bool STimeStretcher::isBypassed() const
+{
+    return dTempo == 1.0 && dPitchInSemitones == 0.0;
+}
+
+void STimeStretcher::reset()
+{
+    // Half a frame of silence before the input so that the first frame is centered on the first input frame
+    // (the same amount of output is dropped).
+
+    vInput.assign((iFrameSize / 2) * iChannels, 0.0f);
+    dAnalysisPos    = 0.0;
+    iLastFrameStart = 0;
+    bFirstFrame     = true;
+
+    vOverlapAdd.assign(iFrameSize * iChannels, 0.0f);
+    iDropFrameCount = iFrameSize / 2;
+
+    iInputFrameCount     = 0;
+    iStretchedFrameCount = 0;
+
+    vLastAnalysisPhase.assign(iBinCount * iChannels, 0.0f);
+    vLastSynthesisPhase.assign(iBinCount * iChannels, 0.0f);
+
+    resampler.setup(iChannels, dPitchRatio);
+}
+
+void STimeStretcher::process(const float *pSamples, size_t iFrameCount, std::vector<float> &vOutSamples)
+{
+    if (iChannels == 0)
+    {
+        return;
+    }
+
+    if (isBypassed())
+    {
+        vOutSamples.insert(vOutSamples.end(), pSamples, pSamples + iFrameCount * iChannels);
+        return;
+    }
+
+
+    vInput.insert(vInput.end(), pSamples, pSamples + iFrameCount * iChannels);
+    iInputFrameCount += iFrameCount;
+
+    vStretched.clear();
+
+    const size_t iInputFrames = vInput.size() / iChannels;
+
+    while (true)
+    {
+        const size_t iFrameStart = static_cast<size_t>(std::llround(dAnalysisPos));
+        if (iFrameStart + iFrameSize > iInputFrames)
+        {
+            break;
+        }
+
+        processFrame(iFrameStart, vStretched);
+
+        dAnalysisPos += dAnalysisHop;
+    }
+
+
+    // Remove the input that will not be used again.
+
+    size_t iUsedFrames = static_cast<size_t>(std::floor(dAnalysisPos));
+    if (iUsedFrames > iInputFrames)
+    {
+        iUsedFrames = iInputFrames;
+    }
+
+    if (iUsedFrames > 0)
+    {
+        vInput.erase(vInput.begin(), vInput.begin() + iUsedFrames * iChannels);
+
+        dAnalysisPos    -= iUsedFrames;
+        iLastFrameStart -= static_cast<long long>(iUsedFrames);
+    }
+
+
+    stretchedToOutput(vStretched, vOutSamples);
+}
+
+void STimeStretcher::flush(std::vector<float> &vOutSamples)
+{
+    if (iChannels == 0 || isBypassed())
+    {
+        return;
+    }
+
+
+    // Feed silence until all of the input is out.
+
+    const unsigned long long iExpectedFrameCount = static_cast<unsigned long long>(std::llround(iInputFrameCount * dPitchRatio / dTempo));
+
+    std::vector<float> vAllStretched;
+    const std::vector<float> vSilence(iFrameSize * iChannels, 0.0f);
+
+    while (iStretchedFrameCount < iExpectedFrameCount)
+    {
+        vInput.insert(vInput.end(), vSilence.begin(), vSilence.end());
+
+        const size_t iInputFrames = vInput.size() / iChannels;
+
+        vStretched.clear();
+
+        while (true)
+        {
+            const size_t iFrameStart = static_cast<size_t>(std::llround(dAnalysisPos));
+            if (iFrameStart + iFrameSize > iInputFrames)
+            {
+                break;
+            }
+
+            processFrame(iFrameStart, vStretched);
+
+            dAnalysisPos += dAnalysisHop;
+        }
+
+        vAllStretched.insert(vAllStretched.end(), vStretched.begin(), vStretched.end());
+    }
+
+
+    // Cut the silence.
+
+    const unsigned long long iExtraFrameCount = iStretchedFrameCount - iExpectedFrameCount;
+    vAllStretched.resize(vAllStretched.size() - static_cast<size_t>(iExtraFrameCount) * iChannels);
+
+    stretchedToOutput(vAllStretched, vOutSamples);
+
+    if (dPitchRatio != 1.0)
+    {
+        resampler.flush(vOutSamples);
+    }
+}
+
+void STimeStretcher::updateHops()
+{
+    // Output hop is fixed, the input hop sets the duration change.
+
+    dAnalysisHop = iSynthesisHop * dTempo / dPitchRatio;
+
+    if (dAnalysisHop < 1.0)
+    {
+        dAnalysisHop = 1.0;
+    }
+}
+
+void STimeStretcher::processFrame(size_t iFrameStart, std::vector<float> &vStretched)
+{
+    const float* pFrame = vInput.data() + iFrameStart * iChannels;
+
+    const float fOutputScale = static_cast<float>(1.0 / (iFrameSize * dOverlapAddGain));
+
+    // The input hop that was actually used (frame starts are rounded).
+    double dHop = static_cast<double>(static_cast<long long>(iFrameStart) - iLastFrameStart);
+    if (dHop < 1.0)
+    {
+        dHop = 1.0;
+    }
+
+
+    // Two channels at once (one as the real part, the other one as the imaginary part).
+
+    for (unsigned short iFirstChannel = 0; iFirstChannel < iChannels; iFirstChannel += 2)
+    {
+        const bool bPair = (iFirstChannel + 1 < iChannels);
+
+        for (size_t i = 0; i < iFrameSize; i++)
+        {
+            vReal[i] = pFrame[i * iChannels + iFirstChannel] * vWindow[i];
+            vImag[i] = bPair ? pFrame[i * iChannels + iFirstChannel + 1] * vWindow[i] : 0.0f;
+        }
+
+        fft.forward(vReal.data(), vImag.data());
+
+
+        // Split the spectrum of the two real signals.
+
+        float* pMagnitude[2] = {vMagnitude.data(), vMagnitude.data() + iBinCount};
+        float* pPhase[2]     = {vPhase.data(), vPhase.data() + iBinCount};
+        float* pSynthesis[2] = {vSynthesisPhase.data(), vSynthesisPhase.data() + iBinCount};
+
+        for (size_t k = 0; k < iBinCount; k++)
+        {
+            const size_t iMirror = (iFrameSize - k) % iFrameSize;
+
+            const float fLeftReal  = 0.5f * (vReal[k] + vReal[iMirror]);
+            const float fLeftImag  = 0.5f * (vImag[k] - vImag[iMirror]);
+            const float fRightReal = 0.5f * (vImag[k] + vImag[iMirror]);
+            const float fRightImag = 0.5f * (vReal[iMirror] - vReal[k]);
+
+            pMagnitude[0][k] = std::sqrt(fLeftReal * fLeftReal + fLeftImag * fLeftImag);
+            pPhase[0][k]     = std::atan2(fLeftImag, fLeftReal);
+            pMagnitude[1][k] = std::sqrt(fRightReal * fRightReal + fRightImag * fRightImag);
+            pPhase[1][k]     = std::atan2(fRightImag, fRightReal);
+        }
+
+        advancePhases(iFirstChannel, dHop, pMagnitude[0], pPhase[0], pSynthesis[0]);
+        if (bPair)
+        {
+            advancePhases(iFirstChannel + 1, dHop, pMagnitude[1], pPhase[1], pSynthesis[1]);
+        }
+        else
+        {
+            std::fill(pMagnitude[1], pMagnitude[1] + iBinCount, 0.0f);
+        }
+
+
+        // Join the two spectra back (Hermitian) and go back to the time domain.
+
+        for (size_t k = 0; k < iBinCount; k++)
+        {
+            float fLeftReal  = pMagnitude[0][k] * std::cos(pSynthesis[0][k]);
+            float fLeftImag  = pMagnitude[0][k] * std::sin(pSynthesis[0][k]);
+            float fRightReal = bPair ? pMagnitude[1][k] * std::cos(pSynthesis[1][k]) : 0.0f;
+            float fRightImag = bPair ? pMagnitude[1][k] * std::sin(pSynthesis[1][k]) : 0.0f;
+
+            if (k == 0 || k == iBinCount - 1)
+            {
+                // Real bins.
+                fLeftImag  = 0.0f;
+                fRightImag = 0.0f;
+            }
+
+            vReal[k] = fLeftReal - fRightImag;
+            vImag[k] = fLeftImag + fRightReal;
+
+            if (k != 0 && k != iBinCount - 1)
+            {
+                vReal[iFrameSize - k] = fLeftReal + fRightImag;
+                vImag[iFrameSize - k] = fRightReal - fLeftImag;
+            }
+        }
+
+        fft.inverse(vReal.data(), vImag.data());
+
+
+        for (size_t i = 0; i < iFrameSize; i++)
+        {
+            const float fWindow = vWindow[i] * fOutputScale;
+
+            vOverlapAdd[i * iChannels + iFirstChannel] += vReal[i] * fWindow;
+            if (bPair)
+            {
+                vOverlapAdd[i * iChannels + iFirstChannel + 1] += vImag[i] * fWindow;
+            }
+        }
+    }
+
+    iLastFrameStart = static_cast<long long>(iFrameStart);
+    bFirstFrame = false;
+
+
+    // The first hop of the overlap-add buffer is complete.
+
+    size_t iReadyFrames = iSynthesisHop;
+    size_t iFirstReadyFrame = 0;
+
+    if (iDropFrameCount > 0)
+    {
+        iFirstReadyFrame = (iDropFrameCount < iReadyFrames) ? iDropFrameCount : iReadyFrames;
+        iDropFrameCount -= iFirstReadyFrame;
+    }
+
+    vStretched.insert(vStretched.end(), vOverlapAdd.begin() + iFirstReadyFrame * iChannels, vOverlapAdd.begin() + iReadyFrames * iChannels);
+    iStretchedFrameCount += iReadyFrames - iFirstReadyFrame;
+
+    std::copy(vOverlapAdd.begin() + iSynthesisHop * iChannels, vOverlapAdd.end(), vOverlapAdd.begin());
+    std::fill(vOverlapAdd.end() - iSynthesisHop * iChannels, vOverlapAdd.end(), 0.0f);
+}
+
+void STimeStretcher::advancePhases(unsigned short iChannel, double dHop, const float *pMagnitude, const float *pPhase, float *pSynthesisPhase)
+{
+    float* pLastAnalysisPhase  = vLastAnalysisPhase.data() + iChannel * iBinCount;
+    float* pLastSynthesisPhase = vLastSynthesisPhase.data() + iChannel * iBinCount;
+
+    if (bFirstFrame)
+    {
+        std::copy(pPhase, pPhase + iBinCount, pSynthesisPhase);
+        std::copy(pPhase, pPhase + iBinCount, pLastAnalysisPhase);
+        std::copy(pPhase, pPhase + iBinCount, pLastSynthesisPhase);
+
+        return;
+    }
+
+
+    // Peaks (louder than 2 bins on each side).
+
+    vPeaks.clear();
+
+    for (size_t k = 2; k + 2 < iBinCount; k++)
+    {
+        if (pMagnitude[k] > pMagnitude[k - 1] && pMagnitude[k] >= pMagnitude[k + 1]
+            && pMagnitude[k] > pMagnitude[k - 2] && pMagnitude[k] >= pMagnitude[k + 2])
+        {
+            vPeaks.push_back(k);
+        }
+    }
+
+
+    if (vPeaks.empty())
+    {
+        // Noise or silence, advance every bin on its own.
+
+        for (size_t k = 0; k < iBinCount; k++)
+        {
+            vPeaks.push_back(k);
+        }
+    }
+
+
+    // Phase of the peaks from their true frequency.
+
+    for (size_t i = 0; i < vPeaks.size(); i++)
+    {
+        const size_t k = vPeaks[i];
+
+        const double dBinFrequency = dTwoPi * k / iFrameSize;
+
+        double dDelta = pPhase[k] - pLastAnalysisPhase[k] - dBinFrequency * dHop;
+        dDelta -= dTwoPi * std::floor(dDelta / dTwoPi + 0.5);
+
+        const double dTrueFrequency = dBinFrequency + dDelta / dHop;
+
+        double dSynthesis = pLastSynthesisPhase[k] + dTrueFrequency * iSynthesisHop;
+        dSynthesis -= dTwoPi * std::floor(dSynthesis / dTwoPi + 0.5);
+
+        pSynthesisPhase[k] = static_cast<float>(dSynthesis);
+    }
+
+
+    // Other bins keep their phase relative to the peak of their region
+    // (region boundary is the quietest bin between two peaks).
+
+    size_t iRegionStart = 0;
+
+    for (size_t i = 0; i < vPeaks.size(); i++)
+    {
+        const size_t iPeak = vPeaks[i];
+
+        size_t iRegionEnd = iBinCount;
+        if (i + 1 < vPeaks.size())
+        {
+            iRegionEnd = iPeak + 1;
+            for (size_t k = iPeak + 1; k < vPeaks[i + 1]; k++)
+            {
+                if (pMagnitude[k] < pMagnitude[iRegionEnd])
+                {
+                    iRegionEnd = k;
+                }
+            }
+        }
+
+        const float fRotation = pSynthesisPhase[iPeak] - pPhase[iPeak];
+
+        for (size_t k = iRegionStart; k < iRegionEnd; k++)
+        {
+            if (k != iPeak)
+            {
+                pSynthesisPhase[k] = pPhase[k] + fRotation;
+            }
+        }
+
+        iRegionStart = iRegionEnd;
+    }
+
+
+    std::copy(pPhase, pPhase + iBinCount, pLastAnalysisPhase);
+    std::copy(pSynthesisPhase, pSynthesisPhase + iBinCount, pLastSynthesisPhase);
+}
+
+void STimeStretcher::stretchedToOutput(std::vector<float> &vStretched, std::vector<float> &vOutSamples)
+{
+    if (vStretched.empty())
+    {
+        return;
+    }
+
+    if (dPitchRatio == 1.0)
+    {
+        vOutSamples.insert(vOutSamples.end(), vStretched.begin(), vStretched.end());
+    }
+    else
+    {
+        // Back to the original duration (and a different pitch).
+        resampler.process(vStretched.data(), vStretched.size() / iChannels, vOutSamples);
+    }
+}
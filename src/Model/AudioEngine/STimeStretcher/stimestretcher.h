@@ -0,0 +1,114 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstddef>
+
+// Custom
+#include "AudioEngine/SFFT/sfft.h"
+#include "AudioEngine/SResampler/sresampler.h"
+
+
+// Streaming tempo and pitch change for interleaved float samples.
+// Phase vocoder (with identity phase locking) changes the duration by 'pitch ratio / tempo',
+// then the resampler changes the playback rate by 'pitch ratio' so that only the tempo changes the duration.
+// The output is aligned with the input (no delay), output frame 'i' corresponds to the input frame 'i * tempo'.
+class STimeStretcher
+{
+public:
+
+    STimeStretcher();
+
+
+    // Returns 'true' if the parameters are invalid. Resets the state.
+    bool setup                (unsigned short iChannels);
+
+    // Call reset() after changing the parameters to apply them right away
+    // (otherwise the already buffered audio is stretched with the new parameters).
+    // 'dTempo' is in [MIN_TEMPO, MAX_TEMPO], 1.0 - original speed.
+    void setTempo             (double dTempo);
+    // In [-MAX_PITCH_IN_SEMITONES, MAX_PITCH_IN_SEMITONES].
+    void setPitchInSemitones  (double dSemitones);
+
+    double getTempo           () const;
+    double getPitchInSemitones() const;
+
+    // 'true' if the tempo is 1 and the pitch is 0, the input is passed through.
+    bool isBypassed           () const;
+
+
+    // Clears the history, the next output is aligned with the next input.
+    void reset                ();
+
+
+    // Appends the output frames to 'vOutSamples'.
+    void process              (const float* pSamples, size_t iFrameCount, std::vector<float>& vOutSamples);
+
+    // Outputs what's left (call once at the end of the stream).
+    void flush                (std::vector<float>& vOutSamples);
+
+
+    static constexpr double MIN_TEMPO = 0.25;
+    static constexpr double MAX_TEMPO = 4.0;
+    static constexpr double MAX_PITCH_IN_SEMITONES = 24.0;
+
+private:
+
+    void updateHops           ();
+    // Analysis, phase advance and overlap-add of the frame that starts at 'iFrameStart' (in 'vInput' frames).
+    void processFrame         (size_t iFrameStart, std::vector<float>& vStretched);
+    // 'pMagnitude', 'pPhase' - analysis of one channel, 'pSynthesisPhase' - result, 'dHop' - input hop since the last frame.
+    void advancePhases        (unsigned short iChannel, double dHop, const float* pMagnitude, const float* pPhase, float* pSynthesisPhase);
+    void stretchedToOutput    (std::vector<float>& vStretched, std::vector<float>& vOutSamples);
+
+
+    static const size_t iFrameSize     = 2048;
+    static const size_t iSynthesisHop  = iFrameSize / 4;
+    static const size_t iBinCount      = iFrameSize / 2 + 1;
+
+
+    SFFT               fft;
+    SResampler         resampler;
+    std::vector<float> vWindow;
+
+
+    std::vector<float> vInput;      // interleaved, starts with the next analysis frame
+    double             dAnalysisPos; // start of the next analysis frame (in 'vInput' frames)
+    double             dAnalysisHop;
+    long long          iLastFrameStart;
+    bool               bFirstFrame;
+
+    std::vector<float> vOverlapAdd; // interleaved, 'iFrameSize' frames
+    size_t             iDropFrameCount;
+
+    unsigned long long iInputFrameCount;
+    unsigned long long iStretchedFrameCount;
+
+
+    // Per channel ('iBinCount' each).
+    std::vector<float> vLastAnalysisPhase;
+    std::vector<float> vLastSynthesisPhase;
+
+    // Scratch.
+    std::vector<float> vReal;
+    std::vector<float> vImag;
+    std::vector<float> vMagnitude;  // 2 channels
+    std::vector<float> vPhase;      // 2 channels
+    std::vector<float> vSynthesisPhase; // 2 channels
+    std::vector<size_t> vPeaks;
+    std::vector<float> vStretched;
+
+
+    double         dTempo;
+    double         dPitchInSemitones;
+    double         dPitchRatio;
+
+    unsigned short iChannels;
+};
@@ -0,0 +1,175 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "swavedecimator.h"
+
+// STL
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__SSE__)
+#define SWAVEDECIMATOR_SSE
+#include <xmmintrin.h>
+#endif
+
+
+SWaveDecimator::SWaveDecimator()
+{
+    iFramesPerBucket = 1;
+    iFramesInBucket  = 0;
+    iBucketCount     = 0;
+
+    fBucketMin = 0.0f;
+    fBucketMax = 0.0f;
+
+    iChannels = 1;
+}
+
+bool SWaveDecimator::setup(unsigned short iChannels, unsigned long long iFramesPerBucket, unsigned long long iExpectedFrameCount)
+{
+    if (iChannels == 0 || iFramesPerBucket == 0)
+    {
+        return true;
+    }
+
+    this->iChannels = iChannels;
+    this->iFramesPerBucket = iFramesPerBucket;
+
+    iFramesInBucket = 0;
+    iBucketCount = 0;
+
+    // +1 for the incomplete bucket at the end.
+    vPeaks.clear();
+    vPeaks.resize(static_cast<size_t>((iExpectedFrameCount / iFramesPerBucket + 1) * 2));
+
+    return false;
+}
+
+void SWaveDecimator::process(const float *pSamples, size_t iFrameCount)
+{
+    while (iFrameCount > 0)
+    {
+        // Take as many frames as the current bucket needs.
+
+        const size_t iFramesToTake = static_cast<size_t>(std::min<unsigned long long>(iFrameCount, iFramesPerBucket - iFramesInBucket));
+
+        float fMin;
+        float fMax;
+        findMinMax(pSamples, iFramesToTake * iChannels, fMin, fMax);
+
+        if (iFramesInBucket == 0)
+        {
+            fBucketMin = fMin;
+            fBucketMax = fMax;
+        }
+        else
+        {
+            fBucketMin = std::min(fBucketMin, fMin);
+            fBucketMax = std::max(fBucketMax, fMax);
+        }
+
+        iFramesInBucket += iFramesToTake;
+
+        if (iFramesInBucket == iFramesPerBucket)
+        {
+            writeBucket();
+        }
+
+        pSamples    += iFramesToTake * iChannels;
+        iFrameCount -= iFramesToTake;
+    }
+}
+
+void SWaveDecimator::flush()
+{
+    if (iFramesInBucket > 0)
+    {
+        writeBucket();
+    }
+}
+
+const std::vector<float> &SWaveDecimator::getPeaks() const
+{
+    return vPeaks;
+}
+
+std::vector<float> SWaveDecimator::takePeaks()
+{
+    vPeaks.resize(iBucketCount * 2);
+
+    iBucketCount = 0;
+
+    return std::move(vPeaks);
+}
+
+size_t SWaveDecimator::getBucketCount() const
+{
+    return iBucketCount;
+}
+
+void SWaveDecimator::findMinMax(const float *pSamples, size_t iSampleCount, float &fMin, float &fMax)
+{
+    fMin = pSamples[0];
+    fMax = pSamples[0];
+
+    size_t i = 0;
+
+#if defined(SWAVEDECIMATOR_SSE)
+    if (iSampleCount >= 16)
+    {
+        __m128 min0 = _mm_loadu_ps(pSamples);
+        __m128 max0 = min0;
+        __m128 min1 = min0;
+        __m128 max1 = min0;
+
+        // 2 accumulators to hide the latency of min/max.
+        for (; i + 8 <= iSampleCount; i += 8)
+        {
+            __m128 a = _mm_loadu_ps(pSamples + i);
+            __m128 b = _mm_loadu_ps(pSamples + i + 4);
+
+            min0 = _mm_min_ps(min0, a);
+            max0 = _mm_max_ps(max0, a);
+            min1 = _mm_min_ps(min1, b);
+            max1 = _mm_max_ps(max1, b);
+        }
+
+        min0 = _mm_min_ps(min0, min1);
+        max0 = _mm_max_ps(max0, max1);
+
+        // Horizontal min/max.
+        min0 = _mm_min_ps(min0, _mm_shuffle_ps(min0, min0, _MM_SHUFFLE(2, 3, 0, 1)));
+        max0 = _mm_max_ps(max0, _mm_shuffle_ps(max0, max0, _MM_SHUFFLE(2, 3, 0, 1)));
+        min0 = _mm_min_ps(min0, _mm_shuffle_ps(min0, min0, _MM_SHUFFLE(1, 0, 3, 2)));
+        max0 = _mm_max_ps(max0, _mm_shuffle_ps(max0, max0, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        fMin = _mm_cvtss_f32(min0);
+        fMax = _mm_cvtss_f32(max0);
+    }
+#endif
+
+    for (; i < iSampleCount; i++)
+    {
+        fMin = std::min(fMin, pSamples[i]);
+        fMax = std::max(fMax, pSamples[i]);
+    }
+}
+
+void SWaveDecimator::writeBucket()
+{
+    if ((iBucketCount + 1) * 2 > vPeaks.size())
+    {
+        // The expected frame count was too small (the duration is approximate for some formats).
+        vPeaks.resize(std::max<size_t>(vPeaks.size() * 2, 2));
+    }
+
+    vPeaks[iBucketCount * 2]     = fBucketMin;
+    vPeaks[iBucketCount * 2 + 1] = fBucketMax;
+
+    iBucketCount++;
+
+    iFramesInBucket = 0;
+}
@@ -0,0 +1,58 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstddef>
+
+
+// Reduces interleaved float samples (any channel count) into (min, max) pairs,
+// one pair per 'iFramesPerBucket' frames, in one streaming pass.
+class SWaveDecimator
+{
+public:
+
+    SWaveDecimator();
+
+
+    // 'iExpectedFrameCount' is used to preallocate the output buffer (it will grow if needed).
+    // Returns 'true' if the parameters are invalid.
+    bool setup                  (unsigned short iChannels, unsigned long long iFramesPerBucket, unsigned long long iExpectedFrameCount);
+
+
+    // 'pSamples' should contain 'iFrameCount * iChannels' samples.
+    void process                (const float* pSamples, size_t iFrameCount);
+
+    // Writes the last (incomplete) bucket.
+    void flush                  ();
+
+
+    // (min, max) pairs, only the first 'getBucketCount() * 2' values are valid.
+    const std::vector<float>& getPeaks() const;
+    std::vector<float>        takePeaks();
+    size_t getBucketCount       () const;
+
+private:
+
+    static void findMinMax      (const float* pSamples, size_t iSampleCount, float& fMin, float& fMax);
+
+    void writeBucket            ();
+
+
+    std::vector<float>  vPeaks;
+
+    unsigned long long  iFramesPerBucket;
+    unsigned long long  iFramesInBucket;
+    size_t              iBucketCount;
+
+    float               fBucketMin;
+    float               fBucketMax;
+
+    unsigned short      iChannels;
+};
@@ -0,0 +1,186 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "swavedecoder.h"
+
+// STL
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+
+SWaveDecoder::SWaveDecoder(SFileHandleCache* pFileCache)
+{
+    this->pFileCache = pFileCache;
+
+    std::memset(&info, 0, sizeof(info));
+
+    iCurrentFrame = 0;
+
+    inputFormat  = SF_INT16;
+    outputFormat = SF_INT16;
+}
+
+bool SWaveDecoder::open(const std::wstring &sPathToFile, S_SAMPLE_FORMAT outputFormat)
+{
+    close();
+
+    if (outputFormat != SF_INT16 && outputFormat != SF_FLOAT32)
+    {
+        return true;
+    }
+
+    if (waveFile.open(sPathToFile, pFileCache))
+    {
+        return true;
+    }
+
+
+    const SWaveFormat& format = waveFile.getFormat();
+
+    if (SSampleConverter::getSampleFormat(format.iBitsPerSample, format.iFormatTag == WFT_IEEE_FLOAT, inputFormat))
+    {
+        close();
+        return true;
+    }
+
+    this->outputFormat = outputFormat;
+
+
+    info.iSampleRate          = format.iSampleRate;
+    info.iChannels            = format.iChannels;
+    info.iFrameCount          = waveFile.getFrameCount();
+    info.dLengthInSec         = waveFile.getLengthInSec();
+    info.iBitrate             = format.iAvgBytesPerSec * 8;
+    info.bExactFrameCount     = true;
+    info.bUsesVariableBitRate = false;
+
+    iCurrentFrame = 0;
+
+    return false;
+}
+
+void SWaveDecoder::close()
+{
+    waveFile.close();
+
+    std::memset(&info, 0, sizeof(info));
+
+    iCurrentFrame = 0;
+}
+
+const SDecoderInfo &SWaveDecoder::getInfo() const
+{
+    return info;
+}
+
+S_SAMPLE_FORMAT SWaveDecoder::getOutputFormat() const
+{
+    return outputFormat;
+}
+
+bool SWaveDecoder::read(unsigned char *pOutData, size_t iFrameCount, size_t &iReadFrameCount)
+{
+    iReadFrameCount = 0;
+
+    if (waveFile.isOpen() == false)
+    {
+        return true;
+    }
+
+
+    const size_t iFramesLeft = waveFile.getFrameCount() - iCurrentFrame;
+    if (iFrameCount > iFramesLeft)
+    {
+        iFrameCount = iFramesLeft;
+    }
+
+    if (inputFormat == outputFormat)
+    {
+        // Same format, just copy.
+        std::memcpy(pOutData, waveFile.getFrame(iCurrentFrame), iFrameCount * waveFile.getFormat().iBlockAlign);
+
+        iCurrentFrame  += iFrameCount;
+        iReadFrameCount = iFrameCount;
+
+        return false;
+    }
+
+
+    // Convert in chunks through a float buffer.
+
+    const size_t iOutBlockAlign = getOutputBlockAlign();
+
+    vConvertBuffer.resize(iConvertChunkFrameCount * info.iChannels);
+
+    while (iReadFrameCount < iFrameCount)
+    {
+        size_t iChunkFrameCount = iFrameCount - iReadFrameCount;
+        if (iChunkFrameCount > iConvertChunkFrameCount)
+        {
+            iChunkFrameCount = iConvertChunkFrameCount;
+        }
+
+        const unsigned char* pInData = waveFile.getFrame(iCurrentFrame);
+        const size_t iSampleCount = iChunkFrameCount * info.iChannels;
+
+        SSampleConverter::convertToFloat(pInData, iSampleCount, inputFormat, vConvertBuffer.data());
+
+        unsigned char* pOut = pOutData + iReadFrameCount * iOutBlockAlign;
+
+        if (outputFormat == SF_FLOAT32)
+        {
+            std::memcpy(pOut, vConvertBuffer.data(), iSampleCount * sizeof(float));
+        }
+        else
+        {
+            floatToInt16(vConvertBuffer.data(), iSampleCount, pOut);
+        }
+
+        iCurrentFrame   += iChunkFrameCount;
+        iReadFrameCount += iChunkFrameCount;
+    }
+
+    return false;
+}
+
+bool SWaveDecoder::seek(unsigned long long iFrameIndex)
+{
+    if (waveFile.isOpen() == false)
+    {
+        return true;
+    }
+
+    if (iFrameIndex > waveFile.getFrameCount())
+    {
+        iFrameIndex = waveFile.getFrameCount();
+    }
+
+    iCurrentFrame = static_cast<size_t>(iFrameIndex);
+
+    return false;
+}
+
+void SWaveDecoder::floatToInt16(const float *pSamples, size_t iSampleCount, unsigned char *pOutData)
+{
+    for (size_t i = 0; i < iSampleCount; i++)
+    {
+        float fSample = pSamples[i] * 32767.0f;
+
+        if (fSample > 32767.0f)
+        {
+            fSample = 32767.0f;
+        }
+        else if (fSample < -32768.0f)
+        {
+            fSample = -32768.0f;
+        }
+
+        const int16_t iSample = static_cast<int16_t>(std::lrint(fSample));
+        std::memcpy(pOutData + i * 2, &iSample, sizeof(iSample));
+    }
+}
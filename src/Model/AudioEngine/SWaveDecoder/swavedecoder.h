@@ -0,0 +1,56 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Custom
+#include "AudioEngine/SDecoder/sdecoder.h"
+#include "AudioEngine/SWaveFile/swavefile.h"
+
+
+// Uncompressed .wav files (8/16/24/32-bit PCM or 32-bit float), portable.
+class SWaveDecoder : public SDecoder
+{
+public:
+
+    // 'pFileCache' (if not 'nullptr') is used to map the file (see SFileHandleCache).
+    SWaveDecoder(SFileHandleCache* pFileCache = nullptr);
+
+
+    bool open           (const std::wstring& sPathToFile, S_SAMPLE_FORMAT outputFormat) override;
+    void close          () override;
+
+
+    const SDecoderInfo& getInfo() const override;
+    S_SAMPLE_FORMAT getOutputFormat() const override;
+
+
+    bool read           (unsigned char* pOutData, size_t iFrameCount, size_t& iReadFrameCount) override;
+    bool seek           (unsigned long long iFrameIndex) override;
+
+private:
+
+    static void floatToInt16 (const float* pSamples, size_t iSampleCount, unsigned char* pOutData);
+
+
+    SWaveFile          waveFile;
+    SFileHandleCache*  pFileCache;
+
+    SDecoderInfo       info;
+
+    std::vector<float> vConvertBuffer;
+
+    size_t             iCurrentFrame;
+
+    S_SAMPLE_FORMAT    inputFormat;
+    S_SAMPLE_FORMAT    outputFormat;
+
+    static const size_t iConvertChunkFrameCount = 4096;
+};
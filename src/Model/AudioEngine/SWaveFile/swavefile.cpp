@@ -0,0 +1,265 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "swavefile.h"
+
+// STL
+#include <cstring>
+
+
+// Little-endian readers (RIFF is always little-endian).
+
+static unsigned short readU16(const unsigned char* p)
+{
+    return static_cast<unsigned short>(p[0] | (p[1] << 8));
+}
+
+static unsigned long readU32(const unsigned char* p)
+{
+    return static_cast<unsigned long>(p[0]) | (static_cast<unsigned long>(p[1]) << 8)
+            | (static_cast<unsigned long>(p[2]) << 16) | (static_cast<unsigned long>(p[3]) << 24);
+}
+
+
+// The last 14 bytes of the KSDATAFORMAT_SUBTYPE_* GUIDs (the first 2 bytes are the format tag).
+static const unsigned char vSubFormatGuidTail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+
+SWaveFile::SWaveFile()
+{
+    std::memset(&format, 0, sizeof(format));
+
+    pData            = nullptr;
+    iDataSizeInBytes = 0;
+}
+
+bool SWaveFile::open(const std::wstring &sPathToFile, SFileHandleCache* pFileCache)
+{
+    close();
+
+    if (pFileCache)
+    {
+        pMappedFile = pFileCache->openFile(sPathToFile);
+    }
+    else
+    {
+        std::shared_ptr<SMappedFile> pFile = std::make_shared<SMappedFile>();
+
+        if (pFile->open(sPathToFile) == false)
+        {
+            pMappedFile = pFile;
+        }
+    }
+
+    if (pMappedFile == nullptr)
+    {
+        return true;
+    }
+
+    if (parse())
+    {
+        close();
+        return true;
+    }
+
+    return false;
+}
+
+void SWaveFile::close()
+{
+    pMappedFile = nullptr;
+
+    std::memset(&format, 0, sizeof(format));
+
+    pData            = nullptr;
+    iDataSizeInBytes = 0;
+}
+
+bool SWaveFile::isOpen() const
+{
+    return pData != nullptr;
+}
+
+const SWaveFormat &SWaveFile::getFormat() const
+{
+    return format;
+}
+
+double SWaveFile::getLengthInSec() const
+{
+    if (format.iSampleRate == 0)
+    {
+        return 0.0;
+    }
+
+    return static_cast<double>(getFrameCount()) / format.iSampleRate;
+}
+
+unsigned long long SWaveFile::getFileSizeInBytes() const
+{
+    if (pMappedFile == nullptr)
+    {
+        return 0;
+    }
+
+    return pMappedFile->getSizeInBytes();
+}
+
+const unsigned char *SWaveFile::getData() const
+{
+    return pData;
+}
+
+size_t SWaveFile::getDataSizeInBytes() const
+{
+    return iDataSizeInBytes;
+}
+
+size_t SWaveFile::getFrameCount() const
+{
+    if (format.iBlockAlign == 0)
+    {
+        return 0;
+    }
+
+    return iDataSizeInBytes / format.iBlockAlign;
+}
+
+const unsigned char *SWaveFile::getFrame(size_t iFrameIndex) const
+{
+    if (iFrameIndex >= getFrameCount())
+    {
+        return nullptr;
+    }
+
+    return pData + iFrameIndex * format.iBlockAlign;
+}
+
+bool SWaveFile::parse()
+{
+    const unsigned char* pFile = pMappedFile->getData();
+    const size_t iFileSize = pMappedFile->getSizeInBytes();
+
+    if (iFileSize < 12 || std::memcmp(pFile, "RIFF", 4) != 0 || std::memcmp(pFile + 8, "WAVE", 4) != 0)
+    {
+        return true;
+    }
+
+
+    bool bFoundFormat = false;
+
+    size_t iPos = 12;
+
+    while (iPos + 8 <= iFileSize)
+    {
+        const unsigned char* pChunkId = pFile + iPos;
+        size_t iChunkSize = readU32(pFile + iPos + 4);
+
+        iPos += 8;
+
+        // Some writers leave the size as is (0 or 0xFFFFFFFF) when the file is truncated or streamed.
+        if (iChunkSize > iFileSize - iPos)
+        {
+            iChunkSize = iFileSize - iPos;
+        }
+
+        if (std::memcmp(pChunkId, "fmt ", 4) == 0)
+        {
+            if (parseFormatChunk(pFile + iPos, iChunkSize))
+            {
+                return true;
+            }
+
+            bFoundFormat = true;
+        }
+        else if (std::memcmp(pChunkId, "data", 4) == 0)
+        {
+            if (bFoundFormat == false)
+            {
+                return true;
+            }
+
+            pData            = pFile + iPos;
+            iDataSizeInBytes = iChunkSize - (iChunkSize % format.iBlockAlign);
+
+            break;
+        }
+
+        // Chunks are padded to an even size.
+        iPos += iChunkSize + (iChunkSize & 1);
+    }
+
+
+    if (pData == nullptr || iDataSizeInBytes == 0)
+    {
+        pData = nullptr;
+        return true;
+    }
+
+    return false;
+}
+
+bool SWaveFile::parseFormatChunk(const unsigned char *pChunk, size_t iChunkSize)
+{
+    if (iChunkSize < 16)
+    {
+        return true;
+    }
+
+    unsigned short iFormatTag = readU16(pChunk);
+
+    format.iChannels       = readU16(pChunk + 2);
+    format.iSampleRate     = readU32(pChunk + 4);
+    format.iAvgBytesPerSec = readU32(pChunk + 8);
+    format.iBlockAlign     = readU16(pChunk + 12);
+    format.iBitsPerSample  = readU16(pChunk + 14);
+
+
+    if (iFormatTag == 0xFFFE) // WAVE_FORMAT_EXTENSIBLE
+    {
+        // cbSize (2), valid bits (2), channel mask (4), sub format GUID (16).
+        if (iChunkSize < 40 || std::memcmp(pChunk + 26, vSubFormatGuidTail, sizeof(vSubFormatGuidTail)) != 0)
+        {
+            return true;
+        }
+
+        iFormatTag = readU16(pChunk + 24);
+    }
+
+
+    if (iFormatTag == WFT_PCM)
+    {
+        if (format.iBitsPerSample != 8 && format.iBitsPerSample != 16 && format.iBitsPerSample != 24 && format.iBitsPerSample != 32)
+        {
+            return true;
+        }
+    }
+    else if (iFormatTag == WFT_IEEE_FLOAT)
+    {
+        if (format.iBitsPerSample != 32)
+        {
+            return true;
+        }
+    }
+    else
+    {
+        // Compressed.
+        return true;
+    }
+
+    format.iFormatTag = static_cast<S_WAVE_FORMAT_TAG>(iFormatTag);
+
+
+    if (format.iChannels == 0 || format.iSampleRate == 0 || format.iBlockAlign != format.iChannels * (format.iBitsPerSample / 8))
+    {
+        return true;
+    }
+
+    format.iAvgBytesPerSec = format.iSampleRate * format.iBlockAlign;
+
+    return false;
+}
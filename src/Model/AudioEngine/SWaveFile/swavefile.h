@@ -0,0 +1,79 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <cstddef>
+#include <memory>
+
+// Custom
+#include "AudioEngine/SMappedFile/smappedfile.h"
+#include "AudioEngine/SFileHandleCache/sfilehandlecache.h"
+
+
+enum S_WAVE_FORMAT_TAG
+{
+    WFT_PCM        = 1,
+    WFT_IEEE_FLOAT = 3
+};
+
+struct SWaveFormat
+{
+    // WAVE_FORMAT_EXTENSIBLE is resolved to the real format.
+    S_WAVE_FORMAT_TAG iFormatTag;
+    unsigned short    iChannels;
+    unsigned long     iSampleRate;
+    unsigned long     iAvgBytesPerSec;
+    unsigned short    iBlockAlign;
+    unsigned short    iBitsPerSample;
+};
+
+// Memory-mapped RIFF/WAVE file with uncompressed samples (8/16/24/32-bit PCM or 32-bit float).
+// The samples are used right from the mapped file, nothing is decoded or copied.
+class SWaveFile
+{
+public:
+
+    SWaveFile();
+
+
+    // Returns 'true' if the file is not a RIFF/WAVE file or its format is not supported,
+    // the mapping is shared with the other users of 'pFileCache' (if not 'nullptr').
+    bool open                  (const std::wstring& sPathToFile, SFileHandleCache* pFileCache = nullptr);
+    void close                 ();
+
+
+    bool isOpen                () const;
+
+    const SWaveFormat& getFormat() const;
+    double getLengthInSec      () const;
+    unsigned long long getFileSizeInBytes() const;
+
+
+    // Interleaved samples of the "data" chunk.
+    const unsigned char* getData() const;
+    size_t getDataSizeInBytes  () const;
+    size_t getFrameCount       () const;
+
+    // Returns nullptr if 'iFrameIndex' is out of range.
+    const unsigned char* getFrame(size_t iFrameIndex) const;
+
+private:
+
+    bool parse                 ();
+    bool parseFormatChunk      (const unsigned char* pChunk, size_t iChunkSize);
+
+
+    std::shared_ptr<const SMappedFile> pMappedFile;
+
+    SWaveFormat          format;
+
+    const unsigned char* pData;
+    size_t               iDataSizeInBytes;
+};
@@ -0,0 +1,161 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "swavefilesink.h"
+
+// STL
+#include <filesystem>
+#include <cstdint>
+
+
+// Little-endian writers (RIFF is always little-endian).
+
+static void writeU16(std::ofstream& file, uint16_t iValue)
+{
+    const char vBytes[2] = {static_cast<char>(iValue & 0xFF), static_cast<char>((iValue >> 8) & 0xFF)};
+    file.write(vBytes, sizeof(vBytes));
+}
+
+static void writeU32(std::ofstream& file, uint32_t iValue)
+{
+    const char vBytes[4] = {static_cast<char>(iValue & 0xFF),         static_cast<char>((iValue >> 8) & 0xFF),
+                            static_cast<char>((iValue >> 16) & 0xFF), static_cast<char>((iValue >> 24) & 0xFF)};
+    file.write(vBytes, sizeof(vBytes));
+}
+
+
+SWaveFileSink::SWaveFileSink(const std::wstring &sPathToFile)
+{
+    this->sPathToFile = sPathToFile;
+
+    format.iSampleRate = 0;
+    format.iChannels = 0;
+
+    iWrittenFrameCount = 0;
+}
+
+SWaveFileSink::~SWaveFileSink()
+{
+    close();
+}
+
+bool SWaveFileSink::open(const SAudioSinkFormat &format)
+{
+    close();
+
+    if (format.iSampleRate == 0 || format.iChannels == 0)
+    {
+        return true;
+    }
+
+    this->format = format;
+
+    iWrittenFrameCount = 0;
+
+
+    // Bigger buffer than the default one, the sink can be called on the audio thread.
+    vWriteBuffer.resize(iWriteBufferSizeInBytes);
+
+    file.rdbuf()->pubsetbuf(vWriteBuffer.data(), static_cast<std::streamsize>(vWriteBuffer.size()));
+
+    file.open(std::filesystem::path(sPathToFile), std::ios::binary | std::ios::trunc);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+
+    // The sizes are not known yet.
+    return writeHeader();
+}
+
+bool SWaveFileSink::write(const float *pSamples, size_t iFrameCount)
+{
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+    // The file is little-endian, same as all the platforms we build for.
+    file.write(reinterpret_cast<const char*>(pSamples), static_cast<std::streamsize>(iFrameCount * format.iChannels * sizeof(float)));
+    if (file.fail())
+    {
+        return true;
+    }
+
+    iWrittenFrameCount += iFrameCount;
+
+    return false;
+}
+
+bool SWaveFileSink::close()
+{
+    if (file.is_open() == false)
+    {
+        return false;
+    }
+
+
+    file.seekp(0);
+
+    const bool bError = writeHeader();
+
+    file.close();
+
+
+    return bError || file.fail();
+}
+
+bool SWaveFileSink::isOpen() const
+{
+    return file.is_open();
+}
+
+unsigned long long SWaveFileSink::getWrittenFrameCount() const
+{
+    return iWrittenFrameCount;
+}
+
+bool SWaveFileSink::writeHeader()
+{
+    const uint32_t iBlockAlign = format.iChannels * sizeof(float);
+
+    unsigned long long iDataSizeInBytes = iWrittenFrameCount * iBlockAlign;
+    if (iDataSizeInBytes > UINT32_MAX - 50)
+    {
+        // RIFF sizes are 32 bit.
+        iDataSizeInBytes = UINT32_MAX - 50;
+    }
+
+
+    // RIFF header + "fmt " (18 bytes, WAVE_FORMAT_IEEE_FLOAT) + "fact" + "data".
+
+    file.write("RIFF", 4);
+    writeU32(file, static_cast<uint32_t>(4 + (8 + 18) + (8 + 4) + 8 + iDataSizeInBytes));
+    file.write("WAVE", 4);
+
+    file.write("fmt ", 4);
+    writeU32(file, 18);
+    writeU16(file, 3); // WAVE_FORMAT_IEEE_FLOAT
+    writeU16(file, format.iChannels);
+    writeU32(file, static_cast<uint32_t>(format.iSampleRate));
+    writeU32(file, static_cast<uint32_t>(format.iSampleRate * iBlockAlign));
+    writeU16(file, static_cast<uint16_t>(iBlockAlign));
+    writeU16(file, 32);
+    writeU16(file, 0);
+
+    // Required for non-PCM formats.
+    file.write("fact", 4);
+    writeU32(file, 4);
+    writeU32(file, static_cast<uint32_t>(iDataSizeInBytes / iBlockAlign));
+
+    file.write("data", 4);
+    writeU32(file, static_cast<uint32_t>(iDataSizeInBytes));
+
+
+    return file.fail();
+}
@@ -0,0 +1,51 @@
+﻿// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <fstream>
+#include <vector>
+
+// Custom
+#include "AudioEngine/SAudioSink/saudiosink.h"
+
+
+// Writes the audio to a 32-bit float RIFF/WAVE file, the header sizes are written in close().
+class SWaveFileSink : public SAudioSink
+{
+public:
+
+    SWaveFileSink(const std::wstring& sPathToFile);
+    ~SWaveFileSink() override;
+
+
+    bool open   (const SAudioSinkFormat& format) override;
+    bool write  (const float* pSamples, size_t iFrameCount) override;
+    bool close  () override;
+
+
+    bool isOpen () const override;
+    unsigned long long getWrittenFrameCount() const override;
+
+private:
+
+    bool writeHeader();
+
+
+    std::wstring     sPathToFile;
+    std::ofstream    file;
+
+    SAudioSinkFormat format;
+
+    std::vector<char> vWriteBuffer;
+
+    unsigned long long iWrittenFrameCount;
+
+    static const size_t iWriteBufferSizeInBytes = 1024 * 1024;
+};
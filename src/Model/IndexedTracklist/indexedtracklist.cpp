@@ -0,0 +1,501 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "indexedtracklist.h"
+
+// STL
+#include <algorithm>
+
+
+IndexedTracklist::IndexedTracklist()
+{
+    iTrackCount = 0;
+    iNextChunkKey = 1;
+}
+
+void IndexedTracklist::append(const XTracklist &vNewTracks)
+{
+    size_t i = 0;
+
+    if (vChunks.size() > 0 && vChunks.back()->vTracks.size() < TRACKLIST_CHUNK_SIZE)
+    {
+        // Fill the last chunk first.
+
+        Chunk& chunk = getChunkForWrite(vChunks.size() - 1);
+
+        for (; i < vNewTracks.size() && chunk.vTracks.size() < TRACKLIST_CHUNK_SIZE; i++)
+        {
+            chunk.vTracks.push_back(vNewTracks[i]);
+
+            setTrackChunk(vNewTracks[i]->iTrackID, chunk.iKey);
+        }
+    }
+
+    const size_t iFirstNewChunk = vChunks.size();
+
+    while (i < vNewTracks.size())
+    {
+        std::shared_ptr<Chunk> pChunk = std::make_shared<Chunk>();
+        pChunk->iKey = iNextChunkKey++;
+        pChunk->vTracks.reserve(TRACKLIST_CHUNK_SIZE);
+
+        for (; i < vNewTracks.size() && pChunk->vTracks.size() < TRACKLIST_CHUNK_SIZE; i++)
+        {
+            pChunk->vTracks.push_back(vNewTracks[i]);
+
+            setTrackChunk(vNewTracks[i]->iTrackID, pChunk->iKey);
+        }
+
+        // The new key is the biggest one.
+        vChunkKeys.push_back({pChunk->iKey, vChunks.size()});
+
+        vChunks.push_back(pChunk);
+    }
+
+    iTrackCount += vNewTracks.size();
+
+    vChunkStarts.resize(vChunks.size());
+    updateChunkStarts(iFirstNewChunk);
+}
+
+void IndexedTracklist::remove(size_t iIndex)
+{
+    std::shared_ptr<XAudioFile> pTrack = eraseTrack(iIndex);
+
+    setTrackChunk(pTrack->iTrackID, 0);
+}
+
+void IndexedTracklist::move(size_t iFrom, size_t iTo)
+{
+    if (iFrom == iTo)
+    {
+        return;
+    }
+
+    // After the erase the track is inserted right at its new position.
+
+    insertTrack(iTo, eraseTrack(iFrom));
+}
+
+bool IndexedTracklist::findTrack(unsigned long long iTrackID, size_t &iOutIndex) const
+{
+    const size_t iShard = static_cast<size_t>(iTrackID / TRACKLIST_INDEX_SHARD_SIZE);
+
+    if (iTrackID == 0 || iShard >= vIndexShards.size() || vIndexShards[iShard] == nullptr)
+    {
+        return false;
+    }
+
+    const unsigned long long iChunkKey = vIndexShards[iShard]->vTrackChunks[iTrackID % TRACKLIST_INDEX_SHARD_SIZE];
+
+    size_t iChunk = 0;
+
+    if (iChunkKey == 0 || findChunk(iChunkKey, iChunk) == false)
+    {
+        return false;
+    }
+
+
+    const XTracklist& vTracks = vChunks[iChunk]->vTracks;
+
+    for (size_t i = 0; i < vTracks.size(); i++)
+    {
+        if (vTracks[i]->iTrackID == iTrackID)
+        {
+            iOutIndex = vChunkStarts[iChunk] + i;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::shared_ptr<XAudioFile> IndexedTracklist::getTrack(unsigned long long iTrackID) const
+{
+    size_t iIndex = 0;
+
+    if (findTrack(iTrackID, iIndex) == false)
+    {
+        return nullptr;
+    }
+
+    return (*this)[iIndex];
+}
+
+size_t IndexedTracklist::size() const
+{
+    return iTrackCount;
+}
+
+const std::shared_ptr<XAudioFile> &IndexedTracklist::operator[](size_t iIndex) const
+{
+    size_t iChunk = 0;
+    size_t iOffset = 0;
+
+    locate(iIndex, iChunk, iOffset);
+
+    return vChunks[iChunk]->vTracks[iOffset];
+}
+
+IndexedTracklist::const_iterator IndexedTracklist::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+IndexedTracklist::const_iterator IndexedTracklist::end() const
+{
+    return const_iterator(this, iTrackCount);
+}
+
+IndexedTracklist::Chunk &IndexedTracklist::getChunkForWrite(size_t iChunk)
+{
+    // Only this tracklist can make new references to the chunk if it has the only one.
+    if (vChunks[iChunk].use_count() > 1)
+    {
+        vChunks[iChunk] = std::make_shared<Chunk>(*vChunks[iChunk]);
+    }
+
+    return *vChunks[iChunk];
+}
+
+IndexedTracklist::IndexShard &IndexedTracklist::getShardForWrite(unsigned long long iTrackID)
+{
+    const size_t iShard = static_cast<size_t>(iTrackID / TRACKLIST_INDEX_SHARD_SIZE);
+
+    if (iShard >= vIndexShards.size())
+    {
+        vIndexShards.resize(iShard + 1);
+    }
+
+    std::shared_ptr<IndexShard>& pShard = vIndexShards[iShard];
+
+    if (pShard == nullptr)
+    {
+        pShard = std::make_shared<IndexShard>();
+        pShard->vTrackChunks.fill(0);
+        pShard->iTrackCount = 0;
+    }
+    else if (pShard.use_count() > 1)
+    {
+        pShard = std::make_shared<IndexShard>(*pShard);
+    }
+
+    return *pShard;
+}
+
+void IndexedTracklist::setTrackChunk(unsigned long long iTrackID, unsigned long long iChunkKey)
+{
+    IndexShard& shard = getShardForWrite(iTrackID);
+
+    unsigned long long& iKey = shard.vTrackChunks[iTrackID % TRACKLIST_INDEX_SHARD_SIZE];
+
+    if (iKey == 0 && iChunkKey != 0)
+    {
+        shard.iTrackCount++;
+    }
+    else if (iKey != 0 && iChunkKey == 0)
+    {
+        shard.iTrackCount--;
+    }
+
+    iKey = iChunkKey;
+
+    if (shard.iTrackCount == 0)
+    {
+        vIndexShards[static_cast<size_t>(iTrackID / TRACKLIST_INDEX_SHARD_SIZE)] = nullptr;
+    }
+}
+
+void IndexedTracklist::insertTrack(size_t iIndex, const std::shared_ptr<XAudioFile>& pTrack)
+{
+    if (vChunks.size() == 0)
+    {
+        append({pTrack});
+
+        return;
+    }
+
+
+    size_t iChunk = 0;
+    size_t iOffset = 0;
+
+    locate(iIndex, iChunk, iOffset);
+
+    Chunk& chunk = getChunkForWrite(iChunk);
+
+    chunk.vTracks.insert(chunk.vTracks.begin() + static_cast<std::ptrdiff_t>(iOffset), pTrack);
+
+    setTrackChunk(pTrack->iTrackID, chunk.iKey);
+
+    iTrackCount++;
+
+
+    if (chunk.vTracks.size() > TRACKLIST_CHUNK_SIZE)
+    {
+        // Split in half so that the next inserts here don't split again.
+
+        std::shared_ptr<Chunk> pSecondHalf = std::make_shared<Chunk>();
+        pSecondHalf->iKey = iNextChunkKey++;
+        pSecondHalf->vTracks.assign(chunk.vTracks.begin() + static_cast<std::ptrdiff_t>(chunk.vTracks.size() / 2), chunk.vTracks.end());
+
+        chunk.vTracks.resize(chunk.vTracks.size() / 2);
+
+        for (size_t i = 0; i < pSecondHalf->vTracks.size(); i++)
+        {
+            setTrackChunk(pSecondHalf->vTracks[i]->iTrackID, pSecondHalf->iKey);
+        }
+
+        vChunks.insert(vChunks.begin() + static_cast<std::ptrdiff_t>(iChunk + 1), pSecondHalf);
+        vChunkStarts.insert(vChunkStarts.begin() + static_cast<std::ptrdiff_t>(iChunk + 1), 0);
+
+        updateChunkKeys();
+    }
+
+    updateChunkStarts(iChunk + 1);
+}
+
+std::shared_ptr<XAudioFile> IndexedTracklist::eraseTrack(size_t iIndex)
+{
+    size_t iChunk = 0;
+    size_t iOffset = 0;
+
+    locate(iIndex, iChunk, iOffset);
+
+    Chunk& chunk = getChunkForWrite(iChunk);
+
+    std::shared_ptr<XAudioFile> pTrack = chunk.vTracks[iOffset];
+
+    chunk.vTracks.erase(chunk.vTracks.begin() + static_cast<std::ptrdiff_t>(iOffset));
+
+    iTrackCount--;
+
+
+    if (chunk.vTracks.size() == 0)
+    {
+        // The chunks are not merged, a chunk is only created for TRACKLIST_CHUNK_SIZE tracks
+        // (or half of it) so there are not much more chunks than needed.
+
+        vChunks.erase(vChunks.begin() + static_cast<std::ptrdiff_t>(iChunk));
+        vChunkStarts.erase(vChunkStarts.begin() + static_cast<std::ptrdiff_t>(iChunk));
+
+        updateChunkKeys();
+
+        updateChunkStarts(iChunk);
+    }
+    else
+    {
+        updateChunkStarts(iChunk + 1);
+    }
+
+    return pTrack;
+}
+
+void IndexedTracklist::locate(size_t iIndex, size_t &iOutChunk, size_t &iOutOffset) const
+{
+    if (vChunks.size() == 0)
+    {
+        iOutChunk = 0;
+        iOutOffset = 0;
+
+        return;
+    }
+
+    if (iIndex >= iTrackCount)
+    {
+        iOutChunk = vChunks.size() - 1;
+        iOutOffset = vChunks.back()->vTracks.size();
+
+        return;
+    }
+
+    // The last chunk that starts at or before 'iIndex'.
+    iOutChunk = static_cast<size_t>(std::upper_bound(vChunkStarts.begin(), vChunkStarts.end(), iIndex) - vChunkStarts.begin()) - 1;
+    iOutOffset = iIndex - vChunkStarts[iOutChunk];
+}
+
+bool IndexedTracklist::findChunk(unsigned long long iChunkKey, size_t &iOutChunk) const
+{
+    auto it = std::lower_bound(vChunkKeys.begin(), vChunkKeys.end(), std::make_pair(iChunkKey, static_cast<size_t>(0)));
+
+    if (it == vChunkKeys.end() || it->first != iChunkKey)
+    {
+        return false;
+    }
+
+    iOutChunk = it->second;
+
+    return true;
+}
+
+void IndexedTracklist::updateChunkStarts(size_t iFromChunk)
+{
+    for (size_t i = iFromChunk; i < vChunks.size(); i++)
+    {
+        vChunkStarts[i] = i == 0 ? 0 : vChunkStarts[i - 1] + vChunks[i - 1]->vTracks.size();
+    }
+}
+
+void IndexedTracklist::updateChunkKeys()
+{
+    vChunkKeys.resize(vChunks.size());
+
+    for (size_t i = 0; i < vChunks.size(); i++)
+    {
+        vChunkKeys[i] = {vChunks[i]->iKey, i};
+    }
+
+    std::sort(vChunkKeys.begin(), vChunkKeys.end());
+}
+
+
+
+IndexedTracklist::const_iterator::const_iterator()
+{
+    pTracklist = nullptr;
+
+    iIndex  = 0;
+    iChunk  = 0;
+    iOffset = 0;
+}
+
+IndexedTracklist::const_iterator::const_iterator(const IndexedTracklist* pTracklist, size_t iIndex)
+{
+    this->pTracklist = pTracklist;
+    this->iIndex = iIndex;
+
+    pTracklist->locate(iIndex, iChunk, iOffset);
+}
+
+IndexedTracklist::const_iterator::reference IndexedTracklist::const_iterator::operator*() const
+{
+    return pTracklist->vChunks[iChunk]->vTracks[iOffset];
+}
+
+IndexedTracklist::const_iterator::pointer IndexedTracklist::const_iterator::operator->() const
+{
+    return &pTracklist->vChunks[iChunk]->vTracks[iOffset];
+}
+
+IndexedTracklist::const_iterator::reference IndexedTracklist::const_iterator::operator[](difference_type iDistance) const
+{
+    return (*pTracklist)[static_cast<size_t>(static_cast<difference_type>(iIndex) + iDistance)];
+}
+
+IndexedTracklist::const_iterator &IndexedTracklist::const_iterator::operator++()
+{
+    iIndex++;
+    iOffset++;
+
+    if (iOffset == pTracklist->vChunks[iChunk]->vTracks.size() && iChunk + 1 < pTracklist->vChunks.size())
+    {
+        iChunk++;
+        iOffset = 0;
+    }
+
+    return *this;
+}
+
+IndexedTracklist::const_iterator IndexedTracklist::const_iterator::operator++(int)
+{
+    const_iterator old = *this;
+
+    ++(*this);
+
+    return old;
+}
+
+IndexedTracklist::const_iterator &IndexedTracklist::const_iterator::operator--()
+{
+    iIndex--;
+
+    if (iOffset == 0)
+    {
+        iChunk--;
+        iOffset = pTracklist->vChunks[iChunk]->vTracks.size() - 1;
+    }
+    else
+    {
+        iOffset--;
+    }
+
+    return *this;
+}
+
+IndexedTracklist::const_iterator IndexedTracklist::const_iterator::operator--(int)
+{
+    const_iterator old = *this;
+
+    --(*this);
+
+    return old;
+}
+
+IndexedTracklist::const_iterator &IndexedTracklist::const_iterator::operator+=(difference_type iDistance)
+{
+    *this = const_iterator(pTracklist, static_cast<size_t>(static_cast<difference_type>(iIndex) + iDistance));
+
+    return *this;
+}
+
+IndexedTracklist::const_iterator &IndexedTracklist::const_iterator::operator-=(difference_type iDistance)
+{
+    return *this += -iDistance;
+}
+
+IndexedTracklist::const_iterator IndexedTracklist::const_iterator::operator+(difference_type iDistance) const
+{
+    const_iterator it = *this;
+
+    it += iDistance;
+
+    return it;
+}
+
+IndexedTracklist::const_iterator IndexedTracklist::const_iterator::operator-(difference_type iDistance) const
+{
+    const_iterator it = *this;
+
+    it -= iDistance;
+
+    return it;
+}
+
+IndexedTracklist::const_iterator::difference_type IndexedTracklist::const_iterator::operator-(const const_iterator &other) const
+{
+    return static_cast<difference_type>(iIndex) - static_cast<difference_type>(other.iIndex);
+}
+
+bool IndexedTracklist::const_iterator::operator==(const const_iterator &other) const
+{
+    return iIndex == other.iIndex;
+}
+
+bool IndexedTracklist::const_iterator::operator!=(const const_iterator &other) const
+{
+    return iIndex != other.iIndex;
+}
+
+bool IndexedTracklist::const_iterator::operator<(const const_iterator &other) const
+{
+    return iIndex < other.iIndex;
+}
+
+bool IndexedTracklist::const_iterator::operator>(const const_iterator &other) const
+{
+    return iIndex > other.iIndex;
+}
+
+bool IndexedTracklist::const_iterator::operator<=(const const_iterator &other) const
+{
+    return iIndex <= other.iIndex;
+}
+
+bool IndexedTracklist::const_iterator::operator>=(const const_iterator &other) const
+{
+    return iIndex >= other.iIndex;
+}
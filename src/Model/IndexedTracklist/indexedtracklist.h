@@ -0,0 +1,147 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <array>
+#include <vector>
+#include <iterator>
+
+// Custom
+#include "Model/globals.h"
+
+
+// The tracks in the tracklist order and the index of their positions by XAudioFile::iTrackID.
+//
+// The tracks are kept in chunks (up to TRACKLIST_CHUNK_SIZE tracks) and the index in shards
+// (TRACKLIST_INDEX_SHARD_SIZE IDs each), a copy of the tracklist shares them with the original
+// and append(), remove() and move() only copy the chunks and the shards they change.
+// So a new snapshot (copy + change) costs O(tracks / chunk size + chunk size) and not O(tracks),
+// a track is found in O(log(chunks) + chunk size).
+class IndexedTracklist
+{
+public:
+
+    // Random access, stays valid while the tracklist is not changed.
+    class const_iterator
+    {
+    public:
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = std::shared_ptr<XAudioFile>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const std::shared_ptr<XAudioFile>*;
+        using reference         = const std::shared_ptr<XAudioFile>&;
+
+
+        const_iterator();
+
+
+        reference       operator*  () const;
+        pointer         operator-> () const;
+        reference       operator[] (difference_type iDistance) const;
+
+        const_iterator& operator++ ();
+        const_iterator  operator++ (int);
+        const_iterator& operator-- ();
+        const_iterator  operator-- (int);
+        const_iterator& operator+= (difference_type iDistance);
+        const_iterator& operator-= (difference_type iDistance);
+        const_iterator  operator+  (difference_type iDistance) const;
+        const_iterator  operator-  (difference_type iDistance) const;
+        difference_type operator-  (const const_iterator& other) const;
+
+        bool operator== (const const_iterator& other) const;
+        bool operator!= (const const_iterator& other) const;
+        bool operator<  (const const_iterator& other) const;
+        bool operator>  (const const_iterator& other) const;
+        bool operator<= (const const_iterator& other) const;
+        bool operator>= (const const_iterator& other) const;
+
+    private:
+
+        friend class IndexedTracklist;
+
+        const_iterator(const IndexedTracklist* pTracklist, size_t iIndex);
+
+
+        const IndexedTracklist* pTracklist;
+
+        size_t iIndex;
+        // Position of 'iIndex' (the end is after the last track of the last chunk).
+        size_t iChunk;
+        size_t iOffset;
+    };
+
+
+    IndexedTracklist();
+
+
+    // The IDs of the tracks should be unique (and not 0), the index is smaller when they are given in order (see AudioCore).
+    void   append    (const XTracklist& vNewTracks);
+    void   remove    (size_t iIndex);
+    // The track at 'iFrom' will be at 'iTo', the tracks in between are shifted by one.
+    void   move      (size_t iFrom, size_t iTo);
+
+
+    // Returns 'false' if there is no track with this ID.
+    bool   findTrack (unsigned long long iTrackID, size_t& iOutIndex) const;
+    // Returns 'nullptr' if there is no track with this ID.
+    std::shared_ptr<XAudioFile> getTrack (unsigned long long iTrackID) const;
+
+
+    size_t size      () const;
+    const std::shared_ptr<XAudioFile>& operator[] (size_t iIndex) const;
+
+    const_iterator begin () const;
+    const_iterator end   () const;
+
+private:
+
+    struct Chunk
+    {
+        unsigned long long iKey; // the copies of the chunk have the same key
+        XTracklist         vTracks;
+    };
+
+    struct IndexShard
+    {
+        // Key of the chunk with the track (0 - no track), by 'iTrackID % TRACKLIST_INDEX_SHARD_SIZE'.
+        std::array<unsigned long long, TRACKLIST_INDEX_SHARD_SIZE> vTrackChunks;
+        size_t iTrackCount;
+    };
+
+
+    // Copy the chunk/shard if it's shared with another tracklist.
+    Chunk&      getChunkForWrite (size_t iChunk);
+    IndexShard& getShardForWrite (unsigned long long iTrackID);
+
+    // 'iChunkKey' == 0 - remove from the index.
+    void   setTrackChunk     (unsigned long long iTrackID, unsigned long long iChunkKey);
+
+    void   insertTrack       (size_t iIndex, const std::shared_ptr<XAudioFile>& pTrack);
+    std::shared_ptr<XAudioFile> eraseTrack (size_t iIndex);
+
+    // 'iIndex' == size() - the end of the last chunk.
+    void   locate            (size_t iIndex, size_t& iOutChunk, size_t& iOutOffset) const;
+    // Returns 'false' if not found.
+    bool   findChunk         (unsigned long long iChunkKey, size_t& iOutChunk) const;
+
+    void   updateChunkStarts (size_t iFromChunk);
+    void   updateChunkKeys   ();
+
+
+    std::vector<std::shared_ptr<Chunk>> vChunks;
+    std::vector<size_t> vChunkStarts; // position of the first track of each chunk
+    std::vector<std::pair<unsigned long long, size_t>> vChunkKeys; // (key, chunk) sorted by the key
+
+    std::vector<std::shared_ptr<IndexShard>> vIndexShards; // by 'iTrackID / TRACKLIST_INDEX_SHARD_SIZE', 'nullptr' if empty
+
+    size_t iTrackCount;
+    unsigned long long iNextChunkKey;
+};
@@ -0,0 +1,518 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "medialibrary.h"
+
+// STL
+#include <filesystem>
+#include <vector>
+#include <cstring>
+
+// Custom
+#include "Model/AudioEngine/SMappedFile/smappedfile.h"
+#include "Model/TracklistFile/tracklistfile.h"
+#include "Model/Utf8/utf8.h"
+
+namespace fs = std::filesystem;
+
+
+// The library file: magic, version and then the records:
+// record type, size of the UTF-8 path, the path and (for LRT_FILE) SMediaLibraryFileRecord.
+
+enum MEDIA_LIBRARY_RECORD_TYPE
+{
+    LRT_FILE   = 1,
+    LRT_REMOVE = 2
+};
+
+struct SMediaLibraryFileRecord
+{
+    unsigned long long iFileSizeInBytes;
+    long long          iLastWriteTime;
+    unsigned long long iContentHash;
+    double             dLengthInSec;
+    unsigned int       iSampleRate;
+    unsigned int       iBitrate;
+    unsigned short     iChannels;
+    unsigned short     iBitsPerSample;
+    unsigned int       iHasMetadata; // 1 - the fields above are the metadata of the file
+};
+
+static_assert(sizeof(SMediaLibraryFileRecord) == 48, "the record size is a part of the file format");
+
+
+MediaLibrary::MediaLibrary()
+{
+    iCurrentScan = 0;
+}
+
+bool MediaLibrary::open(const std::wstring &sPathToFile)
+{
+    std::lock_guard<std::mutex> lock(mtxLibrary);
+
+    libraryFile.close();
+    files.clear();
+
+    sPathToLibraryFile = sPathToFile;
+
+
+    bool   bRewriteFile = true;
+    size_t iRecordCount = 0;
+
+    {
+        SMappedFile mappedFile;
+
+        if (mappedFile.open(sPathToFile) == false)
+        {
+            const unsigned char* pData = mappedFile.getData();
+            const size_t iFileSize = mappedFile.getSizeInBytes();
+
+            unsigned int iVersion = 0;
+
+            if (iFileSize >= 8 && std::memcmp(pData, LIBRARY_FILE_MAGIC, 4) == 0)
+            {
+                std::memcpy(&iVersion, pData + 4, sizeof(iVersion));
+            }
+
+            if (iVersion == LIBRARY_FILE_VERSION)
+            {
+                // A damaged record (the app was closed while writing) is dropped with the records after it.
+                bool bDamaged = readRecords(pData + 8, iFileSize - 8, iRecordCount);
+
+                // Rewrite if most of the records are old.
+                bRewriteFile = bDamaged || iRecordCount > files.size() * 2;
+            }
+        }
+    }
+
+
+    if (bRewriteFile)
+    {
+        return rewriteFile();
+    }
+
+    libraryFile.open(fs::path(sPathToFile), std::ios::binary | std::ios::app);
+
+    return libraryFile.is_open() == false;
+}
+
+void MediaLibrary::beginScan()
+{
+    std::lock_guard<std::mutex> lock(mtxLibrary);
+
+    iCurrentScan++;
+}
+
+bool MediaLibrary::updateFile(const std::wstring &sPathToFile, std::shared_ptr<const XTrackMetadata> &pMetadata)
+{
+    pMetadata = nullptr;
+
+    MediaLibraryFile file;
+
+    if (TracklistFile::getFileKey(sPathToFile, file.iFileSizeInBytes, file.iLastWriteTime))
+    {
+        return true;
+    }
+
+
+    mtxLibrary.lock();
+
+    auto it = files.find(sPathToFile);
+
+    if (it != files.end() && it->second.iFileSizeInBytes == file.iFileSizeInBytes && it->second.iLastWriteTime == file.iLastWriteTime)
+    {
+        // Not changed.
+
+        it->second.iLastScan = iCurrentScan;
+        pMetadata = it->second.pMetadata;
+
+        mtxLibrary.unlock();
+
+        return false;
+    }
+
+    mtxLibrary.unlock();
+
+
+    // The file is read without locking (the files are updated on many threads).
+
+    if (getContentHash(sPathToFile, file.iFileSizeInBytes, file.iContentHash))
+    {
+        return true;
+    }
+
+
+    std::lock_guard<std::mutex> lock(mtxLibrary);
+
+    file.iLastScan = iCurrentScan;
+
+    it = files.find(sPathToFile);
+
+    file.iAddedScan = (it == files.end()) ? iCurrentScan : it->second.iAddedScan;
+
+    files[sPathToFile] = file;
+
+    appendFileRecord(sPathToFile, file);
+
+    return false;
+}
+
+void MediaLibrary::finishScan(const std::wstring &sFolderPath, MediaLibraryChanges* pChanges)
+{
+    std::lock_guard<std::mutex> lock(mtxLibrary);
+
+    std::wstring sFolder = sFolderPath;
+
+    while (sFolder.size() > 1 && (sFolder.back() == L'/' || sFolder.back() == L'\\'))
+    {
+        sFolder.pop_back();
+    }
+
+    const bool bEndsWithSeparator = sFolder.size() > 0 && (sFolder.back() == L'/' || sFolder.back() == L'\\');
+
+    auto isInFolder = [&](const std::wstring& sPath)
+    {
+        return sPath.size() > sFolder.size() && sPath.compare(0, sFolder.size(), sFolder) == 0
+                && (bEndsWithSeparator || sPath[sFolder.size()] == L'/' || sPath[sFolder.size()] == L'\\');
+    };
+
+
+    // Removed from the disk (or moved), by the content hash.
+    std::unordered_multimap<unsigned long long, std::unordered_map<std::wstring, MediaLibraryFile>::iterator> removedFiles;
+    // Found for the first time.
+    std::vector<std::unordered_map<std::wstring, MediaLibraryFile>::iterator> vAddedFiles;
+
+    for (auto it = files.begin(); it != files.end(); ++it)
+    {
+        if (isInFolder(it->first) == false)
+        {
+            continue;
+        }
+
+        if (it->second.iLastScan != iCurrentScan)
+        {
+            removedFiles.insert({it->second.iContentHash, it});
+        }
+        else if (it->second.iAddedScan == iCurrentScan)
+        {
+            vAddedFiles.push_back(it);
+        }
+    }
+
+
+    for (size_t i = 0; i < vAddedFiles.size() && removedFiles.size() > 0; i++)
+    {
+        MediaLibraryFile& file = vAddedFiles[i]->second;
+
+        auto range = removedFiles.equal_range(file.iContentHash);
+
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            const MediaLibraryFile& oldFile = it->second->second;
+
+            if (oldFile.iFileSizeInBytes != file.iFileSizeInBytes)
+            {
+                continue;
+            }
+
+
+            // Moved or renamed, the metadata is still valid (the same content).
+
+            if (oldFile.pMetadata && file.pMetadata == nullptr)
+            {
+                std::shared_ptr<XTrackMetadata> pMetadata = std::make_shared<XTrackMetadata>(*oldFile.pMetadata);
+                pMetadata->iFileSizeInBytes = file.iFileSizeInBytes;
+                pMetadata->iLastWriteTime   = file.iLastWriteTime;
+
+                file.pMetadata = pMetadata;
+
+                appendFileRecord(vAddedFiles[i]->first, file);
+            }
+
+            if (pChanges)
+            {
+                pChanges->vMovedPaths.push_back({it->second->first, vAddedFiles[i]->first});
+            }
+
+            appendRemoveRecord(it->second->first);
+
+            files.erase(it->second);
+            removedFiles.erase(it);
+
+            break;
+        }
+    }
+
+
+    for (auto it = removedFiles.begin(); it != removedFiles.end(); ++it)
+    {
+        if (pChanges)
+        {
+            pChanges->vRemovedPaths.push_back(it->second->first);
+        }
+
+        appendRemoveRecord(it->second->first);
+
+        files.erase(it->second);
+    }
+
+    libraryFile.flush();
+}
+
+void MediaLibrary::setMetadata(const std::wstring &sPathToFile, std::shared_ptr<const XTrackMetadata> pMetadata)
+{
+    std::lock_guard<std::mutex> lock(mtxLibrary);
+
+    auto it = files.find(sPathToFile);
+
+    if (it == files.end() || pMetadata == nullptr
+            || it->second.iFileSizeInBytes != pMetadata->iFileSizeInBytes || it->second.iLastWriteTime != pMetadata->iLastWriteTime)
+    {
+        return;
+    }
+
+    it->second.pMetadata = pMetadata;
+
+    appendFileRecord(sPathToFile, it->second);
+
+    libraryFile.flush();
+}
+
+void MediaLibrary::appendFileRecord(const std::wstring &sPathToFile, const MediaLibraryFile &file)
+{
+    if (libraryFile.is_open() == false)
+    {
+        return;
+    }
+
+    std::string sPath;
+    Utf8::appendUtf8(sPath, sPathToFile);
+
+    unsigned int iRecordType = LRT_FILE;
+    unsigned int iPathSize = static_cast<unsigned int>(sPath.size());
+
+    SMediaLibraryFileRecord record;
+    std::memset(&record, 0, sizeof(record));
+
+    record.iFileSizeInBytes = file.iFileSizeInBytes;
+    record.iLastWriteTime   = file.iLastWriteTime;
+    record.iContentHash     = file.iContentHash;
+
+    if (file.pMetadata)
+    {
+        record.dLengthInSec   = file.pMetadata->dLengthInSec;
+        record.iSampleRate    = file.pMetadata->iSampleRate;
+        record.iBitrate       = file.pMetadata->iBitrate;
+        record.iChannels      = file.pMetadata->iChannels;
+        record.iBitsPerSample = file.pMetadata->iBitsPerSample;
+        record.iHasMetadata   = 1;
+    }
+
+    libraryFile.write(reinterpret_cast<char*>(&iRecordType), sizeof(iRecordType));
+    libraryFile.write(reinterpret_cast<char*>(&iPathSize), sizeof(iPathSize));
+    libraryFile.write(sPath.data(), static_cast<std::streamsize>(sPath.size()));
+    libraryFile.write(reinterpret_cast<char*>(&record), sizeof(record));
+}
+
+void MediaLibrary::appendRemoveRecord(const std::wstring &sPathToFile)
+{
+    if (libraryFile.is_open() == false)
+    {
+        return;
+    }
+
+    std::string sPath;
+    Utf8::appendUtf8(sPath, sPathToFile);
+
+    unsigned int iRecordType = LRT_REMOVE;
+    unsigned int iPathSize = static_cast<unsigned int>(sPath.size());
+
+    libraryFile.write(reinterpret_cast<char*>(&iRecordType), sizeof(iRecordType));
+    libraryFile.write(reinterpret_cast<char*>(&iPathSize), sizeof(iPathSize));
+    libraryFile.write(sPath.data(), static_cast<std::streamsize>(sPath.size()));
+}
+
+bool MediaLibrary::readRecords(const unsigned char *pData, size_t iSizeInBytes, size_t &iRecordCount)
+{
+    size_t iReadPos = 0;
+
+    while (iReadPos < iSizeInBytes)
+    {
+        unsigned int iRecordType = 0;
+        unsigned int iPathSize = 0;
+
+        if (iSizeInBytes - iReadPos < sizeof(iRecordType) + sizeof(iPathSize))
+        {
+            return true;
+        }
+
+        std::memcpy(&iRecordType, pData + iReadPos, sizeof(iRecordType));
+        iReadPos += sizeof(iRecordType);
+
+        std::memcpy(&iPathSize, pData + iReadPos, sizeof(iPathSize));
+        iReadPos += sizeof(iPathSize);
+
+        if ((iRecordType != LRT_FILE && iRecordType != LRT_REMOVE) || iSizeInBytes - iReadPos < iPathSize)
+        {
+            return true;
+        }
+
+        std::wstring sPath;
+
+        if (Utf8::appendWide(sPath, pData + iReadPos, iPathSize))
+        {
+            return true;
+        }
+
+        iReadPos += iPathSize;
+
+
+        if (iRecordType == LRT_REMOVE)
+        {
+            files.erase(sPath);
+        }
+        else
+        {
+            SMediaLibraryFileRecord record;
+
+            if (iSizeInBytes - iReadPos < sizeof(record))
+            {
+                return true;
+            }
+
+            std::memcpy(&record, pData + iReadPos, sizeof(record));
+            iReadPos += sizeof(record);
+
+
+            MediaLibraryFile file;
+            file.iFileSizeInBytes = record.iFileSizeInBytes;
+            file.iLastWriteTime   = record.iLastWriteTime;
+            file.iContentHash     = record.iContentHash;
+
+            if (record.iHasMetadata == 1)
+            {
+                std::shared_ptr<XTrackMetadata> pMetadata = std::make_shared<XTrackMetadata>();
+                pMetadata->iFileSizeInBytes = record.iFileSizeInBytes;
+                pMetadata->iLastWriteTime   = record.iLastWriteTime;
+                pMetadata->dLengthInSec     = record.dLengthInSec;
+                pMetadata->iSampleRate      = record.iSampleRate;
+                pMetadata->iBitrate         = record.iBitrate;
+                pMetadata->iChannels        = record.iChannels;
+                pMetadata->iBitsPerSample   = record.iBitsPerSample;
+
+                file.pMetadata = pMetadata;
+            }
+
+            files[sPath] = file;
+        }
+
+        iRecordCount++;
+    }
+
+    return false;
+}
+
+bool MediaLibrary::rewriteFile()
+{
+    libraryFile.close();
+
+    fs::path filePath = fs::path(sPathToLibraryFile);
+    fs::path tempPath = filePath;
+    tempPath += L".tmp";
+
+    std::error_code ec;
+    fs::create_directories(filePath.parent_path(), ec);
+
+
+    libraryFile.open(tempPath, std::ios::binary | std::ios::trunc);
+    if (libraryFile.is_open() == false)
+    {
+        return true;
+    }
+
+    unsigned int iVersion = LIBRARY_FILE_VERSION;
+
+    libraryFile.write(LIBRARY_FILE_MAGIC, sizeof(LIBRARY_FILE_MAGIC) - 1);
+    libraryFile.write(reinterpret_cast<char*>(&iVersion), sizeof(iVersion));
+
+    for (auto it = files.begin(); it != files.end(); ++it)
+    {
+        appendFileRecord(it->first, it->second);
+    }
+
+    bool bFailed = libraryFile.fail();
+
+    libraryFile.close();
+
+    if (bFailed)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+    fs::rename(tempPath, filePath, ec);
+    if (ec)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+
+    libraryFile.open(filePath, std::ios::binary | std::ios::app);
+
+    return libraryFile.is_open() == false;
+}
+
+bool MediaLibrary::getContentHash(const std::wstring &sPathToFile, unsigned long long iFileSizeInBytes, unsigned long long &iContentHash)
+{
+    std::ifstream file(fs::path(sPathToFile), std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+
+    // FNV-1a (64 bit).
+
+    iContentHash = 14695981039346656037ULL;
+
+    auto hashBytes = [&iContentHash](const unsigned char* pBytes, size_t iSize)
+    {
+        for (size_t i = 0; i < iSize; i++)
+        {
+            iContentHash ^= pBytes[i];
+            iContentHash *= 1099511628211ULL;
+        }
+    };
+
+    hashBytes(reinterpret_cast<const unsigned char*>(&iFileSizeInBytes), sizeof(iFileSizeInBytes));
+
+
+    std::vector<char> vBlock(LIBRARY_HASH_BLOCK_SIZE);
+
+    // The first block.
+    file.read(vBlock.data(), static_cast<std::streamsize>(vBlock.size()));
+    hashBytes(reinterpret_cast<const unsigned char*>(vBlock.data()), static_cast<size_t>(file.gcount()));
+
+    if (iFileSizeInBytes > LIBRARY_HASH_BLOCK_SIZE)
+    {
+        // The last block (without the bytes of the first one).
+
+        unsigned long long iLastBlockStart = iFileSizeInBytes - LIBRARY_HASH_BLOCK_SIZE;
+        if (iLastBlockStart < LIBRARY_HASH_BLOCK_SIZE)
+        {
+            iLastBlockStart = LIBRARY_HASH_BLOCK_SIZE;
+        }
+
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(iLastBlockStart));
+        file.read(vBlock.data(), static_cast<std::streamsize>(iFileSizeInBytes - iLastBlockStart));
+        hashBytes(reinterpret_cast<const unsigned char*>(vBlock.data()), static_cast<size_t>(file.gcount()));
+    }
+
+    return file.bad();
+}
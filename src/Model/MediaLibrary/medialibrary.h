@@ -0,0 +1,97 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <fstream>
+
+// Custom
+#include "Model/globals.h"
+
+
+struct MediaLibraryFile
+{
+    unsigned long long iFileSizeInBytes = 0;
+    long long          iLastWriteTime = 0;
+    unsigned long long iContentHash = 0; // see MediaLibrary::getContentHash()
+
+    std::shared_ptr<const XTrackMetadata> pMetadata; // 'nullptr' if not known
+
+    unsigned int       iLastScan = 0;  // not saved
+    unsigned int       iAddedScan = 0; // not saved, the scan that found the path for the first time
+};
+
+// What finishScan() found in the folder.
+struct MediaLibraryChanges
+{
+    // The files that are no longer in the folder (and were not moved).
+    std::vector<std::wstring> vRemovedPaths;
+    // (old path, new path) of the files that were moved or renamed (found by the content hash).
+    std::vector<std::pair<std::wstring, std::wstring>> vMovedPaths;
+};
+
+// The audio files that were found in the folders (with their size, modification time, content hash and metadata),
+// remembered between the runs so that the files that were not changed are not read again.
+// The library file is append-only: each change is a record (file added/changed or removed)
+// and the last record of a path wins, the file is rewritten without the old records when it's opened.
+class MediaLibrary
+{
+public:
+
+    MediaLibrary();
+
+    MediaLibrary(const MediaLibrary&) = delete;
+    MediaLibrary& operator=(const MediaLibrary&) = delete;
+
+
+    // Reads the library file (a new one is created if there is none),
+    // returns 'true' if the file can't be written (then the library is only kept in memory).
+    bool open              (const std::wstring& sPathToFile);
+
+
+    // Should be called before the files of the folder are updated (see finishScan()).
+    void beginScan         ();
+    // The content hash is calculated only if the file is new or changed (then the metadata is forgotten),
+    // 'pMetadata' is the known metadata of the file. Returns 'true' if the file does not exist.
+    bool updateFile        (const std::wstring& sPathToFile, std::shared_ptr<const XTrackMetadata>& pMetadata);
+    // Forgets the files of the folder (and its subfolders) that were not updated since beginScan(),
+    // a new file with the same content hash as a forgotten one is its new path (the metadata is kept).
+    void finishScan        (const std::wstring& sFolderPath, MediaLibraryChanges* pChanges = nullptr);
+
+
+    // Only if the file is in the library and was not changed since.
+    void setMetadata       (const std::wstring& sPathToFile, std::shared_ptr<const XTrackMetadata> pMetadata);
+
+private:
+
+    // Under 'mtxLibrary'.
+    void appendFileRecord   (const std::wstring& sPathToFile, const MediaLibraryFile& file);
+    void appendRemoveRecord (const std::wstring& sPathToFile);
+    // Returns 'true' if some records can't be read (the records before them are read).
+    bool readRecords        (const unsigned char* pData, size_t iSizeInBytes, size_t& iRecordCount);
+    bool rewriteFile        ();
+
+    // FNV-1a of the size and of the first and the last LIBRARY_HASH_BLOCK_SIZE bytes of the file,
+    // returns 'true' if the file can't be read.
+    static bool getContentHash (const std::wstring& sPathToFile, unsigned long long iFileSizeInBytes, unsigned long long& iContentHash);
+
+
+    std::unordered_map<std::wstring, MediaLibraryFile> files;
+
+    std::mutex    mtxLibrary;
+
+    std::ofstream libraryFile; // opened for appending
+    std::wstring  sPathToLibraryFile;
+
+    unsigned int  iCurrentScan;
+};
@@ -0,0 +1,85 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "nexttrackpredictor.h"
+
+
+std::shared_ptr<XAudioFile> NextTrackPredictor::predict(const IndexedTracklist &vTracks, const XTracklist &vPlayedHistory,
+                                                        bool bRandomTrack, bool bRepeatTrack, std::mt19937_64 &rndGen)
+{
+    size_t iCurrentIndex = 0;
+
+    if (findCurrentTrack(vTracks, vPlayedHistory, bRepeatTrack, iCurrentIndex))
+    {
+        return nullptr;
+    }
+
+
+    size_t iNextTrackIndex = 0;
+
+    if (bRandomTrack)
+    {
+        std::uniform_int_distribution<> uid(0, static_cast<int>(vTracks.size()) - 1);
+
+        do
+        {
+            iNextTrackIndex = static_cast<size_t>(uid(rndGen));
+
+        }while (iNextTrackIndex == iCurrentIndex);
+    }
+    else if (iCurrentIndex != vTracks.size() - 1)
+    {
+        iNextTrackIndex = iCurrentIndex + 1;
+    }
+
+    return vTracks[iNextTrackIndex];
+}
+
+bool NextTrackPredictor::isStillNext(const IndexedTracklist &vTracks, const XTracklist &vPlayedHistory,
+                                     const std::shared_ptr<XAudioFile> &pNextTrack, bool bRandomTrack, bool bRepeatTrack)
+{
+    if (pNextTrack == nullptr)
+    {
+        return false;
+    }
+
+
+    size_t iCurrentIndex = 0;
+
+    if (findCurrentTrack(vTracks, vPlayedHistory, bRepeatTrack, iCurrentIndex))
+    {
+        return false;
+    }
+
+    size_t iNextTrackIndex = 0;
+
+    if (vTracks.findTrack(pNextTrack->iTrackID, iNextTrackIndex) == false || vTracks[iNextTrackIndex] != pNextTrack)
+    {
+        // Removed or replaced.
+        return false;
+    }
+
+
+    if (bRandomTrack)
+    {
+        // Any other track.
+        return iNextTrackIndex != iCurrentIndex;
+    }
+
+    return iNextTrackIndex == ((iCurrentIndex == vTracks.size() - 1) ? 0 : iCurrentIndex + 1);
+}
+
+bool NextTrackPredictor::findCurrentTrack(const IndexedTracklist &vTracks, const XTracklist &vPlayedHistory,
+                                          bool bRepeatTrack, size_t &iCurrentIndex)
+{
+    if (bRepeatTrack || vTracks.size() < 2 || vPlayedHistory.size() == 0)
+    {
+        return true;
+    }
+
+    return vTracks.findTrack(vPlayedHistory.back()->iTrackID, iCurrentIndex) == false;
+}
@@ -0,0 +1,41 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <memory>
+#include <random>
+
+// Custom
+#include "Model/globals.h"
+#include "Model/IndexedTracklist/indexedtracklist.h"
+
+
+// Which track is played after the current one (the last one in the played history),
+// used by AudioCore to prefetch the next track and to keep or drop it when the tracklist changes.
+class NextTrackPredictor
+{
+public:
+
+    // Returns 'nullptr' if the next track can't be known in advance: repeat, less than 2 tracks,
+    // nothing was played or the current track is not in the tracklist.
+    // The next track in the tracklist order (the first one after the last one) or a random track other than the current one.
+    static std::shared_ptr<XAudioFile> predict  (const IndexedTracklist& vTracks, const XTracklist& vPlayedHistory,
+                                                 bool bRandomTrack, bool bRepeatTrack, std::mt19937_64& rndGen);
+
+    // Returns 'true' if 'pNextTrack' (returned by predict() earlier) can still be played next
+    // after the tracklist or the history were changed (the modes are the same).
+    static bool isStillNext                     (const IndexedTracklist& vTracks, const XTracklist& vPlayedHistory,
+                                                 const std::shared_ptr<XAudioFile>& pNextTrack, bool bRandomTrack, bool bRepeatTrack);
+
+private:
+
+    // Returns 'true' if the next track can't be known in advance (see predict()).
+    static bool findCurrentTrack                (const IndexedTracklist& vTracks, const XTracklist& vPlayedHistory,
+                                                 bool bRepeatTrack, size_t& iCurrentIndex);
+};
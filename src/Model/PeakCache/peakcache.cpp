@@ -0,0 +1,305 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "peakcache.h"
+
+// STL
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+
+// Custom
+#include "Model/globals.h"
+
+namespace fs = std::filesystem;
+
+
+PeakCache::PeakCache()
+{
+    std::error_code ec;
+    fs::path tempPath = fs::temp_directory_path(ec);
+
+    sCacheDirectory = (tempPath / L"Xander" / PEAK_CACHE_FOLDER_NAME).wstring();
+}
+
+void PeakCache::setCacheDirectory(const std::wstring &sCacheDirectory)
+{
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    this->sCacheDirectory = sCacheDirectory;
+}
+
+std::wstring PeakCache::getCacheDirectory()
+{
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    return sCacheDirectory;
+}
+
+bool PeakCache::loadPeaks(const std::wstring &sPathToAudioFile, std::vector<PeakLevel> &vLevels)
+{
+    unsigned long long iFileSize = 0;
+    long long iLastWriteTime = 0;
+
+    if (getFileKey(sPathToAudioFile, iFileSize, iLastWriteTime))
+    {
+        return true;
+    }
+
+
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    std::ifstream file(fs::path(getCacheFilePath(sPathToAudioFile)), std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+
+    // Header.
+
+    char vMagic[sizeof(PEAK_CACHE_MAGIC) - 1] = {0};
+    file.read(vMagic, sizeof(vMagic));
+
+    unsigned int iVersion = 0;
+    file.read(reinterpret_cast<char*>(&iVersion), sizeof(iVersion));
+
+    if (file.fail() || std::string(vMagic, sizeof(vMagic)) != PEAK_CACHE_MAGIC || iVersion != PEAK_CACHE_VERSION)
+    {
+        return true;
+    }
+
+
+    // Key.
+
+    unsigned long long iCachedFileSize = 0;
+    long long iCachedLastWriteTime = 0;
+    unsigned int iPathSize = 0;
+
+    file.read(reinterpret_cast<char*>(&iCachedFileSize), sizeof(iCachedFileSize));
+    file.read(reinterpret_cast<char*>(&iCachedLastWriteTime), sizeof(iCachedLastWriteTime));
+    file.read(reinterpret_cast<char*>(&iPathSize), sizeof(iPathSize));
+
+    if (file.fail() || iCachedFileSize != iFileSize || iCachedLastWriteTime != iLastWriteTime || iPathSize != sPathToAudioFile.size())
+    {
+        return true;
+    }
+
+    std::wstring sCachedPath(iPathSize, L'\0');
+    file.read(reinterpret_cast<char*>(&sCachedPath[0]), iPathSize * sizeof(wchar_t));
+
+    if (file.fail() || sCachedPath != sPathToAudioFile)
+    {
+        // Hash collision.
+        return true;
+    }
+
+
+    // Levels.
+
+    unsigned int iLevelCount = 0;
+    file.read(reinterpret_cast<char*>(&iLevelCount), sizeof(iLevelCount));
+
+    if (file.fail() || iLevelCount == 0)
+    {
+        return true;
+    }
+
+    std::vector<PeakLevel> vReadLevels(iLevelCount);
+
+    for (unsigned int i = 0; i < iLevelCount; i++)
+    {
+        unsigned long long iPeakCount = 0;
+
+        file.read(reinterpret_cast<char*>(&vReadLevels[i].iFramesPerPeak), sizeof(vReadLevels[i].iFramesPerPeak));
+        file.read(reinterpret_cast<char*>(&iPeakCount), sizeof(iPeakCount));
+
+        if (file.fail() || iPeakCount > iFileSize)
+        {
+            return true;
+        }
+
+        vReadLevels[i].vPeaks.resize(static_cast<size_t>(iPeakCount) * 2);
+
+        file.read(reinterpret_cast<char*>(vReadLevels[i].vPeaks.data()), static_cast<std::streamsize>(vReadLevels[i].vPeaks.size() * sizeof(float)));
+
+        if (file.fail())
+        {
+            return true;
+        }
+    }
+
+    vLevels = std::move(vReadLevels);
+
+    return false;
+}
+
+bool PeakCache::savePeaks(const std::wstring &sPathToAudioFile, const std::vector<PeakLevel> &vLevels)
+{
+    if (vLevels.size() == 0)
+    {
+        return true;
+    }
+
+    unsigned long long iFileSize = 0;
+    long long iLastWriteTime = 0;
+
+    if (getFileKey(sPathToAudioFile, iFileSize, iLastWriteTime))
+    {
+        return true;
+    }
+
+
+    std::lock_guard<std::mutex> lock(mtxCache);
+
+    std::error_code ec;
+    fs::create_directories(fs::path(sCacheDirectory), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+
+    // Write to a temporary file first so that a half-written entry is never read.
+
+    fs::path cachePath = fs::path(getCacheFilePath(sPathToAudioFile));
+    fs::path tempPath  = cachePath;
+    tempPath += L".tmp";
+
+    std::ofstream file(tempPath, std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+    unsigned int iVersion = PEAK_CACHE_VERSION;
+    unsigned int iPathSize = static_cast<unsigned int>(sPathToAudioFile.size());
+    unsigned int iLevelCount = static_cast<unsigned int>(vLevels.size());
+
+    file.write(PEAK_CACHE_MAGIC, sizeof(PEAK_CACHE_MAGIC) - 1);
+    file.write(reinterpret_cast<char*>(&iVersion), sizeof(iVersion));
+
+    file.write(reinterpret_cast<char*>(&iFileSize), sizeof(iFileSize));
+    file.write(reinterpret_cast<char*>(&iLastWriteTime), sizeof(iLastWriteTime));
+    file.write(reinterpret_cast<char*>(&iPathSize), sizeof(iPathSize));
+    file.write(reinterpret_cast<const char*>(sPathToAudioFile.c_str()), iPathSize * sizeof(wchar_t));
+
+    file.write(reinterpret_cast<char*>(&iLevelCount), sizeof(iLevelCount));
+
+    for (size_t i = 0; i < vLevels.size(); i++)
+    {
+        unsigned long long iFramesPerPeak = vLevels[i].iFramesPerPeak;
+        unsigned long long iPeakCount = vLevels[i].vPeaks.size() / 2;
+
+        file.write(reinterpret_cast<char*>(&iFramesPerPeak), sizeof(iFramesPerPeak));
+        file.write(reinterpret_cast<char*>(&iPeakCount), sizeof(iPeakCount));
+        file.write(reinterpret_cast<const char*>(vLevels[i].vPeaks.data()), static_cast<std::streamsize>(iPeakCount * 2 * sizeof(float)));
+    }
+
+    bool bFailed = file.fail();
+
+    file.close();
+
+    if (bFailed)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+    fs::rename(tempPath, cachePath, ec);
+    if (ec)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+    return false;
+}
+
+void PeakCache::buildLevels(std::vector<PeakLevel> &vLevels, size_t iMinPeakCount)
+{
+    if (vLevels.size() == 0)
+    {
+        return;
+    }
+
+    vLevels.resize(1);
+
+    while (vLevels.back().vPeaks.size() / 2 >= iMinPeakCount * 2)
+    {
+        const PeakLevel& prevLevel = vLevels.back();
+
+        PeakLevel level;
+        level.iFramesPerPeak = prevLevel.iFramesPerPeak * 2;
+        level.vPeaks.reserve(prevLevel.vPeaks.size() / 2 + 2);
+
+        for (size_t i = 0; i < prevLevel.vPeaks.size(); i += 4)
+        {
+            float fMin = prevLevel.vPeaks[i];
+            float fMax = prevLevel.vPeaks[i + 1];
+
+            if (i + 3 < prevLevel.vPeaks.size())
+            {
+                fMin = std::min(fMin, prevLevel.vPeaks[i + 2]);
+                fMax = std::max(fMax, prevLevel.vPeaks[i + 3]);
+            }
+
+            level.vPeaks.push_back(fMin);
+            level.vPeaks.push_back(fMax);
+        }
+
+        vLevels.push_back(std::move(level));
+    }
+}
+
+size_t PeakCache::pickLevel(const std::vector<PeakLevel> &vLevels, size_t iMinPeakCount)
+{
+    size_t iLevel = 0;
+
+    for (size_t i = 1; i < vLevels.size(); i++)
+    {
+        if (vLevels[i].vPeaks.size() / 2 < iMinPeakCount)
+        {
+            break;
+        }
+
+        iLevel = i;
+    }
+
+    return iLevel;
+}
+
+bool PeakCache::getFileKey(const std::wstring &sPathToAudioFile, unsigned long long &iFileSize, long long &iLastWriteTime)
+{
+    std::error_code ec;
+
+    iFileSize = fs::file_size(fs::path(sPathToAudioFile), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+    fs::file_time_type lastWriteTime = fs::last_write_time(fs::path(sPathToAudioFile), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+    iLastWriteTime = static_cast<long long>(lastWriteTime.time_since_epoch().count());
+
+    return false;
+}
+
+std::wstring PeakCache::getCacheFilePath(const std::wstring &sPathToAudioFile)
+{
+    std::wstringstream fileName;
+    fileName << std::hex << std::hash<std::wstring>{}(sPathToAudioFile) << PEAK_CACHE_FILE_EXTENSION;
+
+    return (fs::path(sCacheDirectory) / fileName.str()).wstring();
+}
@@ -0,0 +1,61 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <mutex>
+
+
+struct PeakLevel
+{
+    // How many audio frames are combined into one peak.
+    unsigned long long iFramesPerPeak = 0;
+
+    // (min, max) pairs, values are normalized in [-1.0f, 1.0f].
+    std::vector<float> vPeaks;
+};
+
+// Stores min/max peaks of the audio files on the disk so that
+// the oscillogram can be drawn without decoding the file again.
+// A cache entry is valid only while the file's path, size and modification time are the same.
+class PeakCache
+{
+public:
+
+    PeakCache();
+
+
+    void setCacheDirectory  (const std::wstring& sCacheDirectory);
+    std::wstring getCacheDirectory();
+
+
+    // Returns 'true' if there is no valid cache entry for this file.
+    bool loadPeaks          (const std::wstring& sPathToAudioFile, std::vector<PeakLevel>& vLevels);
+    bool savePeaks          (const std::wstring& sPathToAudioFile, const std::vector<PeakLevel>& vLevels);
+
+
+    // Builds coarser levels (each one is 2 times smaller than the previous one)
+    // from the first level while the new level would have at least 'iMinPeakCount' peaks.
+    static void buildLevels (std::vector<PeakLevel>& vLevels, size_t iMinPeakCount);
+
+    // Returns the index of the coarsest level that has at least 'iMinPeakCount' peaks
+    // (or the first level if no level has that much).
+    static size_t pickLevel (const std::vector<PeakLevel>& vLevels, size_t iMinPeakCount);
+
+private:
+
+    bool getFileKey         (const std::wstring& sPathToAudioFile, unsigned long long& iFileSize, long long& iLastWriteTime);
+    std::wstring getCacheFilePath(const std::wstring& sPathToAudioFile);
+
+
+    std::mutex   mtxCache;
+
+    std::wstring sCacheDirectory;
+};
@@ -0,0 +1,77 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "stoppabletask.h"
+
+// STL
+#include <chrono>
+
+
+StoppableTask::StoppableTask()
+{
+    iLastTaskID = 0;
+    bRunning = false;
+}
+
+std::promise<bool> StoppableTask::start(unsigned long long& iTaskID)
+{
+    std::promise<bool> promiseFinish;
+
+    std::lock_guard<std::mutex> lock(mtxTask);
+
+    futureFinish = promiseFinish.get_future().share();
+    bRunning = true;
+
+    iLastTaskID++;
+    iTaskID = iLastTaskID;
+
+    return promiseFinish;
+}
+
+bool StoppableTask::isStopRequested(unsigned long long iTaskID)
+{
+    std::lock_guard<std::mutex> lock(mtxTask);
+
+    // The previous task may not have seen the stop before the next one was started.
+    return bRunning == false || iTaskID != iLastTaskID;
+}
+
+void StoppableTask::markFinished(unsigned long long iTaskID)
+{
+    std::lock_guard<std::mutex> lock(mtxTask);
+
+    if (iTaskID == iLastTaskID)
+    {
+        bRunning = false;
+    }
+}
+
+std::shared_future<bool> StoppableTask::stop()
+{
+    std::lock_guard<std::mutex> lock(mtxTask);
+
+    bRunning = false;
+
+    return futureFinish;
+}
+
+void StoppableTask::stopAndWaitUnlocked(std::unique_lock<std::mutex>& lock)
+{
+    std::shared_future<bool> futureStopped = stop();
+
+    // Another thread may start a new task while the lock is released, stop it too.
+    while (futureStopped.valid() && futureStopped.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        lock.unlock();
+
+        futureStopped.get();
+
+        lock.lock();
+
+        futureStopped = stop();
+    }
+}
@@ -0,0 +1,48 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <mutex>
+#include <future>
+
+
+// The stop handshake of a detached thread that can take a while to notice the stop (the graph drawing).
+// The owner starts the thread under its own mutex and may ask it to stop under any mutex,
+// but waits for it only after unlocking them, so that the other threads are not blocked meanwhile.
+class StoppableTask
+{
+public:
+
+    StoppableTask();
+
+
+    // Should be called before the thread is started (a stop requested before the thread runs is not lost),
+    // the thread should fulfil the returned promise when it finishes and pass 'iTaskID' to the functions below.
+    std::promise<bool> start            (unsigned long long& iTaskID);
+
+    // Called by the thread: returns 'true' if it should stop (also if another task was started after it).
+    bool isStopRequested                (unsigned long long iTaskID);
+    // Called by the thread when it finishes without being asked to.
+    void markFinished                   (unsigned long long iTaskID);
+
+    // Asks the thread to stop, the returned future is ready when it has stopped (invalid if it was never started).
+    // Shared so that every caller waits for the same thread.
+    std::shared_future<bool> stop       ();
+
+    // Asks the thread to stop and waits for it with 'lock' unlocked, returns with 'lock' locked.
+    // If the thread is only started under the mutex of 'lock' then no thread is running when this returns.
+    void stopAndWaitUnlocked            (std::unique_lock<std::mutex>& lock);
+
+private:
+
+    std::mutex          mtxTask;
+    std::shared_future<bool> futureFinish; // under 'mtxTask', of the last started task
+    unsigned long long  iLastTaskID; // under 'mtxTask'
+    bool                bRunning; // under 'mtxTask', the last started task was not asked to stop
+};
@@ -0,0 +1,520 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "trackimporter.h"
+
+// STL
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+
+// Custom
+#include "Model/TracklistFile/tracklistfile.h"
+
+namespace fs = std::filesystem;
+
+
+TrackImporter::TrackImporter(size_t iBatchSize, size_t iThreadCount)
+{
+    if (iBatchSize == 0)
+    {
+        iBatchSize = 1;
+    }
+
+    if (iThreadCount == 0)
+    {
+        iThreadCount = std::thread::hardware_concurrency();
+        if (iThreadCount == 0)
+        {
+            iThreadCount = 1;
+        }
+    }
+
+    this->iBatchSize = iBatchSize;
+    this->iThreadCount = iThreadCount;
+
+    pKnownMetadata = nullptr;
+    pLibrary = nullptr;
+}
+
+void TrackImporter::setOnBatch(std::function<void (XTracklist&, size_t, size_t)> f)
+{
+    onBatch = f;
+}
+
+void TrackImporter::setOnError(std::function<void (const std::wstring&)> f)
+{
+    onError = f;
+}
+
+void TrackImporter::setSkipPath(std::function<bool (const std::wstring&)> f)
+{
+    skipPath = f;
+}
+
+void TrackImporter::importFiles(const std::vector<std::wstring> &vFiles, const std::atomic<bool> *pCancel,
+                                const std::vector<std::shared_ptr<const XTrackMetadata>>* pMetadata)
+{
+    if (pMetadata && pMetadata->size() == vFiles.size())
+    {
+        pKnownMetadata = pMetadata;
+    }
+
+    run([&](const std::function<bool(const std::wstring&)>& addPath)
+    {
+        for (size_t i = 0; i < vFiles.size(); i++)
+        {
+            if (addPath(vFiles[i]) == false)
+            {
+                break;
+            }
+        }
+    }, pCancel);
+
+    pKnownMetadata = nullptr;
+}
+
+void TrackImporter::importFolder(const std::wstring &sFolderPath, const std::atomic<bool> *pCancel, MediaLibrary* pLibrary,
+                                 MediaLibraryChanges* pChanges)
+{
+    bool bFolderError = false;
+
+    this->pLibrary = pLibrary;
+
+    if (pLibrary)
+    {
+        pLibrary->beginScan();
+    }
+
+    run([&](const std::function<bool(const std::wstring&)>& addPath)
+    {
+        std::error_code error;
+
+        fs::recursive_directory_iterator it(sFolderPath, fs::directory_options::skip_permission_denied, error);
+        if (error)
+        {
+            bFolderError = true;
+            return;
+        }
+
+        for (; it != fs::recursive_directory_iterator(); it.increment(error))
+        {
+            if (error)
+            {
+                break;
+            }
+
+            if (it->is_directory(error) == false &&
+                    (it->path().extension() == EXTENSION_MP3 || it->path().extension() == EXTENSION_WAV || it->path().extension() == EXTENSION_OGG))
+            {
+                if (addPath(it->path().wstring()) == false)
+                {
+                    break;
+                }
+            }
+        }
+    }, pCancel);
+
+    if (pLibrary && bFolderError == false && (pCancel == nullptr || pCancel->load() == false))
+    {
+        // All files of the folder were found.
+        pLibrary->finishScan(sFolderPath, pChanges);
+    }
+
+    this->pLibrary = nullptr;
+
+    if (bFolderError && onError)
+    {
+        onError(sFolderPath);
+    }
+}
+
+void TrackImporter::applyFolderChanges(IndexedTracklist &vTracks, const MediaLibraryChanges &changes, XTracklist &vRemovedTracks)
+{
+    // The IDs of the tracks with the changed paths (a file may be added more than once).
+
+    std::unordered_map<std::wstring, std::vector<unsigned long long>> trackIDs;
+
+    for (size_t i = 0; i < changes.vRemovedPaths.size(); i++)
+    {
+        trackIDs[changes.vRemovedPaths[i]];
+    }
+
+    for (size_t i = 0; i < changes.vMovedPaths.size(); i++)
+    {
+        trackIDs[changes.vMovedPaths[i].first];
+        trackIDs[changes.vMovedPaths[i].second];
+    }
+
+    if (trackIDs.size() == 0)
+    {
+        return;
+    }
+
+    for (const std::shared_ptr<XAudioFile>& pTrack : vTracks)
+    {
+        auto it = trackIDs.find(pTrack->sPathToAudioFile);
+
+        if (it != trackIDs.end())
+        {
+            it->second.push_back(pTrack->iTrackID);
+        }
+    }
+
+
+    std::vector<unsigned long long> vRemovedIDs;
+
+    for (size_t i = 0; i < changes.vRemovedPaths.size(); i++)
+    {
+        const std::vector<unsigned long long>& vIDs = trackIDs[changes.vRemovedPaths[i]];
+
+        vRemovedIDs.insert(vRemovedIDs.end(), vIDs.begin(), vIDs.end());
+    }
+
+    for (size_t i = 0; i < changes.vMovedPaths.size(); i++)
+    {
+        const std::vector<unsigned long long>& vOldIDs = trackIDs[changes.vMovedPaths[i].first];
+        const std::vector<unsigned long long>& vNewIDs = trackIDs[changes.vMovedPaths[i].second];
+
+        size_t iOldIndex = 0;
+        size_t iNewIndex = 0;
+
+        if (vOldIDs.size() > 0 && vNewIDs.size() > 0
+                && vTracks.findTrack(vOldIDs[0], iOldIndex) && vTracks.findTrack(vNewIDs[0], iNewIndex))
+        {
+            // The track of the new path takes the place of the old one.
+            vTracks.move(iNewIndex, iOldIndex);
+        }
+
+        vRemovedIDs.insert(vRemovedIDs.end(), vOldIDs.begin(), vOldIDs.end());
+    }
+
+
+    for (size_t i = 0; i < vRemovedIDs.size(); i++)
+    {
+        size_t iIndex = 0;
+
+        if (vTracks.findTrack(vRemovedIDs[i], iIndex))
+        {
+            vRemovedTracks.push_back(vTracks[iIndex]);
+
+            vTracks.remove(iIndex);
+        }
+    }
+}
+
+std::wstring TrackImporter::getTrackTitle(const std::wstring &sAudioPath)
+{
+    size_t iTitleStartIndex = 0;
+    size_t iLastDotPos = 0;
+
+    for (size_t i = sAudioPath.size() - 1; i >= 1; i--)
+    {
+        if (sAudioPath[i] == L'.' && iLastDotPos == 0)
+        {
+            iLastDotPos = i;
+        }
+
+        if (sAudioPath[i] == L'/' || sAudioPath[i] == L'\\')
+        {
+            iTitleStartIndex = i + 1;
+            break;
+        }
+    }
+
+    std::wstring sTrackTitle = sAudioPath.substr(iTitleStartIndex, iLastDotPos - iTitleStartIndex);
+
+    return sTrackTitle;
+}
+
+std::wstring TrackImporter::getTrackExtension(const std::wstring &sTrackPath)
+{
+    size_t iLastDotPos = 0;
+
+    for (size_t i = sTrackPath.size() - 1; i >= 1; i--)
+    {
+        if (sTrackPath[i] == L'.')
+        {
+            iLastDotPos = i;
+
+            break;
+        }
+    }
+
+    std::wstring sTrackExtension = sTrackPath.substr(iLastDotPos + 1, sTrackPath.size() - (iLastDotPos + 1));
+
+    return sTrackExtension;
+}
+
+void TrackImporter::run(const std::function<void (const std::function<bool (const std::wstring&)>&)> &findPaths, const std::atomic<bool> *pCancel)
+{
+    // The walker adds the paths to 'qPaths', the workers open the files and put them to 'mResults'
+    // and this thread takes the results in the order of the paths.
+
+    struct ImportResult
+    {
+        std::wstring sPath;
+        std::shared_ptr<XAudioFile> pAudio; // 'nullptr' if failed or skipped
+        bool bSkipped = false;
+    };
+
+    std::mutex                mtxImport;
+    std::condition_variable   cvPaths;
+    std::condition_variable   cvResults;
+
+    std::deque<std::pair<size_t, std::wstring>> qPaths;
+    std::map<size_t, ImportResult>              mResults;
+    size_t iFoundCount = 0;
+    bool   bWalkFinished = false;
+
+    auto isCancelled = [pCancel]()
+    {
+        return pCancel && pCancel->load();
+    };
+
+    // The cancel flag is not signaled so the threads check it from time to time.
+    const std::chrono::milliseconds checkCancelInterval(50);
+
+    const size_t iPathsPerTake = 16;
+
+
+    std::thread walker([&]()
+    {
+        // The paths are passed to the workers a few at a time (less locking).
+        std::vector<std::wstring> vFoundPaths;
+
+        auto passFoundPaths = [&]()
+        {
+            for (size_t i = 0; i < vFoundPaths.size(); i++)
+            {
+                qPaths.push_back({iFoundCount, vFoundPaths[i]});
+                iFoundCount++;
+            }
+
+            vFoundPaths.clear();
+
+            cvPaths.notify_all();
+        };
+
+        findPaths([&](const std::wstring& sPath)
+        {
+            if (isCancelled())
+            {
+                return false;
+            }
+
+            vFoundPaths.push_back(sPath);
+
+            if (vFoundPaths.size() >= iPathsPerTake)
+            {
+                std::lock_guard<std::mutex> lock(mtxImport);
+                passFoundPaths();
+            }
+
+            return true;
+        });
+
+        std::lock_guard<std::mutex> lock(mtxImport);
+
+        passFoundPaths();
+
+        bWalkFinished = true;
+
+        cvPaths.notify_all();
+        cvResults.notify_all();
+    });
+
+
+    auto worker = [&]()
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mtxImport);
+
+            while (qPaths.size() == 0 && bWalkFinished == false && isCancelled() == false)
+            {
+                cvPaths.wait_for(lock, checkCancelInterval);
+            }
+
+            if (qPaths.size() == 0 || isCancelled())
+            {
+                break;
+            }
+
+            // Take a few paths at once (less locking).
+            std::vector<std::pair<size_t, std::wstring>> vPaths;
+
+            while (qPaths.size() > 0 && vPaths.size() < iPathsPerTake)
+            {
+                vPaths.push_back(qPaths.front());
+                qPaths.pop_front();
+            }
+
+            lock.unlock();
+
+
+            std::vector<ImportResult> vOpened(vPaths.size());
+
+            for (size_t i = 0; i < vPaths.size(); i++)
+            {
+                vOpened[i].sPath = vPaths[i].second;
+
+                std::shared_ptr<const XTrackMetadata> pMetadata = findMetadata(vPaths[i].first, vPaths[i].second);
+
+                if (skipPath && skipPath(vPaths[i].second))
+                {
+                    vOpened[i].bSkipped = true;
+                }
+                else
+                {
+                    vOpened[i].pAudio = openFile(vPaths[i].second, pMetadata);
+                }
+            }
+
+
+            lock.lock();
+
+            for (size_t i = 0; i < vPaths.size(); i++)
+            {
+                mResults[vPaths[i].first] = vOpened[i];
+            }
+
+            cvResults.notify_one();
+        }
+    };
+
+    std::vector<std::thread> vWorkers;
+
+    for (size_t i = 0; i < iThreadCount; i++)
+    {
+        vWorkers.push_back(std::thread(worker));
+    }
+
+
+
+    XTracklist vBatch;
+    size_t iNextResult = 0;
+
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mtxImport);
+
+        while (mResults.count(iNextResult) == 0 && (bWalkFinished == false || iNextResult < iFoundCount) && isCancelled() == false)
+        {
+            cvResults.wait_for(lock, checkCancelInterval);
+        }
+
+        if (isCancelled() || mResults.count(iNextResult) == 0)
+        {
+            // Cancelled or all paths are processed.
+            break;
+        }
+
+        // Take all results that are ready (in order).
+        std::vector<ImportResult> vReady;
+
+        while (mResults.count(iNextResult) > 0)
+        {
+            vReady.push_back(mResults[iNextResult]);
+            mResults.erase(iNextResult);
+            iNextResult++;
+        }
+
+        const size_t iFoundSoFar = iFoundCount;
+
+        lock.unlock();
+
+
+        for (size_t i = 0; i < vReady.size(); i++)
+        {
+            if (vReady[i].pAudio)
+            {
+                vBatch.push_back(vReady[i].pAudio);
+            }
+            else if (vReady[i].bSkipped == false && onError)
+            {
+                onError(vReady[i].sPath);
+            }
+
+            if (vBatch.size() >= iBatchSize)
+            {
+                if (onBatch)
+                {
+                    onBatch(vBatch, iNextResult - (vReady.size() - 1 - i), iFoundSoFar);
+                }
+
+                vBatch.clear();
+            }
+        }
+    }
+
+
+    walker.join();
+
+    for (size_t i = 0; i < vWorkers.size(); i++)
+    {
+        vWorkers[i].join();
+    }
+
+
+    if (vBatch.size() > 0 && isCancelled() == false && onBatch)
+    {
+        onBatch(vBatch, iNextResult, iFoundCount);
+    }
+}
+
+std::shared_ptr<const XTrackMetadata> TrackImporter::findMetadata(size_t iPathIndex, const std::wstring &sPathToAudioFile) const
+{
+    std::shared_ptr<const XTrackMetadata> pMetadata = nullptr;
+
+    if (pLibrary)
+    {
+        // The library checks if the file was changed (and adds the new files).
+        pLibrary->updateFile(sPathToAudioFile, pMetadata);
+    }
+    else if (pKnownMetadata && (*pKnownMetadata)[iPathIndex])
+    {
+        unsigned long long iFileSize = 0;
+        long long iLastWriteTime = 0;
+
+        if (TracklistFile::getFileKey(sPathToAudioFile, iFileSize, iLastWriteTime) == false
+                && iFileSize == (*pKnownMetadata)[iPathIndex]->iFileSizeInBytes && iLastWriteTime == (*pKnownMetadata)[iPathIndex]->iLastWriteTime)
+        {
+            pMetadata = (*pKnownMetadata)[iPathIndex];
+        }
+    }
+
+    return pMetadata;
+}
+
+std::shared_ptr<XAudioFile> TrackImporter::openFile(const std::wstring &sPathToAudioFile, const std::shared_ptr<const XTrackMetadata>& pMetadata)
+{
+    std::error_code error;
+
+    if (fs::is_regular_file(sPathToAudioFile, error) == false)
+    {
+        return nullptr;
+    }
+
+
+    // The file is only opened when it's played.
+
+    std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+
+    pAudio->sPathToAudioFile = sPathToAudioFile;
+    pAudio->sAudioTitle = getTrackTitle(sPathToAudioFile);
+    pAudio->sTrackExtension = getTrackExtension(sPathToAudioFile);
+    pAudio->pMetadata = pMetadata;
+
+
+    return pAudio;
+}
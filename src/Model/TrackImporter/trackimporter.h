@@ -0,0 +1,85 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+
+// Custom
+#include "Model/globals.h"
+#include "Model/MediaLibrary/medialibrary.h"
+#include "Model/IndexedTracklist/indexedtracklist.h"
+
+
+// Opens the audio files on a pool of threads and passes them to the caller in batches.
+// The paths are taken from a list or from a folder walk (that runs at the same time as the workers),
+// the batches keep the order of the paths.
+class TrackImporter
+{
+public:
+
+    // 'iThreadCount' == 0 - one thread per CPU core.
+    TrackImporter(size_t iBatchSize, size_t iThreadCount = 0);
+
+
+    // Called on the thread that called import...() with the opened files,
+    // 'iProcessedCount' of 'iFoundCount' paths are processed (the folder walk may find more).
+    void setOnBatch (std::function<void(XTracklist& vBatch, size_t iProcessedCount, size_t iFoundCount)> f);
+    // Called on the thread that called import...() for each path (or folder) that could not be opened.
+    void setOnError (std::function<void(const std::wstring& sPath)> f);
+    // Called on the worker threads for each path, the files it returns 'true' for are not added
+    // (but the library is still updated with them, see importFolder()).
+    void setSkipPath (std::function<bool(const std::wstring& sPath)> f);
+
+
+    // Both return when all paths are processed or 'pCancel' is set.
+    // 'pMetadata' (if not 'nullptr') has an entry for each file, it's used if the file was not changed since.
+    void importFiles  (const std::vector<std::wstring>& vFiles, const std::atomic<bool>* pCancel = nullptr,
+                       const std::vector<std::shared_ptr<const XTrackMetadata>>* pMetadata = nullptr);
+    // Only the files with the supported extensions (the subfolders too),
+    // 'pLibrary' (if not 'nullptr') is updated with the found files and gives the metadata of the unchanged ones,
+    // 'pChanges' (if not 'nullptr') gets the removed and moved files of the folder (if the folder was walked to the end).
+    void importFolder (const std::wstring& sFolderPath, const std::atomic<bool>* pCancel = nullptr, MediaLibrary* pLibrary = nullptr,
+                       MediaLibraryChanges* pChanges = nullptr);
+
+
+    // Removes the tracks of the removed files and puts the tracks of the moved files (added by the scan)
+    // at the places of their old tracks, 'vRemovedTracks' gets the removed tracks.
+    static void applyFolderChanges (IndexedTracklist& vTracks, const MediaLibraryChanges& changes, XTracklist& vRemovedTracks);
+
+    static std::wstring getTrackTitle     (const std::wstring& sAudioPath);
+    static std::wstring getTrackExtension (const std::wstring& sTrackPath);
+
+private:
+
+    // 'findPaths' is called on a separate thread, it should stop if 'addPath' returns 'false' (cancelled).
+    void run (const std::function<void(const std::function<bool(const std::wstring&)>& addPath)>& findPaths, const std::atomic<bool>* pCancel);
+
+    // Returns 'nullptr' if the metadata is not known or the file was changed since.
+    std::shared_ptr<const XTrackMetadata> findMetadata (size_t iPathIndex, const std::wstring& sPathToAudioFile) const;
+
+    // Returns 'nullptr' if the file does not exist.
+    static std::shared_ptr<XAudioFile> openFile(const std::wstring& sPathToAudioFile, const std::shared_ptr<const XTrackMetadata>& pMetadata);
+
+
+    std::function<void(XTracklist&, size_t, size_t)> onBatch;
+    std::function<void(const std::wstring&)>         onError;
+    std::function<bool(const std::wstring&)>         skipPath;
+
+    // Set only during importFiles(), indexed as the paths.
+    const std::vector<std::shared_ptr<const XTrackMetadata>>* pKnownMetadata;
+    // Set only during importFolder().
+    MediaLibrary* pLibrary;
+
+
+    size_t iBatchSize;
+    size_t iThreadCount;
+};
@@ -0,0 +1,411 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "tracklistfile.h"
+
+// STL
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+#include <cstring>
+
+// Custom
+#include "Model/AudioEngine/SMappedFile/smappedfile.h"
+#include "Model/Utf8/utf8.h"
+
+namespace fs = std::filesystem;
+
+
+// The records are copied out of the mapped file with memcpy() (the offsets are not checked for alignment).
+
+struct STracklistFileHeader
+{
+    char               vMagic[4];
+    unsigned int       iVersion;
+    unsigned int       iTrackCount;
+    unsigned int       iDirectoryCount;
+    unsigned long long iDirectoriesOffset;
+    unsigned long long iTracksOffset;
+    unsigned long long iStringsOffset;
+    unsigned long long iStringsSizeInBytes;
+};
+
+struct STracklistFileDirectory
+{
+    unsigned int       iParentIndex; // 'iNoDirectory' - the name is the whole path
+    unsigned int       iNameOffset;  // in the strings
+    unsigned int       iNameSizeInBytes;
+};
+
+struct STracklistFileTrack
+{
+    unsigned int       iDirectoryIndex; // 'iNoDirectory' - the name is the whole path
+    unsigned int       iNameOffset;     // in the strings
+    unsigned int       iNameSizeInBytes;
+    unsigned int       iBitrate;
+    unsigned long long iFileSizeInBytes; // 0 - no metadata
+    long long          iLastWriteTime;
+    double             dLengthInSec;
+    unsigned int       iSampleRate;
+    unsigned short     iChannels;
+    unsigned short     iBitsPerSample;
+};
+
+static_assert(sizeof(STracklistFileHeader) == 48,    "the header size is a part of the file format");
+static_assert(sizeof(STracklistFileDirectory) == 12, "the directory size is a part of the file format");
+static_assert(sizeof(STracklistFileTrack) == 48,     "the track size is a part of the file format");
+
+static const unsigned int iNoDirectory = 0xFFFFFFFF;
+
+
+static size_t findLastSeparator(const std::wstring& sPath)
+{
+    return sPath.find_last_of(L"/\\");
+}
+
+// Returns 'true' if [iOffset, iOffset + iSize) is not inside of [0, iTotalSize).
+static bool isOutOfRange(unsigned long long iOffset, unsigned long long iSize, unsigned long long iTotalSize)
+{
+    return iOffset > iTotalSize || iSize > iTotalSize - iOffset;
+}
+
+
+bool TracklistFile::save(const std::wstring &sPathToFile, const IndexedTracklist &vTracks)
+{
+    std::vector<STracklistFileDirectory> vDirectories;
+    std::vector<STracklistFileTrack>     vTrackRecords(vTracks.size());
+    std::string                          sStrings;
+
+    std::unordered_map<std::wstring, unsigned int> directoryIndex;
+
+
+    auto addString = [&](const std::wstring& sText, unsigned int& iOffset, unsigned int& iSizeInBytes)
+    {
+        iOffset = static_cast<unsigned int>(sStrings.size());
+
+        Utf8::appendUtf8(sStrings, sText);
+
+        iSizeInBytes = static_cast<unsigned int>(sStrings.size() - iOffset);
+    };
+
+    // The parent directories are added first.
+    std::function<unsigned int(const std::wstring&)> addDirectory = [&](const std::wstring& sDirectory) -> unsigned int
+    {
+        auto it = directoryIndex.find(sDirectory);
+
+        if (it != directoryIndex.end())
+        {
+            return it->second;
+        }
+
+
+        STracklistFileDirectory directory;
+        directory.iParentIndex = iNoDirectory;
+
+        size_t iSeparatorPos = findLastSeparator(sDirectory);
+
+        if (iSeparatorPos != std::wstring::npos && iSeparatorPos > 0)
+        {
+            directory.iParentIndex = addDirectory(sDirectory.substr(0, iSeparatorPos));
+
+            addString(sDirectory.substr(iSeparatorPos), directory.iNameOffset, directory.iNameSizeInBytes);
+        }
+        else
+        {
+            addString(sDirectory, directory.iNameOffset, directory.iNameSizeInBytes);
+        }
+
+        vDirectories.push_back(directory);
+
+        unsigned int iIndex = static_cast<unsigned int>(vDirectories.size() - 1);
+        directoryIndex[sDirectory] = iIndex;
+
+        return iIndex;
+    };
+
+
+    for (size_t i = 0; i < vTracks.size(); i++)
+    {
+        const std::wstring& sPath = vTracks[i]->sPathToAudioFile;
+        STracklistFileTrack& track = vTrackRecords[i];
+
+        std::memset(&track, 0, sizeof(track));
+
+        size_t iSeparatorPos = findLastSeparator(sPath);
+
+        if (iSeparatorPos != std::wstring::npos && iSeparatorPos > 0)
+        {
+            track.iDirectoryIndex = addDirectory(sPath.substr(0, iSeparatorPos));
+
+            addString(sPath.substr(iSeparatorPos), track.iNameOffset, track.iNameSizeInBytes);
+        }
+        else
+        {
+            track.iDirectoryIndex = iNoDirectory;
+
+            addString(sPath, track.iNameOffset, track.iNameSizeInBytes);
+        }
+
+
+        std::shared_ptr<const XTrackMetadata> pMetadata = std::atomic_load(&vTracks[i]->pMetadata);
+
+        if (pMetadata)
+        {
+            track.iFileSizeInBytes = pMetadata->iFileSizeInBytes;
+            track.iLastWriteTime   = pMetadata->iLastWriteTime;
+            track.dLengthInSec     = pMetadata->dLengthInSec;
+            track.iSampleRate      = pMetadata->iSampleRate;
+            track.iBitrate         = pMetadata->iBitrate;
+            track.iChannels        = pMetadata->iChannels;
+            track.iBitsPerSample   = pMetadata->iBitsPerSample;
+        }
+    }
+
+    if (sStrings.size() > 0xFFFFFFFF)
+    {
+        // The string offsets are 32-bit.
+        return true;
+    }
+
+
+    STracklistFileHeader header;
+    std::memcpy(header.vMagic, TRACKLIST_FILE_MAGIC, sizeof(header.vMagic));
+    header.iVersion            = TRACKLIST_FILE_VERSION;
+    header.iTrackCount         = static_cast<unsigned int>(vTrackRecords.size());
+    header.iDirectoryCount     = static_cast<unsigned int>(vDirectories.size());
+    header.iDirectoriesOffset  = sizeof(header);
+    header.iTracksOffset       = header.iDirectoriesOffset + vDirectories.size() * sizeof(STracklistFileDirectory);
+    header.iStringsOffset      = header.iTracksOffset + vTrackRecords.size() * sizeof(STracklistFileTrack);
+    header.iStringsSizeInBytes = sStrings.size();
+
+
+    // Write to a temporary file first so that the old tracklist is not lost if the write fails.
+
+    fs::path filePath = fs::path(sPathToFile);
+    fs::path tempPath = filePath;
+    tempPath += L".tmp";
+
+    std::ofstream file(tempPath, std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(vDirectories.data()), static_cast<std::streamsize>(vDirectories.size() * sizeof(STracklistFileDirectory)));
+    file.write(reinterpret_cast<const char*>(vTrackRecords.data()), static_cast<std::streamsize>(vTrackRecords.size() * sizeof(STracklistFileTrack)));
+    file.write(sStrings.data(), static_cast<std::streamsize>(sStrings.size()));
+
+    bool bFailed = file.fail();
+
+    file.close();
+
+    std::error_code ec;
+
+    if (bFailed)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+    fs::rename(tempPath, filePath, ec);
+    if (ec)
+    {
+        fs::remove(tempPath, ec);
+        return true;
+    }
+
+    return false;
+}
+
+bool TracklistFile::open(const std::wstring &sPathToFile, std::vector<std::wstring> &vPaths,
+                         std::vector<std::shared_ptr<const XTrackMetadata>> &vMetadata)
+{
+    vPaths.clear();
+    vMetadata.clear();
+
+
+    SMappedFile file;
+
+    if (file.open(sPathToFile))
+    {
+        return true;
+    }
+
+    const unsigned char* pData = file.getData();
+    const size_t iFileSize = file.getSizeInBytes();
+
+
+    if (iFileSize < sizeof(STracklistFileHeader) || std::memcmp(pData, TRACKLIST_FILE_MAGIC, 4) != 0)
+    {
+        if (openOldFormat(pData, iFileSize, vPaths))
+        {
+            vPaths.clear();
+            return true;
+        }
+
+        vMetadata.resize(vPaths.size());
+
+        return false;
+    }
+
+
+    STracklistFileHeader header;
+    std::memcpy(&header, pData, sizeof(header));
+
+    if (header.iVersion != TRACKLIST_FILE_VERSION
+            || isOutOfRange(header.iDirectoriesOffset, static_cast<unsigned long long>(header.iDirectoryCount) * sizeof(STracklistFileDirectory), iFileSize)
+            || isOutOfRange(header.iTracksOffset, static_cast<unsigned long long>(header.iTrackCount) * sizeof(STracklistFileTrack), iFileSize)
+            || isOutOfRange(header.iStringsOffset, header.iStringsSizeInBytes, iFileSize))
+    {
+        return true;
+    }
+
+    const unsigned char* pStrings = pData + header.iStringsOffset;
+
+
+    std::vector<std::wstring> vDirectories(header.iDirectoryCount);
+
+    for (unsigned int i = 0; i < header.iDirectoryCount; i++)
+    {
+        STracklistFileDirectory directory;
+        std::memcpy(&directory, pData + header.iDirectoriesOffset + i * sizeof(STracklistFileDirectory), sizeof(directory));
+
+        if (isOutOfRange(directory.iNameOffset, directory.iNameSizeInBytes, header.iStringsSizeInBytes))
+        {
+            return true;
+        }
+
+        if (directory.iParentIndex != iNoDirectory)
+        {
+            if (directory.iParentIndex >= i)
+            {
+                // The parents are written first.
+                return true;
+            }
+
+            vDirectories[i] = vDirectories[directory.iParentIndex];
+        }
+
+        if (Utf8::appendWide(vDirectories[i], pStrings + directory.iNameOffset, directory.iNameSizeInBytes))
+        {
+            return true;
+        }
+    }
+
+
+    vPaths.resize(header.iTrackCount);
+    vMetadata.resize(header.iTrackCount);
+
+    for (unsigned int i = 0; i < header.iTrackCount; i++)
+    {
+        STracklistFileTrack track;
+        std::memcpy(&track, pData + header.iTracksOffset + i * sizeof(STracklistFileTrack), sizeof(track));
+
+        if (isOutOfRange(track.iNameOffset, track.iNameSizeInBytes, header.iStringsSizeInBytes)
+                || (track.iDirectoryIndex != iNoDirectory && track.iDirectoryIndex >= header.iDirectoryCount))
+        {
+            vPaths.clear();
+            vMetadata.clear();
+            return true;
+        }
+
+        if (track.iDirectoryIndex != iNoDirectory)
+        {
+            vPaths[i] = vDirectories[track.iDirectoryIndex];
+        }
+
+        if (Utf8::appendWide(vPaths[i], pStrings + track.iNameOffset, track.iNameSizeInBytes))
+        {
+            vPaths.clear();
+            vMetadata.clear();
+            return true;
+        }
+
+
+        if (track.iFileSizeInBytes != 0)
+        {
+            std::shared_ptr<XTrackMetadata> pMetadata = std::make_shared<XTrackMetadata>();
+            pMetadata->iFileSizeInBytes = track.iFileSizeInBytes;
+            pMetadata->iLastWriteTime   = track.iLastWriteTime;
+            pMetadata->dLengthInSec     = track.dLengthInSec;
+            pMetadata->iSampleRate      = track.iSampleRate;
+            pMetadata->iBitrate         = track.iBitrate;
+            pMetadata->iChannels        = track.iChannels;
+            pMetadata->iBitsPerSample   = track.iBitsPerSample;
+
+            vMetadata[i] = pMetadata;
+        }
+    }
+
+    return false;
+}
+
+bool TracklistFile::getFileKey(const std::wstring &sPathToAudioFile, unsigned long long &iFileSize, long long &iLastWriteTime)
+{
+    std::error_code ec;
+
+    iFileSize = fs::file_size(fs::path(sPathToAudioFile), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+    fs::file_time_type lastWriteTime = fs::last_write_time(fs::path(sPathToAudioFile), ec);
+    if (ec)
+    {
+        return true;
+    }
+
+    iLastWriteTime = static_cast<long long>(lastWriteTime.time_since_epoch().count());
+
+    return false;
+}
+
+bool TracklistFile::openOldFormat(const unsigned char *pData, size_t iSizeInBytes, std::vector<std::wstring> &vPaths)
+{
+    // The track count and then the size and the characters of each path.
+
+    unsigned int iTrackCount = 0;
+    size_t iReadPos = 0;
+
+    if (iSizeInBytes < sizeof(iTrackCount))
+    {
+        return true;
+    }
+
+    std::memcpy(&iTrackCount, pData, sizeof(iTrackCount));
+    iReadPos += sizeof(iTrackCount);
+
+
+    for (unsigned int i = 0; i < iTrackCount; i++)
+    {
+        unsigned short iPathSize = 0;
+
+        if (isOutOfRange(iReadPos, sizeof(iPathSize), iSizeInBytes))
+        {
+            return true;
+        }
+
+        std::memcpy(&iPathSize, pData + iReadPos, sizeof(iPathSize));
+        iReadPos += sizeof(iPathSize);
+
+        if (isOutOfRange(iReadPos, iPathSize * sizeof(wchar_t), iSizeInBytes))
+        {
+            return true;
+        }
+
+        std::wstring sPath(iPathSize, L'\0');
+        std::memcpy(&sPath[0], pData + iReadPos, iPathSize * sizeof(wchar_t));
+        iReadPos += iPathSize * sizeof(wchar_t);
+
+        vPaths.push_back(sPath);
+    }
+
+    return false;
+}
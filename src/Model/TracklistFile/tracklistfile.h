@@ -0,0 +1,47 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <memory>
+
+// Custom
+#include "Model/globals.h"
+#include "Model/IndexedTracklist/indexedtracklist.h"
+
+
+// The tracklist file (.xtl):
+// - the header (magic, version, counts and offsets of the sections),
+// - the directories, each one is its parent directory + the rest of the path
+//   (so the common part of the paths is stored once),
+// - the tracks, each one is its directory + the file name and the metadata (see XTrackMetadata),
+// - the UTF-8 strings of the names.
+// The records have a fixed size so that the file is read right from the mapped memory.
+// The files of the old format (the count and the 'wchar_t' paths) are opened too.
+class TracklistFile
+{
+public:
+
+    // Returns 'true' if the file can't be written.
+    static bool save       (const std::wstring& sPathToFile, const IndexedTracklist& vTracks);
+
+    // Returns 'true' if the file can't be opened or it's damaged,
+    // 'vMetadata' has an entry for each path ('nullptr' if not known).
+    static bool open       (const std::wstring& sPathToFile, std::vector<std::wstring>& vPaths,
+                            std::vector<std::shared_ptr<const XTrackMetadata>>& vMetadata);
+
+
+    // The key the metadata is checked with, returns 'true' if the file does not exist.
+    static bool getFileKey (const std::wstring& sPathToAudioFile, unsigned long long& iFileSize, long long& iLastWriteTime);
+
+private:
+
+    static bool openOldFormat (const unsigned char* pData, size_t iSizeInBytes, std::vector<std::wstring>& vPaths);
+};
@@ -0,0 +1,122 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "utf8.h"
+
+
+void Utf8::appendUtf8(std::string &sOut, const std::wstring &sText)
+{
+    for (size_t i = 0; i < sText.size(); i++)
+    {
+        unsigned long iCodePoint = static_cast<unsigned long>(sText[i]);
+
+        if (sizeof(wchar_t) == 2 && iCodePoint >= 0xD800 && iCodePoint <= 0xDBFF && i + 1 < sText.size())
+        {
+            unsigned long iLow = static_cast<unsigned long>(sText[i + 1]);
+
+            if (iLow >= 0xDC00 && iLow <= 0xDFFF)
+            {
+                iCodePoint = 0x10000 + ((iCodePoint - 0xD800) << 10) + (iLow - 0xDC00);
+                i++;
+            }
+        }
+
+        if (iCodePoint < 0x80)
+        {
+            sOut += static_cast<char>(iCodePoint);
+        }
+        else if (iCodePoint < 0x800)
+        {
+            sOut += static_cast<char>(0xC0 | (iCodePoint >> 6));
+            sOut += static_cast<char>(0x80 | (iCodePoint & 0x3F));
+        }
+        else if (iCodePoint < 0x10000)
+        {
+            sOut += static_cast<char>(0xE0 | (iCodePoint >> 12));
+            sOut += static_cast<char>(0x80 | ((iCodePoint >> 6) & 0x3F));
+            sOut += static_cast<char>(0x80 | (iCodePoint & 0x3F));
+        }
+        else
+        {
+            sOut += static_cast<char>(0xF0 | ((iCodePoint >> 18) & 0x07));
+            sOut += static_cast<char>(0x80 | ((iCodePoint >> 12) & 0x3F));
+            sOut += static_cast<char>(0x80 | ((iCodePoint >> 6) & 0x3F));
+            sOut += static_cast<char>(0x80 | (iCodePoint & 0x3F));
+        }
+    }
+}
+
+bool Utf8::appendWide(std::wstring &sOut, const unsigned char *pText, size_t iSizeInBytes)
+{
+    size_t i = 0;
+
+    while (i < iSizeInBytes)
+    {
+        unsigned long iCodePoint = pText[i];
+        size_t iContinuationCount = 0;
+
+        if (iCodePoint < 0x80)
+        {
+        }
+        else if ((iCodePoint & 0xE0) == 0xC0)
+        {
+            iCodePoint &= 0x1F;
+            iContinuationCount = 1;
+        }
+        else if ((iCodePoint & 0xF0) == 0xE0)
+        {
+            iCodePoint &= 0x0F;
+            iContinuationCount = 2;
+        }
+        else if ((iCodePoint & 0xF8) == 0xF0)
+        {
+            iCodePoint &= 0x07;
+            iContinuationCount = 3;
+        }
+        else
+        {
+            return true;
+        }
+
+        if (iContinuationCount > iSizeInBytes - i - 1)
+        {
+            return true;
+        }
+
+        for (size_t j = 1; j <= iContinuationCount; j++)
+        {
+            if ((pText[i + j] & 0xC0) != 0x80)
+            {
+                return true;
+            }
+
+            iCodePoint = (iCodePoint << 6) | (pText[i + j] & 0x3F);
+        }
+
+        i += iContinuationCount + 1;
+
+
+        if (iCodePoint > 0x10FFFF)
+        {
+            return true;
+        }
+
+        if (sizeof(wchar_t) == 2 && iCodePoint >= 0x10000)
+        {
+            iCodePoint -= 0x10000;
+
+            sOut += static_cast<wchar_t>(0xD800 + (iCodePoint >> 10));
+            sOut += static_cast<wchar_t>(0xDC00 + (iCodePoint & 0x3FF));
+        }
+        else
+        {
+            sOut += static_cast<wchar_t>(iCodePoint);
+        }
+    }
+
+    return false;
+}
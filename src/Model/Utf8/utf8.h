@@ -0,0 +1,25 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <cstddef>
+
+
+// UTF-8 <-> wchar_t (UTF-16 on Windows, UTF-32 on other platforms) for the files that should not
+// depend on the platform, unpaired surrogates are kept as they are so that any path can be saved.
+class Utf8
+{
+public:
+
+    static void appendUtf8 (std::string& sOut, const std::wstring& sText);
+
+    // Returns 'true' if the text is not valid UTF-8.
+    static bool appendWide (std::wstring& sOut, const unsigned char* pText, size_t iSizeInBytes);
+};
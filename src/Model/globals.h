@@ -8,24 +8,47 @@
 #pragma once
 
 // STL
-#include <fstream>
 #include <string>
+#include <vector>
+#include <memory>
 
 
+// Information about the audio file that is known after the file was played once,
+// it's saved in the tracklist file (see TracklistFile) so it's known after the tracklist is opened.
+struct XTrackMetadata
+{
+    // The file this information is for.
+    unsigned long long iFileSizeInBytes = 0;
+    long long          iLastWriteTime = 0;
+
+    double             dLengthInSec = 0.0;
+    unsigned int       iSampleRate = 0;
+    unsigned int       iBitrate = 0;
+    unsigned short     iChannels = 0;
+    unsigned short     iBitsPerSample = 0;
+};
+
 struct XAudioFile
 {
+    // Unique for the whole session (given when the track is added to the tracklist), 0 - no track.
+    unsigned long long iTrackID = 0;
+
     std::wstring sAudioTitle;
     std::wstring sPathToAudioFile;
-    std::ifstream* pOpenedStream;
 
     std::wstring sTrackExtension;
 
-    class TrackWidget* pTrackWidget = nullptr;
+    // 'nullptr' if not known, replaced (not changed) using std::atomic_load/atomic_store.
+    std::shared_ptr<const XTrackMetadata> pMetadata;
 };
 
+// The tracks are shared so that a snapshot of the tracklist stays valid after the tracks are removed.
+using XTracklist = std::vector<std::shared_ptr<XAudioFile>>;
+
 struct CurrentEffects
 {
     float fPitchInSemitones = 0.0f;
+    float fTempo = 1.0f;
     float fReverbVolume = 0.0f;
 };
 
@@ -45,7 +68,38 @@ struct CurrentEffects
 #define MAX_Y_AXIS_VALUE 1.03
 #define MAX_X_AXIS_VALUE 1000
 
-#define UPDATE_TRACK_POS_IN_MS 500
+#define UPDATE_TRACK_POS_IN_MS 500 // how often the position clock is corrected
+#define PREFETCH_NEXT_TRACK_BEFORE_END_IN_SEC 5.0
+#define MAX_CACHED_AUDIO_FILES 8 // mapped files of the tracks that are not played right now (see SFileHandleCache)
+
+#define IMPORT_BATCH_SIZE 500 // tracks added to the tracklist (and to the UI) at once
+#define IMPORT_THREAD_COUNT 0 // 0 - one thread per CPU core
+
+#define TRACKLIST_CHUNK_SIZE 256 // tracks per chunk of the IndexedTracklist (copied when one of them is changed)
+#define TRACKLIST_INDEX_SHARD_SIZE 256 // track IDs per shard of the IndexedTracklist index
+
+#define SPECTRUM_FFT_SIZE 2048
+#define SPECTRUM_BAND_COUNT 64
+#define SPECTRUM_MIN_FREQUENCY 30.0f
+#define SPECTRUM_MAX_FREQUENCY 16000.0f
+#define SPECTRUM_UPDATE_IN_MS 16
+
+#define DEFAULT_CROSSFADE_IN_SEC 0.0
+#define MAX_CROSSFADE_IN_SEC 12.0
 
 #define REPEAT_SECTION_DELTA_IN_SEC 1.0
 #define TRANSITION_SLEEP_MS 1
+
+#define PEAK_CACHE_FOLDER_NAME L"peaks"
+#define PEAK_CACHE_FILE_EXTENSION L".xpk"
+#define PEAK_CACHE_MAGIC "XPKC"
+#define PEAK_CACHE_VERSION 2
+#define PEAK_CACHE_MIN_PEAK_COUNT 512
+
+#define TRACKLIST_FILE_MAGIC "XTLF"
+#define TRACKLIST_FILE_VERSION 1
+
+#define LIBRARY_FILE_NAME L"library.xlb"
+#define LIBRARY_FILE_MAGIC "XLIB"
+#define LIBRARY_FILE_VERSION 1
+#define LIBRARY_HASH_BLOCK_SIZE 16384 // the first and the last bytes of the file that are hashed
@@ -8,6 +8,9 @@
 #include "fxwindow.h"
 #include "ui_fxwindow.h"
 
+// STL
+#include <cmath>
+
 // Custom
 #include "View/MainWindow/mainwindow.h"
 #include "Controller/controller.h"
@@ -44,6 +47,7 @@ void FXWindow::applyCurrentEffects()
 
     // Pan
     ui->horizontalSlider_pitch->setValue(static_cast<int>(pEffects->fPitchInSemitones));
+    ui->horizontalSlider_tempo->setValue(static_cast<int>(std::lround(pEffects->fTempo * 100.0f)));
     ui->horizontalSlider_reverb->setValue(static_cast<int>(pEffects->fReverbVolume * 100.0f));
 }
 
@@ -59,6 +63,18 @@ void FXWindow::on_pushButton_pitch_clicked()
     ui->horizontalSlider_pitch->setValue(0);
 }
 
+void FXWindow::on_horizontalSlider_tempo_valueChanged(int value)
+{
+    ui->label_tempo->setText("Tempo: " + QString::number(value) + "%");
+
+    pMainWindow->pController->setTempo(value / 100.0f);
+}
+
+void FXWindow::on_pushButton_tempo_clicked()
+{
+    ui->horizontalSlider_tempo->setValue(100);
+}
+
 void FXWindow::on_horizontalSlider_reverb_valueChanged(int value)
 {
     ui->label_reverb->setText("Reverb Volume: " + QString::number(value) + "%");
@@ -29,10 +29,12 @@ protected:
 private slots:
     // Sliders.
     void on_horizontalSlider_pitch_valueChanged(int value);
+    void on_horizontalSlider_tempo_valueChanged(int value);
     void on_horizontalSlider_reverb_valueChanged(int value);
 
     // Reset buttons.
     void on_pushButton_pitch_clicked();
+    void on_pushButton_tempo_clicked();
     void on_pushButton_reverb_clicked();
 
 private:
@@ -13,18 +13,23 @@
 #include <QMessageBox>
 #include <QFile>
 #include <QStyle>
-#include <QScrollBar>
+#include <QStatusBar>
 #include <QFileDialog>
 #include <QKeyEvent>
+#include <QTimer>
+#include <QScreen>
+#include <QGuiApplication>
 
 // Custom
 #include "Controller/controller.h"
 #include "Model/globals.h"
+#include "Model/AudioEngine/SPositionClock/spositionclock.h"
 #include "View/AboutWindow/aboutwindow.h"
-#include "View/TrackWidget/trackwidget.h"
+#include "View/TrackListModel/tracklistmodel.h"
 #include "View/AboutQtWindow/aboutqtwindow.h"
 #include "View/SearchWindow/searchwindow.h"
 #include "View/FXWindow/fxwindow.h"
+#include "View/SpectrumWindow/spectrumwindow.h"
 #include "../ext/qcustomplot/qcustomplot.h"
 
 
@@ -34,10 +39,13 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
-    ui->scrollArea_tracklist->init(this);
+    ui->listView_tracklist->init(this);
 
-    pSelectedTrack = nullptr;
-    pPlayingTrack  = nullptr;
+    pController    = nullptr;
+    pPositionTimer = nullptr;
+
+    iLastPositionPixel  = -1;
+    iLastPositionSecond = -1;
 
     bPlayButtonStatePlay = true;
     bRepeatButtonStateActive = false;
@@ -45,6 +53,8 @@ MainWindow::MainWindow(QWidget *parent)
 
 
     qRegisterMetaType<std::vector<float>>("std::vector<float>");
+    qRegisterMetaType<std::shared_ptr<const IndexedTracklist>>("std::shared_ptr<const IndexedTracklist>");
+    qRegisterMetaType<size_t>("size_t");
 
 
     // This to this.
@@ -55,8 +65,10 @@ MainWindow::MainWindow(QWidget *parent)
     connect(this, &MainWindow::signalClearGraph, this, &MainWindow::slotClearGraph);
     connect(this, &MainWindow::signalSetMaxXToGraph, this, &MainWindow::slotSetMaxXToGraph);
     connect(this, &MainWindow::signalAddWaveDataToGraph, this, &MainWindow::slotAddWaveDataToGraph);
-    connect(this, &MainWindow::signalSetCurrentPos, this, &MainWindow::slotSetCurrentPos);
     connect(this, &MainWindow::signalSetMainWindowTitle, this, &MainWindow::slotSetMainWindowTitle);
+    // Always queued so that the snapshots from different threads are shown in the same order.
+    connect(this, &MainWindow::signalSetTracklist, this, &MainWindow::slotSetTracklist, Qt::QueuedConnection);
+    connect(this, &MainWindow::signalSetImportProgress, this, &MainWindow::slotSetImportProgress);
 
 
     // Apply stylesheet.
@@ -69,11 +81,13 @@ MainWindow::MainWindow(QWidget *parent)
     ui->pushButton_random->setProperty("cssClass", "random");
     ui->pushButton_fx->setProperty("cssClass", "fx");
     ui->pushButton_clear->setProperty("cssClass", "clear");
-    ui->scrollAreaWidgetContents->setProperty("cssClass", "tracklist_widget");
+    ui->listView_tracklist->setProperty("cssClass", "tracklist");
     ui->frame->setProperty("cssClass", "graphWidget");
 
-    ui->scrollAreaWidgetContents->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    ui->verticalLayout_tracks->layout()->setSizeConstraint(QLayout::SetFixedSize);
+    // Context menu on TrackList.
+    connect(ui->listView_tracklist, &TrackList::signalMoveUp, this, &MainWindow::slotMoveUp);
+    connect(ui->listView_tracklist, &TrackList::signalMoveDown, this, &MainWindow::slotMoveDown);
+    connect(ui->listView_tracklist, &TrackList::signalDelete, this, &MainWindow::slotDeleteSelectedTrack);
 
     applyStyle();
 
@@ -106,6 +120,22 @@ void MainWindow::onExecCalled()
     pController = new Controller(this);
 
 
+
+    // Track position.
+    // The position is extrapolated from the position clock on each frame (no locks are taken).
+
+    double dRefreshRate = 60.0;
+    if (QGuiApplication::primaryScreen() && QGuiApplication::primaryScreen()->refreshRate() > 1.0)
+    {
+        dRefreshRate = QGuiApplication::primaryScreen()->refreshRate();
+    }
+
+    pPositionTimer = new QTimer(this);
+    pPositionTimer->setTimerType(Qt::PreciseTimer);
+    connect(pPositionTimer, &QTimer::timeout, this, &MainWindow::slotUpdatePosition);
+    pPositionTimer->start(static_cast<int>(1000.0 / dRefreshRate));
+
+
     if (args.size() > 0)
     {
         std::vector<std::wstring> vTracks;
@@ -131,42 +161,14 @@ void MainWindow::setMainWindowTitle(const std::wstring sText)
     emit signalSetMainWindowTitle(QString::fromStdWString(sText));
 }
 
-void MainWindow::addTrackWidget(const std::wstring &sTrackTitle, std::promise<TrackWidget*> *pPromiseCreateWidget)
+void MainWindow::setTracklist(std::shared_ptr<const IndexedTracklist> pTracklist)
 {
-    std::lock_guard<std::mutex> lock(mtxUIStateChange);
-
-    TrackWidget* pTrackWidget = new TrackWidget(QString::fromStdWString(sTrackTitle), this);
-
-    ui->verticalLayout_tracks->addWidget(pTrackWidget);
-    ui->scrollArea_tracklist->verticalScrollBar()->setSliderPosition(ui->scrollArea_tracklist->verticalScrollBar()->maximum());
-
-    connect(pTrackWidget, &TrackWidget::signalMoveUp, this, &MainWindow::slotMoveUp);
-    connect(pTrackWidget, &TrackWidget::signalMoveDown, this, &MainWindow::slotMoveDown);
-    connect(pTrackWidget, &TrackWidget::signalDelete, this, &MainWindow::slotDeleteSelectedTrack);
-
-    pPromiseCreateWidget->set_value(pTrackWidget);
+    emit signalSetTracklist(pTracklist);
 }
 
-void MainWindow::removeTrackWidget(TrackWidget *pTrackWidget, std::promise<bool> *pPromiseRemoveWidget)
+void MainWindow::setImportProgress(size_t iProcessedCount, size_t iFoundCount, bool bFinished)
 {
-    std::lock_guard<std::mutex> lock(mtxUIStateChange);
-
-    if (pTrackWidget == pSelectedTrack)
-    {
-        pSelectedTrack = nullptr;
-    }
-
-    if (pTrackWidget == pPlayingTrack)
-    {
-        pPlayingTrack = nullptr;
-        ui->label_track_name->setText("");
-        ui->label_track_info->setText("");
-    }
-
-    //delete pTrackWidget; // 'delete' below is causing a crash if the context menu is opened on TrackWidget
-    pTrackWidget->deleteLater();
-
-    pPromiseRemoveWidget->set_value(false);
+    emit signalSetImportProgress(iProcessedCount, iFoundCount, bFinished);
 }
 
 void MainWindow::showMessageBox(std::wstring sMessageTitle, std::wstring sMessageText, bool bErrorMessage, bool bSendSignal)
@@ -314,7 +316,7 @@ void MainWindow::changeRandomButtonStyle(bool bActive)
     bRandomButtonStateActive = bActive;
 }
 
-void MainWindow::setNewPlayingTrack(TrackWidget *pTrackWidget, bool bSendSignal)
+void MainWindow::setNewPlayingTrack(unsigned long long iTrackID, bool bSendSignal)
 {
     std::lock_guard<std::mutex> lock(mtxUIStateChange);
 
@@ -323,13 +325,13 @@ void MainWindow::setNewPlayingTrack(TrackWidget *pTrackWidget, bool bSendSignal)
         std::promise<bool> promiseFinish;
         std::future<bool> f = promiseFinish.get_future();
 
-        emit signalSetNewPlayingTrack(pTrackWidget, &promiseFinish);
+        emit signalSetNewPlayingTrack(iTrackID, &promiseFinish);
 
         f.get();
     }
     else
     {
-        slotSetNewPlayingTrack(pTrackWidget, nullptr);
+        slotSetNewPlayingTrack(iTrackID, nullptr);
     }
 }
 
@@ -351,11 +353,11 @@ void MainWindow::setSearchMatchCount(size_t iMatches)
     emit signalSearchMatchCount(iMatches);
 }
 
-void MainWindow::searchSetSelected(TrackWidget* pTrackWidget)
+void MainWindow::searchSetSelected(unsigned long long iTrackID)
 {
-    on_trackWidget_mousePress(pTrackWidget);
+    on_trackList_mousePress(iTrackID, false);
 
-    ui->scrollArea_tracklist->ensureWidgetVisible(pTrackWidget);
+    ui->listView_tracklist->scrollToTrack(ui->listView_tracklist->getModel()->findRow(iTrackID));
 }
 
 void MainWindow::clearGraph()
@@ -373,14 +375,14 @@ void MainWindow::addWaveDataToGraph(std::vector<float> vWaveData)
     emit signalAddWaveDataToGraph(vWaveData);
 }
 
-void MainWindow::setCurrentPos(double x, const std::string &sTime)
+unsigned int MainWindow::getMaxXPosOnGraph()
 {
-    emit signalSetCurrentPos(x, QString::fromStdString(sTime));
+    return iMaxXOnGraph;
 }
 
-unsigned int MainWindow::getMaxXPosOnGraph()
+unsigned int MainWindow::getGraphWidthInPixels()
 {
-    return iMaxXOnGraph;
+    return iGraphWidthInPixels;
 }
 
 void MainWindow::on_horizontalSlider_volume_valueChanged(int value)
@@ -428,77 +430,38 @@ void MainWindow::on_actionOpen_Folder_triggered()
     }
 }
 
-void MainWindow::on_trackWidget_mousePress(TrackWidget *pPressedTrack)
+void MainWindow::on_trackList_mousePress(unsigned long long iPressedTrackID, bool bToggle)
 {
     std::lock_guard<std::mutex> lock(mtxUIStateChange);
 
-    if (pSelectedTrack == nullptr)
-    {
-        // Nothing is selected.
-
-        pSelectedTrack = pPressedTrack;
+    TrackListModel* pModel = ui->listView_tracklist->getModel();
 
-        pPressedTrack->setSelected();
-    }
-    else if (pSelectedTrack != pPressedTrack)
+    if (bToggle && pModel->getSelectedTrack() == iPressedTrackID)
     {
-        // Something is already selected.
-
-        if (pSelectedTrack == pPlayingTrack)
-        {
-            pSelectedTrack->setPlaying();
-        }
-        else
-        {
-            pSelectedTrack->setIdle();
-        }
-
-        pSelectedTrack = pPressedTrack;
-
-        pPressedTrack->setSelected();
+        pModel->setSelectedTrack(0);
     }
-    else if (pSelectedTrack == pPressedTrack)
+    else
     {
-        if (pPlayingTrack == pSelectedTrack)
-        {
-            pSelectedTrack->setPlaying();
-        }
-        else
-        {
-            pSelectedTrack->setIdle();
-        }
-
-        pSelectedTrack = nullptr;
+        pModel->setSelectedTrack(iPressedTrackID);
     }
 }
 
-void MainWindow::on_trackWidget_mouseDoublePress(TrackWidget *pPressedTrack)
+void MainWindow::on_trackList_mouseDoublePress(unsigned long long iPressedTrackID)
 {
     mtxUIStateChange.lock();
 
-    if (pPressedTrack == pSelectedTrack)
-    {
-        pSelectedTrack = nullptr;
-    }
+    TrackListModel* pModel = ui->listView_tracklist->getModel();
 
-    if (pPlayingTrack == nullptr)
+    if (pModel->getSelectedTrack() == iPressedTrackID)
     {
-        pPlayingTrack = pPressedTrack;
-
-        pPressedTrack->setPlaying();
+        pModel->setSelectedTrack(0);
     }
-    else if (pPlayingTrack != pPressedTrack)
-    {
-        pPlayingTrack->setIdle();
-
-        pPlayingTrack = pPressedTrack;
 
-        pPressedTrack->setPlaying();
-    }
+    pModel->setPlayingTrack(iPressedTrackID);
 
     mtxUIStateChange.unlock();
 
-    pController->playTrack(pPressedTrack->getTrackTitle().toStdWString());
+    pController->playTrack(iPressedTrackID);
 }
 
 void MainWindow::slotSearchFindPrev()
@@ -520,116 +483,60 @@ void MainWindow::slotMoveUp()
 {
     std::lock_guard<std::mutex> lock(mtxUIStateChange);
 
-    if (pSelectedTrack == nullptr)
-    {
-        return;
-    }
-
-    pController->moveUp(pSelectedTrack->getTrackTitle().toStdWString());
-
+    TrackListModel* pModel = ui->listView_tracklist->getModel();
 
-    int iTrackIndex = ui->verticalLayout_tracks->indexOf(pSelectedTrack);
-    QLayoutItem* pItem = ui->verticalLayout_tracks->takeAt(iTrackIndex);
-
-    if (iTrackIndex == 0)
-    {
-        ui->verticalLayout_tracks->addItem(pItem);
-    }
-    else
+    if (pModel->getSelectedTrack() == 0)
     {
-        ui->verticalLayout_tracks->insertItem(iTrackIndex - 1, pItem);
+        return;
     }
 
+    // The row is moved when the new tracklist is set (see slotSetTracklist()).
+    pController->moveUp(pModel->getSelectedTrack());
 
-    // Deselect track widget.
-
-    if (pSelectedTrack == pPlayingTrack)
-    {
-        pSelectedTrack->setPlaying();
-    }
-    else
-    {
-        pSelectedTrack->setIdle();
-    }
-
-    pSelectedTrack = nullptr;
+    pModel->setSelectedTrack(0);
 }
 
 void MainWindow::slotMoveDown()
 {
     std::lock_guard<std::mutex> lock(mtxUIStateChange);
 
-    if (pSelectedTrack == nullptr)
-    {
-        return;
-    }
-
-    pController->moveDown(pSelectedTrack->getTrackTitle().toStdWString());
-
-
-    int iTrackIndex = ui->verticalLayout_tracks->indexOf(pSelectedTrack);
-    QLayoutItem* pItem = ui->verticalLayout_tracks->takeAt(iTrackIndex);
+    TrackListModel* pModel = ui->listView_tracklist->getModel();
 
-    if (iTrackIndex == ui->verticalLayout_tracks->count())
+    if (pModel->getSelectedTrack() == 0)
     {
-        ui->verticalLayout_tracks->insertItem(0, pItem);
-    }
-    else
-    {
-        ui->verticalLayout_tracks->insertItem(iTrackIndex + 1, pItem);
+        return;
     }
 
+    // The row is moved when the new tracklist is set (see slotSetTracklist()).
+    pController->moveDown(pModel->getSelectedTrack());
 
-    // Deselect track widget.
-
-    if (pSelectedTrack == pPlayingTrack)
-    {
-        pSelectedTrack->setPlaying();
-    }
-    else
-    {
-        pSelectedTrack->setIdle();
-    }
-
-    pSelectedTrack = nullptr;
+    pModel->setSelectedTrack(0);
 }
 
 void MainWindow::slotDeleteSelectedTrack()
 {
-    if (pSelectedTrack == nullptr)
+    unsigned long long iSelectedTrackID = ui->listView_tracklist->getModel()->getSelectedTrack();
+
+    if (iSelectedTrackID == 0)
     {
         return;
     }
 
-    pController->removeTrack(pSelectedTrack->getTrackTitle().toStdWString());
+    pController->removeTrack(iSelectedTrackID);
 }
 
-void MainWindow::slotSetNewPlayingTrack(TrackWidget *pTrackWidget, std::promise<bool>* pPromiseFinish)
+void MainWindow::slotSetNewPlayingTrack(unsigned long long iTrackID, std::promise<bool>* pPromiseFinish)
 {
-    if (pTrackWidget == pSelectedTrack)
-    {
-        pSelectedTrack->setPlaying();
-        pSelectedTrack = nullptr;
+    TrackListModel* pModel = ui->listView_tracklist->getModel();
 
-        pPlayingTrack = pTrackWidget;
-    }
-
-    if (pPlayingTrack == nullptr)
+    if (iTrackID == pModel->getSelectedTrack())
     {
-        pPlayingTrack = pTrackWidget;
-
-        pTrackWidget->setPlaying();
+        pModel->setSelectedTrack(0);
     }
-    else if (pPlayingTrack != pTrackWidget)
-    {
-        pPlayingTrack->setIdle();
-
-        pPlayingTrack = pTrackWidget;
 
-        pTrackWidget->setPlaying();
-    }
+    pModel->setPlayingTrack(iTrackID);
 
-    ui->scrollArea_tracklist->ensureWidgetVisible(pTrackWidget);
+    ui->listView_tracklist->scrollToTrack(pModel->findRow(iTrackID));
 
     if (pPromiseFinish)
     {
@@ -660,6 +567,38 @@ void MainWindow::slotChangePlayButtonStyle(bool bChangeStyleToPause, std::promis
     }
 }
 
+void MainWindow::slotSetTracklist(std::shared_ptr<const IndexedTracklist> pTracklist)
+{
+    TrackListModel* pModel = ui->listView_tracklist->getModel();
+
+    bool bHadPlayingTrack = pModel->getPlayingTrack() != 0;
+
+    if (pModel->setTracklist(pTracklist))
+    {
+        // New tracks were added.
+        ui->listView_tracklist->scrollToBottom();
+    }
+
+    if (bHadPlayingTrack && pModel->getPlayingTrack() == 0)
+    {
+        // The playing track was removed.
+        ui->label_track_name->setText("");
+        ui->label_track_info->setText("");
+    }
+}
+
+void MainWindow::slotSetImportProgress(size_t iProcessedCount, size_t iFoundCount, bool bFinished)
+{
+    if (bFinished)
+    {
+        statusBar()->clearMessage();
+    }
+    else
+    {
+        statusBar()->showMessage("Importing tracks: " + QString::number(iProcessedCount) + " / " + QString::number(iFoundCount));
+    }
+}
+
 void MainWindow::slotShowMessageBox(QString sMessageTitle, QString sMessageText, bool bErrorMessage)
 {
     if (bErrorMessage)
@@ -689,6 +628,7 @@ void MainWindow::slotClearGraph()
 
     iCurrentXPosOnGraph = 0;
     ui->widget_graph->graph(0)->data()->clear();
+    ui->widget_graph->graph(1)->data()->clear();
 
     ui->widget_graph->xAxis->setRange(0.0, 0.01);
 
@@ -710,20 +650,29 @@ void MainWindow::slotAddWaveDataToGraph(std::vector<float> vWaveData)
 {
     std::lock_guard<std::mutex> lock(mtxDrawGraph);
 
+    // 'vWaveData' is (min, max) pairs, one pair per X.
+
     QVector<double> x;
-    QVector<double> y;
+    QVector<double> yMax;
+    QVector<double> yMin;
+
+    x.reserve(static_cast<int>(vWaveData.size() / 2));
+    yMax.reserve(static_cast<int>(vWaveData.size() / 2));
+    yMin.reserve(static_cast<int>(vWaveData.size() / 2));
 
 
-    for (size_t i = 0; i < vWaveData.size(); i++)
+    for (size_t i = 0; i + 1 < vWaveData.size(); i += 2)
     {
         x.push_back( static_cast<double>(iCurrentXPosOnGraph) );
         iCurrentXPosOnGraph++;
 
-        y.push_back( static_cast<double>(vWaveData[i]) );
+        yMin.push_back( static_cast<double>(vWaveData[i]) );
+        yMax.push_back( static_cast<double>(vWaveData[i + 1]) );
     }
 
 
-    ui->widget_graph->graph(0)->addData(x, y, true);
+    ui->widget_graph->graph(0)->addData(x, yMax, true);
+    ui->widget_graph->graph(1)->addData(x, yMin, true);
 
     ui->widget_graph->replot();
 }
@@ -749,7 +698,55 @@ void MainWindow::slotSetCurrentPos(double x, QString sTime)
         }
     }
 
-    ui->widget_graph->replot();
+    // Only the overlay (the waveform is not changed).
+    ui->widget_graph->layer("overlay")->replot();
+}
+
+void MainWindow::slotUpdatePosition()
+{
+    double dPos = 0.0;
+    double dLength = 0.0;
+
+    if (pController->getPositionClock()->get(dPos, dLength))
+    {
+        if (iLastPositionPixel != -1)
+        {
+            iLastPositionPixel  = -1;
+            iLastPositionSecond = -1;
+
+            slotSetCurrentPos(0.0, "");
+        }
+
+        return;
+    }
+
+
+    double x = dPos / dLength;
+
+    int iPixel = static_cast<int>(x * ui->widget_graph->axisRect()->width());
+    long long iSecond = static_cast<long long>(dPos);
+
+    if (iPixel == iLastPositionPixel && iSecond == iLastPositionSecond)
+    {
+        // Nothing to redraw.
+        return;
+    }
+
+    iLastPositionPixel  = iPixel;
+    iLastPositionSecond = iSecond;
+
+
+    QString sTime = QString::number(iSecond / 60) + ":";
+
+    if (iSecond % 60 < 10)
+    {
+        sTime += "0";
+    }
+
+    sTime += QString::number(iSecond % 60);
+
+
+    slotSetCurrentPos(x, sTime);
 }
 
 void MainWindow::slotSetMainWindowTitle(QString sText)
@@ -856,7 +853,29 @@ void MainWindow::setupGraph()
 {
     iMaxXOnGraph = 1;
 
-    // Graph
+
+    // The graph is stretched to the window width so the window can be as wide as the widest screen.
+    iGraphWidthInPixels = 0;
+
+    const QList<QScreen*> vScreens = QGuiApplication::screens();
+    for (int i = 0; i < vScreens.size(); i++)
+    {
+        const unsigned int iScreenWidth = static_cast<unsigned int>(vScreens[i]->geometry().width() * vScreens[i]->devicePixelRatio());
+
+        if (iScreenWidth > iGraphWidthInPixels)
+        {
+            iGraphWidthInPixels = iScreenWidth;
+        }
+    }
+
+    if (iGraphWidthInPixels == 0)
+    {
+        iGraphWidthInPixels = PEAK_CACHE_MIN_PEAK_COUNT;
+    }
+
+
+    // Graph (0 - max peaks, 1 - min peaks, the space between them is filled)
+    ui->widget_graph->addGraph();
     ui->widget_graph->addGraph();
     ui->widget_graph->xAxis->setRange(0.0, 1.0);
     ui->widget_graph->yAxis->setRange(0.0, MAX_Y_AXIS_VALUE);
@@ -865,6 +884,9 @@ void MainWindow::setupGraph()
     pen.setWidth(1);
     pen.setColor(QColor(255, 130, 0));
     ui->widget_graph->graph(0)->setPen(pen);
+    ui->widget_graph->graph(1)->setPen(pen);
+    ui->widget_graph->graph(0)->setBrush(QBrush(QColor(255, 130, 0)));
+    ui->widget_graph->graph(0)->setChannelFillGraph(ui->widget_graph->graph(1));
 
     // color and stuff
     ui->widget_graph->setBackground(QColor(24, 24, 24));
@@ -873,12 +895,18 @@ void MainWindow::setupGraph()
     ui->widget_graph->xAxis->setTicks(false);
     ui->widget_graph->yAxis->setTicks(false);
     ui->widget_graph->graph(0)->setLineStyle(QCPGraph::LineStyle::lsLine);
+    ui->widget_graph->graph(1)->setLineStyle(QCPGraph::LineStyle::lsLine);
     ui->widget_graph->axisRect()->setAutoMargins(QCP::msNone);
     ui->widget_graph->axisRect()->setMargins(QMargins(0,0,0,0));
 
     connect(ui->widget_graph, &QCustomPlot::mousePress, this, &MainWindow::slotClickOnGraph);
 
 
+    // The position items are on a separate buffered layer so that they can be redrawn without the waveform.
+    ui->widget_graph->addLayer("overlay", ui->widget_graph->layer("main"), QCustomPlot::limAbove);
+    ui->widget_graph->layer("overlay")->setMode(QCPLayer::lmBuffered);
+
+
     // fill rect
     backgnd = new QCPItemRect(ui->widget_graph);
     backgnd->topLeft->setType(QCPItemPosition::ptAxisRectRatio);
@@ -887,6 +915,7 @@ void MainWindow::setupGraph()
     backgnd->bottomRight->setCoords(0, MAX_Y_AXIS_VALUE);
     backgnd->setBrush(QBrush(QColor(0, 0, 0, PLAYED_SECTION_ALPHA)));
     backgnd->setPen(Qt::NoPen);
+    backgnd->setLayer("overlay");
 
 
     backgndRight = new QCPItemRect(ui->widget_graph);
@@ -896,6 +925,7 @@ void MainWindow::setupGraph()
     backgndRight->bottomRight->setCoords(0, MAX_Y_AXIS_VALUE);
     backgndRight->setBrush(QBrush(QColor(0, 0, 0, PLAYED_SECTION_ALPHA)));
     backgndRight->setPen(Qt::NoPen);
+    backgndRight->setLayer("overlay");
 
 
     // text
@@ -907,6 +937,7 @@ void MainWindow::setupGraph()
     pGraphTextTrackTime->setPen(Qt::NoPen);
     pGraphTextTrackTime->setSelectedPen(Qt::NoPen);
     pGraphTextTrackTime->setText("");
+    pGraphTextTrackTime->setLayer("overlay");
 
 
 
@@ -918,6 +949,20 @@ void MainWindow::setupGraph()
     maxPosOnGraphForText /= static_cast<double>(MAX_X_AXIS_VALUE);
 }
 
+void MainWindow::on_actionSpectrum_triggered()
+{
+    if (pSpectrumWindow)
+    {
+        pSpectrumWindow->activateWindow();
+        return;
+    }
+
+    // Not modal so that the player can be used while the spectrum is shown.
+    pSpectrumWindow = new SpectrumWindow(this, this);
+
+    pSpectrumWindow->show();
+}
+
 void MainWindow::on_pushButton_fx_clicked()
 {
     FXWindow* pFXWindow = new FXWindow(this, this);
@@ -928,6 +973,11 @@ void MainWindow::on_pushButton_fx_clicked()
 
 MainWindow::~MainWindow()
 {
+    if (pPositionTimer)
+    {
+        pPositionTimer->stop();
+    }
+
     delete pController;
 
     delete pTrayIcon;
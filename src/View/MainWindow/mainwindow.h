@@ -9,10 +9,16 @@
 
 // Qt
 #include <QMainWindow>
+#include <QPointer>
 
 // STL
 #include <mutex>
 #include <future>
+#include <memory>
+
+// Custom
+#include "Model/globals.h"
+#include "Model/IndexedTracklist/indexedtracklist.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -21,10 +27,11 @@ QT_END_NAMESPACE
 
 class QSystemTrayIcon;
 class QHideEvent;
+class QTimer;
 class Controller;
-class TrackWidget;
 class QCPItemText;
 class QCPItemRect;
+class SpectrumWindow;
 
 class MainWindow : public QMainWindow
 {
@@ -33,15 +40,16 @@ class MainWindow : public QMainWindow
 signals:
 
     // This to this.
-    void signalSetNewPlayingTrack    (TrackWidget* pTrackWidget, std::promise<bool>* pPromiseFinish);
+    void signalSetNewPlayingTrack    (unsigned long long iTrackID, std::promise<bool>* pPromiseFinish);
     void signalChangePlayButtonStyle (bool bChangeStyleToPause, std::promise<bool>* pPromiseFinish);
     void signalShowMessageBox        (QString sMessageTitle, QString sMessageText, bool bErrorMessage);
     void signalSetTrackInfo          (QString sTrackTitle, QString sTrackInfo, std::promise<bool>* pPromiseFinish);
     void signalClearGraph            ();
     void signalSetMaxXToGraph        (unsigned int iMaxX);
     void signalAddWaveDataToGraph    (std::vector<float> vWaveData);
-    void signalSetCurrentPos         (double x, QString sTime);
     void signalSetMainWindowTitle    (QString sText);
+    void signalSetTracklist          (std::shared_ptr<const IndexedTracklist> pTracklist);
+    void signalSetImportProgress     (size_t iProcessedCount, size_t iFoundCount, bool bFinished);
 
     void signalSearchMatchCount      (size_t iCount);
 
@@ -58,8 +66,10 @@ public:
     void setMainWindowTitle       (const std::wstring sText);
 
 
-    void addTrackWidget           (const std::wstring& sTrackTitle, std::promise<TrackWidget*>* pPromiseCreateWidget);
-    void removeTrackWidget        (TrackWidget* pTrackWidget, std::promise<bool>* pPromiseRemoveWidget);
+    // Called when the tracklist snapshot is replaced (see AudioCore::publishTracklist()),
+    // the snapshots are shown in the same order as they were published.
+    void setTracklist             (std::shared_ptr<const IndexedTracklist> pTracklist);
+    void setImportProgress        (size_t iProcessedCount, size_t iFoundCount, bool bFinished);
 
 
     void changePlayButtonStyle    (bool bChangeStyleToPause, bool bSendSignal);
@@ -67,21 +77,22 @@ public:
     void changeRandomButtonStyle  (bool bActive);
 
 
-    void setNewPlayingTrack       (TrackWidget* pTrackWidget, bool bSendSignal);
+    void setNewPlayingTrack       (unsigned long long iTrackID, bool bSendSignal);
     void setTrackInfo             (const std::wstring& sTrackTitle, const std::wstring& sTrackInfo);
 
 
     void setSearchMatchCount      (size_t iMatches);
-    void searchSetSelected        (TrackWidget* pTrackWidget);
+    void searchSetSelected        (unsigned long long iTrackID);
 
 
     void clearGraph               ();
     void setMaxXToGraph           (unsigned int iMaxX);
     void addWaveDataToGraph       (std::vector<float> vWaveData);
-    void setCurrentPos            (double x, const std::string& sTime);
 
 
     unsigned int getMaxXPosOnGraph();
+    // The widest the graph can be (on the widest screen), in physical pixels.
+    unsigned int getGraphWidthInPixels();
 
 
     void showMessageBox           (std::wstring sMessageTitle, std::wstring sMessageText, bool bErrorMessage, bool bSendSignal);
@@ -92,9 +103,10 @@ protected:
     void  hideEvent               (QHideEvent  *event);
     void  keyPressEvent           (QKeyEvent* ev);
 
-    // Track Widgets.
-    void  on_trackWidget_mousePress       (TrackWidget* pPressedTrack);
-    void  on_trackWidget_mouseDoublePress (TrackWidget* pPressedTrack);
+    // Track List.
+    // 'bToggle' - deselect if already selected.
+    void  on_trackList_mousePress         (unsigned long long iPressedTrackID, bool bToggle);
+    void  on_trackList_mouseDoublePress   (unsigned long long iPressedTrackID);
 
 public slots:
 
@@ -103,7 +115,7 @@ public slots:
     void  slotSearchFindNext  ();
     void  slotSearchTextSet   (QString keyword);
 
-    // Context menu on TrackWidget
+    // Context menu on TrackList
     void  slotMoveUp          ();
     void  slotMoveDown        ();
     void  slotDeleteSelectedTrack ();
@@ -111,7 +123,7 @@ public slots:
 private slots:
 
     // This to this.
-    void  slotSetNewPlayingTrack          (TrackWidget* pTrackWidget, std::promise<bool>* pPromiseFinish);
+    void  slotSetNewPlayingTrack          (unsigned long long iTrackID, std::promise<bool>* pPromiseFinish);
     void  slotChangePlayButtonStyle       (bool bChangeStyleToPause, std::promise<bool>* pPromiseFinish);
     void  slotShowMessageBox              (QString sMessageTitle, QString sMessageText, bool bErrorMessage);
     void  slotSetTrackInfo                (QString sTrackTitle, QString sTrackInfo, std::promise<bool>* pPromiseFinish);
@@ -120,6 +132,11 @@ private slots:
     void  slotAddWaveDataToGraph          (std::vector<float> vWaveData);
     void  slotSetCurrentPos               (double x, QString sTime);
     void  slotSetMainWindowTitle          (QString sText);
+    void  slotSetTracklist                (std::shared_ptr<const IndexedTracklist> pTracklist);
+    void  slotSetImportProgress           (size_t iProcessedCount, size_t iFoundCount, bool bFinished);
+
+    // Position timer (reads the position clock).
+    void  slotUpdatePosition              ();
 
     // Tray icon.
     void  slotTrayIconActivated           ();
@@ -144,6 +161,7 @@ private slots:
     void  on_actionAbout_Qt_triggered     ();
     void  on_actionSave_Tracklist_triggered();
     void  on_actionOpen_Tracklist_triggered();
+    void  on_actionSpectrum_triggered     ();
 
     // Oscillogram.
     void  slotClickOnGraph                 (QMouseEvent* ev);
@@ -151,8 +169,8 @@ private slots:
 private:
 
     friend class TrackList;
-    friend class TrackWidget;
     friend class FXWindow;
+    friend class SpectrumWindow;
 
     void setupGraph ();
     void applyStyle ();
@@ -168,19 +186,22 @@ private:
 
     Controller*      pController;
 
+    QTimer*          pPositionTimer; // fires at the screen refresh rate
 
-    std::mutex       mtxUIStateChange;
-    std::mutex       mtxDrawGraph;
+    QPointer<SpectrumWindow> pSpectrumWindow; // only one at a time
 
 
-    TrackWidget*     pSelectedTrack;
-    TrackWidget*     pPlayingTrack;
+    std::mutex       mtxUIStateChange;
+    std::mutex       mtxDrawGraph;
 
 
     double           minPosOnGraphForText;
     double           maxPosOnGraphForText;
     unsigned int     iCurrentXPosOnGraph;
     unsigned int     iMaxXOnGraph;
+    unsigned int     iGraphWidthInPixels;
+    int              iLastPositionPixel;
+    long long        iLastPositionSecond;
 
 
     bool             bPlayButtonStatePlay;
@@ -0,0 +1,85 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "spectrumwindow.h"
+#include "ui_spectrumwindow.h"
+
+// Qt
+#include <QTimer>
+#include <QPainter>
+#include <QCloseEvent>
+
+// Custom
+#include "View/MainWindow/mainwindow.h"
+#include "Controller/controller.h"
+#include "Model/globals.h"
+
+SpectrumWindow::SpectrumWindow(MainWindow* pMainWindow, QWidget *parent) :
+    QMainWindow(parent),
+    ui(new Ui::SpectrumWindow)
+{
+    ui->setupUi(this);
+
+    this->pMainWindow = pMainWindow;
+
+    vBands.resize(SPECTRUM_BAND_COUNT, 0.0f);
+
+    pMainWindow->pController->setSpectrumEnabled(true);
+
+    pUpdateTimer = new QTimer(this);
+    connect(pUpdateTimer, &QTimer::timeout, this, &SpectrumWindow::slotUpdateSpectrum);
+    pUpdateTimer->start(SPECTRUM_UPDATE_IN_MS);
+}
+
+SpectrumWindow::~SpectrumWindow()
+{
+    delete ui;
+}
+
+void SpectrumWindow::closeEvent(QCloseEvent *event)
+{
+    Q_UNUSED(event)
+
+    pUpdateTimer->stop();
+
+    // Don't analyze the mix when nobody sees it.
+    pMainWindow->pController->setSpectrumEnabled(false);
+
+    deleteLater();
+}
+
+void SpectrumWindow::slotUpdateSpectrum()
+{
+    pMainWindow->pController->getSpectrum(vBands);
+
+    update();
+}
+
+void SpectrumWindow::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+
+    QPainter painter(this);
+
+    const QRect area = ui->centralwidget->geometry();
+
+    painter.fillRect(area, QColor(24, 24, 24));
+
+
+    // Same color as the oscillogram.
+
+    const double dBandWidth = area.width() / static_cast<double>(vBands.size());
+
+    for (size_t i = 0; i < vBands.size(); i++)
+    {
+        const int iHeight = static_cast<int>(vBands[i] * area.height());
+        const int iLeft   = area.left() + static_cast<int>(i * dBandWidth);
+        const int iRight  = area.left() + static_cast<int>((i + 1) * dBandWidth);
+
+        painter.fillRect(iLeft + 1, area.bottom() - iHeight + 1, iRight - iLeft - 2, iHeight, QColor(255, 130, 0));
+    }
+}
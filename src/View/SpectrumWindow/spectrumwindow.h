@@ -0,0 +1,48 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// Qt
+#include <QMainWindow>
+
+// STL
+#include <vector>
+
+namespace Ui {
+class SpectrumWindow;
+}
+
+class MainWindow;
+class QTimer;
+class QCloseEvent;
+class QPaintEvent;
+
+class SpectrumWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumWindow(MainWindow* pMainWindow, QWidget *parent = nullptr);
+    ~SpectrumWindow() override;
+
+protected:
+    void closeEvent(QCloseEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+
+private slots:
+    void slotUpdateSpectrum();
+
+private:
+
+    Ui::SpectrumWindow *ui;
+    MainWindow* pMainWindow;
+
+    QTimer*     pUpdateTimer;
+
+    std::vector<float> vBands;
+};
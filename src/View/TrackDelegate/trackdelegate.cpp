@@ -0,0 +1,87 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "trackdelegate.h"
+
+// Qt
+#include <QPainter>
+#include <QLinearGradient>
+
+// Custom
+#include "View/TrackListModel/tracklistmodel.h"
+
+
+TrackDelegate::TrackDelegate(QObject* parent) : QStyledItemDelegate(parent)
+{
+    titleFont = QFont("Segoe UI", 11);
+}
+
+void TrackDelegate::paint(QPainter* pPainter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QRectF rect = QRectF(option.rect).adjusted(iRowMargin + 0.5, iRowMargin + 0.5, -iRowMargin - 0.5, -iRowMargin - 0.5);
+
+
+    // Same colors as the rest of the theme.
+
+    QColor bottomColor;
+    QColor topColor;
+
+    int iState = index.data(TrackListModel::TRACK_STATE_ROLE).toInt();
+
+    if (option.state & QStyle::State_MouseOver)
+    {
+        bottomColor = QColor(24, 24, 24);
+        topColor    = QColor(54, 40, 28);
+    }
+    else if (iState == TS_SELECTED)
+    {
+        bottomColor = QColor(40, 40, 40);
+        topColor    = QColor(55, 45, 35);
+    }
+    else if (iState == TS_PLAYING)
+    {
+        bottomColor = QColor(40, 25, 15);
+        topColor    = QColor(60, 45, 30);
+    }
+    else
+    {
+        bottomColor = QColor(4, 4, 4);
+        topColor    = QColor(34, 20, 8);
+    }
+
+    // x1:0.5, y1:1, x2:0.5, y2:0.3
+    QLinearGradient gradient(rect.center().x(), rect.bottom(), rect.center().x(), rect.top() + rect.height() * 0.3);
+    gradient.setColorAt(0.0, bottomColor);
+    gradient.setColorAt(1.0, topColor);
+
+
+    pPainter->save();
+
+    pPainter->setRenderHint(QPainter::Antialiasing);
+
+    pPainter->setPen(QPen(QColor(255, 130, 0), 1.0));
+    pPainter->setBrush(gradient);
+    pPainter->drawRoundedRect(rect, iCornerRadius, iCornerRadius);
+
+
+    QRect textRect = option.rect.adjusted(iRowMargin + iTextMargin, iRowMargin, -iRowMargin - iTextMargin, -iRowMargin);
+
+    pPainter->setFont(titleFont);
+    pPainter->setPen(Qt::white);
+
+    QString sTitle = QFontMetrics(titleFont).elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, textRect.width());
+    pPainter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, sTitle);
+
+    pPainter->restore();
+}
+
+QSize TrackDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    Q_UNUSED(index)
+
+    return QSize(option.rect.width(), iRowHeight);
+}
@@ -0,0 +1,34 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// Qt
+#include <QStyledItemDelegate>
+#include <QFont>
+
+// Draws one row of the TrackList (rounded frame with the track title),
+// only the visible rows are drawn.
+class TrackDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit TrackDelegate(QObject* parent = nullptr);
+
+    void  paint    (QPainter* pPainter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint (const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+
+    QFont titleFont;
+
+    static const int iRowHeight     = 70;
+    static const int iRowMargin     = 3;
+    static const int iTextMargin    = 10;
+    static const int iCornerRadius  = 15;
+};
@@ -10,20 +10,62 @@
 
 // Qt
 #include <QDragEnterEvent>
+#include <QDragMoveEvent>
+#include <QMouseEvent>
 #include <QMimeData>
 #include <QDir>
+#include <QMenu>
+#include <QAction>
 
 // Custom
 #include "View/MainWindow/mainwindow.h"
+#include "View/TrackListModel/tracklistmodel.h"
+#include "View/TrackDelegate/trackdelegate.h"
 #include "Controller/controller.h"
 #include "Model/globals.h"
 
 TrackList::TrackList(QWidget *parent) :
-    QScrollArea(parent),
+    QListView(parent),
     ui(new Ui::TrackList)
 {
     ui->setupUi(this);
     setAcceptDrops(true);
+
+    pMainWindow = nullptr;
+
+
+    // Only the visible rows are created/drawn, all rows have the same height
+    // so the layout does not ask the delegate for each row.
+
+    pModel = new TrackListModel(this);
+
+    setModel(pModel);
+    setItemDelegate(new TrackDelegate(this));
+
+    setUniformItemSizes(true);
+    setLayoutMode(QListView::Batched);
+    setSelectionMode(QAbstractItemView::NoSelection); // see TrackListModel::setSelectedTrack()
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setSpacing(2);
+    setMouseTracking(true);
+    viewport()->setAttribute(Qt::WA_Hover);
+
+
+    pMenuContextMenu = new QMenu(this);
+        pActionMoveUp = new QAction  ("Move Up");
+        connect(pActionMoveUp, &QAction::triggered, this, &TrackList::signalMoveUp);
+
+        pActionMoveDown = new QAction("Move Down");
+        connect(pActionMoveDown, &QAction::triggered, this, &TrackList::signalMoveDown);
+
+        pActionDelete = new QAction  ("Delete");
+        connect(pActionDelete, &QAction::triggered, this, &TrackList::signalDelete);
+
+    pMenuContextMenu->addAction(pActionMoveUp);
+    pMenuContextMenu->addAction(pActionMoveDown);
+    pMenuContextMenu->addAction(pActionDelete);
 }
 
 void TrackList::init(MainWindow *pMainWindow)
@@ -33,9 +75,66 @@ void TrackList::init(MainWindow *pMainWindow)
 
 TrackList::~TrackList()
 {
+    delete pActionDelete;
+    delete pActionMoveDown;
+    delete pActionMoveUp;
+    delete pMenuContextMenu;
+
     delete ui;
 }
 
+TrackListModel* TrackList::getModel()
+{
+    return pModel;
+}
+
+void TrackList::scrollToTrack(int iRow)
+{
+    if (iRow != -1)
+    {
+        scrollTo(pModel->index(iRow));
+    }
+}
+
+void TrackList::mousePressEvent(QMouseEvent *ev)
+{
+    const XAudioFile* pPressedTrack = pModel->getTrack(indexAt(ev->pos()).row());
+
+    if (pPressedTrack == nullptr)
+    {
+        return;
+    }
+
+
+    if (ev->button() == Qt::MouseButton::RightButton)
+    {
+        // The menu is for the pressed track.
+        pMainWindow->on_trackList_mousePress(pPressedTrack->iTrackID, false);
+
+        pMenuContextMenu->exec(viewport()->mapToGlobal(ev->pos()));
+    }
+    else
+    {
+        pMainWindow->on_trackList_mousePress(pPressedTrack->iTrackID, true);
+    }
+}
+
+void TrackList::mouseDoubleClickEvent(QMouseEvent *ev)
+{
+    const XAudioFile* pPressedTrack = pModel->getTrack(indexAt(ev->pos()).row());
+
+    if (pPressedTrack && ev->button() == Qt::MouseButton::LeftButton)
+    {
+        pMainWindow->on_trackList_mouseDoublePress(pPressedTrack->iTrackID);
+    }
+}
+
+void TrackList::dragMoveEvent(QDragMoveEvent *event)
+{
+    // QListView only accepts its own items by default.
+    event->acceptProposedAction();
+}
+
 void TrackList::dragEnterEvent(QDragEnterEvent *event)
 {
     const QMimeData* mimeData = event->mimeData();
@@ -7,28 +7,47 @@
 
 #pragma once
 
-#include <QScrollArea>
+#include <QListView>
 
 namespace Ui {
 class TrackList;
 }
 
 class QDragEnterEvent;
+class QDragMoveEvent;
 class QDropEvent;
+class QMouseEvent;
+class QMenu;
+class QAction;
 class MainWindow;
+class TrackListModel;
 
-class TrackList : public QScrollArea
+class TrackList : public QListView
 {
     Q_OBJECT
 
+signals:
+
+    // Context menu signals
+    void signalDelete();
+    void signalMoveUp();
+    void signalMoveDown();
+
 public:
     explicit TrackList(QWidget *parent = nullptr);
     void init(MainWindow* pMainWindow);
-    ~TrackList();
+    ~TrackList() override;
+
+    TrackListModel* getModel();
+
+    void  scrollToTrack           (int iRow);
 
 protected:
-    void  dragEnterEvent          (QDragEnterEvent* event);
-    void  dropEvent               (QDropEvent* event);
+    void  dragEnterEvent          (QDragEnterEvent* event) override;
+    void  dragMoveEvent           (QDragMoveEvent* event) override;
+    void  dropEvent               (QDropEvent* event) override;
+    void  mousePressEvent         (QMouseEvent* ev) override;
+    void  mouseDoubleClickEvent   (QMouseEvent* ev) override;
 
 private:
 
@@ -36,4 +55,12 @@ private:
 
     Ui::TrackList *ui;
     MainWindow* pMainWindow;
+
+    TrackListModel* pModel;
+
+    // Context menu
+    QMenu* pMenuContextMenu;
+        QAction* pActionMoveUp;
+        QAction* pActionMoveDown;
+        QAction* pActionDelete;
 };
@@ -0,0 +1,227 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "tracklistmodel.h"
+
+// STL
+#include <algorithm>
+
+
+TrackListModel::TrackListModel(QObject* parent) : QAbstractListModel(parent)
+{
+    pTracklist = std::make_shared<IndexedTracklist>();
+
+    iSelectedTrackID = 0;
+    iPlayingTrackID  = 0;
+}
+
+bool TrackListModel::setTracklist(std::shared_ptr<const IndexedTracklist> pNewTracklist)
+{
+    const IndexedTracklist& vOld = *pTracklist;
+    const IndexedTracklist& vNew = *pNewTracklist;
+
+    // With the iterators and not operator[] that looks for the chunk of the track every time.
+    const size_t iCommonSize = std::min(vOld.size(), vNew.size());
+    const size_t iPrefix = static_cast<size_t>(std::mismatch(vOld.begin(), vOld.begin() + static_cast<std::ptrdiff_t>(iCommonSize), vNew.begin()).first
+                                               - vOld.begin());
+
+
+    if (iPrefix == vOld.size() && iPrefix == vNew.size())
+    {
+        // Same tracks.
+
+        pTracklist = pNewTracklist;
+
+        return false;
+    }
+
+    if (iPrefix == vOld.size())
+    {
+        // Appended.
+
+        beginInsertRows(QModelIndex(), static_cast<int>(vOld.size()), static_cast<int>(vNew.size() - 1));
+        pTracklist = pNewTracklist;
+        endInsertRows();
+
+        return true;
+    }
+
+    if (vNew.size() + 1 == vOld.size() && std::equal(vOld.begin() + iPrefix + 1, vOld.end(), vNew.begin() + iPrefix))
+    {
+        // One track removed.
+
+        beginRemoveRows(QModelIndex(), static_cast<int>(iPrefix), static_cast<int>(iPrefix));
+        pTracklist = pNewTracklist;
+        endRemoveRows();
+
+        forgetRemovedTracks();
+
+        return false;
+    }
+
+    if (vNew.size() == vOld.size())
+    {
+        // Maybe one track moved (see AudioCore::moveUp()), then [iPrefix, iLast] is rotated by one.
+
+        size_t iLast = vOld.size() - 1;
+        while (iLast > iPrefix && vOld[iLast] == vNew[iLast])
+        {
+            iLast--;
+        }
+
+        int iFirstRow = static_cast<int>(iPrefix);
+        int iLastRow  = static_cast<int>(iLast);
+
+        if (vNew[iPrefix] == vOld[iLast] && std::equal(vOld.begin() + iPrefix, vOld.begin() + iLast, vNew.begin() + iPrefix + 1))
+        {
+            beginMoveRows(QModelIndex(), iLastRow, iLastRow, QModelIndex(), iFirstRow);
+            pTracklist = pNewTracklist;
+            endMoveRows();
+
+            return false;
+        }
+
+        if (vNew[iLast] == vOld[iPrefix] && std::equal(vOld.begin() + iPrefix + 1, vOld.begin() + iLast + 1, vNew.begin() + iPrefix))
+        {
+            beginMoveRows(QModelIndex(), iFirstRow, iFirstRow, QModelIndex(), iLastRow + 1);
+            pTracklist = pNewTracklist;
+            endMoveRows();
+
+            return false;
+        }
+    }
+
+
+    beginResetModel();
+    pTracklist = pNewTracklist;
+    endResetModel();
+
+    forgetRemovedTracks();
+
+    return false;
+}
+
+void TrackListModel::setSelectedTrack(unsigned long long iTrackID)
+{
+    unsigned long long iOldTrackID = iSelectedTrackID;
+
+    iSelectedTrackID = iTrackID;
+
+    updateRow(iOldTrackID);
+    updateRow(iTrackID);
+}
+
+void TrackListModel::setPlayingTrack(unsigned long long iTrackID)
+{
+    unsigned long long iOldTrackID = iPlayingTrackID;
+
+    iPlayingTrackID = iTrackID;
+
+    updateRow(iOldTrackID);
+    updateRow(iTrackID);
+}
+
+unsigned long long TrackListModel::getSelectedTrack() const
+{
+    return iSelectedTrackID;
+}
+
+unsigned long long TrackListModel::getPlayingTrack() const
+{
+    return iPlayingTrackID;
+}
+
+const XAudioFile* TrackListModel::getTrack(int iRow) const
+{
+    if (iRow < 0 || static_cast<size_t>(iRow) >= pTracklist->size())
+    {
+        return nullptr;
+    }
+
+    return (*pTracklist)[static_cast<size_t>(iRow)].get();
+}
+
+int TrackListModel::findRow(unsigned long long iTrackID) const
+{
+    size_t iIndex = 0;
+
+    if (pTracklist->findTrack(iTrackID, iIndex) == false)
+    {
+        return -1;
+    }
+
+    return static_cast<int>(iIndex);
+}
+
+int TrackListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+
+    return static_cast<int>(pTracklist->size());
+}
+
+QVariant TrackListModel::data(const QModelIndex& index, int role) const
+{
+    const XAudioFile* pTrack = getTrack(index.row());
+
+    if (index.isValid() == false || pTrack == nullptr)
+    {
+        return QVariant();
+    }
+
+
+    if (role == Qt::DisplayRole)
+    {
+        return QString::fromStdWString(pTrack->sAudioTitle);
+    }
+    else if (role == TRACK_STATE_ROLE)
+    {
+        // The selection is drawn over the playing state.
+
+        if (pTrack->iTrackID == iSelectedTrackID)
+        {
+            return TS_SELECTED;
+        }
+        else if (pTrack->iTrackID == iPlayingTrackID)
+        {
+            return TS_PLAYING;
+        }
+        else
+        {
+            return TS_IDLE;
+        }
+    }
+
+
+    return QVariant();
+}
+
+void TrackListModel::updateRow(unsigned long long iTrackID)
+{
+    int iRow = findRow(iTrackID);
+
+    if (iRow != -1)
+    {
+        emit dataChanged(index(iRow), index(iRow), {TRACK_STATE_ROLE});
+    }
+}
+
+void TrackListModel::forgetRemovedTracks()
+{
+    if (findRow(iSelectedTrackID) == -1)
+    {
+        iSelectedTrackID = 0;
+    }
+
+    if (findRow(iPlayingTrackID) == -1)
+    {
+        iPlayingTrackID = 0;
+    }
+}
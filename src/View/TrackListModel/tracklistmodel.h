@@ -0,0 +1,75 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// Qt
+#include <QAbstractListModel>
+
+// STL
+#include <memory>
+
+// Custom
+#include "Model/IndexedTracklist/indexedtracklist.h"
+
+
+enum TRACK_STATE
+{
+    TS_IDLE     = 0,
+    TS_SELECTED = 1,
+    TS_PLAYING  = 2
+};
+
+// Shows the tracklist snapshot of the AudioCore (no copies of the tracks are made),
+// the view only asks for the rows that are visible.
+class TrackListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+
+    // Qt::DisplayRole - title, TRACK_STATE_ROLE - TRACK_STATE.
+    static const int TRACK_STATE_ROLE = Qt::UserRole;
+
+
+    explicit TrackListModel(QObject* parent = nullptr);
+
+
+    // Only the changed rows are updated if the snapshot differs from the current one
+    // by appended tracks, one removed track or one moved track, otherwise the model is reset.
+    // Returns 'true' if tracks were appended.
+    bool setTracklist     (std::shared_ptr<const IndexedTracklist> pNewTracklist);
+
+
+    // The tracks are identified by XAudioFile::iTrackID, 0 to clear.
+    void setSelectedTrack (unsigned long long iTrackID);
+    void setPlayingTrack  (unsigned long long iTrackID);
+
+
+    unsigned long long getSelectedTrack () const;
+    unsigned long long getPlayingTrack  () const;
+    // Returns 'nullptr' if the row is not valid.
+    const XAudioFile*  getTrack         (int iRow) const;
+    // Returns -1 if not found.
+    int                findRow          (unsigned long long iTrackID) const;
+
+
+    int      rowCount (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data     (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+
+    void updateRow    (unsigned long long iTrackID);
+    // Clears the selected/playing track if it's not in the tracklist anymore.
+    void forgetRemovedTracks();
+
+
+    std::shared_ptr<const IndexedTracklist> pTracklist;
+
+    unsigned long long iSelectedTrackID;
+    unsigned long long iPlayingTrackID;
+};
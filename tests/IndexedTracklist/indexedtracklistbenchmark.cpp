@@ -0,0 +1,160 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Time of a new tracklist snapshot (copy + remove/move/append, as in AudioCore) for the chunked
+// IndexedTracklist and for the flat one that it replaced (a vector and a hash map of all positions).
+//
+// Usage: IndexedTracklistBenchmark [changes per case (default 200)]
+
+// STL
+#include <random>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+
+// Custom
+#include "Model/IndexedTracklist/indexedtracklist.h"
+#include "TestUtils/testutils.h"
+
+
+// The old IndexedTracklist.
+class FlatTracklist
+{
+public:
+
+    void append(const XTracklist& vNewTracks)
+    {
+        for (size_t i = 0; i < vNewTracks.size(); i++)
+        {
+            trackIndex[vNewTracks[i]->iTrackID] = vTracks.size();
+
+            vTracks.push_back(vNewTracks[i]);
+        }
+    }
+
+    void remove(size_t iIndex)
+    {
+        trackIndex.erase(vTracks[iIndex]->iTrackID);
+
+        vTracks.erase(vTracks.begin() + static_cast<std::ptrdiff_t>(iIndex));
+
+        for (size_t i = iIndex; i < vTracks.size(); i++)
+        {
+            trackIndex[vTracks[i]->iTrackID] = i;
+        }
+    }
+
+    void move(size_t iFrom, size_t iTo)
+    {
+        std::rotate(vTracks.begin() + static_cast<std::ptrdiff_t>(iTo),
+                    vTracks.begin() + static_cast<std::ptrdiff_t>(iFrom),
+                    vTracks.begin() + static_cast<std::ptrdiff_t>(iFrom + 1));
+
+        for (size_t i = iTo; i <= iFrom; i++)
+        {
+            trackIndex[vTracks[i]->iTrackID] = i;
+        }
+    }
+
+    size_t size() const
+    {
+        return vTracks.size();
+    }
+
+private:
+
+    XTracklist vTracks;
+    std::unordered_map<unsigned long long, size_t> trackIndex;
+};
+
+
+static unsigned long long iNextTrackID = 1;
+
+static XTracklist makeTracks(size_t iCount)
+{
+    XTracklist vTracks;
+
+    for (size_t i = 0; i < iCount; i++)
+    {
+        std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+        pAudio->iTrackID = iNextTrackID++;
+
+        vTracks.push_back(pAudio);
+    }
+
+    return vTracks;
+}
+
+// Returns the time of one change in microseconds.
+template<typename Tracklist>
+static double measure(size_t iTrackCount, size_t iChangeCount, int iAction)
+{
+    std::shared_ptr<Tracklist> pSnapshot = std::make_shared<Tracklist>();
+    pSnapshot->append(makeTracks(iTrackCount));
+
+    std::vector<XTracklist> vBatches;
+    if (iAction == 2)
+    {
+        for (size_t i = 0; i < iChangeCount; i++)
+        {
+            vBatches.push_back(makeTracks(IMPORT_BATCH_SIZE));
+        }
+    }
+
+    std::mt19937 random(1);
+
+    TestTimer timer;
+
+    for (size_t i = 0; i < iChangeCount; i++)
+    {
+        // The old snapshot is released right away (as the UI does after showing the new one).
+        std::shared_ptr<Tracklist> pNew = std::make_shared<Tracklist>(*pSnapshot);
+
+        const size_t iIndex = 1 + random() % (pNew->size() - 1);
+
+        if (iAction == 0)
+        {
+            pNew->remove(iIndex);
+        }
+        else if (iAction == 1)
+        {
+            pNew->move(iIndex, iIndex - 1);
+        }
+        else
+        {
+            pNew->append(vBatches[i]);
+        }
+
+        pSnapshot = pNew;
+    }
+
+    return timer.getElapsedInMs() * 1000.0 / iChangeCount;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iChangeCount = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 200;
+
+    const size_t vTrackCounts[] = {1000, 10000, 100000, 1000000};
+    const char*  vActions[]     = {"remove", "move up", "append 500"};
+
+    std::printf("%-12s %10s %14s %14s %10s\n", "change", "tracks", "flat us", "chunked us", "speedup");
+
+    for (int iAction = 0; iAction < 3; iAction++)
+    {
+        for (size_t iTrackCount : vTrackCounts)
+        {
+            const double dFlatInUs    = measure<FlatTracklist>(iTrackCount, iChangeCount, iAction);
+            const double dChunkedInUs = measure<IndexedTracklist>(iTrackCount, iChangeCount, iAction);
+
+            std::printf("%-12s %10zu %14.1f %14.1f %9.0fx\n", vActions[iAction], iTrackCount, dFlatInUs, dChunkedInUs, dFlatInUs / dChunkedInUs);
+        }
+    }
+
+    return 0;
+}
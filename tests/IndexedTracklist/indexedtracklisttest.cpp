@@ -0,0 +1,197 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Random appends, removes and moves (as AudioCore makes them: copy the snapshot, change the copy)
+// checked against a plain vector, the older snapshots should not change.
+
+// STL
+#include <random>
+#include <algorithm>
+
+// Custom
+#include "Model/IndexedTracklist/indexedtracklist.h"
+#include "TestUtils/testutils.h"
+
+
+static unsigned long long iNextTrackID = 1;
+
+
+static XTracklist makeTracks(size_t iCount)
+{
+    XTracklist vTracks;
+
+    for (size_t i = 0; i < iCount; i++)
+    {
+        std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+        pAudio->iTrackID = iNextTrackID++;
+
+        vTracks.push_back(pAudio);
+    }
+
+    return vTracks;
+}
+
+// Returns 'false' if the tracklist is not the same as 'vExpected'.
+static bool isSame(const IndexedTracklist& vTracks, const XTracklist& vExpected)
+{
+    if (vTracks.size() != vExpected.size())
+    {
+        return false;
+    }
+
+    if (std::equal(vTracks.begin(), vTracks.end(), vExpected.begin()) == false)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < vExpected.size(); i++)
+    {
+        size_t iIndex = 0;
+
+        if (vTracks[i] != vExpected[i] || vTracks.findTrack(vExpected[i]->iTrackID, iIndex) == false || iIndex != i)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void testRandomChanges()
+{
+    std::mt19937 random(1);
+
+    std::shared_ptr<const IndexedTracklist> pSnapshot = std::make_shared<IndexedTracklist>();
+    XTracklist vExpected;
+
+    std::vector<std::pair<std::shared_ptr<const IndexedTracklist>, XTracklist>> vOldSnapshots;
+
+    for (size_t iStep = 0; iStep < 3000; iStep++)
+    {
+        std::shared_ptr<IndexedTracklist> pNew = std::make_shared<IndexedTracklist>(*pSnapshot);
+
+        const unsigned int iAction = random() % 10;
+
+        if (iAction < 2 || vExpected.size() < 2)
+        {
+            XTracklist vBatch = makeTracks(random() % 700);
+
+            pNew->append(vBatch);
+            vExpected.insert(vExpected.end(), vBatch.begin(), vBatch.end());
+        }
+        else if (iAction < 6)
+        {
+            const size_t iIndex = random() % vExpected.size();
+
+            pNew->remove(iIndex);
+            vExpected.erase(vExpected.begin() + static_cast<std::ptrdiff_t>(iIndex));
+        }
+        else
+        {
+            // Mostly by one (move up/down), sometimes far.
+
+            const size_t iFrom = random() % vExpected.size();
+            size_t iTo = random() % vExpected.size();
+
+            if (iAction < 9)
+            {
+                iTo = iFrom == 0 ? vExpected.size() - 1 : iFrom - 1;
+            }
+
+            pNew->move(iFrom, iTo);
+
+            std::shared_ptr<XAudioFile> pTrack = vExpected[iFrom];
+            vExpected.erase(vExpected.begin() + static_cast<std::ptrdiff_t>(iFrom));
+            vExpected.insert(vExpected.begin() + static_cast<std::ptrdiff_t>(iTo), pTrack);
+        }
+
+        pSnapshot = pNew;
+
+        if (iStep % 300 == 0)
+        {
+            XCHECK(isSame(*pSnapshot, vExpected));
+
+            vOldSnapshots.push_back({pSnapshot, vExpected});
+        }
+    }
+
+    XCHECK(isSame(*pSnapshot, vExpected));
+
+
+    for (const auto& oldSnapshot : vOldSnapshots)
+    {
+        XCHECK(isSame(*oldSnapshot.first, oldSnapshot.second));
+    }
+
+
+    // Removed tracks are not found.
+
+    std::shared_ptr<IndexedTracklist> pNew = std::make_shared<IndexedTracklist>(*pSnapshot);
+    const unsigned long long iRemovedID = vExpected[vExpected.size() / 2]->iTrackID;
+    pNew->remove(vExpected.size() / 2);
+
+    size_t iIndex = 0;
+    XCHECK(pNew->findTrack(iRemovedID, iIndex) == false);
+    XCHECK(pNew->getTrack(iRemovedID) == nullptr);
+    XCHECK(pSnapshot->getTrack(iRemovedID) != nullptr);
+
+    XCHECK(pNew->findTrack(0, iIndex) == false);
+    XCHECK(pNew->findTrack(iNextTrackID + 1000000, iIndex) == false);
+}
+
+static void testIterators()
+{
+    IndexedTracklist vTracks;
+
+    XCHECK(vTracks.begin() == vTracks.end());
+
+    XTracklist vExpected = makeTracks(TRACKLIST_CHUNK_SIZE * 3 + 7);
+    vTracks.append(vExpected);
+
+    XCHECK(vTracks.end() - vTracks.begin() == static_cast<std::ptrdiff_t>(vExpected.size()));
+
+    // Backwards over the chunk borders.
+    size_t i = vExpected.size();
+    for (IndexedTracklist::const_iterator it = vTracks.end(); it != vTracks.begin();)
+    {
+        --it;
+        i--;
+
+        XCHECK(*it == vExpected[i]);
+    }
+
+    IndexedTracklist::const_iterator it = vTracks.begin() + TRACKLIST_CHUNK_SIZE;
+    XCHECK(*it == vExpected[TRACKLIST_CHUNK_SIZE]);
+    XCHECK(it[-1] == vExpected[TRACKLIST_CHUNK_SIZE - 1]);
+    XCHECK((it - 1)->get() == vExpected[TRACKLIST_CHUNK_SIZE - 1].get());
+    XCHECK(it < vTracks.end() && it > vTracks.begin());
+
+
+    // Everything removed.
+
+    while (vTracks.size() > 0)
+    {
+        vTracks.remove(vTracks.size() - 1);
+    }
+
+    XCHECK(vTracks.begin() == vTracks.end());
+
+    XTracklist vNew = makeTracks(3);
+    vTracks.append(vNew);
+    vTracks.move(0, 2);
+
+    XCHECK(isSame(vTracks, {vNew[1], vNew[2], vNew[0]}));
+}
+
+
+int main()
+{
+    testRandomChanges();
+    testIterators();
+
+    return finishTest();
+}
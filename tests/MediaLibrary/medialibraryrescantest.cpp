@@ -0,0 +1,182 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// A folder is added, its files are changed, removed, renamed, moved and added and the folder is added again
+// (as AudioCore does it: the files that are in the tracklist are skipped, then the folder changes are applied).
+// The tracklist should have each file once, the moved files at the places of their old tracks.
+
+// STL
+#include <cmath>
+#include <memory>
+#include <algorithm>
+#include <unordered_set>
+
+// Custom
+#include "Model/TrackImporter/trackimporter.h"
+#include "TestUtils/testutils.h"
+
+
+static unsigned long long iNextTrackID = 1;
+
+
+static void writeTrack(const std::filesystem::path& path, int iTone, unsigned long long iFrameCount = 2000)
+{
+    XCHECK(writeWaveFile(path, 1, 16, 1, 44100, iFrameCount, [iTone](unsigned long long iFrame, unsigned short)
+    {
+        return 0.5 * std::sin(iFrame * 0.001 * iTone);
+    }) == false);
+}
+
+static void addFolder(const std::filesystem::path& folder, MediaLibrary& library, IndexedTracklist& vTracks, MediaLibraryChanges& changes)
+{
+    std::unordered_set<std::wstring> trackPaths;
+
+    for (const std::shared_ptr<XAudioFile>& pTrack : vTracks)
+    {
+        trackPaths.insert(pTrack->sPathToAudioFile);
+    }
+
+    TrackImporter importer(IMPORT_BATCH_SIZE, 2);
+
+    importer.setSkipPath([&trackPaths](const std::wstring& sPath)
+    {
+        return trackPaths.count(sPath) > 0;
+    });
+
+    importer.setOnBatch([&](XTracklist& vBatch, size_t, size_t)
+    {
+        for (size_t i = 0; i < vBatch.size(); i++)
+        {
+            vBatch[i]->iTrackID = iNextTrackID++;
+        }
+
+        vTracks.append(vBatch);
+    });
+
+    changes = MediaLibraryChanges();
+
+    importer.importFolder(folder.wstring(), nullptr, &library, &changes);
+
+    XTracklist vRemovedTracks;
+    TrackImporter::applyFolderChanges(vTracks, changes, vRemovedTracks);
+}
+
+static std::vector<std::wstring> getPaths(const IndexedTracklist& vTracks)
+{
+    std::vector<std::wstring> vPaths;
+
+    for (const std::shared_ptr<XAudioFile>& pTrack : vTracks)
+    {
+        vPaths.push_back(pTrack->sPathToAudioFile);
+    }
+
+    return vPaths;
+}
+
+static size_t indexOf(const std::vector<std::wstring>& vPaths, const std::filesystem::path& path)
+{
+    return static_cast<size_t>(std::find(vPaths.begin(), vPaths.end(), path.wstring()) - vPaths.begin());
+}
+
+
+int main()
+{
+    const std::filesystem::path dir = getTestDirectory(L"MediaLibraryRescanTest");
+    const std::filesystem::path folder = dir / L"Music";
+
+    std::filesystem::create_directories(folder / L"Album");
+
+    const int iTrackCount = 12;
+
+    for (int i = 0; i < iTrackCount; i++)
+    {
+        writeTrack(folder / L"Album" / (L"track" + std::to_wstring(i) + L".wav"), i + 1);
+    }
+
+
+    std::unique_ptr<MediaLibrary> pLibrary = std::make_unique<MediaLibrary>();
+    XCHECK(pLibrary->open((dir / L"library.xlb").wstring()) == false);
+
+    IndexedTracklist vTracks;
+    MediaLibraryChanges changes;
+
+    addFolder(folder, *pLibrary, vTracks, changes);
+
+    XCHECK(vTracks.size() == iTrackCount);
+    XCHECK(changes.vRemovedPaths.empty() && changes.vMovedPaths.empty());
+
+    const std::vector<std::wstring> vFirstPaths = getPaths(vTracks);
+
+
+    // Added again without changes: nothing is added twice.
+
+    addFolder(folder, *pLibrary, vTracks, changes);
+
+    XCHECK(getPaths(vTracks) == vFirstPaths);
+    XCHECK(changes.vRemovedPaths.empty() && changes.vMovedPaths.empty());
+
+
+    // Changed, removed, renamed, moved to a subfolder and new files.
+
+    const std::filesystem::path changedPath = folder / L"Album" / L"track1.wav";
+    const std::filesystem::path removedPath = folder / L"Album" / L"track2.wav";
+    const std::filesystem::path renamedPath = folder / L"Album" / L"track5.wav";
+    const std::filesystem::path movedPath   = folder / L"Album" / L"track8.wav";
+    const std::filesystem::path newName     = folder / L"Album" / L"05 - renamed.wav";
+    const std::filesystem::path newFolder   = folder / L"Album" / L"CD2" / L"track8.wav";
+    const std::filesystem::path addedPath   = folder / L"Album" / L"new.wav";
+
+    const std::shared_ptr<XAudioFile> pChangedTrack = vTracks[indexOf(vFirstPaths, changedPath)];
+    const size_t iRenamedIndex = indexOf(vFirstPaths, renamedPath);
+    const size_t iMovedIndex   = indexOf(vFirstPaths, movedPath);
+
+    writeTrack(changedPath, 100, 3000);
+    std::filesystem::remove(removedPath);
+    std::filesystem::rename(renamedPath, newName);
+    std::filesystem::create_directories(newFolder.parent_path());
+    std::filesystem::rename(movedPath, newFolder);
+    writeTrack(addedPath, 200);
+
+    addFolder(folder, *pLibrary, vTracks, changes);
+
+    const std::vector<std::wstring> vPaths = getPaths(vTracks);
+
+    XCHECK(changes.vRemovedPaths == std::vector<std::wstring>{removedPath.wstring()});
+    XCHECK(changes.vMovedPaths.size() == 2);
+
+    // The moved files keep the places of their old tracks, the new file is added at the end.
+    std::vector<std::wstring> vExpected = vFirstPaths;
+    vExpected[iRenamedIndex] = newName.wstring();
+    vExpected[iMovedIndex] = newFolder.wstring();
+    vExpected.erase(vExpected.begin() + static_cast<std::ptrdiff_t>(indexOf(vExpected, removedPath)));
+    vExpected.push_back(addedPath.wstring());
+
+    XCHECK(vPaths == vExpected);
+
+    // The changed file stays the same track.
+    XCHECK(vTracks[indexOf(vPaths, changedPath)] == pChangedTrack);
+
+
+    // The library is kept between the runs (the moves were saved).
+
+    pLibrary = std::make_unique<MediaLibrary>();
+    XCHECK(pLibrary->open((dir / L"library.xlb").wstring()) == false);
+
+    std::filesystem::remove(newName);
+
+    addFolder(folder, *pLibrary, vTracks, changes);
+
+    XCHECK(changes.vRemovedPaths == std::vector<std::wstring>{newName.wstring()});
+    XCHECK(changes.vMovedPaths.empty());
+    XCHECK(vTracks.size() == iTrackCount - 1);
+
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return finishTest();
+}
@@ -0,0 +1,199 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Time of adding a folder again after some of its files were changed, removed, renamed and added:
+// as before (the whole folder is added to the tracklist again) and with the diff
+// (the files that are in the tracklist are skipped, the removed/moved tracks are updated).
+// Reports the tracklist size after the rescan and how many paths are in it more than once.
+//
+// Usage: RescanBenchmark [file count (default 20000)] [churn in percent of the files for each change (default 1)]
+
+// STL
+#include <cmath>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_set>
+
+// Custom
+#include "Model/TrackImporter/trackimporter.h"
+#include "TestUtils/testutils.h"
+
+
+static unsigned long long iNextTrackID = 1;
+
+
+static bool writeTrack(const std::filesystem::path& path, size_t iTone, unsigned long long iFrameCount)
+{
+    return writeWaveFile(path, 1, 16, 1, 8000, iFrameCount, [iTone](unsigned long long iFrame, unsigned short)
+    {
+        return 0.5 * std::sin(iFrame * 0.0001 * static_cast<double>(iTone + 1));
+    });
+}
+
+struct RescanResult
+{
+    double dTimeInMs = 0.0;
+    size_t iTrackCount = 0;
+    size_t iDuplicateCount = 0;
+    size_t iRemovedCount = 0;
+    size_t iMovedCount = 0;
+};
+
+static RescanResult addFolder(const std::filesystem::path& folder, MediaLibrary& library, IndexedTracklist& vTracks, bool bDiff)
+{
+    RescanResult result;
+
+    TestTimer timer;
+
+    std::unordered_set<std::wstring> trackPaths;
+
+    TrackImporter importer(IMPORT_BATCH_SIZE, IMPORT_THREAD_COUNT);
+
+    if (bDiff)
+    {
+        for (const std::shared_ptr<XAudioFile>& pTrack : vTracks)
+        {
+            trackPaths.insert(pTrack->sPathToAudioFile);
+        }
+
+        importer.setSkipPath([&trackPaths](const std::wstring& sPath)
+        {
+            return trackPaths.count(sPath) > 0;
+        });
+    }
+
+    importer.setOnBatch([&](XTracklist& vBatch, size_t, size_t)
+    {
+        for (size_t i = 0; i < vBatch.size(); i++)
+        {
+            vBatch[i]->iTrackID = iNextTrackID++;
+        }
+
+        vTracks.append(vBatch);
+    });
+
+    MediaLibraryChanges changes;
+
+    importer.importFolder(folder.wstring(), nullptr, &library, &changes);
+
+    if (bDiff)
+    {
+        XTracklist vRemovedTracks;
+        TrackImporter::applyFolderChanges(vTracks, changes, vRemovedTracks);
+    }
+
+    result.dTimeInMs = timer.getElapsedInMs();
+
+
+    std::vector<std::wstring> vPaths;
+    for (const std::shared_ptr<XAudioFile>& pTrack : vTracks)
+    {
+        vPaths.push_back(pTrack->sPathToAudioFile);
+    }
+
+    std::sort(vPaths.begin(), vPaths.end());
+
+    result.iTrackCount = vPaths.size();
+    result.iDuplicateCount = vPaths.size() - static_cast<size_t>(std::unique(vPaths.begin(), vPaths.end()) - vPaths.begin());
+    result.iRemovedCount = changes.vRemovedPaths.size();
+    result.iMovedCount = changes.vMovedPaths.size();
+
+    return result;
+}
+
+static void changeFiles(const std::filesystem::path& folder, size_t iFileCount, size_t iChurnCount, size_t iRound)
+{
+    // Different files in each round (the files are 'iStep' apart, see main()).
+    auto getPath = [&](size_t i)
+    {
+        return folder / (L"Artist " + std::to_wstring(i / 100)) / (L"track" + std::to_wstring(i) + L".wav");
+    };
+
+    const size_t iStep = iFileCount / (iChurnCount * 4);
+
+    for (size_t i = 0; i < iChurnCount; i++)
+    {
+        const size_t iFirst = (i * 4) * iStep + iRound;
+
+        writeTrack(getPath(iFirst), iFileCount + iFirst, 600);                  // changed
+
+        std::filesystem::remove(getPath(iFirst + iStep));                     // removed
+
+        std::filesystem::rename(getPath(iFirst + 2 * iStep),                  // renamed
+                                folder / (L"Artist " + std::to_wstring((iFirst + 2 * iStep) / 100)) / (L"renamed" + std::to_wstring(iRound) + L"_" + std::to_wstring(i) + L".wav"));
+
+        writeTrack(folder / (L"new" + std::to_wstring(iRound) + L"_" + std::to_wstring(i) + L".wav"), 3 * iFileCount + i, 400); // added
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iFileCount = std::max<size_t>(argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 20000, 400);
+    const double dChurnInPercent = argc > 2 ? std::atof(argv[2]) : 1.0;
+
+    // At least 2 files between the changed ones so that the rounds change different files.
+    const size_t iChurnCount = std::min(std::max<size_t>(static_cast<size_t>(iFileCount * dChurnInPercent / 100.0), 1), iFileCount / 8);
+
+    const std::filesystem::path dir = getTestDirectory(L"RescanBenchmark");
+
+
+    std::printf("%zu files, %zu changed, %zu removed, %zu renamed and %zu added before each rescan\n\n",
+                iFileCount, iChurnCount, iChurnCount, iChurnCount, iChurnCount);
+    std::printf("%-8s %-10s %10s %10s %12s %10s %8s\n", "rescan", "mode", "ms", "tracks", "duplicates", "removed", "moved");
+
+    auto print = [](const char* pScan, const char* pMode, const RescanResult& result)
+    {
+        std::printf("%-8s %-10s %10.1f %10zu %12zu %10zu %8zu\n", pScan, pMode, result.dTimeInMs, result.iTrackCount,
+                    result.iDuplicateCount, result.iRemovedCount, result.iMovedCount);
+    };
+
+    const char* vModes[] = {"add all", "diff"};
+
+    for (int iMode = 0; iMode < 2; iMode++)
+    {
+        const std::filesystem::path folder = dir / (L"Music" + std::to_wstring(iMode));
+
+        for (size_t i = 0; i < iFileCount; i++)
+        {
+            const std::filesystem::path path = folder / (L"Artist " + std::to_wstring(i / 100)) / (L"track" + std::to_wstring(i) + L".wav");
+
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+
+            if (writeTrack(path, i, 400))
+            {
+                std::printf("failed to write the files\n");
+                return 1;
+            }
+        }
+
+        MediaLibrary library;
+        library.open((dir / (L"library" + std::to_wstring(iMode) + L".xlb")).wstring());
+
+        IndexedTracklist vTracks;
+
+        print("first", vModes[iMode], addFolder(folder, library, vTracks, iMode == 1));
+        print("same", vModes[iMode], addFolder(folder, library, vTracks, iMode == 1));
+
+        for (size_t iRound = 0; iRound < 2; iRound++)
+        {
+            changeFiles(folder, iFileCount, iChurnCount, iRound);
+
+            print("churn", vModes[iMode], addFolder(folder, library, vTracks, iMode == 1));
+        }
+    }
+
+    std::printf("\npeak memory: %zu KB\n", getPeakMemoryInKB());
+
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return 0;
+}
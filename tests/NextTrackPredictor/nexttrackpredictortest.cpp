@@ -0,0 +1,272 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// The next track that AudioCore prefetches: repeat, too few tracks, nothing played, the order
+// of the tracklist (with the wrap around), random, the history, and whether the prefetched track
+// is still the next one after tracks are removed, added, moved or replaced.
+
+// STL
+#include <set>
+
+// Custom
+#include "Model/NextTrackPredictor/nexttrackpredictor.h"
+#include "TestUtils/testutils.h"
+
+
+static unsigned long long iNextTrackID = 1;
+
+
+static std::shared_ptr<XAudioFile> makeTrack()
+{
+    std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+    pAudio->iTrackID = iNextTrackID;
+    pAudio->sPathToAudioFile = L"/music/track" + std::to_wstring(iNextTrackID) + L".wav";
+
+    iNextTrackID++;
+
+    return pAudio;
+}
+
+static IndexedTracklist makeTracklist(size_t iTrackCount)
+{
+    XTracklist vNewTracks;
+
+    for (size_t i = 0; i < iTrackCount; i++)
+    {
+        vNewTracks.push_back(makeTrack());
+    }
+
+    IndexedTracklist vTracks;
+    vTracks.append(vNewTracks);
+
+    return vTracks;
+}
+
+
+static void testNotPredicted()
+{
+    std::mt19937_64 rndGen(1);
+
+    const IndexedTracklist vTracks = makeTracklist(5);
+
+    // Repeat.
+    XCHECK(NextTrackPredictor::predict(vTracks, {vTracks[1]}, false, true, rndGen) == nullptr);
+    XCHECK(NextTrackPredictor::predict(vTracks, {vTracks[1]}, true, true, rndGen) == nullptr);
+
+    // Nothing played.
+    XCHECK(NextTrackPredictor::predict(vTracks, {}, false, false, rndGen) == nullptr);
+
+    // One track.
+    const IndexedTracklist vOneTrack = makeTracklist(1);
+    XCHECK(NextTrackPredictor::predict(vOneTrack, {vOneTrack[0]}, false, false, rndGen) == nullptr);
+    XCHECK(NextTrackPredictor::predict(vOneTrack, {vOneTrack[0]}, true, false, rndGen) == nullptr);
+
+    // The current track is not in the tracklist (removed).
+    XCHECK(NextTrackPredictor::predict(vTracks, {makeTrack()}, false, false, rndGen) == nullptr);
+}
+
+static void testInOrder()
+{
+    std::mt19937_64 rndGen(1);
+
+    const IndexedTracklist vTracks = makeTracklist(5);
+
+    for (size_t i = 0; i < vTracks.size(); i++)
+    {
+        const std::shared_ptr<XAudioFile> pNext = NextTrackPredictor::predict(vTracks, {vTracks[i]}, false, false, rndGen);
+
+        // The first track after the last one.
+        XCHECK(pNext == vTracks[(i + 1) % vTracks.size()]);
+    }
+
+    // The current track is the last one in the history.
+    XCHECK(NextTrackPredictor::predict(vTracks, {vTracks[3], vTracks[0], vTracks[1]}, false, false, rndGen) == vTracks[2]);
+    XCHECK(NextTrackPredictor::predict(vTracks, {vTracks[1], vTracks[4]}, false, false, rndGen) == vTracks[0]);
+
+    // Two tracks.
+    const IndexedTracklist vTwoTracks = makeTracklist(2);
+    XCHECK(NextTrackPredictor::predict(vTwoTracks, {vTwoTracks[1]}, false, false, rndGen) == vTwoTracks[0]);
+}
+
+static void testRandom()
+{
+    const IndexedTracklist vTracks = makeTracklist(6);
+
+    std::mt19937_64 rndGen(1);
+
+    std::set<std::shared_ptr<XAudioFile>> picked;
+
+    for (size_t i = 0; i < 1000; i++)
+    {
+        const std::shared_ptr<XAudioFile> pNext = NextTrackPredictor::predict(vTracks, {vTracks[0], vTracks[2]}, true, false, rndGen);
+
+        // Never the current track.
+        XCHECK(pNext != nullptr && pNext != vTracks[2]);
+
+        picked.insert(pNext);
+    }
+
+    // Every other track (including the ones in the history).
+    XCHECK(picked.size() == vTracks.size() - 1);
+
+
+    // The same generator state gives the same track.
+    std::mt19937_64 rndGen1(7);
+    std::mt19937_64 rndGen2(7);
+
+    for (size_t i = 0; i < 100; i++)
+    {
+        XCHECK(NextTrackPredictor::predict(vTracks, {vTracks[i % vTracks.size()]}, true, false, rndGen1)
+               == NextTrackPredictor::predict(vTracks, {vTracks[i % vTracks.size()]}, true, false, rndGen2));
+    }
+
+    // Two tracks: always the other one.
+    const IndexedTracklist vTwoTracks = makeTracklist(2);
+    for (size_t i = 0; i < 20; i++)
+    {
+        XCHECK(NextTrackPredictor::predict(vTwoTracks, {vTwoTracks[0]}, true, false, rndGen) == vTwoTracks[1]);
+    }
+}
+
+static void testStillNextInOrder()
+{
+    std::mt19937_64 rndGen(1);
+
+    const IndexedTracklist vTracks = makeTracklist(5);
+    const XTracklist vHistory = {vTracks[1]};
+
+    const std::shared_ptr<XAudioFile> pNext = NextTrackPredictor::predict(vTracks, vHistory, false, false, rndGen);
+    XCHECK(pNext == vTracks[2]);
+
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, vHistory, pNext, false, false));
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, vHistory, vTracks[3], false, false) == false);
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, vHistory, nullptr, false, false) == false);
+
+    // The modes are changed (AudioCore drops the next track then anyway).
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, vHistory, pNext, false, true) == false);
+
+
+    // Other tracks removed: the next one is still after the current one.
+    IndexedTracklist vRemoved = vTracks;
+    vRemoved.remove(4);
+    vRemoved.remove(0);
+    XCHECK(NextTrackPredictor::isStillNext(vRemoved, vHistory, pNext, false, false));
+
+    // The next track removed.
+    vRemoved = vTracks;
+    vRemoved.remove(2);
+    XCHECK(NextTrackPredictor::isStillNext(vRemoved, vHistory, pNext, false, false) == false);
+    XCHECK(NextTrackPredictor::predict(vRemoved, vHistory, false, false, rndGen) == vTracks[3]);
+
+    // The current track removed (from the tracklist and the history).
+    vRemoved = vTracks;
+    vRemoved.remove(1);
+    XCHECK(NextTrackPredictor::isStillNext(vRemoved, vHistory, pNext, false, false) == false);
+    XCHECK(NextTrackPredictor::isStillNext(vRemoved, {}, pNext, false, false) == false);
+
+    // The current track removed from the history only: the previous one is current again.
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, {vTracks[0], vTracks[1]}, pNext, false, false));
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, {vTracks[0]}, pNext, false, false) == false);
+
+    // A track moved between the current and the next one.
+    IndexedTracklist vMoved = vTracks;
+    vMoved.move(4, 2);
+    XCHECK(NextTrackPredictor::isStillNext(vMoved, vHistory, pNext, false, false) == false);
+
+    // A track moved elsewhere.
+    vMoved = vTracks;
+    vMoved.move(0, 4);
+    XCHECK(NextTrackPredictor::isStillNext(vMoved, vHistory, pNext, false, false));
+
+    // Tracks added at the end.
+    IndexedTracklist vAdded = vTracks;
+    vAdded.append({makeTrack(), makeTrack()});
+    XCHECK(NextTrackPredictor::isStillNext(vAdded, vHistory, pNext, false, false));
+
+    // Replaced with another track of the same ID (the track of a moved file).
+    std::shared_ptr<XAudioFile> pReplacement = std::make_shared<XAudioFile>(*pNext);
+    pReplacement->sPathToAudioFile = L"/music/moved.wav";
+
+    XTracklist vReplaced(vTracks.begin(), vTracks.end());
+    vReplaced[2] = pReplacement;
+
+    IndexedTracklist vReplacedTracks;
+    vReplacedTracks.append(vReplaced);
+    XCHECK(NextTrackPredictor::isStillNext(vReplacedTracks, vHistory, pNext, false, false) == false);
+}
+
+static void testStillNextAfterLast()
+{
+    std::mt19937_64 rndGen(1);
+
+    const IndexedTracklist vTracks = makeTracklist(4);
+    const XTracklist vHistory = {vTracks[3]};
+
+    // The first track after the last one.
+    const std::shared_ptr<XAudioFile> pNext = NextTrackPredictor::predict(vTracks, vHistory, false, false, rndGen);
+    XCHECK(pNext == vTracks[0]);
+
+    // Tracks added at the end (the import): the next track is the first added one now.
+    IndexedTracklist vAdded = vTracks;
+    const std::shared_ptr<XAudioFile> pAdded = makeTrack();
+    vAdded.append({pAdded});
+
+    XCHECK(NextTrackPredictor::isStillNext(vAdded, vHistory, pNext, false, false) == false);
+    XCHECK(NextTrackPredictor::predict(vAdded, vHistory, false, false, rndGen) == pAdded);
+}
+
+static void testStillNextRandom()
+{
+    std::mt19937_64 rndGen(3);
+
+    const IndexedTracklist vTracks = makeTracklist(5);
+    const XTracklist vHistory = {vTracks[2]};
+
+    const std::shared_ptr<XAudioFile> pNext = NextTrackPredictor::predict(vTracks, vHistory, true, false, rndGen);
+    XCHECK(pNext != nullptr && pNext != vTracks[2]);
+
+    size_t iNextIndex = 0;
+    XCHECK(vTracks.findTrack(pNext->iTrackID, iNextIndex));
+
+    // Any other track can be next.
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, vHistory, pNext, true, false));
+    XCHECK(NextTrackPredictor::isStillNext(vTracks, vHistory, vTracks[2], true, false) == false);
+
+    // Tracks added and moved.
+    IndexedTracklist vChanged = vTracks;
+    vChanged.append({makeTrack()});
+    vChanged.move(iNextIndex, vChanged.size() - 1);
+    XCHECK(NextTrackPredictor::isStillNext(vChanged, vHistory, pNext, true, false));
+
+    // Another track removed (not the current one, it's at 2).
+    IndexedTracklist vRemoved = vTracks;
+    vRemoved.remove(iNextIndex == 0 ? 1 : 0);
+    XCHECK(NextTrackPredictor::isStillNext(vRemoved, vHistory, pNext, true, false));
+
+    // The next track removed.
+    vRemoved = vTracks;
+    vRemoved.remove(iNextIndex);
+    XCHECK(NextTrackPredictor::isStillNext(vRemoved, vHistory, pNext, true, false) == false);
+
+    // Only the current track is left.
+    IndexedTracklist vOneTrack;
+    vOneTrack.append({vTracks[2]});
+    XCHECK(NextTrackPredictor::isStillNext(vOneTrack, vHistory, pNext, true, false) == false);
+}
+
+
+int main()
+{
+    testNotPredicted();
+    testInOrder();
+    testRandom();
+    testStillNextInOrder();
+    testStillNextAfterLast();
+    testStillNextRandom();
+
+    return finishTest();
+}
@@ -0,0 +1,134 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Compares drawing the oscillogram of a long WAV file without the peak cache (decoding the whole file)
+// and with it (like AudioCore::drawGraphFromFile() and AudioCore::drawGraphFromCache()).
+//
+// Usage: PeakCacheBenchmark [length in minutes (default 120)] [graph width in pixels (default 1920)]
+
+// STL
+#include <cmath>
+#include <cstdlib>
+
+// Custom
+#include "Model/globals.h"
+#include "Model/PeakCache/peakcache.h"
+#include "Model/AudioEngine/SWaveFile/swavefile.h"
+#include "Model/AudioEngine/SSampleConverter/ssampleconverter.h"
+#include "Model/AudioEngine/SWaveDecimator/swavedecimator.h"
+#include "TestUtils/testutils.h"
+
+
+int main(int argc, char* argv[])
+{
+    const double dLengthInMin  = argc > 1 ? std::atof(argv[1]) : 120.0;
+    const size_t iGraphWidth   = argc > 2 ? static_cast<size_t>(std::atoi(argv[2])) : 1920;
+
+    const unsigned int iSampleRate = 44100;
+    const unsigned long long iFrameCount = static_cast<unsigned long long>(dLengthInMin * 60 * iSampleRate);
+
+
+    const std::filesystem::path dir = getTestDirectory(L"PeakCacheBenchmark");
+    const std::filesystem::path audioPath = dir / L"long.wav";
+
+    std::printf("generating %.0f min 16-bit stereo WAV...\n", dLengthInMin);
+
+    if (writeWaveFile(audioPath, 1, 16, 2, iSampleRate, iFrameCount,
+                      [](unsigned long long iFrame, unsigned short iChannel)
+                      {
+                          return 0.5 * std::sin(iFrame * 0.01 + iChannel);
+                      }))
+    {
+        std::printf("failed to write the file\n");
+        return 1;
+    }
+
+
+    PeakCache cache;
+    cache.setCacheDirectory((dir / L"cache").wstring());
+
+
+    // Cold: decode the whole file.
+
+    TestTimer timer;
+
+    SWaveFile waveFile;
+    if (waveFile.open(audioPath.wstring()))
+    {
+        std::printf("failed to open the file\n");
+        return 1;
+    }
+
+    const SWaveFormat& format = waveFile.getFormat();
+
+    S_SAMPLE_FORMAT sampleFormat = SF_INT16;
+    SSampleConverter::getSampleFormat(format.iBitsPerSample, format.iFormatTag == WFT_IEEE_FLOAT, sampleFormat);
+
+    unsigned long long iFramesPerPeak = static_cast<unsigned long long>(3000 * waveFile.getLengthInSec() / 6000);
+    if (iFramesPerPeak == 0)
+    {
+        iFramesPerPeak = 1;
+    }
+
+    SWaveDecimator decimator;
+    decimator.setup(format.iChannels, iFramesPerPeak, waveFile.getFrameCount());
+
+    const size_t iChunkFrameCount = iSampleRate / 10;
+    std::vector<float> vFloatSamples(iChunkFrameCount * format.iChannels);
+
+    for (size_t iFrame = 0; iFrame < waveFile.getFrameCount(); iFrame += iChunkFrameCount)
+    {
+        size_t iFrames = waveFile.getFrameCount() - iFrame;
+        if (iFrames > iChunkFrameCount)
+        {
+            iFrames = iChunkFrameCount;
+        }
+
+        SSampleConverter::convertToFloat(waveFile.getFrame(iFrame), iFrames * format.iChannels, sampleFormat, vFloatSamples.data());
+        decimator.process(vFloatSamples.data(), iFrames);
+    }
+    decimator.flush();
+
+    std::vector<PeakLevel> vLevels(1);
+    vLevels[0].iFramesPerPeak = iFramesPerPeak;
+    vLevels[0].vPeaks = decimator.takePeaks();
+
+    PeakCache::buildLevels(vLevels, PEAK_CACHE_MIN_PEAK_COUNT);
+    cache.savePeaks(audioPath.wstring(), vLevels);
+
+    const double dColdTimeInMs = timer.getElapsedInMs();
+
+    waveFile.close();
+
+
+    // Warm: read the cache.
+
+    timer.restart();
+
+    std::vector<PeakLevel> vLoadedLevels;
+    if (cache.loadPeaks(audioPath.wstring(), vLoadedLevels))
+    {
+        std::printf("failed to load the peaks\n");
+        return 1;
+    }
+
+    const size_t iLevel = PeakCache::pickLevel(vLoadedLevels, iGraphWidth);
+
+    const double dWarmTimeInMs = timer.getElapsedInMs();
+
+
+    std::printf("levels: %zu, first level: %zu peaks\n", vLoadedLevels.size(), vLoadedLevels[0].vPeaks.size() / 2);
+    std::printf("cold (decode + save):  %10.2f ms\n", dColdTimeInMs);
+    std::printf("warm (load + pick):    %10.2f ms (%.0fx faster)\n", dWarmTimeInMs, dColdTimeInMs / dWarmTimeInMs);
+    std::printf("peaks sent to a %zu px graph: %zu (level %zu) instead of %zu (level 0)\n",
+                iGraphWidth, vLoadedLevels[iLevel].vPeaks.size() / 2, iLevel, vLoadedLevels[0].vPeaks.size() / 2);
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// STL
+#include <cmath>
+
+// Custom
+#include "Model/PeakCache/peakcache.h"
+#include "TestUtils/testutils.h"
+
+
+static std::vector<PeakLevel> makeLevels(size_t iPeakCount, size_t iMinPeakCount)
+{
+    std::vector<PeakLevel> vLevels(1);
+    vLevels[0].iFramesPerPeak = 100;
+
+    for (size_t i = 0; i < iPeakCount; i++)
+    {
+        const float fValue = static_cast<float>(std::sin(i * 0.01));
+
+        vLevels[0].vPeaks.push_back(-std::fabs(fValue));
+        vLevels[0].vPeaks.push_back(std::fabs(fValue));
+    }
+
+    PeakCache::buildLevels(vLevels, iMinPeakCount);
+
+    return vLevels;
+}
+
+static void testBuildLevels()
+{
+    std::vector<PeakLevel> vLevels = makeLevels(10000, 512);
+
+    // 10000 -> 5000 -> 2500 -> 1250 -> 625 (the next one would have less than 512 peaks).
+    XCHECK(vLevels.size() == 5);
+    XCHECK(vLevels.back().vPeaks.size() / 2 == 625);
+
+    for (size_t i = 1; i < vLevels.size(); i++)
+    {
+        XCHECK(vLevels[i].iFramesPerPeak == vLevels[i - 1].iFramesPerPeak * 2);
+
+        // The coarser level covers the finer one.
+        XCHECK(vLevels[i].vPeaks[0] <= vLevels[i - 1].vPeaks[0]);
+        XCHECK(vLevels[i].vPeaks[1] >= vLevels[i - 1].vPeaks[1]);
+    }
+}
+
+static void testPickLevel()
+{
+    std::vector<PeakLevel> vLevels = makeLevels(10000, 512);
+
+    XCHECK(PeakCache::pickLevel(vLevels, 20000) == 0);
+    XCHECK(PeakCache::pickLevel(vLevels, 10000) == 0);
+    XCHECK(PeakCache::pickLevel(vLevels, 5000)  == 1);
+    XCHECK(PeakCache::pickLevel(vLevels, 1920)  == 2);
+    XCHECK(PeakCache::pickLevel(vLevels, 1250)  == 3);
+    XCHECK(PeakCache::pickLevel(vLevels, 1)     == 4);
+
+    std::vector<PeakLevel> vOneLevel = makeLevels(100, 512);
+    XCHECK(PeakCache::pickLevel(vOneLevel, 1920) == 0);
+}
+
+static void testSaveLoad()
+{
+    const std::filesystem::path dir = getTestDirectory(L"PeakCacheTest");
+    const std::filesystem::path audioPath = dir / L"audio.wav";
+
+    XCHECK(writeWaveFile(audioPath, 1, 16, 1, 44100, std::vector<double>(44100, 0.5)) == false);
+
+    PeakCache cache;
+    cache.setCacheDirectory((dir / L"cache").wstring());
+
+    std::vector<PeakLevel> vLoaded;
+    XCHECK(cache.loadPeaks(audioPath.wstring(), vLoaded));
+
+    std::vector<PeakLevel> vLevels = makeLevels(4000, 512);
+    XCHECK(cache.savePeaks(audioPath.wstring(), vLevels) == false);
+    XCHECK(cache.loadPeaks(audioPath.wstring(), vLoaded) == false);
+
+    XCHECK(vLoaded.size() == vLevels.size());
+    for (size_t i = 0; i < vLoaded.size() && i < vLevels.size(); i++)
+    {
+        XCHECK(vLoaded[i].iFramesPerPeak == vLevels[i].iFramesPerPeak);
+        XCHECK(vLoaded[i].vPeaks == vLevels[i].vPeaks);
+    }
+
+
+    // The cache entry is not valid after the file was changed.
+
+    XCHECK(writeWaveFile(audioPath, 1, 16, 1, 44100, std::vector<double>(44200, 0.5)) == false);
+    XCHECK(cache.loadPeaks(audioPath.wstring(), vLoaded));
+}
+
+int main()
+{
+    testBuildLevels();
+    testPickLevel();
+    testSaveLoad();
+
+    return finishTest();
+}
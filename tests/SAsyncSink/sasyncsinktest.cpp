@@ -0,0 +1,274 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// The sink that SAudioEngine puts between the mastering voice tap and the output sink: every frame
+// reaches the sink in order, close() waits for the rest of the ring, a slow sink makes frames drop
+// (whole frames, the kept ones still in order) instead of blocking write(), and the sink errors are returned by close().
+//
+// Usage: SAsyncSinkTest [delay of the slow sink per write in ms (default 50)]
+
+// STL
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+// Custom
+#include "Model/AudioEngine/SAsyncSink/sasyncsink.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned long  iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+// As the XAudio2 thread passes the mix.
+static const size_t iBlockFrameCount = 441;
+
+
+// Keeps everything it receives, sleeps on every write (as a file on a slow disk).
+class RecordingSink : public SAudioSink
+{
+public:
+
+    RecordingSink(int iWriteDelayInMs = 0, bool bFailWrite = false)
+    {
+        this->iWriteDelayInMs = iWriteDelayInMs;
+        this->bFailWrite = bFailWrite;
+
+        bOpen = false;
+        iOpenCount = 0;
+    }
+
+    bool open(const SAudioSinkFormat&) override
+    {
+        vSamples.clear();
+
+        bOpen = true;
+        iOpenCount++;
+
+        return false;
+    }
+
+    bool write(const float* pSamples, size_t iFrameCount) override
+    {
+        if (iWriteDelayInMs > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(iWriteDelayInMs));
+        }
+
+        vSamples.insert(vSamples.end(), pSamples, pSamples + iFrameCount * iChannels);
+
+        return bFailWrite;
+    }
+
+    bool close() override
+    {
+        bOpen = false;
+
+        return false;
+    }
+
+    bool isOpen() const override
+    {
+        return bOpen;
+    }
+
+    unsigned long long getWrittenFrameCount() const override
+    {
+        return vSamples.size() / iChannels;
+    }
+
+
+    std::vector<float> vSamples;
+    bool bOpen;
+    int  iOpenCount;
+
+private:
+
+    int  iWriteDelayInMs;
+    bool bFailWrite;
+};
+
+
+// Frame 'i' has both channels equal to 'i'.
+static std::vector<float> makeFrames(size_t iFirstFrame, size_t iFrameCount)
+{
+    std::vector<float> vSamples(iFrameCount * iChannels);
+
+    for (size_t i = 0; i < iFrameCount; i++)
+    {
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            vSamples[i * iChannels + c] = static_cast<float>(iFirstFrame + i);
+        }
+    }
+
+    return vSamples;
+}
+
+
+static void testNotOpened()
+{
+    SAsyncSink asyncSink;
+
+    const std::vector<float> vFrames = makeFrames(0, 10);
+
+    // No sink.
+    XCHECK(asyncSink.open({iSampleRate, iChannels}));
+    XCHECK(asyncSink.isOpen() == false);
+    XCHECK(asyncSink.write(vFrames.data(), 10));
+    XCHECK(asyncSink.close() == false);
+
+    RecordingSink sink;
+    asyncSink.setSink(&sink);
+
+    XCHECK(asyncSink.open({0, iChannels}));
+    XCHECK(sink.iOpenCount == 0);
+}
+
+static void testEveryFrameInOrder()
+{
+    RecordingSink sink;
+
+    SAsyncSink asyncSink;
+    asyncSink.setSink(&sink);
+
+    // Twice to check that it can be opened again.
+    for (int iRun = 0; iRun < 2; iRun++)
+    {
+        XCHECK(asyncSink.open({iSampleRate, iChannels}) == false);
+        XCHECK(asyncSink.isOpen() && sink.isOpen());
+
+        // Less than the ring so nothing is dropped, with pauses so that the writer runs in between.
+        const size_t iFrameCount = static_cast<size_t>(iSampleRate * SAsyncSink::RING_SIZE_IN_SEC / 2);
+
+        for (size_t iFrame = 0; iFrame < iFrameCount; iFrame += iBlockFrameCount)
+        {
+            const size_t iCount = std::min(iBlockFrameCount, iFrameCount - iFrame);
+            const std::vector<float> vFrames = makeFrames(iFrame, iCount);
+
+            XCHECK(asyncSink.write(vFrames.data(), iCount) == false);
+
+            if (iFrame % (iBlockFrameCount * 20) == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(3));
+            }
+        }
+
+        XCHECK(asyncSink.close() == false);
+        XCHECK(asyncSink.isOpen() == false && sink.isOpen() == false);
+
+        XCHECK(asyncSink.getWrittenFrameCount() == iFrameCount);
+        XCHECK(asyncSink.getDroppedFrameCount() == 0);
+
+        // Everything written before close() reached the sink.
+        XCHECK(sink.vSamples == makeFrames(0, iFrameCount));
+    }
+
+    XCHECK(sink.iOpenCount == 2);
+}
+
+// Returns the longest write() call.
+static double testSlowSink(int iWriteDelayInMs)
+{
+    RecordingSink sink(iWriteDelayInMs);
+
+    SAsyncSink asyncSink;
+    asyncSink.setSink(&sink);
+
+    XCHECK(asyncSink.open({iSampleRate, iChannels}) == false);
+
+    // More than the ring at once (much faster than real time).
+    const size_t iFrameCount = static_cast<size_t>(iSampleRate * SAsyncSink::RING_SIZE_IN_SEC * 3);
+
+    double dMaxWriteInMs = 0.0;
+    bool bDropped = false;
+
+    for (size_t iFrame = 0; iFrame < iFrameCount; iFrame += iBlockFrameCount)
+    {
+        const size_t iCount = std::min(iBlockFrameCount, iFrameCount - iFrame);
+        const std::vector<float> vFrames = makeFrames(iFrame, iCount);
+
+        TestTimer timer;
+
+        if (asyncSink.write(vFrames.data(), iCount))
+        {
+            bDropped = true;
+        }
+
+        dMaxWriteInMs = std::max(dMaxWriteInMs, timer.getElapsedInMs());
+    }
+
+    XCHECK(asyncSink.close() == false);
+
+    XCHECK(bDropped);
+    XCHECK(asyncSink.getDroppedFrameCount() > 0);
+    XCHECK(asyncSink.getWrittenFrameCount() + asyncSink.getDroppedFrameCount() == iFrameCount);
+
+    // The kept frames are whole and in order.
+    XCHECK(sink.vSamples.size() == asyncSink.getWrittenFrameCount() * iChannels);
+
+    bool bInOrder = true;
+
+    for (size_t i = 0; i < sink.vSamples.size() / iChannels; i++)
+    {
+        if (sink.vSamples[i * iChannels] != sink.vSamples[i * iChannels + 1]
+            || (i > 0 && sink.vSamples[i * iChannels] <= sink.vSamples[(i - 1) * iChannels]))
+        {
+            bInOrder = false;
+        }
+    }
+
+    XCHECK(bInOrder);
+
+    return dMaxWriteInMs;
+}
+
+static void testSinkError()
+{
+    RecordingSink sink(0, true);
+
+    SAsyncSink asyncSink;
+    asyncSink.setSink(&sink);
+
+    XCHECK(asyncSink.open({iSampleRate, iChannels}) == false);
+
+    const std::vector<float> vFrames = makeFrames(0, iBlockFrameCount);
+    XCHECK(asyncSink.write(vFrames.data(), iBlockFrameCount) == false);
+
+    // The error of the writer thread.
+    XCHECK(asyncSink.close());
+
+    // Not kept after the next open().
+    sink = RecordingSink();
+
+    XCHECK(asyncSink.open({iSampleRate, iChannels}) == false);
+    XCHECK(asyncSink.write(vFrames.data(), iBlockFrameCount) == false);
+    XCHECK(asyncSink.close() == false);
+}
+
+
+int main(int argc, char* argv[])
+{
+    const int iWriteDelayInMs = argc > 1 ? std::atoi(argv[1]) : 50;
+
+    testNotOpened();
+    testEveryFrameInOrder();
+
+    const double dMaxWriteInMs = testSlowSink(iWriteDelayInMs);
+
+    testSinkError();
+
+
+    std::printf("slow sink (%d ms per write): longest write() %.3f ms\n", iWriteDelayInMs, dMaxWriteInMs);
+
+    // write() never waits for the sink.
+    XCHECK(dMaxWriteInMs < iWriteDelayInMs * 0.5);
+
+    return finishTest();
+}
@@ -0,0 +1,271 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Renders a crossfade of two generated tones to a WAV file and checks it sample by sample.
+// Like in SSound, the outgoing and the incoming tracks are decoded in buffers of different sizes,
+// each track applies its own gain ramp and the two are summed (by the submix voice in the player).
+
+// STL
+#include <cmath>
+#include <random>
+#include <memory>
+
+// Custom
+#include "Model/AudioEngine/SCrossfader/scrossfader.h"
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "Model/AudioEngine/SWaveFile/swavefile.h"
+#include "Model/AudioEngine/SWaveFileSink/swavefilesink.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int   iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+static const double dPi = 3.14159265358979323846;
+
+
+// Decodes the whole track in buffers of random size and applies the fade to every buffer
+// (like the streaming loop does before the buffer goes to the ring).
+static std::vector<float> decodeWithFade(const std::filesystem::path& path, const SCrossfader& fade, std::mt19937& random)
+{
+    std::vector<float> vSamples;
+
+    std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(path.wstring(), SF_FLOAT32));
+    XCHECK(pDecoder != nullptr);
+    if (pDecoder == nullptr)
+    {
+        return vSamples;
+    }
+
+    unsigned long long iFrame = 0;
+
+    while (true)
+    {
+        const size_t iFrameCount = 1 + random() % 5000;
+
+        std::vector<float> vBuffer(iFrameCount * iChannels);
+
+        size_t iReadFrameCount = 0;
+        XCHECK(pDecoder->read(reinterpret_cast<unsigned char*>(vBuffer.data()), iFrameCount, iReadFrameCount) == false);
+
+        fade.apply(vBuffer.data(), iReadFrameCount, iChannels, iFrame);
+
+        vSamples.insert(vSamples.end(), vBuffer.begin(), vBuffer.begin() + static_cast<long>(iReadFrameCount * iChannels));
+        iFrame += iReadFrameCount;
+
+        if (iReadFrameCount < iFrameCount)
+        {
+            break;
+        }
+    }
+
+    return vSamples;
+}
+
+static void testTwoTones(S_CROSSFADE_CURVE curve)
+{
+    const std::filesystem::path dir = getTestDirectory(L"SCrossfaderTest");
+
+    const std::filesystem::path outgoingPath = dir / L"outgoing.wav";
+    const std::filesystem::path incomingPath = dir / L"incoming.wav";
+    const std::filesystem::path outputPath   = dir / (curve == CC_LINEAR ? L"linear.wav" : L"equalpower.wav");
+
+    // 3 s of 440 Hz, then a 1.5 s crossfade into 3 s of 660 Hz (float so that the samples are exact).
+    const unsigned long long iTrackFrameCount = iSampleRate * 3;
+    const unsigned long long iFadeFrameCount  = iSampleRate * 3 / 2 + 7;
+    const unsigned long long iFadeStartFrame  = iTrackFrameCount - iFadeFrameCount;
+
+    auto getOutgoingSample = [](unsigned long long iFrame, unsigned short)
+    {
+        return 0.5 * std::sin(2.0 * dPi * 440.0 * iFrame / iSampleRate);
+    };
+    auto getIncomingSample = [](unsigned long long iFrame, unsigned short)
+    {
+        return 0.5 * std::sin(2.0 * dPi * 660.0 * iFrame / iSampleRate);
+    };
+
+    XCHECK(writeWaveFile(outgoingPath, 3, 32, iChannels, iSampleRate, iTrackFrameCount, getOutgoingSample) == false);
+    XCHECK(writeWaveFile(incomingPath, 3, 32, iChannels, iSampleRate, iTrackFrameCount, getIncomingSample) == false);
+
+
+    // Render.
+
+    SCrossfader fadeOut;
+    fadeOut.setup(curve, false, iFadeStartFrame, iFadeFrameCount);
+
+    SCrossfader fadeIn;
+    fadeIn.setup(curve, true, 0, iFadeFrameCount);
+
+    std::mt19937 random(curve == CC_LINEAR ? 11 : 12);
+
+    const std::vector<float> vOutgoing = decodeWithFade(outgoingPath, fadeOut, random);
+    const std::vector<float> vIncoming = decodeWithFade(incomingPath, fadeIn, random);
+
+    XCHECK(vOutgoing.size() == iTrackFrameCount * iChannels);
+    XCHECK(vIncoming.size() == iTrackFrameCount * iChannels);
+    if (vOutgoing.size() != iTrackFrameCount * iChannels || vIncoming.size() != iTrackFrameCount * iChannels)
+    {
+        return;
+    }
+
+    // The incoming track starts at the first frame of the fade.
+    const unsigned long long iOutputFrameCount = iFadeStartFrame + iTrackFrameCount;
+
+    std::vector<float> vMix(iOutputFrameCount * iChannels, 0.0f);
+    for (size_t i = 0; i < vOutgoing.size(); i++)
+    {
+        vMix[i] += vOutgoing[i];
+    }
+    for (size_t i = 0; i < vIncoming.size(); i++)
+    {
+        vMix[iFadeStartFrame * iChannels + i] += vIncoming[i];
+    }
+
+    {
+        SWaveFileSink sink(outputPath.wstring());
+        XCHECK(sink.open({iSampleRate, iChannels}) == false);
+        XCHECK(sink.write(vMix.data(), iOutputFrameCount) == false);
+        XCHECK(sink.getWrittenFrameCount() == iOutputFrameCount);
+        XCHECK(sink.close() == false);
+    }
+
+
+    // Check the file.
+
+    SWaveFile output;
+    XCHECK(output.open(outputPath.wstring()) == false);
+    XCHECK(output.getFormat().iFormatTag == WFT_IEEE_FLOAT);
+    XCHECK(output.getFrameCount() == iOutputFrameCount);
+    if (output.getFrameCount() != iOutputFrameCount)
+    {
+        return;
+    }
+
+    std::vector<float> vRendered(iOutputFrameCount * iChannels);
+    std::memcpy(vRendered.data(), output.getData(), vRendered.size() * sizeof(float));
+
+
+    double dMaxError = 0.0;
+    double dMaxGainError = 0.0;
+
+    for (unsigned long long i = 0; i < iOutputFrameCount; i++)
+    {
+        double dOutgoingGain = 0.0;
+        double dIncomingGain = 0.0;
+
+        if (i < iFadeStartFrame)
+        {
+            dOutgoingGain = 1.0;
+        }
+        else if (i - iFadeStartFrame < iFadeFrameCount)
+        {
+            const double dProgress = static_cast<double>(i - iFadeStartFrame) / iFadeFrameCount;
+
+            dIncomingGain = (curve == CC_LINEAR) ? dProgress : std::sin(dProgress * dPi / 2.0);
+            dOutgoingGain = (curve == CC_LINEAR) ? 1.0 - dProgress : std::cos(dProgress * dPi / 2.0);
+
+            // Linear keeps the amplitude, equal power keeps the power of uncorrelated tracks.
+            const double dSum = (curve == CC_LINEAR) ? dOutgoingGain + dIncomingGain
+                                                     : dOutgoingGain * dOutgoingGain + dIncomingGain * dIncomingGain;
+            const double dRenderedSum = (curve == CC_LINEAR) ? fadeOut.getGain(i) + fadeIn.getGain(i - iFadeStartFrame)
+                                                             : fadeOut.getGain(i) * fadeOut.getGain(i) + fadeIn.getGain(i - iFadeStartFrame) * fadeIn.getGain(i - iFadeStartFrame);
+
+            dMaxGainError = std::max(dMaxGainError, std::fabs(dSum - 1.0));
+            dMaxGainError = std::max(dMaxGainError, std::fabs(dRenderedSum - 1.0));
+        }
+        else
+        {
+            dIncomingGain = 1.0;
+        }
+
+        double dExpected = 0.0;
+        if (i < iTrackFrameCount)
+        {
+            dExpected += dOutgoingGain * getOutgoingSample(i, 0);
+        }
+        if (i >= iFadeStartFrame)
+        {
+            dExpected += dIncomingGain * getIncomingSample(i - iFadeStartFrame, 0);
+        }
+
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            dMaxError = std::max(dMaxError, std::fabs(vRendered[i * iChannels + c] - dExpected));
+        }
+    }
+
+    XCHECK(dMaxError < 0.00001);
+    XCHECK(dMaxGainError < 0.00001);
+
+
+    // Sample accurate edges: the outgoing track is untouched before the fade and silent after it,
+    // the incoming one is silent at the first frame of the fade and untouched after it.
+
+    XCHECK(vOutgoing[(iFadeStartFrame - 1) * iChannels] == static_cast<float>(getOutgoingSample(iFadeStartFrame - 1, 0)));
+    XCHECK(vIncoming[0] == 0.0f && vIncoming[1] == 0.0f);
+    XCHECK(vIncoming[iFadeFrameCount * iChannels] == static_cast<float>(getIncomingSample(iFadeFrameCount, 0)));
+    XCHECK(fadeOut.getGain(iFadeStartFrame) == 1.0f);
+    XCHECK(fadeOut.getGain(iTrackFrameCount) == 0.0f);
+
+
+    // SCrossfader::mix() gives the same crossfade (from the fade start).
+
+    const size_t iMixFrameCount = static_cast<size_t>(iFadeFrameCount + 100);
+
+    std::vector<float> vOutgoingTail(iMixFrameCount * iChannels, 0.0f);
+    std::vector<float> vIncomingHead(iMixFrameCount * iChannels);
+    for (size_t i = 0; i < iMixFrameCount; i++)
+    {
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            if (iFadeStartFrame + i < iTrackFrameCount)
+            {
+                vOutgoingTail[i * iChannels + c] = static_cast<float>(getOutgoingSample(iFadeStartFrame + i, c));
+            }
+
+            vIncomingHead[i * iChannels + c] = static_cast<float>(getIncomingSample(i, c));
+        }
+    }
+
+    std::vector<float> vMixed(iMixFrameCount * iChannels);
+
+    // In two parts so that 'iFirstFrame' is used.
+    const size_t iFirstPart = 1234;
+    SCrossfader::mix(vOutgoingTail.data(), vIncomingHead.data(), vMixed.data(), iFirstPart, iChannels, curve, 0, iFadeFrameCount);
+    SCrossfader::mix(vOutgoingTail.data() + iFirstPart * iChannels, vIncomingHead.data() + iFirstPart * iChannels,
+                     vMixed.data() + iFirstPart * iChannels, iMixFrameCount - iFirstPart, iChannels, curve, iFirstPart, iFadeFrameCount);
+
+    double dMaxMixError = 0.0;
+    for (size_t i = 0; i < vMixed.size(); i++)
+    {
+        dMaxMixError = std::max(dMaxMixError, static_cast<double>(std::fabs(vMixed[i] - vRendered[iFadeStartFrame * iChannels + i])));
+    }
+
+    XCHECK(dMaxMixError < 0.00001);
+}
+
+static void testCurveGain()
+{
+    XCHECK(SCrossfader::getCurveGain(CC_LINEAR, 0.0) == 0.0f);
+    XCHECK(SCrossfader::getCurveGain(CC_LINEAR, 1.0) == 1.0f);
+    XCHECK(SCrossfader::getCurveGain(CC_EQUAL_POWER, 0.0) == 0.0f);
+    XCHECK(std::fabs(SCrossfader::getCurveGain(CC_EQUAL_POWER, 1.0) - 1.0f) < 0.000001f);
+    XCHECK(std::fabs(SCrossfader::getCurveGain(CC_EQUAL_POWER, 0.5) - std::sqrt(0.5f)) < 0.000001f);
+
+    SCrossfader disabled;
+    XCHECK(disabled.isEnabled() == false);
+    XCHECK(disabled.getGain(12345) == 1.0f);
+}
+
+int main()
+{
+    testCurveGain();
+    testTwoTones(CC_LINEAR);
+    testTwoTones(CC_EQUAL_POWER);
+
+    return finishTest();
+}
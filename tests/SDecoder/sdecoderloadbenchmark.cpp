@@ -0,0 +1,191 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Load time and peak memory of decoding a whole file into memory (like SSound::loadFileIntoMemory()),
+// every mode runs in its own process so that the peak memory is not shared.
+//
+// Modes:
+//   byte - every decoded buffer is appended one byte at a time (the old readWaveData()/loadFileIntoMemory()),
+//   bulk - every decoded buffer is appended with one copy,
+//   reserve - the decoded size is reserved from the stream info and the decoder writes right into the vector
+//             (the current loadFileIntoMemory()).
+//
+// Usage: SDecoderLoadBenchmark [decoded size in MB (default 500)] [mode (default - run all modes)]
+
+// STL
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <memory>
+
+// Custom
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int iSampleRate = 44100;
+static const unsigned short iChannels = 2;
+
+
+static std::filesystem::path getAudioPath()
+{
+    std::error_code ec;
+    return std::filesystem::temp_directory_path(ec) / L"XanderTests" / L"SDecoderLoadBenchmark" / L"large.wav";
+}
+
+static int runMode(const std::string& sMode)
+{
+    std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(getAudioPath().wstring(), SF_INT16));
+    if (pDecoder == nullptr)
+    {
+        std::printf("failed to open the file\n");
+        return 1;
+    }
+
+    const size_t iBlockAlign = pDecoder->getOutputBlockAlign();
+    const size_t iChunkFrameCount = iSampleRate / 10;
+
+    TestTimer timer;
+
+    std::vector<unsigned char> vAudioData;
+
+    // The decoder's own buffer (like a locked Media Foundation buffer).
+    std::vector<unsigned char> vDecodedBuffer(iChunkFrameCount * iBlockAlign);
+
+    // While the vector grows the old and the new buffers exist at the same time.
+    size_t iPeakVectorSize = 0;
+
+    if (sMode == "reserve")
+    {
+        // +1 frame to see the end of the stream without growing the vector.
+        vAudioData.reserve((static_cast<size_t>(pDecoder->getInfo().iFrameCount) + 1) * iBlockAlign);
+
+        iPeakVectorSize = vAudioData.capacity();
+
+        while (true)
+        {
+            // 100 ms (or what's left of the reserved space).
+            size_t iFrameCount = iChunkFrameCount;
+
+            const size_t iFreeFrameCount = (vAudioData.capacity() - vAudioData.size()) / iBlockAlign;
+            if (iFreeFrameCount > 0 && iFreeFrameCount < iFrameCount)
+            {
+                iFrameCount = iFreeFrameCount;
+            }
+
+            const size_t iOldSize = vAudioData.size();
+            vAudioData.resize(iOldSize + iFrameCount * iBlockAlign);
+
+            size_t iReadFrameCount = 0;
+            if (pDecoder->read(vAudioData.data() + iOldSize, iFrameCount, iReadFrameCount))
+            {
+                std::printf("failed to decode the file\n");
+                return 1;
+            }
+
+            vAudioData.resize(iOldSize + iReadFrameCount * iBlockAlign);
+
+            if (iReadFrameCount < iFrameCount)
+            {
+                break;
+            }
+        }
+    }
+
+    while (sMode != "reserve")
+    {
+        const size_t iOldCapacity = vAudioData.capacity();
+
+        size_t iReadFrameCount = 0;
+        if (pDecoder->read(vDecodedBuffer.data(), iChunkFrameCount, iReadFrameCount))
+        {
+            std::printf("failed to decode the file\n");
+            return 1;
+        }
+
+        const size_t iReadSize = iReadFrameCount * iBlockAlign;
+
+        if (sMode == "byte")
+        {
+            for (size_t i = 0; i < iReadSize; i++)
+            {
+                vAudioData.push_back(vDecodedBuffer[i]);
+            }
+        }
+        else
+        {
+            vAudioData.insert(vAudioData.end(), vDecodedBuffer.begin(), vDecodedBuffer.begin() + static_cast<long>(iReadSize));
+        }
+
+        if (vAudioData.capacity() != iOldCapacity && iOldCapacity + vAudioData.capacity() > iPeakVectorSize)
+        {
+            iPeakVectorSize = iOldCapacity + vAudioData.capacity();
+        }
+
+        if (iReadFrameCount < iChunkFrameCount)
+        {
+            break;
+        }
+    }
+
+    const double dTimeInMs = timer.getElapsedInMs();
+
+    std::printf("%-8s %10.1f ms %10zu KB peak RSS %10zu KB peak vector size %10zu KB decoded\n", sMode.c_str(), dTimeInMs,
+                getPeakMemoryInKB(), iPeakVectorSize / 1024, vAudioData.size() / 1024);
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2)
+    {
+        return runMode(argv[2]);
+    }
+
+
+    const double dSizeInMB = argc > 1 ? std::atof(argv[1]) : 500.0;
+    const unsigned long long iFrameCount = static_cast<unsigned long long>(dSizeInMB * 1024 * 1024 / (iChannels * 2));
+
+    const std::filesystem::path dir = getTestDirectory(L"SDecoderLoadBenchmark");
+
+    std::printf("generating %.0f MB 16-bit stereo WAV...\n", dSizeInMB);
+
+    if (writeWaveFile(getAudioPath(), 1, 16, iChannels, iSampleRate, iFrameCount,
+                      [](unsigned long long iFrame, unsigned short iChannel)
+                      {
+                          return 0.5 * std::sin(iFrame * 0.01 + iChannel);
+                      }))
+    {
+        std::printf("failed to write the file\n");
+        return 1;
+    }
+
+    std::fflush(stdout);
+
+
+    // The mapped file is counted in the peak RSS of every mode too.
+
+    const char* vModes[] = {"byte", "bulk", "reserve"};
+
+    int iResult = 0;
+
+    for (const char* pMode : vModes)
+    {
+        const std::string sCommand = "\"" + std::string(argv[0]) + "\" " + std::to_string(dSizeInMB) + " " + pMode;
+
+        if (std::system(sCommand.c_str()) != 0)
+        {
+            iResult = 1;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return iResult;
+}
@@ -0,0 +1,93 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Processing cost (ns per sample) of every native effect for mono, stereo and 5.1 blocks.
+//
+// Usage: SEffectProcessorBenchmark [seconds of audio per case (default 60)]
+
+// STL
+#include <memory>
+#include <random>
+#include <cstdlib>
+
+// Custom
+#include "Model/AudioEngine/SEffectProcessor/seffectprocessor.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned long iSampleRate = 44100;
+
+// Same as SOfflineRenderer.
+static const size_t iBlockFrameCount = 1024;
+
+
+int main(int argc, char* argv[])
+{
+    const double dLengthInSec = argc > 1 ? std::atof(argv[1]) : 60.0;
+    const size_t iBlockCount = static_cast<size_t>(dLengthInSec * iSampleRate / iBlockFrameCount);
+
+    FXEQ_PARAMETERS eqParams = {FXEQ_DEFAULT_FREQUENCY_CENTER_0, 2.0f, FXEQ_DEFAULT_BANDWIDTH,
+                                FXEQ_DEFAULT_FREQUENCY_CENTER_1, 0.5f, FXEQ_DEFAULT_BANDWIDTH,
+                                FXEQ_DEFAULT_FREQUENCY_CENTER_2, 1.5f, FXEQ_DEFAULT_BANDWIDTH,
+                                FXEQ_DEFAULT_FREQUENCY_CENTER_3, 0.8f, FXEQ_DEFAULT_BANDWIDTH};
+    FXREVERB_PARAMETERS reverbParams = {FXREVERB_DEFAULT_DIFFUSION, FXREVERB_DEFAULT_ROOMSIZE};
+    FXECHO_PARAMETERS echoParams = {FXECHO_DEFAULT_WETDRYMIX, FXECHO_DEFAULT_FEEDBACK, FXECHO_DEFAULT_DELAY};
+
+    struct Effect
+    {
+        S_EFFECT_TYPE type;
+        const void*   pParameters;
+        const char*   pName;
+    };
+
+    const Effect vEffects[] = {{ET_EQ, &eqParams, "eq"}, {ET_REVERB, &reverbParams, "reverb"}, {ET_ECHO, &echoParams, "echo"}};
+
+    const unsigned short vChannels[] = {1, 2, 6};
+
+
+    std::printf("%-8s %8s %14s %12s\n", "effect", "channels", "ns/sample", "realtime x");
+
+    for (const Effect& effect : vEffects)
+    {
+        for (unsigned short iChannels : vChannels)
+        {
+            std::unique_ptr<SEffectProcessor> pEffect(SEffectProcessor::create(effect.type));
+            pEffect->setup(iSampleRate, iChannels);
+            pEffect->setParameters(effect.pParameters);
+
+            std::mt19937 random(1);
+            std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+
+            std::vector<float> vInput(iBlockFrameCount * iChannels);
+            for (float& fSample : vInput)
+            {
+                fSample = distribution(random);
+            }
+
+            std::vector<float> vBlock(vInput.size());
+
+            TestTimer timer;
+
+            for (size_t i = 0; i < iBlockCount; i++)
+            {
+                // The copy is a small part of the cost and keeps the input from decaying to denormals.
+                std::copy(vInput.begin(), vInput.end(), vBlock.begin());
+
+                pEffect->process(vBlock.data(), iBlockFrameCount);
+            }
+
+            const double dTimeInSec = timer.getElapsedInMs() / 1000.0;
+
+            const double dSampleCount = static_cast<double>(iBlockCount) * iBlockFrameCount * iChannels;
+
+            std::printf("%-8s %8u %14.2f %12.0f%s\n", effect.pName, iChannels, dTimeInSec * 1000000000.0 / dSampleCount,
+                        iBlockCount * iBlockFrameCount / static_cast<double>(iSampleRate) / dTimeInSec, vBlock[0] == 12345.0f ? " " : "");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,354 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Output of the native effects against references:
+// the EQ against a double precision biquad cascade (Audio EQ Cookbook), the echo against its exact impulse response,
+// the reverb against its decay time. All effects should give the same output no matter how the input is split into blocks.
+
+// STL
+#include <cmath>
+#include <random>
+#include <memory>
+#include <algorithm>
+
+// Custom
+#include "Model/AudioEngine/SEffectProcessor/seffectprocessor.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned long iSampleRate = 44100;
+
+static const double dPi = 3.14159265358979323846;
+
+
+static std::vector<float> makeNoise(size_t iSampleCount, unsigned int iSeed)
+{
+    std::mt19937 random(iSeed);
+    std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+
+    std::vector<float> vSamples(iSampleCount);
+    for (float& fSample : vSamples)
+    {
+        fSample = distribution(random);
+    }
+
+    return vSamples;
+}
+
+static std::unique_ptr<SEffectProcessor> createEffect(S_EFFECT_TYPE type, unsigned short iChannels, const void* pParameters)
+{
+    std::unique_ptr<SEffectProcessor> pEffect(SEffectProcessor::create(type));
+
+    pEffect->setup(iSampleRate, iChannels);
+    pEffect->setParameters(pParameters);
+
+    return pEffect;
+}
+
+// Processes the samples in blocks of random size.
+static void processInBlocks(SEffectProcessor* pEffect, std::vector<float>& vSamples, unsigned short iChannels, unsigned int iSeed)
+{
+    std::mt19937 random(iSeed);
+
+    const size_t iFrameCount = vSamples.size() / iChannels;
+
+    size_t iFrame = 0;
+    while (iFrame < iFrameCount)
+    {
+        const size_t iBlockFrameCount = std::min<size_t>(1 + random() % 2000, iFrameCount - iFrame);
+
+        pEffect->process(vSamples.data() + iFrame * iChannels, iBlockFrameCount);
+
+        iFrame += iBlockFrameCount;
+    }
+}
+
+static void checkBlockIndependence(S_EFFECT_TYPE type, unsigned short iChannels, const void* pParameters)
+{
+    const std::vector<float> vInput = makeNoise(iSampleRate * iChannels, 3);
+
+    std::vector<float> vWhole = vInput;
+    createEffect(type, iChannels, pParameters)->process(vWhole.data(), vWhole.size() / iChannels);
+
+    std::vector<float> vBlocks = vInput;
+    processInBlocks(createEffect(type, iChannels, pParameters).get(), vBlocks, iChannels, 4);
+
+    XCHECK(vWhole == vBlocks);
+
+
+    // reset() gives the same output as a new instance.
+
+    std::unique_ptr<SEffectProcessor> pEffect = createEffect(type, iChannels, pParameters);
+
+    std::vector<float> vFirst = vInput;
+    pEffect->process(vFirst.data(), vFirst.size() / iChannels);
+
+    pEffect->reset();
+
+    std::vector<float> vSecond = vInput;
+    pEffect->process(vSecond.data(), vSecond.size() / iChannels);
+
+    XCHECK(vFirst == vSecond);
+}
+
+
+// ---------------------------------------------------------------------
+// EQ.
+// ---------------------------------------------------------------------
+
+static std::vector<double> filterReference(const std::vector<float>& vInput, unsigned short iChannels, const FXEQ_PARAMETERS& params)
+{
+    const double vBands[4][3] = {{params.FrequencyCenter0, params.Gain0, params.Bandwidth0},
+                                 {params.FrequencyCenter1, params.Gain1, params.Bandwidth1},
+                                 {params.FrequencyCenter2, params.Gain2, params.Bandwidth2},
+                                 {params.FrequencyCenter3, params.Gain3, params.Bandwidth3}};
+
+    std::vector<double> vOutput(vInput.begin(), vInput.end());
+
+    for (const auto& band : vBands)
+    {
+        const double dA     = std::sqrt(band[1]);
+        const double dW0    = 2.0 * dPi * band[0] / iSampleRate;
+        const double dAlpha = std::sin(dW0) * std::sinh(std::log(2.0) / 2.0 * band[2] * dW0 / std::sin(dW0));
+
+        const double dA0 = 1.0 + dAlpha / dA;
+        const double dB0 = (1.0 + dAlpha * dA) / dA0;
+        const double dB1 = -2.0 * std::cos(dW0) / dA0;
+        const double dB2 = (1.0 - dAlpha * dA) / dA0;
+        const double dA1 = dB1;
+        const double dA2 = (1.0 - dAlpha / dA) / dA0;
+
+        // Direct form I.
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            double dX1 = 0.0, dX2 = 0.0, dY1 = 0.0, dY2 = 0.0;
+
+            for (size_t i = c; i < vOutput.size(); i += iChannels)
+            {
+                const double dX = vOutput[i];
+                const double dY = dB0 * dX + dB1 * dX1 + dB2 * dX2 - dA1 * dY1 - dA2 * dY2;
+
+                dX2 = dX1;
+                dX1 = dX;
+                dY2 = dY1;
+                dY1 = dY;
+
+                vOutput[i] = dY;
+            }
+        }
+    }
+
+    return vOutput;
+}
+
+static void testEQ()
+{
+    const FXEQ_PARAMETERS params = {80.0f,   3.0f,  1.5f,
+                                    700.0f,  0.3f,  0.5f,
+                                    3000.0f, 1.8f,  1.0f,
+                                    12000.0f, 0.6f, 2.0f};
+
+    // 6 channels: one full SSE group and a partial one.
+    for (unsigned short iChannels : {1, 2, 6})
+    {
+        const std::vector<float> vInput = makeNoise(iSampleRate * iChannels, 1);
+
+        std::vector<float> vOutput = vInput;
+        processInBlocks(createEffect(ET_EQ, iChannels, &params).get(), vOutput, iChannels, 2);
+
+        const std::vector<double> vReference = filterReference(vInput, iChannels, params);
+
+        double dMaxError = 0.0;
+        for (size_t i = 0; i < vOutput.size(); i++)
+        {
+            dMaxError = std::max(dMaxError, std::fabs(vOutput[i] - vReference[i]));
+        }
+
+        XCHECK(dMaxError < 0.0005);
+
+        checkBlockIndependence(ET_EQ, iChannels, &params);
+    }
+
+
+    // Unity gains pass the audio through.
+
+    const FXEQ_PARAMETERS flat = {FXEQ_DEFAULT_FREQUENCY_CENTER_0, 1.0f, 1.0f, FXEQ_DEFAULT_FREQUENCY_CENTER_1, 1.0f, 1.0f,
+                                  FXEQ_DEFAULT_FREQUENCY_CENTER_2, 1.0f, 1.0f, FXEQ_DEFAULT_FREQUENCY_CENTER_3, 1.0f, 1.0f};
+
+    const std::vector<float> vInput = makeNoise(iSampleRate * 2, 5);
+
+    std::vector<float> vOutput = vInput;
+    createEffect(ET_EQ, 2, &flat)->process(vOutput.data(), vOutput.size() / 2);
+
+    double dMaxError = 0.0;
+    for (size_t i = 0; i < vOutput.size(); i++)
+    {
+        dMaxError = std::max(dMaxError, static_cast<double>(std::fabs(vOutput[i] - vInput[i])));
+    }
+
+    XCHECK(dMaxError < 0.00001);
+
+
+    // A sine at the center of a band is scaled by the band's gain.
+
+    const FXEQ_PARAMETERS boost = {1000.0f, 4.0f, 0.5f, 20.0f, 1.0f, 1.0f, 5000.0f, 1.0f, 1.0f, 15000.0f, 1.0f, 1.0f};
+
+    std::vector<float> vSine(iSampleRate);
+    for (size_t i = 0; i < vSine.size(); i++)
+    {
+        vSine[i] = 0.1f * static_cast<float>(std::sin(2.0 * dPi * 1000.0 * i / iSampleRate));
+    }
+
+    createEffect(ET_EQ, 1, &boost)->process(vSine.data(), vSine.size());
+
+    // After the filter settled.
+    const float fPeak = *std::max_element(vSine.begin() + iSampleRate / 2, vSine.end());
+    XCHECK(std::fabs(fPeak - 0.4f) < 0.004f);
+}
+
+
+// ---------------------------------------------------------------------
+// Echo.
+// ---------------------------------------------------------------------
+
+static void testEcho()
+{
+    const FXECHO_PARAMETERS params = {0.4f, 0.5f, 100.0f};
+
+    const size_t iDelayInFrames = static_cast<size_t>(100.0 / 1000.0 * iSampleRate);
+
+    const unsigned short iChannels = 2;
+
+    // Impulse in the left channel, a negative one in the right channel a bit later.
+    std::vector<float> vSamples(iSampleRate * iChannels, 0.0f);
+    vSamples[0] = 1.0f;
+    vSamples[10 * iChannels + 1] = -1.0f;
+
+    processInBlocks(createEffect(ET_ECHO, iChannels, &params).get(), vSamples, iChannels, 6);
+
+    std::vector<float> vExpected(vSamples.size(), 0.0f);
+
+    float fGain = 0.4f;
+    vExpected[0] = 0.6f;
+    vExpected[10 * iChannels + 1] = -0.6f;
+
+    for (size_t iEcho = 1; iEcho * iDelayInFrames + 10 < iSampleRate; iEcho++)
+    {
+        vExpected[iEcho * iDelayInFrames * iChannels] = fGain;
+        vExpected[(iEcho * iDelayInFrames + 10) * iChannels + 1] = -fGain;
+
+        fGain *= 0.5f;
+    }
+
+    double dMaxError = 0.0;
+    for (size_t i = 0; i < vSamples.size(); i++)
+    {
+        dMaxError = std::max(dMaxError, static_cast<double>(std::fabs(vSamples[i] - vExpected[i])));
+    }
+
+    XCHECK(dMaxError < 0.000001);
+
+    checkBlockIndependence(ET_ECHO, 2, &params);
+    checkBlockIndependence(ET_ECHO, 6, &params);
+}
+
+
+// ---------------------------------------------------------------------
+// Reverb.
+// ---------------------------------------------------------------------
+
+// Time (in sec) after which the level (in 10 ms windows) stays 60 dB below the loudest window.
+static double getDecayTimeInSec(const std::vector<float>& vSamples, unsigned short iChannels)
+{
+    const size_t iWindowFrameCount = iSampleRate / 100;
+
+    std::vector<double> vEnergy;
+    for (size_t i = 0; i + iWindowFrameCount * iChannels <= vSamples.size(); i += iWindowFrameCount * iChannels)
+    {
+        double dEnergy = 0.0;
+        for (size_t j = 0; j < iWindowFrameCount * iChannels; j++)
+        {
+            dEnergy += static_cast<double>(vSamples[i + j]) * vSamples[i + j];
+        }
+
+        vEnergy.push_back(dEnergy);
+    }
+
+    const double dMaxEnergy = *std::max_element(vEnergy.begin(), vEnergy.end());
+
+    size_t iLastLoudWindow = 0;
+    for (size_t i = 0; i < vEnergy.size(); i++)
+    {
+        if (vEnergy[i] > dMaxEnergy * 0.000001)
+        {
+            iLastLoudWindow = i;
+        }
+    }
+
+    return (iLastLoudWindow + 1) * 0.01;
+}
+
+static void testReverb()
+{
+    const unsigned short iChannels = 2;
+
+    double dPreviousDecayTime = 0.0;
+
+    for (float fRoomSize : {0.1f, 0.5f, 1.0f})
+    {
+        const FXREVERB_PARAMETERS params = {FXREVERB_DEFAULT_DIFFUSION, fRoomSize};
+
+        std::vector<float> vSamples(iSampleRate * 6 * iChannels, 0.0f);
+        vSamples[0] = 1.0f;
+        vSamples[1] = 1.0f;
+
+        processInBlocks(createEffect(ET_REVERB, iChannels, &params).get(), vSamples, iChannels, 7);
+
+        // 100% wet: nothing comes out before the shortest delay line.
+        XCHECK(vSamples[0] == 0.0f && vSamples[1] == 0.0f);
+
+        bool bFinite = true;
+        for (float fSample : vSamples)
+        {
+            bFinite = bFinite && std::isfinite(fSample) && std::fabs(fSample) < 1.0f;
+        }
+
+        XCHECK(bFinite);
+
+        // -60 dB after the reverb time of the room (0.25 - 4 sec), the damping makes it a bit shorter.
+        const double dReverbTimeInSec = 0.25 + 3.75 * fRoomSize;
+        const double dDecayTimeInSec = getDecayTimeInSec(vSamples, iChannels);
+
+        std::printf("room size %.1f: reverb time %.2f sec, measured -60 dB after %.2f sec\n", fRoomSize, dReverbTimeInSec, dDecayTimeInSec);
+
+        XCHECK(dDecayTimeInSec > dReverbTimeInSec * 0.7 && dDecayTimeInSec < dReverbTimeInSec * 1.1);
+        XCHECK(dDecayTimeInSec > dPreviousDecayTime);
+
+        dPreviousDecayTime = dDecayTimeInSec;
+
+        checkBlockIndependence(ET_REVERB, iChannels, &params);
+    }
+
+
+    // Silence stays silent.
+
+    const FXREVERB_PARAMETERS params = {FXREVERB_DEFAULT_DIFFUSION, FXREVERB_DEFAULT_ROOMSIZE};
+
+    std::vector<float> vSilence(iSampleRate * iChannels, 0.0f);
+    createEffect(ET_REVERB, iChannels, &params)->process(vSilence.data(), iSampleRate);
+
+    XCHECK(*std::max_element(vSilence.begin(), vSilence.end()) == 0.0f);
+}
+
+int main()
+{
+    testEQ();
+    testEcho();
+    testReverb();
+
+    return finishTest();
+}
@@ -0,0 +1,112 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// The forward transform of random complex input is compared with a naive DFT (in double)
+// and the inverse of it (divided by N) with the input, for every size from 4 to 4096.
+
+// STL
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+// Custom
+#include "Model/AudioEngine/SFFT/sfft.h"
+#include "TestUtils/testutils.h"
+
+
+static void naiveDFT(const std::vector<float>& vReal, const std::vector<float>& vImag, std::vector<double>& vOutReal, std::vector<double>& vOutImag)
+{
+    const size_t iSize = vReal.size();
+    const double dTwoPi = 2.0 * 3.14159265358979323846;
+
+    vOutReal.assign(iSize, 0.0);
+    vOutImag.assign(iSize, 0.0);
+
+    for (size_t k = 0; k < iSize; k++)
+    {
+        for (size_t n = 0; n < iSize; n++)
+        {
+            // (k * n) mod N keeps the angle small.
+            const double dAngle = -dTwoPi * static_cast<double>((k * n) % iSize) / static_cast<double>(iSize);
+
+            vOutReal[k] += vReal[n] * std::cos(dAngle) - vImag[n] * std::sin(dAngle);
+            vOutImag[k] += vReal[n] * std::sin(dAngle) + vImag[n] * std::cos(dAngle);
+        }
+    }
+}
+
+
+int main()
+{
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    SFFT fft;
+
+    XCHECK(fft.setup(0));
+    XCHECK(fft.setup(2));
+    XCHECK(fft.setup(1000));
+
+    for (size_t iSize = 4; iSize <= 4096; iSize *= 2)
+    {
+        XCHECK(fft.setup(iSize) == false);
+        XCHECK(fft.getSize() == iSize);
+
+        std::vector<float> vInputReal(iSize);
+        std::vector<float> vInputImag(iSize);
+
+        for (size_t i = 0; i < iSize; i++)
+        {
+            vInputReal[i] = distribution(random);
+            vInputImag[i] = distribution(random);
+        }
+
+        std::vector<double> vExpectedReal;
+        std::vector<double> vExpectedImag;
+        naiveDFT(vInputReal, vInputImag, vExpectedReal, vExpectedImag);
+
+
+        std::vector<float> vReal = vInputReal;
+        std::vector<float> vImag = vInputImag;
+
+        fft.forward(vReal.data(), vImag.data());
+
+        // The error of the float butterflies grows with log2(N), the values grow with sqrt(N).
+        const double dForwardErrorLimit = 1e-5 * std::sqrt(static_cast<double>(iSize)) * std::log2(static_cast<double>(iSize));
+
+        double dMaxForwardError = 0.0;
+
+        for (size_t k = 0; k < iSize; k++)
+        {
+            dMaxForwardError = std::max(dMaxForwardError, std::abs(vReal[k] - vExpectedReal[k]));
+            dMaxForwardError = std::max(dMaxForwardError, std::abs(vImag[k] - vExpectedImag[k]));
+        }
+
+        XCHECK(dMaxForwardError < dForwardErrorLimit);
+
+
+        fft.inverse(vReal.data(), vImag.data());
+
+        double dMaxRoundTripError = 0.0;
+
+        for (size_t i = 0; i < iSize; i++)
+        {
+            dMaxRoundTripError = std::max(dMaxRoundTripError, std::abs(vReal[i] / static_cast<double>(iSize) - vInputReal[i]));
+            dMaxRoundTripError = std::max(dMaxRoundTripError, std::abs(vImag[i] / static_cast<double>(iSize) - vInputImag[i]));
+        }
+
+        XCHECK(dMaxRoundTripError < 1e-5);
+
+        if (dMaxForwardError >= dForwardErrorLimit || dMaxRoundTripError >= 1e-5)
+        {
+            std::printf("size %zu: forward error %g, round trip error %g\n", iSize, dMaxForwardError, dMaxRoundTripError);
+        }
+    }
+
+    return finishTest();
+}
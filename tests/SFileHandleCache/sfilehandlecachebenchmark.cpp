@@ -0,0 +1,245 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// File handle and memory report of a listening session with and without SFileHandleCache.
+// Every track is opened by the decoders as in the player: the prefetch (kept until the track ends),
+// the graph (whole file), sometimes "previous track" and at the end the export of the last tracks.
+// Reports the opens that mapped a file, the time per open, the opened file handles and the mapped memory.
+//
+// Usage: SFileHandleCacheBenchmark [track count (default 40)] [track length in sec (default 30)]
+
+// STL
+#include <cmath>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+// Custom
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "Model/AudioEngine/SFileHandleCache/sfilehandlecache.h"
+#include "Model/globals.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int   iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+
+// Opened file handles of this process.
+static size_t getOpenedHandleCount()
+{
+#if defined(_WIN32)
+    DWORD iHandleCount = 0;
+    GetProcessHandleCount(GetCurrentProcess(), &iHandleCount);
+
+    return iHandleCount;
+#else
+    std::error_code ec;
+
+    size_t iCount = 0;
+
+    for (std::filesystem::directory_iterator it("/proc/self/fd", ec); it != std::filesystem::directory_iterator(); it.increment(ec))
+    {
+        if (ec)
+        {
+            break;
+        }
+
+        iCount++;
+    }
+
+    return iCount;
+#endif
+}
+
+
+struct SessionResult
+{
+    size_t iOpenCount = 0;
+    double dOpenTimeInMs = 0.0;
+    size_t iMaxExtraHandleCount = 0;
+    unsigned long long iMaxMappedSizeInBytes = 0;
+    SFileHandleCacheStats stats = {0, 0, 0, 0};
+};
+
+static SessionResult runSession(const std::vector<std::filesystem::path>& vTracks, SFileHandleCache* pFileCache)
+{
+    SessionResult result;
+
+    const size_t iBaseHandleCount = getOpenedHandleCount();
+
+    std::vector<unsigned char> vBuffer;
+
+    auto open = [&](size_t iTrack) -> std::unique_ptr<SDecoder>
+    {
+        TestTimer timer;
+        std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(vTracks[iTrack].wstring(), SF_INT16, pFileCache));
+        result.dOpenTimeInMs += timer.getElapsedInMs();
+        result.iOpenCount++;
+
+        return pDecoder;
+    };
+
+    // Without the cache each used decoder has its own mapping,
+    // with the cache the used files are the most recently used ones so they are in the cache.
+    auto measure = [&](std::initializer_list<const SDecoder*> vUsed)
+    {
+        result.iMaxExtraHandleCount = std::max(result.iMaxExtraHandleCount, getOpenedHandleCount() - iBaseHandleCount);
+
+        unsigned long long iMappedSizeInBytes = 0;
+
+        if (pFileCache)
+        {
+            iMappedSizeInBytes = pFileCache->getStats().iCachedSizeInBytes;
+        }
+        else
+        {
+            for (const SDecoder* pDecoder : vUsed)
+            {
+                if (pDecoder)
+                {
+                    iMappedSizeInBytes += pDecoder->getInfo().iFrameCount * pDecoder->getOutputBlockAlign();
+                }
+            }
+        }
+
+        result.iMaxMappedSizeInBytes = std::max(result.iMaxMappedSizeInBytes, iMappedSizeInBytes);
+    };
+
+    auto decodeAll = [&](SDecoder* pDecoder)
+    {
+        const size_t iChunkFrameCount = iSampleRate / 7;
+        vBuffer.resize(iChunkFrameCount * pDecoder->getOutputBlockAlign());
+
+        size_t iReadFrameCount = iChunkFrameCount;
+        while (iReadFrameCount == iChunkFrameCount && pDecoder->read(vBuffer.data(), iChunkFrameCount, iReadFrameCount) == false)
+        {
+        }
+    };
+
+
+    std::unique_ptr<SDecoder> pPlaying = open(0);
+    std::vector<size_t> vHistory = {0};
+
+    size_t iTrack = 0;
+
+    while (iTrack + 1 < vTracks.size())
+    {
+        // Graph of the played track.
+        std::unique_ptr<SDecoder> pGraph = open(iTrack);
+        decodeAll(pGraph.get());
+
+        // Prefetch of the next track (then it's played).
+        std::unique_ptr<SDecoder> pNext = open(iTrack + 1);
+
+        measure({pPlaying.get(), pGraph.get(), pNext.get()});
+
+        pGraph = nullptr;
+        pPlaying = std::move(pNext);
+
+        iTrack++;
+        vHistory.push_back(iTrack);
+
+        if (iTrack % 5 == 0)
+        {
+            // "Previous track" twice and back.
+            pPlaying = open(iTrack - 1);
+            pPlaying = open(iTrack - 2);
+            pPlaying = open(iTrack);
+
+            measure({pPlaying.get()});
+        }
+    }
+
+    pPlaying = nullptr;
+
+
+    // Export of the last played tracks.
+    const size_t iExportCount = std::min<size_t>(MAX_CACHED_AUDIO_FILES, vHistory.size());
+    for (size_t i = vHistory.size() - iExportCount; i < vHistory.size(); i++)
+    {
+        std::unique_ptr<SDecoder> pExport = open(vHistory[i]);
+        decodeAll(pExport.get());
+
+        measure({pExport.get()});
+    }
+
+
+    if (pFileCache)
+    {
+        result.stats = pFileCache->getStats();
+    }
+
+    return result;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iTrackCount = std::max<size_t>(argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 40, 3);
+    const double dLengthInSec = argc > 2 ? std::atof(argv[2]) : 30.0;
+
+    const std::filesystem::path dir = getTestDirectory(L"SFileHandleCacheBenchmark");
+
+    std::vector<std::filesystem::path> vTracks;
+
+    for (size_t i = 0; i < iTrackCount; i++)
+    {
+        const std::filesystem::path path = dir / ("track" + std::to_string(i) + ".wav");
+
+        if (writeWaveFile(path, 1, 16, iChannels, iSampleRate, static_cast<unsigned long long>(dLengthInSec * iSampleRate),
+                          [i](unsigned long long iFrame, unsigned short iChannel)
+                          {
+                              return 0.5 * std::sin(iFrame * 0.01 * (i + 1) + iChannel);
+                          }))
+        {
+            std::printf("failed to write the tracks\n");
+            return 1;
+        }
+
+        vTracks.push_back(path);
+    }
+
+
+    std::printf("%zu tracks of %.0f sec, %d cached files\n\n", iTrackCount, dLengthInSec, MAX_CACHED_AUDIO_FILES);
+    std::printf("%-10s %8s %10s %12s %14s %16s\n", "cache", "opens", "mapped", "us per open", "max handles", "max mapped MB");
+
+    auto print = [](const char* pName, const SessionResult& result, size_t iMappedCount)
+    {
+        std::printf("%-10s %8zu %10zu %12.1f %14zu %16.1f\n", pName, result.iOpenCount, iMappedCount,
+                    result.dOpenTimeInMs * 1000.0 / result.iOpenCount, result.iMaxExtraHandleCount,
+                    result.iMaxMappedSizeInBytes / (1024.0 * 1024.0));
+    };
+
+    // Without the cache every open maps the file.
+    const SessionResult noCache = runSession(vTracks, nullptr);
+    print("none", noCache, noCache.iOpenCount);
+
+    SFileHandleCache cache;
+    cache.setMaxOpenedFiles(MAX_CACHED_AUDIO_FILES);
+
+    const SessionResult withCache = runSession(vTracks, &cache);
+    print("LRU", withCache, static_cast<size_t>(withCache.stats.iMissCount));
+
+    std::printf("\ncache: %llu hits, %llu misses, %zu files (%.1f MB) cached at the end\n", withCache.stats.iHitCount, withCache.stats.iMissCount,
+                withCache.stats.iCachedFileCount, withCache.stats.iCachedSizeInBytes / (1024.0 * 1024.0));
+
+    cache.closeAll();
+
+    std::printf("handles after closeAll(): %zu\n", getOpenedHandleCount());
+    std::printf("peak memory: %zu KB\n", getPeakMemoryInKB());
+
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return 0;
+}
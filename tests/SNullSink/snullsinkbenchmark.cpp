@@ -0,0 +1,208 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Headless playback without an audio device: a generated track is decoded in blocks,
+// optionally sent through the effect chain (like SSoundMix's FX send) and written to a sink.
+// Prints the realtime factor (seconds of audio per second of CPU time) of every case.
+//
+// Usage: SNullSinkBenchmark [track length in sec (default 120)]
+
+// STL
+#include <cmath>
+#include <memory>
+#include <random>
+#include <cstdlib>
+
+// Custom
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "Model/AudioEngine/SEffectProcessor/seffectprocessor.h"
+#include "Model/AudioEngine/SNullSink/snullsink.h"
+#include "Model/AudioEngine/SWaveFileSink/swavefilesink.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int   iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+// Same as SOfflineRenderer.
+static const size_t iBlockFrameCount = 1024;
+
+
+static std::vector<std::unique_ptr<SEffectProcessor>> createEffects()
+{
+    std::vector<std::unique_ptr<SEffectProcessor>> vEffects;
+
+    FXEQ_PARAMETERS eqParams = {FXEQ_DEFAULT_FREQUENCY_CENTER_0, 2.0f, FXEQ_DEFAULT_BANDWIDTH,
+                                FXEQ_DEFAULT_FREQUENCY_CENTER_1, 0.5f, FXEQ_DEFAULT_BANDWIDTH,
+                                FXEQ_DEFAULT_FREQUENCY_CENTER_2, 1.5f, FXEQ_DEFAULT_BANDWIDTH,
+                                FXEQ_DEFAULT_FREQUENCY_CENTER_3, 0.8f, FXEQ_DEFAULT_BANDWIDTH};
+    FXREVERB_PARAMETERS reverbParams = {FXREVERB_DEFAULT_DIFFUSION, FXREVERB_DEFAULT_ROOMSIZE};
+    FXECHO_PARAMETERS echoParams = {FXECHO_DEFAULT_WETDRYMIX, FXECHO_DEFAULT_FEEDBACK, FXECHO_DEFAULT_DELAY};
+
+    const S_EFFECT_TYPE vTypes[] = {ET_EQ, ET_REVERB, ET_ECHO};
+    const void* vParams[]        = {&eqParams, &reverbParams, &echoParams};
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        vEffects.push_back(std::unique_ptr<SEffectProcessor>(SEffectProcessor::create(vTypes[i])));
+        vEffects.back()->setup(iSampleRate, iChannels);
+        vEffects.back()->setParameters(vParams[i]);
+    }
+
+    return vEffects;
+}
+
+// Returns the realtime factor, 0 on error.
+static double play(const std::filesystem::path& trackPath, SAudioSink& sink, bool bEffects, bool bSeeks)
+{
+    std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(trackPath.wstring(), SF_FLOAT32));
+    if (pDecoder == nullptr || sink.open({iSampleRate, iChannels}))
+    {
+        return 0.0;
+    }
+
+    std::vector<std::unique_ptr<SEffectProcessor>> vEffects;
+    if (bEffects)
+    {
+        vEffects = createEffects();
+    }
+
+    std::vector<float> vBlock(iBlockFrameCount * iChannels);
+    std::vector<float> vFXBuffer(iBlockFrameCount * iChannels);
+
+    const unsigned long long iFrameCount = pDecoder->getInfo().iFrameCount;
+
+    std::mt19937 random(5);
+
+    TestTimer timer;
+
+    SDenormalGuard denormalGuard;
+
+    size_t iBlockIndex = 0;
+
+    while (true)
+    {
+        if (bSeeks && iBlockIndex % 4 == 0)
+        {
+            // A seek every ~100 ms of played audio.
+            if (pDecoder->seek(random() % iFrameCount))
+            {
+                return 0.0;
+            }
+
+            for (auto& pEffect : vEffects)
+            {
+                pEffect->reset();
+            }
+        }
+
+        size_t iReadFrameCount = 0;
+        if (pDecoder->read(reinterpret_cast<unsigned char*>(vBlock.data()), iBlockFrameCount, iReadFrameCount))
+        {
+            return 0.0;
+        }
+
+        if (vEffects.size() > 0)
+        {
+            // FX send mixed with the dry signal.
+
+            std::copy(vBlock.begin(), vBlock.begin() + static_cast<long>(iReadFrameCount * iChannels), vFXBuffer.begin());
+
+            for (auto& pEffect : vEffects)
+            {
+                pEffect->process(vFXBuffer.data(), iReadFrameCount);
+            }
+
+            for (size_t i = 0; i < iReadFrameCount * iChannels; i++)
+            {
+                vBlock[i] = 0.5f * (vBlock[i] + vFXBuffer[i]);
+            }
+        }
+
+        if (sink.write(vBlock.data(), iReadFrameCount))
+        {
+            return 0.0;
+        }
+
+        iBlockIndex++;
+
+        if (iReadFrameCount < iBlockFrameCount || (bSeeks && sink.getWrittenFrameCount() >= iFrameCount))
+        {
+            break;
+        }
+    }
+
+    if (sink.close())
+    {
+        return 0.0;
+    }
+
+    const double dTimeInSec = timer.getElapsedInMs() / 1000.0;
+
+    return sink.getWrittenFrameCount() / static_cast<double>(iSampleRate) / dTimeInSec;
+}
+
+int main(int argc, char* argv[])
+{
+    const double dLengthInSec = argc > 1 ? std::atof(argv[1]) : 120.0;
+
+    const std::filesystem::path dir = getTestDirectory(L"SNullSinkBenchmark");
+    const std::filesystem::path trackPath = dir / L"track.wav";
+    const std::filesystem::path outputPath = dir / L"output.wav";
+
+    if (writeWaveFile(trackPath, 1, 16, iChannels, iSampleRate, static_cast<unsigned long long>(dLengthInSec * iSampleRate),
+                      [](unsigned long long iFrame, unsigned short iChannel)
+                      {
+                          return 0.4 * std::sin(iFrame * 0.0627 + iChannel) + 0.2 * std::sin(iFrame * 0.31);
+                      }))
+    {
+        std::printf("failed to write the track\n");
+        return 1;
+    }
+
+
+    std::printf("%-28s %14s\n", "case", "realtime x");
+
+    struct Case
+    {
+        const char* pName;
+        bool bFileSink;
+        bool bEffects;
+        bool bSeeks;
+    };
+
+    const Case vCases[] = {{"null sink",                 false, false, false},
+                           {"null sink + EQ/reverb/echo", false, true,  false},
+                           {"null sink + seeks",          false, false, true},
+                           {"WAV sink",                  true,  false, false},
+                           {"WAV sink + EQ/reverb/echo", true,  true,  false}};
+
+    int iResult = 0;
+
+    for (const Case& testCase : vCases)
+    {
+        SNullSink nullSink;
+        SWaveFileSink fileSink(outputPath.wstring());
+
+        SAudioSink* pSink = testCase.bFileSink ? static_cast<SAudioSink*>(&fileSink) : static_cast<SAudioSink*>(&nullSink);
+
+        const double dRealtimeFactor = play(trackPath, *pSink, testCase.bEffects, testCase.bSeeks);
+        if (dRealtimeFactor == 0.0)
+        {
+            std::printf("%-28s failed\n", testCase.pName);
+            iResult = 1;
+            continue;
+        }
+
+        std::printf("%-28s %14.1f\n", testCase.pName, dRealtimeFactor);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return iResult;
+}
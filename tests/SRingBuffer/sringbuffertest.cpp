@@ -0,0 +1,225 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Single-threaded checks and a producer/consumer stress run (on different cores when possible)
+// that checks the order of every byte and prints the throughput.
+//
+// Usage: SRingBufferTest [bytes per stress run in MB (default 64)]
+
+// STL
+#include <thread>
+#include <random>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+// Custom
+#include "Model/AudioEngine/SRingBuffer/sringbuffer.h"
+#include "TestUtils/testutils.h"
+
+
+// The byte that should be at this position of the stream.
+static unsigned char getStreamByte(unsigned long long iPos)
+{
+    return static_cast<unsigned char>((iPos * 2654435761ULL) >> 13);
+}
+
+static void pinToCore(std::thread& thread, unsigned int iCore)
+{
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(iCore % std::thread::hardware_concurrency(), &cpuSet);
+
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet);
+#else
+    (void)thread;
+    (void)iCore;
+#endif
+}
+
+static void testSingleThread()
+{
+    SRingBuffer ring;
+    ring.setup(10);
+
+    XCHECK(ring.getCapacity() == 10);
+    XCHECK(ring.getFreeSize() == 10);
+    XCHECK(ring.getReadableSize() == 0);
+
+    size_t iSize = 0;
+    XCHECK(ring.peek(0, iSize) == nullptr && iSize == 0);
+
+
+    const unsigned char vIn[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+
+    // Full ring only takes what fits.
+    XCHECK(ring.write(vIn, 12) == 10);
+    XCHECK(ring.getFreeSize() == 0);
+    XCHECK(ring.write(vIn, 1) == 0);
+
+    unsigned char vOut[12] = {};
+    XCHECK(ring.read(vOut, 7) == 7);
+    XCHECK(vOut[0] == 1 && vOut[6] == 7);
+
+
+    // Wraps around the end.
+    XCHECK(ring.write(vIn + 10, 2) == 2);
+    XCHECK(ring.getReadableSize() == 5);
+
+    const unsigned char* pData = ring.peek(0, iSize);
+    XCHECK(pData != nullptr && iSize == 3 && pData[0] == 8);
+
+    pData = ring.peek(3, iSize);
+    XCHECK(pData != nullptr && iSize == 2 && pData[0] == 11 && pData[1] == 12);
+
+    ring.consume(3);
+    XCHECK(ring.read(vOut, 10) == 2);
+    XCHECK(vOut[0] == 11 && vOut[1] == 12);
+
+    XCHECK(ring.getWriteCount() == 12);
+    XCHECK(ring.getReadCount() == 12);
+}
+
+// 'bPeek' - the consumer uses peek()/consume() (like the voice submission), otherwise read().
+static void testStress(size_t iCapacity, unsigned long long iTotalSize, bool bPeek)
+{
+    SRingBuffer ring;
+    ring.setup(iCapacity);
+
+    std::atomic<bool> bOrderBroken(false);
+
+
+    TestTimer timer;
+
+    std::thread producer([&]()
+    {
+        std::mt19937 random(1);
+
+        std::vector<unsigned char> vChunk(iCapacity);
+
+        unsigned long long iPos = 0;
+        while (iPos < iTotalSize)
+        {
+            size_t iChunkSize = 1 + random() % iCapacity;
+            if (iChunkSize > iTotalSize - iPos)
+            {
+                iChunkSize = static_cast<size_t>(iTotalSize - iPos);
+            }
+
+            for (size_t i = 0; i < iChunkSize; i++)
+            {
+                vChunk[i] = getStreamByte(iPos + i);
+            }
+
+            size_t iWritten = 0;
+            while (iWritten < iChunkSize)
+            {
+                const size_t iDone = ring.write(vChunk.data() + iWritten, iChunkSize - iWritten);
+                if (iDone == 0)
+                {
+                    // Full, let the consumer run (matters when both threads share one core).
+                    std::this_thread::yield();
+                }
+
+                iWritten += iDone;
+            }
+
+            iPos += iChunkSize;
+        }
+    });
+
+    std::thread consumer([&]()
+    {
+        std::mt19937 random(2);
+
+        std::vector<unsigned char> vChunk(iCapacity);
+
+        unsigned long long iPos = 0;
+        while (iPos < iTotalSize)
+        {
+            if (bPeek)
+            {
+                size_t iSize = 0;
+                const unsigned char* pData = ring.peek(0, iSize);
+                if (pData == nullptr)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                for (size_t i = 0; i < iSize; i++)
+                {
+                    if (pData[i] != getStreamByte(iPos + i))
+                    {
+                        bOrderBroken = true;
+                    }
+                }
+
+                ring.consume(iSize);
+                iPos += iSize;
+            }
+            else
+            {
+                const size_t iRead = ring.read(vChunk.data(), 1 + random() % iCapacity);
+                if (iRead == 0)
+                {
+                    std::this_thread::yield();
+                }
+
+                for (size_t i = 0; i < iRead; i++)
+                {
+                    if (vChunk[i] != getStreamByte(iPos + i))
+                    {
+                        bOrderBroken = true;
+                    }
+                }
+
+                iPos += iRead;
+            }
+        }
+    });
+
+    pinToCore(producer, 0);
+    pinToCore(consumer, 1);
+
+    producer.join();
+    consumer.join();
+
+    const double dTimeInSec = timer.getElapsedInMs() / 1000.0;
+
+    XCHECK(bOrderBroken == false);
+    XCHECK(ring.getWriteCount() == iTotalSize);
+    XCHECK(ring.getReadCount() == iTotalSize);
+    XCHECK(ring.getReadableSize() == 0);
+
+    std::printf("capacity %8zu B, %-6s %10.1f MB/s\n", iCapacity, bPeek ? "peek" : "read",
+                iTotalSize / dTimeInSec / (1024.0 * 1024.0));
+}
+
+int main(int argc, char* argv[])
+{
+    const unsigned long long iTotalSize = (argc > 1 ? std::atoll(argv[1]) : 64) * 1024ULL * 1024ULL;
+
+    testSingleThread();
+
+    // Small odd sizes wrap all the time, the last one is about 1 second of 48 kHz float stereo.
+    const size_t vCapacities[] = {7, 4093, 384000};
+
+    for (size_t iCapacity : vCapacities)
+    {
+        // The byte by byte check is the slow part, small rings get less data.
+        const unsigned long long iSize = iCapacity < 1000 ? iTotalSize / 64 : iTotalSize;
+
+        testStress(iCapacity, iSize, false);
+        testStress(iCapacity, iSize, true);
+    }
+
+    return finishTest();
+}
@@ -0,0 +1,78 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Converted samples per second of every sample format and every path (scalar, SSE2, AVX2).
+//
+// Usage: SSampleConverterBenchmark [samples per format (default 100000000)]
+
+// STL
+#include <cstdlib>
+
+// Custom
+#include "Model/AudioEngine/SSampleConverter/ssampleconverter.h"
+#include "TestUtils/testutils.h"
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iTotalSampleCount = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000000;
+
+    // Same chunk size as the graph (about 100 ms of stereo audio).
+    const size_t iChunkSampleCount = 8820;
+
+    struct Format
+    {
+        S_SAMPLE_FORMAT format;
+        size_t          iSampleSize;
+        const char*     pName;
+    };
+
+    const Format vFormats[] = {{SF_UINT8, 1, "uint8"}, {SF_INT16, 2, "int16"}, {SF_INT24, 3, "int24"}, {SF_INT32, 4, "int32"}, {SF_FLOAT32, 4, "float32"}};
+
+    const S_CONVERTER_PATH vPaths[]  = {CP_SCALAR, CP_SSE2, CP_AVX2};
+    const char* vPathNames[]         = {"scalar", "sse2", "avx2"};
+
+
+    std::vector<unsigned char> vData(iChunkSampleCount * 4);
+    for (size_t i = 0; i < vData.size(); i++)
+    {
+        vData[i] = static_cast<unsigned char>(i * 31);
+    }
+
+    std::vector<float> vSamples(iChunkSampleCount);
+
+    std::printf("%-8s %-7s %14s\n", "format", "path", "Msamples/s");
+
+    for (const Format& format : vFormats)
+    {
+        for (size_t p = 0; p < 3; p++)
+        {
+            SSampleConverter::setPath(vPaths[p]);
+            if (SSampleConverter::getPath() != vPaths[p])
+            {
+                continue;
+            }
+
+            TestTimer timer;
+
+            float fSum = 0.0f;
+
+            for (size_t iDone = 0; iDone < iTotalSampleCount; iDone += iChunkSampleCount)
+            {
+                SSampleConverter::convertToFloat(vData.data(), iChunkSampleCount, format.format, vSamples.data());
+                fSum += vSamples[iDone % iChunkSampleCount];
+            }
+
+            const double dTimeInSec = timer.getElapsedInMs() / 1000.0;
+
+            std::printf("%-8s %-7s %14.1f%s\n", format.pName, vPathNames[p], iTotalSampleCount / dTimeInSec / 1000000.0,
+                        fSum == 12345.0f ? " " : "");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// STL
+#include <cmath>
+#include <random>
+
+// Custom
+#include "Model/AudioEngine/SSampleConverter/ssampleconverter.h"
+#include "Model/AudioEngine/SCrossfader/scrossfader.h"
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "TestUtils/testutils.h"
+
+
+static size_t getSampleSize(S_SAMPLE_FORMAT format)
+{
+    switch (format)
+    {
+    case(SF_UINT8):  return 1;
+    case(SF_INT16):  return 2;
+    case(SF_INT24):  return 3;
+    default:         return 4;
+    }
+}
+
+static void testGetSampleFormat()
+{
+    S_SAMPLE_FORMAT format = SF_INT16;
+
+    XCHECK(SSampleConverter::getSampleFormat(8, false, format) == false && format == SF_UINT8);
+    XCHECK(SSampleConverter::getSampleFormat(16, false, format) == false && format == SF_INT16);
+    XCHECK(SSampleConverter::getSampleFormat(24, false, format) == false && format == SF_INT24);
+    XCHECK(SSampleConverter::getSampleFormat(32, false, format) == false && format == SF_INT32);
+    XCHECK(SSampleConverter::getSampleFormat(32, true, format) == false && format == SF_FLOAT32);
+
+    XCHECK(SSampleConverter::getSampleFormat(12, false, format));
+    XCHECK(SSampleConverter::getSampleFormat(64, true, format));
+}
+
+static void testUInt8()
+{
+    const unsigned char vData[] = {0, 64, 128, 192, 255};
+
+    float vSamples[5];
+    SSampleConverter::convertToFloat(vData, 5, SF_UINT8, vSamples);
+
+    XCHECK(vSamples[0] == -1.0f);
+    XCHECK(vSamples[1] == -0.5f);
+    XCHECK(vSamples[2] == 0.0f);
+    XCHECK(vSamples[3] == 0.5f);
+    XCHECK(vSamples[4] == 127.0f / 128.0f);
+
+
+    const float vFloats[] = {-2.0f, -1.0f, 0.0f, 1.0f, 2.0f};
+
+    unsigned char vOut[5];
+    SSampleConverter::convertFromFloat(vFloats, 5, SF_UINT8, vOut);
+
+    XCHECK(vOut[0] == 1);
+    XCHECK(vOut[1] == 1);
+    XCHECK(vOut[2] == 128);
+    XCHECK(vOut[3] == 255);
+    XCHECK(vOut[4] == 255);
+}
+
+static void testPathsAreEqual()
+{
+    // Odd count so that the scalar tail of every path is used too.
+    const size_t iSampleCount = 1027;
+
+    std::mt19937 random(42);
+
+    const S_SAMPLE_FORMAT vFormats[] = {SF_UINT8, SF_INT16, SF_INT24, SF_INT32};
+
+    for (S_SAMPLE_FORMAT format : vFormats)
+    {
+        std::vector<unsigned char> vData(iSampleCount * getSampleSize(format));
+        for (size_t i = 0; i < vData.size(); i++)
+        {
+            vData[i] = static_cast<unsigned char>(random());
+        }
+
+        std::vector<float> vScalar(iSampleCount);
+        std::vector<float> vOther(iSampleCount);
+
+        SSampleConverter::setPath(CP_SCALAR);
+        SSampleConverter::convertToFloat(vData.data(), iSampleCount, format, vScalar.data());
+
+        const S_CONVERTER_PATH vPaths[] = {CP_SSE2, CP_AVX2};
+
+        for (S_CONVERTER_PATH path : vPaths)
+        {
+            SSampleConverter::setPath(path);
+            if (SSampleConverter::getPath() != path)
+            {
+                // Not supported by this CPU.
+                continue;
+            }
+
+            std::fill(vOther.begin(), vOther.end(), 2.0f);
+            SSampleConverter::convertToFloat(vData.data(), iSampleCount, format, vOther.data());
+
+            XCHECK(vOther == vScalar);
+        }
+
+
+        // To float and back gives the same samples (up to rounding of the scale).
+
+        std::vector<unsigned char> vBack(vData.size());
+        SSampleConverter::convertFromFloat(vScalar.data(), iSampleCount, format, vBack.data());
+
+        std::vector<float> vBackSamples(iSampleCount);
+        SSampleConverter::convertToFloat(vBack.data(), iSampleCount, format, vBackSamples.data());
+
+        float fMaxError = 0.0f;
+        for (size_t i = 0; i < iSampleCount; i++)
+        {
+            fMaxError = std::max(fMaxError, std::fabs(vBackSamples[i] - vScalar[i]));
+        }
+
+        XCHECK(fMaxError <= 2.0f / 128.0f);
+    }
+
+    SSampleConverter::setPath(CP_AVX2);
+}
+
+static void testCrossfaderUInt8()
+{
+    SCrossfader fade;
+    fade.setup(CC_LINEAR, true, 0, 4);
+
+    // Fade in from silence, silence of 8 bit samples is 128.
+    unsigned char vData[] = {255, 255, 255, 255, 255, 255};
+    fade.apply(vData, 6, 1, SF_UINT8, 0);
+
+    XCHECK(vData[0] == 128);
+    XCHECK(vData[0] < vData[1] && vData[1] < vData[2] && vData[2] < vData[3]);
+    XCHECK(vData[4] == 255 && vData[5] == 255);
+}
+
+static void testWaveDecoderUInt8()
+{
+    const std::filesystem::path dir = getTestDirectory(L"SSampleConverterTest");
+    const std::filesystem::path path = dir / L"8bit.wav";
+
+    std::vector<double> vSamples = {0.0, 0.5, -0.5, 1.0, -1.0};
+    XCHECK(writeWaveFile(path, 1, 8, 1, 8000, vSamples) == false);
+
+    SDecoder* pDecoder = SDecoder::openFile(path.wstring(), SF_FLOAT32);
+    XCHECK(pDecoder != nullptr);
+    if (pDecoder == nullptr)
+    {
+        return;
+    }
+
+    float vOut[5];
+    size_t iReadFrameCount = 0;
+    XCHECK(pDecoder->read(reinterpret_cast<unsigned char*>(vOut), 5, iReadFrameCount) == false);
+    XCHECK(iReadFrameCount == 5);
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        XCHECK(std::fabs(vOut[i] - vSamples[i]) < 2.0 / 128.0);
+    }
+
+    delete pDecoder;
+}
+
+int main()
+{
+    testGetSampleFormat();
+    testUInt8();
+    testPathsAreEqual();
+    testCrossfaderUInt8();
+    testWaveDecoderUInt8();
+
+    return finishTest();
+}
@@ -0,0 +1,269 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Seeks to random frames and checks that the exact frame is read:
+// through SSeekIndex on a simulated VBR stream (like SSound does with the source reader)
+// and through SWaveDecoder on a generated WAV file.
+
+// STL
+#include <random>
+#include <memory>
+
+// Custom
+#include "Model/AudioEngine/SSeekIndex/sseekindex.h"
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int iSampleRate = 44100;
+
+
+// A stream of packets with a different frame count (like VBR MP3 after the decoder).
+struct TestPacket
+{
+    unsigned long long iFirstFrame;
+    size_t             iFrameCount;
+    long long          iTimestamp;
+};
+
+static std::vector<TestPacket> makePackets(unsigned long long& iTotalFrameCount, std::mt19937& random)
+{
+    std::vector<TestPacket> vPackets;
+
+    unsigned long long iFrame = 0;
+
+    for (size_t i = 0; i < 5000; i++)
+    {
+        const size_t iFrameCount = (random() % 4 == 0) ? 576 : 1152 + random() % 300;
+
+        // Timestamps are rounded to 100 ns, so the frame can't be calculated back from them.
+        vPackets.push_back({iFrame, iFrameCount, static_cast<long long>(iFrame * 10000000ULL / iSampleRate)});
+
+        iFrame += iFrameCount;
+    }
+
+    iTotalFrameCount = iFrame;
+
+    return vPackets;
+}
+
+// Seeks like SSound::setPositionInSec(): to the indexed packet and then skips the frames before the target.
+static unsigned long long seekAndRead(const std::vector<TestPacket>& vPackets, const SSeekIndex& index, unsigned long long iTargetFrame)
+{
+    SSeekIndexEntry entry;
+    if (index.findByFrame(iTargetFrame, entry))
+    {
+        return ~0ULL;
+    }
+
+    // The decoder can only start at a packet.
+    size_t iPacket = 0;
+    while (iPacket < vPackets.size() && vPackets[iPacket].iTimestamp != entry.iTimestamp)
+    {
+        iPacket++;
+    }
+
+    if (iPacket == vPackets.size())
+    {
+        return ~0ULL;
+    }
+
+    // The decoded frames are their own index, so the first frame after the skip tells where we are.
+    unsigned long long iFrame = vPackets[iPacket].iFirstFrame;
+    unsigned long long iFramesToSkip = iTargetFrame - entry.iFrame;
+
+    while (iFramesToSkip >= vPackets[iPacket].iFrameCount)
+    {
+        iFramesToSkip -= vPackets[iPacket].iFrameCount;
+        iFrame += vPackets[iPacket].iFrameCount;
+        iPacket++;
+
+        if (iPacket == vPackets.size())
+        {
+            return ~0ULL;
+        }
+    }
+
+    return iFrame + iFramesToSkip;
+}
+
+static void testIndexSeek()
+{
+    std::mt19937 random(3);
+
+    unsigned long long iTotalFrameCount = 0;
+    const std::vector<TestPacket> vPackets = makePackets(iTotalFrameCount, random);
+
+
+    // Built while the file is played from the start.
+    SSeekIndex index;
+    for (const TestPacket& packet : vPackets)
+    {
+        XCHECK(index.addEntry(packet.iFirstFrame, packet.iTimestamp) == false);
+    }
+
+    XCHECK(index.addEntry(0, 0)); // out of order
+    XCHECK(index.isComplete() == false);
+
+    index.setComplete(iTotalFrameCount);
+
+    XCHECK(index.isComplete());
+    XCHECK(index.getLastFrame() == iTotalFrameCount);
+    XCHECK(index.getEntryCount() == vPackets.size());
+
+
+    // Random seeks (and the edges).
+
+    std::vector<unsigned long long> vTargets = {0, 1, vPackets[1].iFirstFrame, vPackets[1].iFirstFrame - 1, iTotalFrameCount - 1};
+    for (size_t i = 0; i < 10000; i++)
+    {
+        vTargets.push_back(random() % iTotalFrameCount);
+    }
+
+    size_t iWrongFrameCount = 0;
+    for (unsigned long long iTarget : vTargets)
+    {
+        if (seekAndRead(vPackets, index, iTarget) != iTarget)
+        {
+            iWrongFrameCount++;
+        }
+    }
+
+    XCHECK(iWrongFrameCount == 0);
+
+
+    // The position reported from a decoded sample timestamp is exact too.
+
+    bool bTimestampsMatch = true;
+    for (size_t i = 0; i < vPackets.size(); i += 7)
+    {
+        unsigned long long iFrame = 0;
+        bTimestampsMatch = bTimestampsMatch && index.findByTimestamp(vPackets[i].iTimestamp, iFrame) == false
+                           && iFrame == vPackets[i].iFirstFrame;
+    }
+
+    XCHECK(bTimestampsMatch);
+
+    unsigned long long iFrame = 0;
+    XCHECK(index.findByTimestamp(vPackets[1].iTimestamp + 1, iFrame));
+
+
+    // Saved and loaded for the same audio file only.
+
+    const std::filesystem::path dir = getTestDirectory(L"SSeekIndexTest");
+    const std::filesystem::path audioPath = dir / L"audio.mp3";
+    const std::filesystem::path indexPath = dir / L"index" / L"audio.xski";
+
+    {
+        std::ofstream audioFile(audioPath, std::ios::binary);
+        audioFile << "not really an mp3";
+    }
+
+    XCHECK(index.save(indexPath.wstring(), audioPath.wstring()) == false);
+
+    SSeekIndex loaded;
+    XCHECK(loaded.load(indexPath.wstring(), audioPath.wstring()) == false);
+    XCHECK(loaded.isComplete());
+    XCHECK(loaded.getEntryCount() == index.getEntryCount());
+    XCHECK(loaded.getLastFrame() == iTotalFrameCount);
+
+    iWrongFrameCount = 0;
+    for (size_t i = 0; i < 1000; i++)
+    {
+        if (seekAndRead(vPackets, loaded, vTargets[i]) != vTargets[i])
+        {
+            iWrongFrameCount++;
+        }
+    }
+
+    XCHECK(iWrongFrameCount == 0);
+
+    {
+        std::ofstream audioFile(audioPath, std::ios::binary | std::ios::app);
+        audioFile << "changed";
+    }
+
+    XCHECK(loaded.load(indexPath.wstring(), audioPath.wstring()));
+
+
+    // Not complete indexes are not saved.
+    SSeekIndex partial;
+    partial.addEntry(0, 0);
+    XCHECK(partial.save(indexPath.wstring(), audioPath.wstring()));
+}
+
+static void testWaveDecoderSeek()
+{
+    const std::filesystem::path dir = getTestDirectory(L"SSeekIndexTest");
+    const std::filesystem::path path = dir / L"frames.wav";
+
+    // Every frame stores its own index: low 15 bits in the left channel, high bits in the right one.
+    const unsigned long long iFrameCount = iSampleRate * 30 + 17;
+
+    XCHECK(writeWaveFile(path, 1, 16, 2, iSampleRate, iFrameCount,
+                         [](unsigned long long iFrame, unsigned short iChannel)
+                         {
+                             const unsigned long long iValue = (iChannel == 0) ? (iFrame & 0x7FFF) : (iFrame >> 15);
+                             return (static_cast<double>(iValue) + 0.5) / 32767.0;
+                         }) == false);
+
+    std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(path.wstring(), SF_INT16));
+    XCHECK(pDecoder != nullptr);
+    if (pDecoder == nullptr)
+    {
+        return;
+    }
+
+    XCHECK(pDecoder->getInfo().iFrameCount == iFrameCount);
+
+    std::mt19937 random(9);
+
+    std::vector<unsigned long long> vTargets = {0, iFrameCount - 1, iFrameCount / 2};
+    for (size_t i = 0; i < 2000; i++)
+    {
+        vTargets.push_back(random() % iFrameCount);
+    }
+
+    size_t iWrongFrameCount = 0;
+
+    int16_t vFrames[2 * 4];
+    for (unsigned long long iTarget : vTargets)
+    {
+        size_t iReadFrameCount = 0;
+        if (pDecoder->seek(iTarget) || pDecoder->read(reinterpret_cast<unsigned char*>(vFrames), 4, iReadFrameCount)
+                || iReadFrameCount == 0)
+        {
+            iWrongFrameCount++;
+            continue;
+        }
+
+        const unsigned long long iFrame = static_cast<unsigned long long>(vFrames[0])
+                                          | (static_cast<unsigned long long>(vFrames[1]) << 15);
+        if (iFrame != iTarget)
+        {
+            iWrongFrameCount++;
+        }
+    }
+
+    XCHECK(iWrongFrameCount == 0);
+
+    // Past the end.
+    size_t iReadFrameCount = 1;
+    if (pDecoder->seek(iFrameCount) == false)
+    {
+        XCHECK(pDecoder->read(reinterpret_cast<unsigned char*>(vFrames), 4, iReadFrameCount) == false);
+        XCHECK(iReadFrameCount == 0);
+    }
+}
+
+int main()
+{
+    testIndexSeek();
+    testWaveDecoderSeek();
+
+    return finishTest();
+}
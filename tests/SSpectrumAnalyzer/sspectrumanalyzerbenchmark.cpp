@@ -0,0 +1,104 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// CPU cost of the live spectrum: write() on the audio thread (per 10 ms stereo callback)
+// and getSpectrum() on the UI thread (per displayed frame), plus the CPU load at 60 fps.
+//
+// Usage: SSpectrumAnalyzerBenchmark [displayed frames per case (default 6000)]
+
+// STL
+#include <cmath>
+#include <cstdlib>
+
+// Custom
+#include "Model/AudioEngine/SSpectrumAnalyzer/sspectrumanalyzer.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned long  iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+static const double dFramesPerSec = 60.0;
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iDisplayFrameCount = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 6000;
+
+    // Like the XAudio2 processing pass (10 ms).
+    const size_t iCallbackFrameCount = iSampleRate / 100;
+
+    std::vector<float> vAudio(iSampleRate * iChannels);
+    for (size_t i = 0; i < vAudio.size(); i++)
+    {
+        vAudio[i] = 0.3f * static_cast<float>(std::sin(i * 0.05) + std::sin(i * 0.31));
+    }
+
+    const size_t vFFTSizes[]   = {1024, 2048, 4096};
+    const size_t vBandCounts[] = {32, 64};
+
+    std::printf("%-8s %6s %16s %18s %14s\n", "fft", "bands", "write() ns/call", "getSpectrum() us", "CPU at 60 fps");
+
+    int iResult = 0;
+
+    for (size_t iFFTSize : vFFTSizes)
+    {
+        for (size_t iBandCount : vBandCounts)
+        {
+            SSpectrumAnalyzer analyzer;
+            if (analyzer.setup(iFFTSize, iBandCount, 20.0f, 20000.0f) || analyzer.open({iSampleRate, iChannels}))
+            {
+                std::printf("failed to set up the analyzer\n");
+                iResult = 1;
+                continue;
+            }
+
+            std::vector<float> vBands(analyzer.getBandCount());
+
+            double dWriteTimeInMs = 0.0;
+            size_t iWriteCount = 0;
+            size_t iAudioPos = 0;
+
+            double dProducedFrames = 0.0;
+
+            for (size_t i = 0; i < iDisplayFrameCount; i++)
+            {
+                // Audio of one displayed frame.
+                dProducedFrames += iSampleRate / dFramesPerSec;
+
+                while (dProducedFrames >= iCallbackFrameCount)
+                {
+                    if (iAudioPos + iCallbackFrameCount > iSampleRate)
+                    {
+                        iAudioPos = 0;
+                    }
+
+                    TestTimer timer;
+                    analyzer.write(vAudio.data() + iAudioPos * iChannels, iCallbackFrameCount);
+                    dWriteTimeInMs += timer.getElapsedInMs();
+
+                    iWriteCount++;
+                    iAudioPos += iCallbackFrameCount;
+                    dProducedFrames -= iCallbackFrameCount;
+                }
+
+                analyzer.getSpectrum(vBands.data());
+            }
+
+            const double dSpectrumTimeInUs = analyzer.getAverageSpectrumTimeInUs();
+            const double dWriteTimeInNs = dWriteTimeInMs * 1000000.0 / iWriteCount;
+
+            // Both threads, per second of playback.
+            const double dCpuLoad = (dSpectrumTimeInUs * dFramesPerSec + dWriteTimeInNs / 1000.0 * iWriteCount / (iDisplayFrameCount / dFramesPerSec))
+                                    / 1000000.0;
+
+            std::printf("%-8zu %6zu %16.0f %18.1f %13.2f%%\n", iFFTSize, iBandCount, dWriteTimeInNs, dSpectrumTimeInUs, dCpuLoad * 100.0);
+        }
+    }
+
+    return iResult;
+}
@@ -0,0 +1,130 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// CPU cost of the tempo/pitch change of a stereo 44.1 kHz stream fed in 1024 frame blocks (as SOfflineRenderer does):
+// time per second of input, how many times faster than real time and the slowest block
+// (compared with the time it takes to play the block at the normal tempo). Also the cost of one SFFT frame.
+//
+// Usage: STimeStretcherBenchmark [seconds of audio per case (default 30)]
+
+// STL
+#include <cmath>
+#include <random>
+#include <cstdlib>
+#include <algorithm>
+
+// Custom
+#include "Model/AudioEngine/STimeStretcher/stimestretcher.h"
+#include "Model/AudioEngine/SFFT/sfft.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned long  iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+static const size_t iBlockFrameCount = 1024;
+
+
+int main(int argc, char* argv[])
+{
+    const double dLengthInSec = argc > 1 ? std::atof(argv[1]) : 30.0;
+    const size_t iBlockCount = static_cast<size_t>(dLengthInSec * iSampleRate / iBlockFrameCount);
+
+    // Music-like input: a few tones and some noise.
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+
+    std::vector<float> vInput(iSampleRate * iChannels);
+    for (size_t i = 0; i < vInput.size(); i++)
+    {
+        const double t = static_cast<double>(i / iChannels) / iSampleRate;
+
+        vInput[i] = static_cast<float>(0.3 * std::sin(2.0 * 3.14159265358979323846 * 220.0 * t)
+                                       + 0.2 * std::sin(2.0 * 3.14159265358979323846 * 659.3 * t)) + noise(random);
+    }
+
+    const size_t iInputBlockCount = vInput.size() / iChannels / iBlockFrameCount;
+
+    const double dBlockDurationInMs = iBlockFrameCount * 1000.0 / iSampleRate;
+
+
+    struct Case
+    {
+        double dTempo;
+        double dSemitones;
+    };
+
+    const Case vCases[] = {{1.0, 0.0}, {0.5, 0.0}, {1.5, 0.0}, {2.0, 0.0}, {1.0, -5.0}, {1.0, 7.0}, {1.0, 12.0}, {1.25, 3.0}, {0.75, -12.0}};
+
+    std::printf("%-6s %6s %16s %12s %18s\n", "tempo", "pitch", "ms per input sec", "realtime x", "max block ms");
+
+    size_t iTotalOutput = 0;
+
+    for (const Case& c : vCases)
+    {
+        STimeStretcher stretcher;
+        stretcher.setTempo(c.dTempo);
+        stretcher.setPitchInSemitones(c.dSemitones);
+        stretcher.setup(iChannels);
+
+        std::vector<float> vOutput;
+        vOutput.reserve(static_cast<size_t>(iBlockFrameCount * iChannels * 4 / STimeStretcher::MIN_TEMPO));
+
+        double dMaxBlockInMs = 0.0;
+
+        TestTimer timer;
+
+        for (size_t i = 0; i < iBlockCount; i++)
+        {
+            TestTimer blockTimer;
+
+            vOutput.clear();
+            stretcher.process(vInput.data() + (i % iInputBlockCount) * iBlockFrameCount * iChannels, iBlockFrameCount, vOutput);
+
+            dMaxBlockInMs = std::max(dMaxBlockInMs, blockTimer.getElapsedInMs());
+
+            iTotalOutput += vOutput.size();
+        }
+
+        const double dTimeInSec = timer.getElapsedInMs() / 1000.0;
+        const double dInputInSec = static_cast<double>(iBlockCount) * iBlockFrameCount / iSampleRate;
+
+        // The output plays 'tempo' times faster than the input.
+        std::printf("%-6.2f %+6.0f %16.2f %12.0f %11.2f of %4.1f\n", c.dTempo, c.dSemitones, dTimeInSec * 1000.0 / dInputInSec,
+                    dInputInSec / c.dTempo / dTimeInSec, dMaxBlockInMs, dBlockDurationInMs / c.dTempo);
+    }
+
+
+    // One frame of the phase vocoder (forward + inverse of 2048 points for a pair of channels).
+
+    SFFT fft;
+    fft.setup(2048);
+
+    std::vector<float> vReal(vInput.begin(), vInput.begin() + 2048);
+    std::vector<float> vImag(vInput.begin() + 2048, vInput.begin() + 4096);
+
+    const size_t iTransformCount = 20000;
+
+    TestTimer timer;
+
+    for (size_t i = 0; i < iTransformCount; i++)
+    {
+        fft.forward(vReal.data(), vImag.data());
+        fft.inverse(vReal.data(), vImag.data());
+
+        // The inverse is not scaled, keep the values from growing.
+        for (size_t k = 0; k < vReal.size(); k++)
+        {
+            vReal[k] *= 1.0f / 2048;
+            vImag[k] *= 1.0f / 2048;
+        }
+    }
+
+    std::printf("\nSFFT 2048 forward + inverse: %.2f us%s\n", timer.getElapsedInMs() * 1000.0 / iTransformCount, (iTotalOutput == 0 || vReal[0] == 12345.0f) ? " " : "");
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Output length of process() + flush() for several tempo and pitch values (fed in uneven blocks):
+// the phase vocoder outputs round(N * pitch ratio / tempo) frames and the resampler turns them
+// into N / tempo frames. A sine shifted by 's' semitones has its frequency multiplied by 2^(s/12)
+// while its duration stays the same.
+
+// STL
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+// Custom
+#include "Model/AudioEngine/STimeStretcher/stimestretcher.h"
+#include "Model/AudioEngine/SResampler/sresampler.h"
+#include "Model/AudioEngine/SFFT/sfft.h"
+#include "TestUtils/testutils.h"
+
+
+static const double dPi = 3.14159265358979323846;
+
+static const unsigned long iSampleRate = 44100;
+
+
+static std::vector<float> makeSine(double dFrequency, size_t iFrameCount, unsigned short iChannels)
+{
+    std::vector<float> vSamples(iFrameCount * iChannels);
+
+    for (size_t i = 0; i < iFrameCount; i++)
+    {
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            vSamples[i * iChannels + c] = static_cast<float>(0.5 * std::sin(2.0 * dPi * dFrequency * i / iSampleRate + c));
+        }
+    }
+
+    return vSamples;
+}
+
+// Process (in blocks of random size) and flush.
+static std::vector<float> stretch(const std::vector<float>& vInput, unsigned short iChannels, double dTempo, double dSemitones, std::mt19937& random)
+{
+    STimeStretcher stretcher;
+    stretcher.setTempo(dTempo);
+    stretcher.setPitchInSemitones(dSemitones);
+    XCHECK(stretcher.setup(iChannels) == false);
+
+    std::uniform_int_distribution<size_t> blockSize(1, 5000);
+
+    std::vector<float> vOutput;
+
+    const size_t iFrameCount = vInput.size() / iChannels;
+
+    for (size_t iFrame = 0; iFrame < iFrameCount;)
+    {
+        const size_t iBlockFrameCount = std::min(blockSize(random), iFrameCount - iFrame);
+
+        stretcher.process(vInput.data() + iFrame * iChannels, iBlockFrameCount, vOutput);
+
+        iFrame += iBlockFrameCount;
+    }
+
+    stretcher.flush(vOutput);
+
+    return vOutput;
+}
+
+// Frequency of the loudest bin (interpolated) of the window in the middle of the first channel.
+static double getDominantFrequency(const std::vector<float>& vSamples, unsigned short iChannels)
+{
+    const size_t iSize = 8192;
+
+    SFFT fft;
+    fft.setup(iSize);
+
+    const size_t iFirstFrame = (vSamples.size() / iChannels - iSize) / 2;
+
+    std::vector<float> vReal(iSize);
+    std::vector<float> vImag(iSize, 0.0f);
+
+    for (size_t i = 0; i < iSize; i++)
+    {
+        vReal[i] = vSamples[(iFirstFrame + i) * iChannels] * static_cast<float>(0.5 - 0.5 * std::cos(2.0 * dPi * i / iSize));
+    }
+
+    fft.forward(vReal.data(), vImag.data());
+
+    std::vector<double> vMagnitude(iSize / 2);
+    size_t iPeak = 1;
+
+    for (size_t k = 0; k < iSize / 2; k++)
+    {
+        vMagnitude[k] = std::sqrt(static_cast<double>(vReal[k]) * vReal[k] + static_cast<double>(vImag[k]) * vImag[k]);
+
+        if (k > 0 && vMagnitude[k] > vMagnitude[iPeak])
+        {
+            iPeak = k;
+        }
+    }
+
+    // Parabola through the peak and its neighbours (on the log magnitude).
+    double dOffset = 0.0;
+
+    if (iPeak + 1 < iSize / 2)
+    {
+        const double a = std::log(vMagnitude[iPeak - 1] + 1e-12);
+        const double b = std::log(vMagnitude[iPeak] + 1e-12);
+        const double c = std::log(vMagnitude[iPeak + 1] + 1e-12);
+
+        dOffset = 0.5 * (a - c) / (a - 2.0 * b + c);
+    }
+
+    return (iPeak + dOffset) * iSampleRate / iSize;
+}
+
+
+static void testOutputLength()
+{
+    std::mt19937 random(1);
+
+    const double vTempos[] = {0.5, 0.8, 1.0, 1.25, 2.0, 3.7};
+    const double vSemitones[] = {-12.0, -5.0, 0.0, 3.0, 7.0, 19.0};
+    const unsigned short vChannels[] = {1, 2, 3};
+
+    const size_t iFrameCount = 3 * iSampleRate + 123;
+
+    for (unsigned short iChannels : vChannels)
+    {
+        const std::vector<float> vInput = makeSine(440.0, iFrameCount, iChannels);
+
+        for (double dTempo : vTempos)
+        {
+            for (double dSemitones : vSemitones)
+            {
+                const std::vector<float> vOutput = stretch(vInput, iChannels, dTempo, dSemitones, random);
+
+                XCHECK(vOutput.size() % iChannels == 0);
+
+                const size_t iOutputFrameCount = vOutput.size() / iChannels;
+
+                const double dPitchRatio = std::pow(2.0, dSemitones / 12.0);
+
+                // The phase vocoder changes the duration by 'pitch ratio / tempo'.
+                const size_t iStretchedFrameCount = static_cast<size_t>(std::llround(iFrameCount * dPitchRatio / dTempo));
+
+                // The resampler outputs one frame per 'pitch ratio' input frames (see below).
+                const size_t iExpectedFrameCount = (dSemitones == 0.0) ? iStretchedFrameCount
+                                                                       : static_cast<size_t>(std::ceil(iStretchedFrameCount / dPitchRatio));
+
+                XCHECK(iOutputFrameCount == iExpectedFrameCount);
+
+                // Only the tempo changes the duration (up to the rounding of the stretched frames, half of one
+                // is '0.5 / pitch ratio' output frames, and the last resampled frame).
+                XCHECK(std::abs(static_cast<double>(iOutputFrameCount) - iFrameCount / dTempo) <= 0.5 / dPitchRatio + 1.0);
+
+                if (iOutputFrameCount != iExpectedFrameCount)
+                {
+                    std::printf("%u channels, tempo %.2f, pitch %+.0f: %zu frames, expected %zu\n",
+                                iChannels, dTempo, dSemitones, iOutputFrameCount, iExpectedFrameCount);
+                }
+            }
+        }
+    }
+
+
+    // The resampler stage on its own: 'M' frames become ceil(M / ratio) frames.
+
+    for (double dSemitones : vSemitones)
+    {
+        const double dPitchRatio = std::pow(2.0, dSemitones / 12.0);
+
+        for (size_t iStretchedFrameCount : {size_t(1000), size_t(44100), size_t(132423)})
+        {
+            SResampler resampler;
+            XCHECK(resampler.setup(2, dPitchRatio) == false);
+
+            const std::vector<float> vInput = makeSine(440.0, iStretchedFrameCount, 2);
+
+            std::vector<float> vOutput;
+            resampler.process(vInput.data(), iStretchedFrameCount, vOutput);
+            resampler.flush(vOutput);
+
+            XCHECK(vOutput.size() / 2 == static_cast<size_t>(std::ceil(iStretchedFrameCount / dPitchRatio)));
+        }
+    }
+}
+
+static void testPitchShift()
+{
+    std::mt19937 random(2);
+
+    const double dFrequency = 440.0;
+    const size_t iFrameCount = 2 * iSampleRate;
+
+    const unsigned short iChannels = 2;
+
+    const std::vector<float> vInput = makeSine(dFrequency, iFrameCount, iChannels);
+
+    const double dInputFrequency = getDominantFrequency(vInput, iChannels);
+    XCHECK(std::abs(dInputFrequency - dFrequency) < 1.0);
+
+    for (double dSemitones : {-12.0, -7.0, -1.0, 2.0, 5.0, 12.0})
+    {
+        for (double dTempo : {1.0, 1.5})
+        {
+            const std::vector<float> vOutput = stretch(vInput, iChannels, dTempo, dSemitones, random);
+
+            // Same duration as without the pitch shift (see testOutputLength()).
+            XCHECK(std::abs(static_cast<double>(vOutput.size() / iChannels) - iFrameCount / dTempo) <= 0.5 / std::pow(2.0, dSemitones / 12.0) + 1.0);
+
+            const double dExpected = dInputFrequency * std::pow(2.0, dSemitones / 12.0);
+            const double dShifted = getDominantFrequency(vOutput, iChannels);
+
+            // A fifth of a semitone.
+            XCHECK(std::abs(std::log2(dShifted / dExpected) * 12.0) < 0.2);
+
+            if (std::abs(std::log2(dShifted / dExpected) * 12.0) >= 0.2)
+            {
+                std::printf("pitch %+.0f, tempo %.1f: %.1f Hz, expected %.1f Hz\n", dSemitones, dTempo, dShifted, dExpected);
+            }
+        }
+    }
+}
+
+
+int main()
+{
+    testOutputLength();
+    testPitchShift();
+
+    return finishTest();
+}
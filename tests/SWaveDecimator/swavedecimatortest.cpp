@@ -0,0 +1,203 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// STL
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+// Custom
+#include "Model/AudioEngine/SWaveDecimator/swavedecimator.h"
+#include "TestUtils/testutils.h"
+
+
+// The peaks as AudioCore::drawGraphFromFile() computed them before SWaveDecimator:
+// channels are folded into one sample (the loudest one) and then (min, max) of every bucket is taken.
+static std::vector<float> getReferencePeaks(const std::vector<float>& vSamples, unsigned short iChannels, size_t iFramesPerBucket)
+{
+    std::vector<float> vPeaks;
+
+    float fPeakMin = 0.0f;
+    float fPeakMax = 0.0f;
+    size_t iFramesInPeak = 0;
+
+    for (size_t i = 0; i < vSamples.size(); i += iChannels)
+    {
+        float fSample = vSamples[i];
+
+        for (unsigned short j = 1; j < iChannels; j++)
+        {
+            if (std::abs(vSamples[i + j]) > std::abs(fSample))
+            {
+                fSample = vSamples[i + j];
+            }
+        }
+
+        if (iFramesInPeak == 0)
+        {
+            fPeakMin = fSample;
+            fPeakMax = fSample;
+        }
+        else
+        {
+            fPeakMin = std::min(fPeakMin, fSample);
+            fPeakMax = std::max(fPeakMax, fSample);
+        }
+
+        iFramesInPeak++;
+
+        if (iFramesInPeak == iFramesPerBucket)
+        {
+            vPeaks.push_back(fPeakMin);
+            vPeaks.push_back(fPeakMax);
+
+            iFramesInPeak = 0;
+        }
+    }
+
+    if (iFramesInPeak > 0)
+    {
+        vPeaks.push_back(fPeakMin);
+        vPeaks.push_back(fPeakMax);
+    }
+
+    return vPeaks;
+}
+
+// Min and max of all samples of all channels in every bucket.
+static std::vector<float> getEnvelopePeaks(const std::vector<float>& vSamples, unsigned short iChannels, size_t iFramesPerBucket)
+{
+    std::vector<float> vPeaks;
+
+    const size_t iBucketSampleCount = iFramesPerBucket * iChannels;
+
+    for (size_t i = 0; i < vSamples.size(); i += iBucketSampleCount)
+    {
+        const size_t iEnd = std::min(vSamples.size(), i + iBucketSampleCount);
+
+        vPeaks.push_back(*std::min_element(vSamples.begin() + static_cast<long>(i), vSamples.begin() + static_cast<long>(iEnd)));
+        vPeaks.push_back(*std::max_element(vSamples.begin() + static_cast<long>(i), vSamples.begin() + static_cast<long>(iEnd)));
+    }
+
+    return vPeaks;
+}
+
+// Feeds the samples in random chunks (like the decoded buffers).
+static std::vector<float> decimate(const std::vector<float>& vSamples, unsigned short iChannels, size_t iFramesPerBucket, std::mt19937& random)
+{
+    const size_t iFrameCount = vSamples.size() / iChannels;
+
+    SWaveDecimator decimator;
+    XCHECK(decimator.setup(iChannels, iFramesPerBucket, iFrameCount / 2) == false);
+
+    size_t iFrame = 0;
+    while (iFrame < iFrameCount)
+    {
+        size_t iChunkFrameCount = 1 + random() % 3000;
+        if (iChunkFrameCount > iFrameCount - iFrame)
+        {
+            iChunkFrameCount = iFrameCount - iFrame;
+        }
+
+        decimator.process(vSamples.data() + iFrame * iChannels, iChunkFrameCount);
+
+        iFrame += iChunkFrameCount;
+    }
+
+    decimator.flush();
+
+    return decimator.takePeaks();
+}
+
+static void testMatchesReference()
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    const unsigned short vChannels[]     = {1, 2, 3, 6};
+    const size_t         vBucketSizes[]  = {1, 3, 64, 1000, 1801};
+
+    for (unsigned short iChannels : vChannels)
+    {
+        for (size_t iFramesPerBucket : vBucketSizes)
+        {
+            std::vector<float> vSamples((44100 + 17) * iChannels);
+            for (float& fSample : vSamples)
+            {
+                fSample = distribution(random);
+            }
+
+            const std::vector<float> vPeaks     = decimate(vSamples, iChannels, iFramesPerBucket, random);
+            const std::vector<float> vReference = getReferencePeaks(vSamples, iChannels, iFramesPerBucket);
+
+            XCHECK(vPeaks.size() == vReference.size());
+            if (vPeaks.size() != vReference.size())
+            {
+                continue;
+            }
+
+            if (iChannels == 1)
+            {
+                // Nothing to fold, must be the same as before.
+                XCHECK(vPeaks == vReference);
+            }
+            else
+            {
+                // The true envelope, it always covers the old (folded) peaks.
+                XCHECK(vPeaks == getEnvelopePeaks(vSamples, iChannels, iFramesPerBucket));
+
+                bool bCovers = true;
+                for (size_t i = 0; i < vPeaks.size(); i += 2)
+                {
+                    bCovers = bCovers && vPeaks[i] <= vReference[i] && vPeaks[i + 1] >= vReference[i + 1];
+                }
+
+                XCHECK(bCovers);
+            }
+        }
+    }
+}
+
+static void testSine()
+{
+    // A full period in every bucket gives (-amplitude, amplitude).
+
+    const size_t iFramesPerBucket = 100;
+
+    std::vector<float> vSamples(iFramesPerBucket * 10);
+    for (size_t i = 0; i < vSamples.size(); i++)
+    {
+        vSamples[i] = 0.5f * static_cast<float>(std::sin(2.0 * 3.14159265358979 * (i + 0.5) / iFramesPerBucket));
+    }
+
+    std::mt19937 random(1);
+    const std::vector<float> vPeaks = decimate(vSamples, 1, iFramesPerBucket, random);
+
+    XCHECK(vPeaks.size() == 20);
+    for (size_t i = 0; i < vPeaks.size(); i += 2)
+    {
+        XCHECK(std::fabs(vPeaks[i] + 0.5f) < 0.001f);
+        XCHECK(std::fabs(vPeaks[i + 1] - 0.5f) < 0.001f);
+    }
+}
+
+static void testInvalidSetup()
+{
+    SWaveDecimator decimator;
+
+    XCHECK(decimator.setup(0, 100, 1000));
+    XCHECK(decimator.setup(2, 0, 1000));
+}
+
+int main()
+{
+    testMatchesReference();
+    testSine();
+    testInvalidSetup();
+
+    return finishTest();
+}
@@ -0,0 +1,122 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Decode throughput (realtime factor) of SDecoder::openFile() for every WAV sample format and both output formats.
+// MP3 and OGG are decoded by SMFDecoder (Media Foundation) and can only be measured on Windows.
+//
+// Usage: SWaveDecoderBenchmark [track length in sec (default 300)]
+
+// STL
+#include <cmath>
+#include <memory>
+#include <cstdlib>
+
+// Custom
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int   iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+
+int main(int argc, char* argv[])
+{
+    const double dLengthInSec = argc > 1 ? std::atof(argv[1]) : 300.0;
+    const unsigned long long iFrameCount = static_cast<unsigned long long>(dLengthInSec * iSampleRate);
+
+    const std::filesystem::path dir = getTestDirectory(L"SWaveDecoderBenchmark");
+
+    struct Format
+    {
+        unsigned short iFormatTag;
+        unsigned short iBitsPerSample;
+        const char*    pName;
+    };
+
+    const Format vFormats[] = {{1, 8, "pcm8"}, {1, 16, "pcm16"}, {1, 24, "pcm24"}, {1, 32, "pcm32"}, {3, 32, "float32"}};
+
+    const S_SAMPLE_FORMAT vOutputFormats[] = {SF_INT16, SF_FLOAT32};
+
+    // Same as the streaming buffers (about 1/7 s).
+    const size_t iChunkFrameCount = iSampleRate / 7;
+
+    std::printf("%-8s %-8s %12s %12s\n", "input", "output", "realtime x", "MB/s in");
+
+    int iResult = 0;
+
+    for (const Format& format : vFormats)
+    {
+        const std::filesystem::path path = dir / (std::string(format.pName) + ".wav");
+
+        if (writeWaveFile(path, format.iFormatTag, format.iBitsPerSample, iChannels, iSampleRate, iFrameCount,
+                          [](unsigned long long iFrame, unsigned short iChannel)
+                          {
+                              return 0.5 * std::sin(iFrame * 0.0627 + iChannel);
+                          }))
+        {
+            std::printf("failed to write the file\n");
+            return 1;
+        }
+
+        for (S_SAMPLE_FORMAT outputFormat : vOutputFormats)
+        {
+            TestTimer timer;
+
+            std::unique_ptr<SDecoder> pDecoder(SDecoder::openFile(path.wstring(), outputFormat));
+            if (pDecoder == nullptr)
+            {
+                std::printf("failed to open %s\n", format.pName);
+                iResult = 1;
+                continue;
+            }
+
+            std::vector<unsigned char> vBuffer(iChunkFrameCount * pDecoder->getOutputBlockAlign());
+
+            unsigned long long iDecodedFrameCount = 0;
+
+            while (true)
+            {
+                size_t iReadFrameCount = 0;
+                if (pDecoder->read(vBuffer.data(), iChunkFrameCount, iReadFrameCount))
+                {
+                    std::printf("failed to decode %s\n", format.pName);
+                    iResult = 1;
+                    break;
+                }
+
+                iDecodedFrameCount += iReadFrameCount;
+
+                if (iReadFrameCount < iChunkFrameCount)
+                {
+                    break;
+                }
+            }
+
+            const double dTimeInSec = timer.getElapsedInMs() / 1000.0;
+
+            if (iDecodedFrameCount != iFrameCount)
+            {
+                std::printf("decoded %llu frames instead of %llu\n", iDecodedFrameCount, iFrameCount);
+                iResult = 1;
+            }
+
+            const double dInputSizeInMB = iFrameCount * iChannels * (format.iBitsPerSample / 8) / (1024.0 * 1024.0);
+
+            std::printf("%-8s %-8s %12.0f %12.0f\n", format.pName, outputFormat == SF_INT16 ? "int16" : "float32",
+                        dLengthInSec / dTimeInSec, dInputSizeInMB / dTimeInSec);
+        }
+
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return iResult;
+}
@@ -0,0 +1,244 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// STL
+#include <cmath>
+
+// Custom
+#include "Model/AudioEngine/SWaveFile/swavefile.h"
+#include "Model/AudioEngine/SFileHandleCache/sfilehandlecache.h"
+#include "Model/AudioEngine/SSampleConverter/ssampleconverter.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int iSampleRate = 44100;
+
+
+static double getTestSample(unsigned long long iFrame, unsigned short iChannel)
+{
+    return 0.8 * std::sin(iFrame * 0.05 + iChannel);
+}
+
+static void testFormat(unsigned short iFormatTag, unsigned short iBitsPerSample, unsigned short iChannels)
+{
+    std::printf("format %u, %u bit, %u channel(s)\n", iFormatTag, iBitsPerSample, iChannels);
+
+    const std::filesystem::path dir = getTestDirectory(L"SWaveFileTest");
+    const std::filesystem::path path = dir / L"test.wav";
+
+    const size_t iFrameCount = 1001;
+
+    XCHECK(writeWaveFile(path, iFormatTag, iBitsPerSample, iChannels, iSampleRate, iFrameCount, getTestSample) == false);
+
+
+    SWaveFile waveFile;
+    XCHECK(waveFile.isOpen() == false);
+    XCHECK(waveFile.open(path.wstring()) == false);
+    XCHECK(waveFile.isOpen());
+
+    const SWaveFormat& format = waveFile.getFormat();
+
+    XCHECK(format.iFormatTag == iFormatTag);
+    XCHECK(format.iBitsPerSample == iBitsPerSample);
+    XCHECK(format.iChannels == iChannels);
+    XCHECK(format.iSampleRate == iSampleRate);
+    XCHECK(format.iBlockAlign == iChannels * iBitsPerSample / 8);
+
+    XCHECK(waveFile.getFrameCount() == iFrameCount);
+    XCHECK(waveFile.getDataSizeInBytes() == iFrameCount * format.iBlockAlign);
+    XCHECK(std::fabs(waveFile.getLengthInSec() - iFrameCount / static_cast<double>(iSampleRate)) < 0.000001);
+    XCHECK(waveFile.getFileSizeInBytes() == std::filesystem::file_size(path));
+
+    XCHECK(waveFile.getFrame(0) == waveFile.getData());
+    XCHECK(waveFile.getFrame(10) == waveFile.getData() + 10 * format.iBlockAlign);
+    XCHECK(waveFile.getFrame(iFrameCount) == nullptr);
+
+
+    // The samples are the same as the written ones.
+
+    S_SAMPLE_FORMAT sampleFormat = SF_INT16;
+    XCHECK(SSampleConverter::getSampleFormat(format.iBitsPerSample, format.iFormatTag == WFT_IEEE_FLOAT, sampleFormat) == false);
+
+    std::vector<float> vSamples(iFrameCount * iChannels);
+    SSampleConverter::convertToFloat(waveFile.getData(), vSamples.size(), sampleFormat, vSamples.data());
+
+    const double dMaxError = (iBitsPerSample == 8) ? 2.0 / 128 : 2.0 / 32768;
+
+    bool bSame = true;
+    for (size_t i = 0; i < iFrameCount; i++)
+    {
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            bSame = bSame && std::fabs(vSamples[i * iChannels + c] - getTestSample(i, c)) < dMaxError;
+        }
+    }
+
+    XCHECK(bSame);
+
+
+    waveFile.close();
+    XCHECK(waveFile.isOpen() == false);
+    XCHECK(waveFile.getData() == nullptr);
+}
+
+static void writeBytes(const std::filesystem::path& path, const std::vector<unsigned char>& vBytes)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(vBytes.data()), static_cast<std::streamsize>(vBytes.size()));
+}
+
+static void append16(std::vector<unsigned char>& vBytes, uint16_t iValue)
+{
+    vBytes.push_back(static_cast<unsigned char>(iValue & 0xFF));
+    vBytes.push_back(static_cast<unsigned char>(iValue >> 8));
+}
+
+static void append32(std::vector<unsigned char>& vBytes, uint32_t iValue)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        vBytes.push_back(static_cast<unsigned char>((iValue >> (8 * i)) & 0xFF));
+    }
+}
+
+static void appendTag(std::vector<unsigned char>& vBytes, const char* pTag)
+{
+    vBytes.insert(vBytes.end(), pTag, pTag + 4);
+}
+
+static void testExtensibleWithJunk()
+{
+    // WAVE_FORMAT_EXTENSIBLE (float) with a "JUNK" chunk of odd size before "fmt ".
+
+    const std::filesystem::path dir = getTestDirectory(L"SWaveFileTest");
+    const std::filesystem::path path = dir / L"extensible.wav";
+
+    const unsigned short iChannels = 6;
+    const uint32_t iFrameCount = 100;
+    const uint32_t iDataSize = iFrameCount * iChannels * 4;
+
+    std::vector<unsigned char> vBytes;
+    appendTag(vBytes, "RIFF");
+    append32(vBytes, 0);
+    appendTag(vBytes, "WAVE");
+
+    appendTag(vBytes, "JUNK");
+    append32(vBytes, 3);
+    vBytes.insert(vBytes.end(), {1, 2, 3, 0}); // padded to an even size
+
+    appendTag(vBytes, "fmt ");
+    append32(vBytes, 40);
+    append16(vBytes, 0xFFFE);
+    append16(vBytes, iChannels);
+    append32(vBytes, iSampleRate);
+    append32(vBytes, iSampleRate * iChannels * 4);
+    append16(vBytes, iChannels * 4);
+    append16(vBytes, 32);
+    append16(vBytes, 22);
+    append16(vBytes, 32);
+    append32(vBytes, 0x3F);
+    append32(vBytes, 3); // KSDATAFORMAT_SUBTYPE_IEEE_FLOAT
+    vBytes.insert(vBytes.end(), {0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71});
+
+    appendTag(vBytes, "data");
+    append32(vBytes, iDataSize);
+    vBytes.resize(vBytes.size() + iDataSize, 0);
+
+    writeBytes(path, vBytes);
+
+
+    SWaveFile waveFile;
+    XCHECK(waveFile.open(path.wstring()) == false);
+    XCHECK(waveFile.getFormat().iFormatTag == WFT_IEEE_FLOAT);
+    XCHECK(waveFile.getFormat().iChannels == iChannels);
+    XCHECK(waveFile.getFrameCount() == iFrameCount);
+
+
+    // The "data" size is larger than the file (the file was cut), only the existing frames are used.
+
+    vBytes.resize(vBytes.size() - iDataSize / 2);
+    writeBytes(path, vBytes);
+
+    waveFile.close();
+    XCHECK(waveFile.open(path.wstring()) == false);
+    XCHECK(waveFile.getFrameCount() == iFrameCount / 2);
+}
+
+static void testInvalidFiles()
+{
+    const std::filesystem::path dir = getTestDirectory(L"SWaveFileTest");
+
+    SWaveFile waveFile;
+
+    XCHECK(waveFile.open((dir / L"missing.wav").wstring()));
+
+
+    // Not a RIFF file.
+    writeBytes(dir / L"text.wav", std::vector<unsigned char>(100, 'a'));
+    XCHECK(waveFile.open((dir / L"text.wav").wstring()));
+
+    // Empty.
+    writeBytes(dir / L"empty.wav", std::vector<unsigned char>());
+    XCHECK(waveFile.open((dir / L"empty.wav").wstring()));
+
+
+    // Compressed (ADPCM).
+    std::vector<unsigned char> vBytes;
+    appendTag(vBytes, "RIFF");
+    append32(vBytes, 0);
+    appendTag(vBytes, "WAVE");
+    appendTag(vBytes, "fmt ");
+    append32(vBytes, 16);
+    append16(vBytes, 2);
+    append16(vBytes, 2);
+    append32(vBytes, iSampleRate);
+    append32(vBytes, iSampleRate * 4);
+    append16(vBytes, 4);
+    append16(vBytes, 4);
+    appendTag(vBytes, "data");
+    append32(vBytes, 16);
+    vBytes.resize(vBytes.size() + 16, 0);
+
+    writeBytes(dir / L"adpcm.wav", vBytes);
+    XCHECK(waveFile.open((dir / L"adpcm.wav").wstring()));
+
+    XCHECK(waveFile.isOpen() == false);
+}
+
+static void testFileCache()
+{
+    const std::filesystem::path dir = getTestDirectory(L"SWaveFileTest");
+    const std::filesystem::path path = dir / L"cached.wav";
+
+    XCHECK(writeWaveFile(path, 1, 16, 2, iSampleRate, 1000, getTestSample) == false);
+
+    SFileHandleCache cache;
+
+    SWaveFile first;
+    SWaveFile second;
+    XCHECK(first.open(path.wstring(), &cache) == false);
+    XCHECK(second.open(path.wstring(), &cache) == false);
+
+    // The same mapping.
+    XCHECK(first.getData() == second.getData());
+}
+
+int main()
+{
+    testFormat(1, 8, 1);
+    testFormat(1, 16, 2);
+    testFormat(1, 24, 2);
+    testFormat(1, 32, 2);
+    testFormat(3, 32, 2);
+    testFormat(1, 16, 6);
+
+    testExtensibleWithJunk();
+    testInvalidFiles();
+    testFileCache();
+
+    return finishTest();
+}
@@ -0,0 +1,288 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// The cost of opening the decoder of the next track and decoding its first streaming buffer at the switch,
+// that is the part of the gap between two tracks that prefetching the next track removes.
+// This is not the end-to-end gap of the player: starting the XAudio2 voice (and the rest of AudioCore) is not here.
+//
+// The time of the switch is written to a WAV-file sink as silent frames (as the device would play silence),
+// every track is a tone that never crosses zero, so the time is the run of silent frames between two tracks.
+//
+// Modes:
+//   open at switch - the next track is opened and its first streaming buffer is decoded after the current one ended
+//                    (SSound::loadAudioFile() + playSound() from AudioCore::onCurrentTrackEnded() without prefetching),
+//   opened before  - the same is done while the current track plays (as SSound::preloadSound() does),
+//                    nothing is left to do at the switch here, so this mode is 0 by construction and only checks the switches.
+//
+// Usage: NextTrackOpenBenchmark [track count (default 20)]
+
+// STL
+#include <cmath>
+#include <thread>
+#include <memory>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+
+// Custom
+#include "Model/AudioEngine/SDecoder/sdecoder.h"
+#include "Model/AudioEngine/SWaveFile/swavefile.h"
+#include "Model/AudioEngine/SWaveFileSink/swavefilesink.h"
+#include "TestUtils/testutils.h"
+
+
+static const unsigned int   iSampleRate = 44100;
+static const unsigned short iChannels   = 2;
+
+// Like SSound with the default buffering (1 second of read-ahead over 7 queued buffers).
+static const size_t iStreamingBufferFrameCount = iSampleRate / 7;
+
+
+// A track opened for playback: the decoder and its first streaming buffer.
+struct TestTrack
+{
+    std::unique_ptr<SDecoder> pDecoder;
+    std::vector<float>        vFirstBuffer;
+};
+
+static bool openTrack(const std::filesystem::path& path, TestTrack& track)
+{
+    // The decoder thread is started like in SSound::playSound().
+    bool bError = false;
+
+    std::thread decoderThread([&]()
+    {
+        track.pDecoder.reset(SDecoder::openFile(path.wstring(), SF_FLOAT32));
+        if (track.pDecoder == nullptr)
+        {
+            bError = true;
+            return;
+        }
+
+        track.vFirstBuffer.resize(iStreamingBufferFrameCount * iChannels);
+
+        size_t iReadFrameCount = 0;
+        if (track.pDecoder->read(reinterpret_cast<unsigned char*>(track.vFirstBuffer.data()), iStreamingBufferFrameCount, iReadFrameCount))
+        {
+            bError = true;
+            return;
+        }
+
+        track.vFirstBuffer.resize(iReadFrameCount * iChannels);
+    });
+
+    decoderThread.join();
+
+    return bError;
+}
+
+static bool playTrack(TestTrack& track, SWaveFileSink& sink)
+{
+    if (sink.write(track.vFirstBuffer.data(), track.vFirstBuffer.size() / iChannels))
+    {
+        return true;
+    }
+
+    std::vector<float> vBuffer(iStreamingBufferFrameCount * iChannels);
+
+    while (true)
+    {
+        size_t iReadFrameCount = 0;
+        if (track.pDecoder->read(reinterpret_cast<unsigned char*>(vBuffer.data()), iStreamingBufferFrameCount, iReadFrameCount))
+        {
+            return true;
+        }
+
+        if (sink.write(vBuffer.data(), iReadFrameCount))
+        {
+            return true;
+        }
+
+        if (iReadFrameCount < iStreamingBufferFrameCount)
+        {
+            return false;
+        }
+    }
+}
+
+static bool writeSilence(SWaveFileSink& sink, double dTimeInMs)
+{
+    const size_t iFrameCount = static_cast<size_t>(std::llround(dTimeInMs * iSampleRate / 1000.0));
+
+    const std::vector<float> vSilence(iFrameCount * iChannels, 0.0f);
+
+    return sink.write(vSilence.data(), iFrameCount);
+}
+
+static bool runMode(const std::vector<std::filesystem::path>& vTracks, const std::filesystem::path& outputPath, bool bPrefetch)
+{
+    SWaveFileSink sink(outputPath.wstring());
+    if (sink.open({iSampleRate, iChannels}))
+    {
+        return true;
+    }
+
+    TestTrack current;
+    if (openTrack(vTracks[0], current))
+    {
+        return true;
+    }
+
+    for (size_t i = 0; i < vTracks.size(); i++)
+    {
+        TestTrack next;
+
+        if (bPrefetch && i + 1 < vTracks.size())
+        {
+            // Done a few seconds before the end, not on the clock.
+            if (openTrack(vTracks[i + 1], next))
+            {
+                return true;
+            }
+        }
+
+        if (playTrack(current, sink))
+        {
+            return true;
+        }
+
+        if (i + 1 == vTracks.size())
+        {
+            break;
+        }
+
+
+        // The current track ended.
+
+        TestTimer timer;
+
+        if (bPrefetch == false && openTrack(vTracks[i + 1], next))
+        {
+            return true;
+        }
+
+        current = std::move(next);
+
+        if (writeSilence(sink, timer.getElapsedInMs()))
+        {
+            return true;
+        }
+    }
+
+    return sink.close();
+}
+
+// Returns the silent gaps (in frames) between the tracks in the file.
+static std::vector<size_t> findGaps(const std::filesystem::path& path)
+{
+    std::vector<size_t> vGaps;
+
+    SWaveFile output;
+    if (output.open(path.wstring()))
+    {
+        return vGaps;
+    }
+
+    const float* pSamples = reinterpret_cast<const float*>(output.getData());
+
+    size_t iSilentFrameCount = 0;
+    bool bInTrack = false;
+
+    for (size_t i = 0; i < output.getFrameCount(); i++)
+    {
+        if (std::fabs(pSamples[i * iChannels]) < 0.01f)
+        {
+            iSilentFrameCount++;
+            continue;
+        }
+
+        if (bInTrack && iSilentFrameCount > 0)
+        {
+            vGaps.push_back(iSilentFrameCount);
+        }
+        else if (bInTrack && i > 0 && std::fabs(pSamples[i * iChannels] - pSamples[(i - 1) * iChannels]) > 0.1f)
+        {
+            // Neighbour tracks have different levels, a jump without silence is a gapless switch.
+            vGaps.push_back(0);
+        }
+
+        bInTrack = true;
+        iSilentFrameCount = 0;
+    }
+
+    return vGaps;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t iTrackCount = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 20;
+
+    const std::filesystem::path dir = getTestDirectory(L"NextTrackOpenBenchmark");
+
+
+    // 16-bit tracks of 0.5-1.5 seconds, a slow tone above zero, every other track at a different level.
+
+    std::vector<std::filesystem::path> vTracks;
+
+    for (size_t i = 0; i < iTrackCount; i++)
+    {
+        const std::filesystem::path path = dir / (L"track" + std::to_wstring(i) + L".wav");
+
+        const unsigned long long iFrameCount = iSampleRate / 2 + (i * 7919) % iSampleRate;
+
+        const double dLevel = (i % 2 == 0) ? 0.3 : 0.7;
+
+        if (writeWaveFile(path, 1, 16, iChannels, iSampleRate, iFrameCount,
+                          [dLevel](unsigned long long iFrame, unsigned short)
+                          {
+                              return dLevel + 0.05 * std::cos(iFrame * 0.001);
+                          }))
+        {
+            std::printf("failed to write the tracks\n");
+            return 1;
+        }
+
+        vTracks.push_back(path);
+    }
+
+
+    std::printf("%-15s %14s %12s %10s\n", "mode", "median open", "max open", "switches");
+
+    int iResult = 0;
+
+    const bool vModes[] = {false, true};
+
+    for (bool bPrefetch : vModes)
+    {
+        const std::filesystem::path outputPath = dir / (bPrefetch ? L"opened-before.wav" : L"open-at-switch.wav");
+
+        if (runMode(vTracks, outputPath, bPrefetch))
+        {
+            std::printf("failed to render\n");
+            iResult = 1;
+            continue;
+        }
+
+        std::vector<size_t> vGaps = findGaps(outputPath);
+        if (vGaps.size() != iTrackCount - 1)
+        {
+            std::printf("found %zu switches instead of %zu\n", vGaps.size(), iTrackCount - 1);
+            iResult = 1;
+            continue;
+        }
+
+        std::sort(vGaps.begin(), vGaps.end());
+
+        std::printf("%-15s %11.3f ms %9.3f ms %10zu\n", bPrefetch ? "opened before" : "open at switch",
+                    vGaps[vGaps.size() / 2] * 1000.0 / iSampleRate, vGaps.back() * 1000.0 / iSampleRate, vGaps.size());
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return iResult;
+}
@@ -0,0 +1,263 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// The stop handshake that AudioCore uses for the graph drawing thread: a stop requested before
+// the thread runs is not lost, every waiter waits for the same thread, a task started while
+// stopAndWaitUnlocked() waits is stopped too, and the waiting does not block the other users of the mutex
+// (as waiting for the future under the mutex does).
+//
+// Usage: StoppableTaskTest [stop delay in ms (default 100)]
+
+// STL
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <algorithm>
+
+// Custom
+#include "Model/StoppableTask/stoppabletask.h"
+#include "TestUtils/testutils.h"
+
+
+// Works until asked to stop, then needs 'iStopDelayInMs' to finish (as the draw thread decodes the rest of its chunk).
+static void runTask(StoppableTask& task, std::promise<bool> promiseFinish, unsigned long long iTaskID, int iStopDelayInMs,
+                    std::atomic<int>& iChecksBeforeStop, std::atomic<int>& iFinishedCount)
+{
+    while (task.isStopRequested(iTaskID) == false)
+    {
+        iChecksBeforeStop++;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(iStopDelayInMs));
+
+    iFinishedCount++;
+
+    promiseFinish.set_value(false);
+}
+
+static void startTask(StoppableTask& task, int iStopDelayInMs, std::atomic<int>& iChecksBeforeStop, std::atomic<int>& iFinishedCount)
+{
+    unsigned long long iTaskID = 0;
+    std::promise<bool> promiseFinish = task.start(iTaskID);
+
+    std::thread t(runTask, std::ref(task), std::move(promiseFinish), iTaskID, iStopDelayInMs, std::ref(iChecksBeforeStop), std::ref(iFinishedCount));
+    t.detach();
+}
+
+
+static void testNotStarted()
+{
+    StoppableTask task;
+
+    XCHECK(task.stop().valid() == false);
+
+    std::mutex mtx;
+    std::unique_lock<std::mutex> lock(mtx);
+
+    task.stopAndWaitUnlocked(lock);
+
+    XCHECK(lock.owns_lock());
+}
+
+static void testStopBeforeThreadRuns()
+{
+    StoppableTask task;
+
+    std::atomic<int> iChecksBeforeStop(0);
+    std::atomic<int> iFinishedCount(0);
+
+    unsigned long long iTaskID = 0;
+    std::promise<bool> promiseFinish = task.start(iTaskID);
+    std::shared_future<bool> futureStopped = task.stop();
+
+    std::thread t(runTask, std::ref(task), std::move(promiseFinish), iTaskID, 0, std::ref(iChecksBeforeStop), std::ref(iFinishedCount));
+
+    XCHECK(futureStopped.valid());
+    futureStopped.get();
+
+    XCHECK(iChecksBeforeStop == 0);
+    XCHECK(iFinishedCount == 1);
+
+    t.join();
+}
+
+static void testFinishedByItself()
+{
+    StoppableTask task;
+
+    unsigned long long iTaskID = 0;
+    std::promise<bool> promiseFinish = task.start(iTaskID);
+
+    XCHECK(task.isStopRequested(iTaskID) == false);
+
+    std::thread t([&task, &promiseFinish, iTaskID]()
+    {
+        task.markFinished(iTaskID);
+        promiseFinish.set_value(false);
+    });
+    t.join();
+
+    XCHECK(task.isStopRequested(iTaskID));
+
+    std::shared_future<bool> futureStopped = task.stop();
+    XCHECK(futureStopped.valid() && futureStopped.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+}
+
+static void testNextTaskStopsPrevious()
+{
+    StoppableTask task;
+
+    unsigned long long iFirstID = 0;
+    std::promise<bool> promiseFirst = task.start(iFirstID);
+
+    task.stop();
+
+    // Started before the first task has checked the stop.
+    unsigned long long iSecondID = 0;
+    std::promise<bool> promiseSecond = task.start(iSecondID);
+
+    XCHECK(iFirstID != iSecondID);
+    XCHECK(task.isStopRequested(iFirstID));
+    XCHECK(task.isStopRequested(iSecondID) == false);
+
+    // The first task finishing late does not finish the second one.
+    task.markFinished(iFirstID);
+    XCHECK(task.isStopRequested(iSecondID) == false);
+
+    promiseFirst.set_value(false);
+    promiseSecond.set_value(false);
+}
+
+static void testSameThreadForEveryWaiter(int iStopDelayInMs)
+{
+    StoppableTask task;
+
+    std::atomic<int> iChecksBeforeStop(0);
+    std::atomic<int> iFinishedCount(0);
+
+    startTask(task, iStopDelayInMs, iChecksBeforeStop, iFinishedCount);
+
+    std::atomic<int> iWaitedCount(0);
+
+    std::thread waiter1([&]() { task.stop().get(); XCHECK(iFinishedCount == 1); iWaitedCount++; });
+    std::thread waiter2([&]() { task.stop().get(); XCHECK(iFinishedCount == 1); iWaitedCount++; });
+
+    waiter1.join();
+    waiter2.join();
+
+    XCHECK(iWaitedCount == 2);
+}
+
+// Returns the longest time another thread waited for 'mtx' while the task was stopped.
+static double stopUnderMutex(bool bWaitUnlocked, int iStopDelayInMs, bool bStartAnotherDuringWait)
+{
+    StoppableTask task;
+    std::mutex mtx;
+
+    std::atomic<int> iChecksBeforeStop(0);
+    std::atomic<int> iFinishedCount(0);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        startTask(task, iStopDelayInMs, iChecksBeforeStop, iFinishedCount);
+    }
+
+    std::atomic<bool> bStop(false);
+    std::atomic<bool> bStartedAnother(false);
+    std::atomic<bool> bWaiting(false);
+    double dMaxLockInMs = 0.0;
+
+    // Another user of the mutex (the transport, the import).
+    std::thread other([&]()
+    {
+        while (bStop == false)
+        {
+            TestTimer timer;
+
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+
+                if (bStartAnotherDuringWait && bStartedAnother == false && bWaiting)
+                {
+                    // As another playTrack() would.
+                    startTask(task, iStopDelayInMs, iChecksBeforeStop, iFinishedCount);
+
+                    bStartedAnother = true;
+                }
+            }
+
+            dMaxLockInMs = std::max(dMaxLockInMs, timer.getElapsedInMs());
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+
+    std::unique_lock<std::mutex> lock(mtx);
+
+    bWaiting = true;
+
+    if (bWaitUnlocked)
+    {
+        task.stopAndWaitUnlocked(lock);
+
+        XCHECK(lock.owns_lock());
+
+        // Every task started under the mutex has finished.
+        XCHECK(iFinishedCount == (bStartAnotherDuringWait ? 2 : 1));
+        XCHECK(bStartedAnother == bStartAnotherDuringWait);
+    }
+    else
+    {
+        task.stop().get();
+
+        XCHECK(iFinishedCount == 1);
+    }
+
+    lock.unlock();
+
+
+    bStop = true;
+    other.join();
+
+    // The other thread may have started a task after the wait (not the case above).
+    task.stop().get();
+
+    return dMaxLockInMs;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const int iStopDelayInMs = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    testNotStarted();
+    testStopBeforeThreadRuns();
+    testFinishedByItself();
+    testNextTaskStopsPrevious();
+    testSameThreadForEveryWaiter(iStopDelayInMs);
+
+
+    const double dUnderMutexInMs = stopUnderMutex(false, iStopDelayInMs, false);
+    const double dUnlockedInMs = stopUnderMutex(true, iStopDelayInMs, false);
+    stopUnderMutex(true, iStopDelayInMs, true);
+
+    std::printf("%-22s %18s\n", "stop", "max other lock ms");
+    std::printf("%-22s %18.1f\n", "wait under the mutex", dUnderMutexInMs);
+    std::printf("%-22s %18.1f\n", "stopAndWaitUnlocked", dUnlockedInMs);
+
+    // The stop delay is the stall of waiting under the mutex, half of it leaves enough room for the scheduler.
+    XCHECK(dUnderMutexInMs >= iStopDelayInMs * 0.9);
+    XCHECK(dUnlockedInMs < iStopDelayInMs * 0.5);
+
+    return finishTest();
+}
@@ -0,0 +1,250 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+// Test helpers shared by the tests and benchmarks, everything is header-only
+// so that every test is a single source file.
+
+
+inline int& getTestFailureCount()
+{
+    static int iFailureCount = 0;
+
+    return iFailureCount;
+}
+
+// Logs and counts a failed check but continues the test.
+#define XCHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            getTestFailureCount()++; \
+        } \
+    } while (false)
+
+// Returns the exit code of the test.
+inline int finishTest()
+{
+    if (getTestFailureCount() != 0)
+    {
+        std::printf("%d check(s) failed\n", getTestFailureCount());
+        return 1;
+    }
+
+    std::printf("all checks passed\n");
+    return 0;
+}
+
+
+// Returns an empty directory in the temp directory.
+inline std::filesystem::path getTestDirectory(const std::wstring& sTestName)
+{
+    std::error_code ec;
+
+    std::filesystem::path path = std::filesystem::temp_directory_path(ec) / L"XanderTests" / sTestName;
+
+    std::filesystem::remove_all(path, ec);
+    std::filesystem::create_directories(path, ec);
+
+    return path;
+}
+
+
+// 'getSample' returns the sample of the frame 'iFrame' and channel 'iChannel' normalized in [-1.0, 1.0].
+// 'iFormatTag' is 1 (PCM) or 3 (IEEE float), 'iBitsPerSample' is 8, 16, 24 or 32.
+// The data is written in chunks so huge files can be generated too.
+// Returns 'true' if failed.
+inline bool writeWaveFile(const std::filesystem::path& path, unsigned short iFormatTag, unsigned short iBitsPerSample,
+                          unsigned short iChannels, unsigned int iSampleRate, unsigned long long iFrameCount,
+                          const std::function<double(unsigned long long iFrame, unsigned short iChannel)>& getSample)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+    auto write16 = [&](uint16_t iValue)
+    {
+        file.put(static_cast<char>(iValue & 0xFF));
+        file.put(static_cast<char>(iValue >> 8));
+    };
+    auto write32 = [&](uint32_t iValue)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            file.put(static_cast<char>((iValue >> (8 * i)) & 0xFF));
+        }
+    };
+
+    const uint32_t iBlockAlign = iChannels * (iBitsPerSample / 8);
+    const uint32_t iDataSize = static_cast<uint32_t>(iFrameCount * iBlockAlign);
+
+    file.write("RIFF", 4);
+    write32(36 + iDataSize);
+    file.write("WAVE", 4);
+
+    file.write("fmt ", 4);
+    write32(16);
+    write16(iFormatTag);
+    write16(iChannels);
+    write32(iSampleRate);
+    write32(iSampleRate * iBlockAlign);
+    write16(static_cast<uint16_t>(iBlockAlign));
+    write16(iBitsPerSample);
+
+    file.write("data", 4);
+    write32(iDataSize);
+
+
+    const unsigned long long iChunkFrameCount = 65536;
+
+    std::vector<unsigned char> vData;
+    vData.reserve(iChunkFrameCount * iBlockAlign);
+
+    for (unsigned long long iFrame = 0; iFrame < iFrameCount; iFrame++)
+    {
+        for (unsigned short c = 0; c < iChannels; c++)
+        {
+            double dSample = getSample(iFrame, c);
+            if (dSample > 1.0)  dSample = 1.0;
+            if (dSample < -1.0) dSample = -1.0;
+
+            if (iFormatTag == 3)
+            {
+                const float fSample = static_cast<float>(dSample);
+                unsigned char vBytes[4];
+                std::memcpy(vBytes, &fSample, sizeof(fSample));
+                vData.insert(vData.end(), vBytes, vBytes + 4);
+
+                continue;
+            }
+
+            switch (iBitsPerSample)
+            {
+            case(8):
+            {
+                vData.push_back(static_cast<unsigned char>(static_cast<int>(dSample * 127.0) + 128));
+                break;
+            }
+            case(16):
+            {
+                const int32_t iSample = static_cast<int32_t>(dSample * 32767.0);
+                vData.push_back(static_cast<unsigned char>(iSample & 0xFF));
+                vData.push_back(static_cast<unsigned char>((iSample >> 8) & 0xFF));
+                break;
+            }
+            case(24):
+            {
+                const int32_t iSample = static_cast<int32_t>(dSample * 8388607.0);
+                vData.push_back(static_cast<unsigned char>(iSample & 0xFF));
+                vData.push_back(static_cast<unsigned char>((iSample >> 8) & 0xFF));
+                vData.push_back(static_cast<unsigned char>((iSample >> 16) & 0xFF));
+                break;
+            }
+            default:
+            {
+                const int32_t iSample = static_cast<int32_t>(dSample * 2147483647.0);
+                for (int b = 0; b < 4; b++)
+                {
+                    vData.push_back(static_cast<unsigned char>((iSample >> (8 * b)) & 0xFF));
+                }
+                break;
+            }
+            }
+        }
+
+        if (vData.size() >= iChunkFrameCount * iBlockAlign || iFrame + 1 == iFrameCount)
+        {
+            file.write(reinterpret_cast<const char*>(vData.data()), static_cast<std::streamsize>(vData.size()));
+            vData.clear();
+        }
+    }
+
+    return file.fail();
+}
+
+// 'vSamples' are interleaved.
+inline bool writeWaveFile(const std::filesystem::path& path, unsigned short iFormatTag, unsigned short iBitsPerSample,
+                          unsigned short iChannels, unsigned int iSampleRate, const std::vector<double>& vSamples)
+{
+    return writeWaveFile(path, iFormatTag, iBitsPerSample, iChannels, iSampleRate, vSamples.size() / iChannels,
+                         [&](unsigned long long iFrame, unsigned short iChannel)
+                         {
+                             return vSamples[iFrame * iChannels + iChannel];
+                         });
+}
+
+
+class TestTimer
+{
+public:
+
+    TestTimer()
+    {
+        start = std::chrono::steady_clock::now();
+    }
+
+    double getElapsedInMs() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void restart()
+    {
+        start = std::chrono::steady_clock::now();
+    }
+
+private:
+
+    std::chrono::steady_clock::time_point start;
+};
+
+
+// Peak resident memory of this process (in KB).
+inline size_t getPeakMemoryInKB()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == 0)
+    {
+        return 0;
+    }
+
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+}
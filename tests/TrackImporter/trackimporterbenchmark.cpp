@@ -0,0 +1,195 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Import throughput over a generated folder tree: the old serial import (open every file one by one,
+// the tracks are shown when all are opened) against TrackImporter with one thread and with the pool.
+// Reports the total time, the files per second and the time until the first batch can be shown.
+// The files are generated right before the run so they are in the OS file cache.
+//
+// Usage: TrackImporterBenchmark [file count (default 20000)] [files per folder (default 200)]
+
+// STL
+#include <thread>
+#include <cstdlib>
+#include <fstream>
+
+// Custom
+#include "Model/TrackImporter/trackimporter.h"
+#include "TestUtils/testutils.h"
+
+
+namespace fs = std::filesystem;
+
+
+struct ImportResult
+{
+    double dTotalInMs = 0.0;
+    double dFirstBatchInMs = 0.0;
+    size_t iTrackCount = 0;
+};
+
+
+// As AudioCore::addTracks() before TrackImporter (without the widgets).
+static ImportResult importSerial(const fs::path& dir)
+{
+    ImportResult result;
+
+    TestTimer timer;
+
+    std::vector<std::wstring> vFilePaths;
+
+    for (const auto& entry : fs::recursive_directory_iterator(dir))
+    {
+        if (entry.is_directory() == false &&
+                (entry.path().extension() == EXTENSION_MP3 || entry.path().extension() == EXTENSION_WAV || entry.path().extension() == EXTENSION_OGG))
+        {
+            vFilePaths.push_back(entry.path().wstring());
+        }
+    }
+
+    XTracklist vNewTracks;
+
+    for (size_t i = 0; i < vFilePaths.size(); i++)
+    {
+        std::ifstream file(fs::path(vFilePaths[i]), std::ios::binary);
+
+        if (file.is_open())
+        {
+            std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+
+            pAudio->sPathToAudioFile = vFilePaths[i];
+            pAudio->sAudioTitle = TrackImporter::getTrackTitle(vFilePaths[i]);
+            pAudio->sTrackExtension = TrackImporter::getTrackExtension(vFilePaths[i]);
+
+            vNewTracks.push_back(pAudio);
+        }
+    }
+
+    result.dTotalInMs = timer.getElapsedInMs();
+    result.dFirstBatchInMs = result.dTotalInMs;
+    result.iTrackCount = vNewTracks.size();
+
+    return result;
+}
+
+static ImportResult importWithImporter(const fs::path& dir, size_t iThreadCount, const std::vector<std::wstring>* pFiles)
+{
+    ImportResult result;
+
+    TrackImporter importer(IMPORT_BATCH_SIZE, iThreadCount);
+
+    TestTimer timer;
+
+    importer.setOnBatch([&](XTracklist& vBatch, size_t, size_t)
+    {
+        if (result.iTrackCount == 0)
+        {
+            result.dFirstBatchInMs = timer.getElapsedInMs();
+        }
+
+        result.iTrackCount += vBatch.size();
+    });
+
+    if (pFiles)
+    {
+        importer.importFiles(*pFiles);
+    }
+    else
+    {
+        importer.importFolder(dir.wstring());
+    }
+
+    result.dTotalInMs = timer.getElapsedInMs();
+
+    return result;
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iFileCount = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 20000;
+    size_t iFilesPerFolder = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 200;
+
+    if (iFilesPerFolder == 0)
+    {
+        iFilesPerFolder = 1;
+    }
+
+    const fs::path dir = getTestDirectory(L"TrackImporterBenchmark");
+
+    // Artist/Album/N - Track I.ext and a cover.jpg in every album (it should be skipped).
+
+    const char* vExtensions[] = {EXTENSION_MP3, EXTENSION_OGG, EXTENSION_WAV};
+
+    std::vector<std::wstring> vFiles;
+
+    const std::vector<char> vContent(4096, 0);
+
+    for (size_t i = 0; i < iFileCount; i++)
+    {
+        const size_t iFolder = i / iFilesPerFolder;
+
+        const fs::path folder = dir / ("Artist " + std::to_string(iFolder / 10)) / ("Album " + std::to_string(iFolder % 10));
+
+        if (i % iFilesPerFolder == 0)
+        {
+            fs::create_directories(folder);
+
+            std::ofstream cover(folder / "cover.jpg", std::ios::binary);
+            cover.write(vContent.data(), vContent.size());
+        }
+
+        const fs::path path = folder / (std::to_string(i % iFilesPerFolder) + " - Track " + std::to_string(i) + vExtensions[i % 3]);
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(vContent.data(), vContent.size());
+
+        if (file.fail())
+        {
+            std::printf("failed to write the files\n");
+            return 1;
+        }
+
+        vFiles.push_back(path.wstring());
+    }
+
+
+    std::printf("%zu files in %zu folders, batch size %d, %u CPU core(s)\n\n", iFileCount, (iFileCount + iFilesPerFolder - 1) / iFilesPerFolder,
+                IMPORT_BATCH_SIZE, std::thread::hardware_concurrency());
+
+    std::printf("%-28s %12s %12s %16s\n", "import", "total ms", "files/s", "first batch ms");
+
+    int iResult = 0;
+
+    auto print = [&](const char* pName, const ImportResult& result)
+    {
+        std::printf("%-28s %12.1f %12.0f %16.1f\n", pName, result.dTotalInMs, result.iTrackCount / (result.dTotalInMs / 1000.0), result.dFirstBatchInMs);
+
+        if (result.iTrackCount != iFileCount)
+        {
+            std::printf("imported %zu tracks instead of %zu\n", result.iTrackCount, iFileCount);
+            iResult = 1;
+        }
+    };
+
+    // Warm up the file cache (the metadata of the folders).
+    importSerial(dir);
+
+    print("serial (old)",            importSerial(dir));
+    print("folder, 1 thread",        importWithImporter(dir, 1, nullptr));
+    print("folder, thread per core", importWithImporter(dir, 0, nullptr));
+    print("files, 1 thread",         importWithImporter(dir, 1, &vFiles));
+    print("files, thread per core",  importWithImporter(dir, 0, &vFiles));
+
+    std::printf("\npeak memory: %zu KB\n", getPeakMemoryInKB());
+
+
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+
+    return iResult;
+}
@@ -0,0 +1,168 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Time and memory of the virtualized tracklist view (TrackListModel + TrackDelegate in a QListView
+// set up as in TrackList) for a big tracklist: showing it, scrolling, and the updates
+// after an appended batch, a removed track and a moved track.
+// Built only if Qt is found, run with QT_QPA_PLATFORM=offscreen on a machine without a display.
+//
+// Usage: TrackListViewBenchmark [track count (default 100000)] [scroll frames (default 300)]
+
+// Qt
+#include <QApplication>
+#include <QListView>
+#include <QScrollBar>
+
+// STL
+#include <random>
+#include <cstdlib>
+
+// Custom
+#include "View/TrackListModel/tracklistmodel.h"
+#include "View/TrackDelegate/trackdelegate.h"
+#include "TestUtils/testutils.h"
+
+
+// Lays out and draws the visible rows.
+static void render(QListView& view)
+{
+    QCoreApplication::processEvents();
+
+    view.viewport()->grab();
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iTrackCount = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000;
+    const size_t iScrollFrameCount = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 300;
+
+    QApplication app(argc, argv);
+
+
+    const size_t iStartMemoryInKB = getPeakMemoryInKB();
+
+    XTracklist vTracks;
+    vTracks.reserve(iTrackCount);
+
+    for (size_t i = 0; i < iTrackCount; i++)
+    {
+        std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+        pAudio->iTrackID = i + 1;
+        pAudio->sAudioTitle = L"Artist " + std::to_wstring(i % 500) + L" - Track " + std::to_wstring(i);
+        pAudio->sPathToAudioFile = L"/music/Artist " + std::to_wstring(i % 500) + L"/" + pAudio->sAudioTitle + L".mp3";
+        pAudio->sTrackExtension = L"mp3";
+
+        vTracks.push_back(pAudio);
+    }
+
+    std::shared_ptr<IndexedTracklist> pTracklist = std::make_shared<IndexedTracklist>();
+    pTracklist->append(vTracks);
+    vTracks.clear();
+
+    const size_t iTracklistMemoryInKB = getPeakMemoryInKB();
+
+
+    // As in TrackList.
+
+    QListView view;
+    TrackListModel model(&view);
+
+    view.setModel(&model);
+    view.setItemDelegate(new TrackDelegate(&view));
+    view.setUniformItemSizes(true);
+    view.setLayoutMode(QListView::Batched);
+    view.setSelectionMode(QAbstractItemView::NoSelection);
+    view.setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    view.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    view.setSpacing(2);
+    view.resize(500, 800);
+    view.show();
+
+    render(view);
+
+
+    std::printf("%zu tracks\n\n", iTrackCount);
+    std::printf("%-32s %12s\n", "operation", "ms");
+
+    TestTimer timer;
+    model.setTracklist(pTracklist);
+    render(view);
+    std::printf("%-32s %12.1f\n", "show the tracklist", timer.getElapsedInMs());
+
+    const size_t iViewMemoryInKB = getPeakMemoryInKB();
+
+
+    // Random jumps (the scroll bar is dragged) and small steps (the mouse wheel).
+
+    std::mt19937 random(1);
+    QScrollBar* pScrollBar = view.verticalScrollBar();
+    std::uniform_int_distribution<int> distribution(pScrollBar->minimum(), pScrollBar->maximum());
+
+    timer = TestTimer();
+    for (size_t i = 0; i < iScrollFrameCount; i++)
+    {
+        pScrollBar->setValue(distribution(random));
+        render(view);
+    }
+    std::printf("%-32s %12.3f\n", "scroll frame (jump)", timer.getElapsedInMs() / iScrollFrameCount);
+
+    timer = TestTimer();
+    for (size_t i = 0; i < iScrollFrameCount; i++)
+    {
+        pScrollBar->setValue(pScrollBar->value() + 120);
+        render(view);
+    }
+    std::printf("%-32s %12.3f\n", "scroll frame (wheel)", timer.getElapsedInMs() / iScrollFrameCount);
+
+
+    // The snapshots are made as in AudioCore.
+
+    XTracklist vBatch;
+    for (size_t i = 0; i < IMPORT_BATCH_SIZE; i++)
+    {
+        std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+        pAudio->iTrackID = iTrackCount + i + 1;
+        pAudio->sAudioTitle = L"Imported " + std::to_wstring(i);
+
+        vBatch.push_back(pAudio);
+    }
+
+    timer = TestTimer();
+    std::shared_ptr<IndexedTracklist> pAppended = std::make_shared<IndexedTracklist>(*pTracklist);
+    pAppended->append(vBatch);
+    model.setTracklist(pAppended);
+    render(view);
+    std::printf("%-32s %12.1f\n", "append a batch", timer.getElapsedInMs());
+
+    timer = TestTimer();
+    std::shared_ptr<IndexedTracklist> pRemoved = std::make_shared<IndexedTracklist>(*pAppended);
+    pRemoved->remove(pRemoved->size() / 2);
+    model.setTracklist(pRemoved);
+    render(view);
+    std::printf("%-32s %12.1f\n", "remove a track", timer.getElapsedInMs());
+
+    timer = TestTimer();
+    std::shared_ptr<IndexedTracklist> pMoved = std::make_shared<IndexedTracklist>(*pRemoved);
+    pMoved->move(pMoved->size() / 2, pMoved->size() / 2 - 1);
+    model.setTracklist(pMoved);
+    render(view);
+    std::printf("%-32s %12.1f\n", "move a track up", timer.getElapsedInMs());
+
+    timer = TestTimer();
+    model.setSelectedTrack((*pMoved)[pMoved->size() / 2]->iTrackID);
+    render(view);
+    std::printf("%-32s %12.1f\n", "select a track", timer.getElapsedInMs());
+
+
+    std::printf("\n%-32s %12s\n", "peak memory", "KB");
+    std::printf("%-32s %12zu\n", "tracklist", iTracklistMemoryInKB - iStartMemoryInKB);
+    std::printf("%-32s %12zu\n", "view (over the tracklist)", iViewMemoryInKB - iTracklistMemoryInKB);
+    std::printf("%-32s %12zu\n", "total", getPeakMemoryInKB());
+
+    return model.rowCount() == static_cast<int>(iTrackCount + IMPORT_BATCH_SIZE - 1) ? 0 : 1;
+}
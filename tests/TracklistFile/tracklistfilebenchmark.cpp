@@ -0,0 +1,147 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// Save and open time, file size and memory of a large tracklist in the tracklist file (with the metadata)
+// and in the old format (the count and the 'wchar_t' paths, written here as the old version did).
+// The paths look like a music library: "<root>/Artist N/Album N/NN - Track title N.flac".
+//
+// Usage: TracklistFileBenchmark [track count (default 100000)]
+
+// STL
+#include <cstdlib>
+#include <fstream>
+
+// Custom
+#include "Model/TracklistFile/tracklistfile.h"
+#include "TestUtils/testutils.h"
+
+
+static bool saveOldFormat(const std::filesystem::path& path, const IndexedTracklist& vTracks)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (file.is_open() == false)
+    {
+        return true;
+    }
+
+    unsigned int iTrackCount = static_cast<unsigned int>(vTracks.size());
+    file.write(reinterpret_cast<const char*>(&iTrackCount), sizeof(iTrackCount));
+
+    for (const std::shared_ptr<XAudioFile>& pTrack : vTracks)
+    {
+        unsigned short iPathSize = static_cast<unsigned short>(pTrack->sPathToAudioFile.size());
+        file.write(reinterpret_cast<const char*>(&iPathSize), sizeof(iPathSize));
+        file.write(reinterpret_cast<const char*>(pTrack->sPathToAudioFile.data()), static_cast<std::streamsize>(iPathSize * sizeof(wchar_t)));
+    }
+
+    return file.fail();
+}
+
+
+int main(int argc, char* argv[])
+{
+    const size_t iTrackCount = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000;
+
+    const std::filesystem::path dir = getTestDirectory(L"TracklistFileBenchmark");
+
+    const std::wstring sRoot = (dir / L"Music").wstring();
+
+
+    XTracklist vNewTracks;
+
+    for (size_t i = 0; i < iTrackCount; i++)
+    {
+        // 10 tracks per album, 5 albums per artist.
+        std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+        pAudio->iTrackID = i + 1;
+        pAudio->sPathToAudioFile = sRoot + L"/Artist " + std::to_wstring(i / 50) + L"/Album " + std::to_wstring(i / 10)
+                + L"/" + std::to_wstring(i % 10 + 1) + L" - Track title " + std::to_wstring(i) + L".flac";
+
+        std::shared_ptr<XTrackMetadata> pMetadata = std::make_shared<XTrackMetadata>();
+        pMetadata->iFileSizeInBytes = 30000000 + i;
+        pMetadata->iLastWriteTime   = 1600000000 + static_cast<long long>(i);
+        pMetadata->dLengthInSec     = 180.0 + i % 120;
+        pMetadata->iSampleRate      = 44100;
+        pMetadata->iBitrate         = 1000;
+        pMetadata->iChannels        = 2;
+        pMetadata->iBitsPerSample   = 16;
+        pAudio->pMetadata = pMetadata;
+
+        vNewTracks.push_back(pAudio);
+    }
+
+    IndexedTracklist vTracks;
+    vTracks.append(vNewTracks);
+    vNewTracks.clear();
+
+    const size_t iMemoryBeforeOpenInKB = getPeakMemoryInKB();
+
+
+    const std::filesystem::path newPath = dir / L"tracklist.xtl";
+    const std::filesystem::path oldPath = dir / L"tracklist-old.xtl";
+
+    TestTimer timer;
+    if (TracklistFile::save(newPath.wstring(), vTracks))
+    {
+        std::printf("failed to save the tracklist\n");
+        return 1;
+    }
+    const double dNewSaveInMs = timer.getElapsedInMs();
+
+    timer.restart();
+    if (saveOldFormat(oldPath, vTracks))
+    {
+        std::printf("failed to save the tracklist in the old format\n");
+        return 1;
+    }
+    const double dOldSaveInMs = timer.getElapsedInMs();
+
+
+    std::vector<std::wstring> vPaths;
+    std::vector<std::shared_ptr<const XTrackMetadata>> vMetadata;
+
+    timer.restart();
+    if (TracklistFile::open(oldPath.wstring(), vPaths, vMetadata) || vPaths.size() != iTrackCount)
+    {
+        std::printf("failed to open the tracklist in the old format\n");
+        return 1;
+    }
+    const double dOldOpenInMs = timer.getElapsedInMs();
+
+    timer.restart();
+    if (TracklistFile::open(newPath.wstring(), vPaths, vMetadata) || vPaths.size() != iTrackCount)
+    {
+        std::printf("failed to open the tracklist\n");
+        return 1;
+    }
+    const double dNewOpenInMs = timer.getElapsedInMs();
+
+    size_t iMismatchCount = 0;
+    for (size_t i = 0; i < iTrackCount; i++)
+    {
+        if (vPaths[i] != vTracks[i]->sPathToAudioFile || vMetadata[i] == nullptr
+                || vMetadata[i]->iFileSizeInBytes != vTracks[i]->pMetadata->iFileSizeInBytes)
+        {
+            iMismatchCount++;
+        }
+    }
+
+
+    std::printf("%zu tracks, %zu mismatches after open\n\n", iTrackCount, iMismatchCount);
+    std::printf("%-8s %10s %10s %12s %10s\n", "format", "save ms", "open ms", "size MB", "metadata");
+    std::printf("%-8s %10.1f %10.1f %12.1f %10s\n", "old", dOldSaveInMs, dOldOpenInMs,
+                std::filesystem::file_size(oldPath) / (1024.0 * 1024.0), "no");
+    std::printf("%-8s %10.1f %10.1f %12.1f %10s\n", "xtl", dNewSaveInMs, dNewOpenInMs,
+                std::filesystem::file_size(newPath) / (1024.0 * 1024.0), "yes");
+    std::printf("\npeak memory: %zu KB with the tracklist, %zu KB after save/open\n", iMemoryBeforeOpenInKB, getPeakMemoryInKB());
+
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return iMismatchCount == 0 ? 0 : 1;
+}
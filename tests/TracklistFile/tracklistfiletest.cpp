@@ -0,0 +1,230 @@
+// ******************************************************************
+// This file is part of the Xander.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+// A tracklist (nested and shared directories, non-ASCII names, tracks with and without the metadata)
+// is saved and opened back, the old format is opened and the damaged files are not.
+
+// STL
+#include <fstream>
+
+// Custom
+#include "Model/TracklistFile/tracklistfile.h"
+#include "TestUtils/testutils.h"
+
+
+static unsigned long long iNextTrackID = 1;
+
+
+static std::shared_ptr<XAudioFile> makeTrack(const std::wstring& sPath, bool bWithMetadata)
+{
+    std::shared_ptr<XAudioFile> pAudio = std::make_shared<XAudioFile>();
+    pAudio->iTrackID = iNextTrackID;
+    pAudio->sPathToAudioFile = sPath;
+
+    if (bWithMetadata)
+    {
+        std::shared_ptr<XTrackMetadata> pMetadata = std::make_shared<XTrackMetadata>();
+        pMetadata->iFileSizeInBytes = 1000 + iNextTrackID;
+        pMetadata->iLastWriteTime   = -5000000000LL + static_cast<long long>(iNextTrackID);
+        pMetadata->dLengthInSec     = 123.25 + iNextTrackID;
+        pMetadata->iSampleRate      = 44100;
+        pMetadata->iBitrate         = 320 + static_cast<unsigned int>(iNextTrackID);
+        pMetadata->iChannels        = 2;
+        pMetadata->iBitsPerSample   = 24;
+
+        pAudio->pMetadata = pMetadata;
+    }
+
+    iNextTrackID++;
+
+    return pAudio;
+}
+
+static bool isSameMetadata(const std::shared_ptr<const XTrackMetadata>& pOpened, const std::shared_ptr<const XTrackMetadata>& pSaved)
+{
+    if (pOpened == nullptr || pSaved == nullptr)
+    {
+        return pOpened == pSaved;
+    }
+
+    return pOpened->iFileSizeInBytes == pSaved->iFileSizeInBytes
+            && pOpened->iLastWriteTime == pSaved->iLastWriteTime
+            && pOpened->dLengthInSec == pSaved->dLengthInSec
+            && pOpened->iSampleRate == pSaved->iSampleRate
+            && pOpened->iBitrate == pSaved->iBitrate
+            && pOpened->iChannels == pSaved->iChannels
+            && pOpened->iBitsPerSample == pSaved->iBitsPerSample;
+}
+
+
+static void testRoundTrip(const std::filesystem::path& dir)
+{
+    XTracklist vSaved =
+    {
+        makeTrack(L"/music/Artist/Album/01 - Intro.flac", true),
+        makeTrack(L"/music/Artist/Album/02 - Song.mp3", false),
+        makeTrack(L"/music/Artist/Другой альбом/03 - Песня.ogg", true),
+        makeTrack(L"/music/Artist/Album/CD2/01 - \u00E9t\u00E9 \u266B.wav", true),
+        makeTrack(L"C:\\Music\\Windows\\track.wav", true),
+        makeTrack(L"/music/Artist/Album/01 - Intro.flac", true), // same file twice
+        makeTrack(L"no directory.wav", false),
+        makeTrack(L"/root file.wav", true),
+        makeTrack(L"/music/\U0001F3B5/emoji.wav", true),
+    };
+
+    IndexedTracklist vTracks;
+    vTracks.append(vSaved);
+
+    const std::wstring sPathToFile = (dir / L"tracklist.xtl").wstring();
+
+    XCHECK(TracklistFile::save(sPathToFile, vTracks) == false);
+    XCHECK(std::filesystem::exists(sPathToFile + L".tmp") == false);
+
+
+    std::vector<std::wstring> vPaths;
+    std::vector<std::shared_ptr<const XTrackMetadata>> vMetadata;
+
+    XCHECK(TracklistFile::open(sPathToFile, vPaths, vMetadata) == false);
+
+    XCHECK(vPaths.size() == vSaved.size());
+    XCHECK(vMetadata.size() == vSaved.size());
+
+    for (size_t i = 0; i < vSaved.size() && i < vPaths.size() && i < vMetadata.size(); i++)
+    {
+        XCHECK(vPaths[i] == vSaved[i]->sPathToAudioFile);
+        XCHECK(isSameMetadata(vMetadata[i], vSaved[i]->pMetadata));
+    }
+
+
+    // Saved again over the old file.
+
+    IndexedTracklist vFewTracks;
+    vFewTracks.append({vSaved[1], vSaved[2]});
+
+    XCHECK(TracklistFile::save(sPathToFile, vFewTracks) == false);
+    XCHECK(TracklistFile::open(sPathToFile, vPaths, vMetadata) == false);
+
+    XCHECK(vPaths.size() == 2 && vMetadata.size() == 2);
+    if (vPaths.size() == 2 && vMetadata.size() == 2)
+    {
+        XCHECK(vPaths[0] == vSaved[1]->sPathToAudioFile && vMetadata[0] == nullptr);
+        XCHECK(vPaths[1] == vSaved[2]->sPathToAudioFile && isSameMetadata(vMetadata[1], vSaved[2]->pMetadata));
+    }
+
+
+    // Empty tracklist.
+
+    XCHECK(TracklistFile::save(sPathToFile, IndexedTracklist()) == false);
+    XCHECK(TracklistFile::open(sPathToFile, vPaths, vMetadata) == false);
+    XCHECK(vPaths.empty() && vMetadata.empty());
+}
+
+static void testOldFormat(const std::filesystem::path& dir)
+{
+    const std::vector<std::wstring> vSaved = {L"/music/a.wav", L"/music/\u00E9t\u00E9.flac", L""};
+
+    const std::filesystem::path path = dir / L"old.xtl";
+
+    {
+        std::ofstream file(path, std::ios::binary);
+
+        unsigned int iTrackCount = static_cast<unsigned int>(vSaved.size());
+        file.write(reinterpret_cast<const char*>(&iTrackCount), sizeof(iTrackCount));
+
+        for (const std::wstring& sPath : vSaved)
+        {
+            unsigned short iPathSize = static_cast<unsigned short>(sPath.size());
+            file.write(reinterpret_cast<const char*>(&iPathSize), sizeof(iPathSize));
+            file.write(reinterpret_cast<const char*>(sPath.data()), static_cast<std::streamsize>(sPath.size() * sizeof(wchar_t)));
+        }
+    }
+
+    std::vector<std::wstring> vPaths;
+    std::vector<std::shared_ptr<const XTrackMetadata>> vMetadata;
+
+    XCHECK(TracklistFile::open(path.wstring(), vPaths, vMetadata) == false);
+    XCHECK(vPaths == vSaved);
+    XCHECK(vMetadata.size() == vSaved.size());
+
+    for (const std::shared_ptr<const XTrackMetadata>& pMetadata : vMetadata)
+    {
+        XCHECK(pMetadata == nullptr);
+    }
+}
+
+static void testDamagedFiles(const std::filesystem::path& dir)
+{
+    IndexedTracklist vTracks;
+    vTracks.append({makeTrack(L"/music/Artist/a.wav", true), makeTrack(L"/music/Artist/b.wav", false)});
+
+    const std::filesystem::path path = dir / L"damaged.xtl";
+
+    XCHECK(TracklistFile::save(path.wstring(), vTracks) == false);
+
+    std::vector<char> vFile(static_cast<size_t>(std::filesystem::file_size(path)));
+    {
+        std::ifstream file(path, std::ios::binary);
+        file.read(vFile.data(), static_cast<std::streamsize>(vFile.size()));
+    }
+
+    auto writeAndOpen = [&](const std::vector<char>& vData) -> bool
+    {
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(vData.data(), static_cast<std::streamsize>(vData.size()));
+        }
+
+        std::vector<std::wstring> vPaths;
+        std::vector<std::shared_ptr<const XTrackMetadata>> vMetadata;
+
+        const bool bFailed = TracklistFile::open(path.wstring(), vPaths, vMetadata);
+
+        // Nothing is returned from a damaged file.
+        XCHECK(bFailed == false || (vPaths.empty() && vMetadata.empty()));
+
+        return bFailed;
+    };
+
+
+    // Every truncated file (the strings are at the end).
+    for (size_t iSize = 1; iSize < vFile.size(); iSize++)
+    {
+        XCHECK(writeAndOpen(std::vector<char>(vFile.begin(), vFile.begin() + static_cast<std::ptrdiff_t>(iSize))));
+    }
+
+    // Unknown version.
+    std::vector<char> vDamaged = vFile;
+    vDamaged[4] = 99;
+    XCHECK(writeAndOpen(vDamaged));
+
+    // The track count is larger than the file.
+    vDamaged = vFile;
+    vDamaged[8] = 100;
+    XCHECK(writeAndOpen(vDamaged));
+
+    XCHECK(writeAndOpen(vFile) == false);
+
+
+    std::vector<std::wstring> vPaths;
+    std::vector<std::shared_ptr<const XTrackMetadata>> vMetadata;
+    XCHECK(TracklistFile::open((dir / L"does not exist.xtl").wstring(), vPaths, vMetadata));
+}
+
+
+int main()
+{
+    const std::filesystem::path dir = getTestDirectory(L"TracklistFileTest");
+
+    testRoundTrip(dir);
+    testOldFormat(dir);
+    testDamagedFiles(dir);
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    return finishTest();
+}